@@ -107,54 +107,69 @@ int InSinkRegion(const double x1, const double x2, const double x3) {
 
 
 
+/* Cells intersecting the accretion surface, with their area weights */
+static int    sc_ncells = 0;
+static int    *sc_i, *sc_j, *sc_k;
+static double *sc_area;
+
+
 /* ************************************************ */
-void SphericalAccretion(const Data *d, Grid *grid) {
+static void BuildShellCells(Grid *grid) {
 /*!
- * Calculate the spherical accretion rate through the surface of a sphere.
+ * Build the list of local cells intersecting the spherical
+ * surface of radius ac.rad, together with the area assigned to
+ * each of them. In hybrid mode, the area already includes the
+ * factor 2 of cells detected by both methods and the final
+ * average of the two.
+ * The list only depends on the grid and is rebuilt whenever the
+ * local grid changes (g_gridEpoch).
  *
  ************************************************** */
 
-    /* Accretion */
-
-    int i, j, k;
-    double rho, vs1;
-    double vx1, vx2, vx3;
+    int i, j, k, n;
+    int sicr = 0, sicc = 0;
     double *x1, *x2, *x3;
-    double accr, accr_rate = 0;
+    double area;
 
-#if SINK_METHOD == SINK_BONDI
-    int gcount = 0, lcount = 0;
-    double rho_acc = 0, snd_acc = 0, prs, prs_acc = 0;
-    double tmp_far, snd_far;
-#endif
+    static int once = 0;
+    static double area_per_cell;
 
+    /* Get number of cells lying on spherical surface ac.rad. */
+    if (!once) {
+        int ncells;
+        ncells = SphereSurfaceIntersectsNCells(grid[IDIR].dx[0], grid[JDIR].dx[0], grid[KDIR].dx[0], ac.rad);
+        area_per_cell = ac.area / ncells;
+        once = 1;
+    }
 
-    /* Measure accretion rate through a spherical surface defined by ac->rad (ARAD) */
+    if (sc_i != NULL) {
+        FreeArray1D((void *) sc_i);
+        FreeArray1D((void *) sc_j);
+        FreeArray1D((void *) sc_k);
+        FreeArray1D((void *) sc_area);
+        sc_i = NULL;
+    }
+    sc_ncells = 0;
 
-    if (SphereSurfaceIntersectsDomain(grid, ac.rad)) {
+    if (!SphereSurfaceIntersectsDomain(grid, ac.rad)) return;
 
-        /* Get number of cells lying on spherical surface ac.rad. */
+    /* These are the geometrical central points */
+    x1 = grid[IDIR].x;
+    x2 = grid[JDIR].x;
+    x3 = grid[KDIR].x;
 
-        static int once = 0;
-        static int ncells;
-        static double area_per_cell;
+    /* Two passes: count, then fill */
+    for (n = 0; n < 2; n++) {
 
-        if (!once) {
-            ncells = SphereSurfaceIntersectsNCells(grid[IDIR].dx[0], grid[JDIR].dx[0], grid[KDIR].dx[0], ac.rad);
-            area_per_cell = ac.area / ncells;
-            once = 1;
+        if (n == 1) {
+            if (sc_ncells == 0) return;
+            sc_i = ARRAY_1D(sc_ncells, int);
+            sc_j = ARRAY_1D(sc_ncells, int);
+            sc_k = ARRAY_1D(sc_ncells, int);
+            sc_area = ARRAY_1D(sc_ncells, double);
+            sc_ncells = 0;
         }
 
-
-        /* These are the geometrical central points */
-        x1 = grid[IDIR].x;
-        x2 = grid[JDIR].x;
-        x3 = grid[KDIR].x;
-
-        /* Intersection "booleans" */
-        int sicr = 0;
-        int sicc = 0;
-
         DOM_LOOP(k, j, i) {
 
 #if SIC_METHOD == SIC_RADIUS || SIC_METHOD == SIC_HYBRID
@@ -168,83 +183,116 @@ void SphericalAccretion(const Data *d, Grid *grid) {
                                                                 grid[IDIR].dx[i], grid[JDIR].dx[j], grid[KDIR].dx[k],
                                                                 ac.rad);
 #endif
-                    /* Only for cells "on" the surface, where we measure the accretion rate. */
-                    if (sicr || sicc) {
-
-                        /* Calculate and sum accretion rate */
-                        rho = d->Vc[RHO][k][j][i];
-                        vx1 = vx2 = vx3 = 0;
-                        EXPAND(vx1 = d->Vc[VX1][k][j][i];,
-                               vx2 = d->Vc[VX2][k][j][i];,
-                               vx3 = d->Vc[VX3][k][j][i];);
-                        vs1 = VSPH1(x1[i], x2[j], x3[k], vx1, vx2, vx3);
-                        vs1 = fabs(MIN(vs1, 0));
-
-                        accr = rho * vs1 * area_per_cell;
+                    if (!(sicr || sicc)) continue;
+
+                    if (n == 1) {
+                        area = area_per_cell;
 #if SIC_METHOD == SIC_HYBRID
-                        if (sicr && sicc) accr *= 2;
+                        /* Weight cells found by both methods twice, then average */
+                        if (sicr && sicc) area *= 2;
+                        area /= 2;
 #endif
-                        accr_rate += accr;
+                        sc_i[sc_ncells] = i;
+                        sc_j[sc_ncells] = j;
+                        sc_k[sc_ncells] = k;
+                        sc_area[sc_ncells] = area;
+                    }
+                    sc_ncells++;
 
+                }  // DOM_LOOP
+    }
+}
 
-#if SINK_METHOD == SINK_BONDI
-                        /* Bondi accretion parameters */
-                        rho_acc += rho;
-                        prs = d->Vc[PRS][k][j][i];
-                        prs_acc += prs;
-                        snd_acc += sqrt(g_gamma * prs / rho);
-                        lcount++;
-#endif
 
-                    } // if sicr || sicc
+/* ************************************************ */
+void SphericalAccretion(const Data *d, Grid *grid) {
+/*!
+ * Calculate the spherical accretion rate through the surface of a sphere.
+ * Only the cells intersecting the surface are visited (see
+ * BuildShellCells) and all the sums are reduced at once.
+ *
+ ************************************************** */
+
+    /* Accretion */
 
-                }  // DOM_LOOP
+    int i, j, k, n;
+    double rho, vs1;
+    double vx1, vx2, vx3;
+    double *x1, *x2;
+    static int epoch = -1;
 
-        /* Averaging in HYBRID mode */
-#if SIC_METHOD == SIC_HYBRID
-        accr_rate /= 2;
+    /* Local and global sums: accretion rate, then (Bondi only)
+     * density, pressure, sound speed and number of cells */
+    enum {SUM_ACCR, SUM_RHO, SUM_PRS, SUM_SND, SUM_COUNT, NSUMS};
+    double lsum[NSUMS], gsum[NSUMS];
+
+#if SINK_METHOD == SINK_BONDI
+    double prs, tmp_far, snd_far;
 #endif
 
+
+    /* Measure accretion rate through a spherical surface defined by ac->rad (ARAD) */
+
+    if (epoch != g_gridEpoch) {
+        BuildShellCells(grid);
+        epoch = g_gridEpoch;
     }
 
+    /* These are the geometrical central points */
+    x1 = grid[IDIR].x;
+    x2 = grid[JDIR].x;
 
+    for (n = 0; n < NSUMS; n++) lsum[n] = 0;
 
-    /* Reductions, including MPI reductions,
-     * and calculation of other quantities. */
+    for (n = 0; n < sc_ncells; n++) {
 
-#ifdef PARALLEL
-    MPI_Allreduce(&accr_rate, &ac.accr_rate, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+        i = sc_i[n];
+        j = sc_j[n];
+        k = sc_k[n];
 
-#if SINK_METHOD == SINK_BONDI
+        /* Calculate and sum accretion rate */
+        rho = d->Vc[RHO][k][j][i];
+        vx1 = vx2 = vx3 = 0;
+        EXPAND(vx1 = d->Vc[VX1][k][j][i];,
+               vx2 = d->Vc[VX2][k][j][i];,
+               vx3 = d->Vc[VX3][k][j][i];);
+        vs1 = VSPH1(x1[i], x2[j], grid[KDIR].x[k], vx1, vx2, vx3);
+        vs1 = fabs(MIN(vs1, 0));
 
-    /* MPI reduce Bondi accretion parameters */
-    MPI_Allreduce(&lcount, &gcount, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
-    MPI_Allreduce(&rho_acc, &ac.rho_acc, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
-    MPI_Allreduce(&prs_acc, &ac.prs_acc, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
-    MPI_Allreduce(&snd_acc, &ac.snd_acc, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+        lsum[SUM_ACCR] += rho * vs1 * sc_area[n];
 
-    ac.rho_acc /= gcount;
-    ac.prs_acc /= gcount;
-    ac.snd_acc /= gcount;
+#if SINK_METHOD == SINK_BONDI
+        /* Bondi accretion parameters */
+        lsum[SUM_RHO] += rho;
+        prs = d->Vc[PRS][k][j][i];
+        lsum[SUM_PRS] += prs;
+        lsum[SUM_SND] += sqrt(g_gamma * prs / rho);
+        lsum[SUM_COUNT] += 1;
 #endif
 
-    MPI_Barrier(MPI_COMM_WORLD);
+    }
 
-#else // If not parallel
 
-    ac.accr_rate = accr_rate;
+    /* Reductions, including MPI reductions,
+     * and calculation of other quantities. */
+
+#ifdef PARALLEL
+    MPI_Allreduce(lsum, gsum, NSUMS, MPI_DOUBLE, MPI_SUM, AL_COMM_WORLD);
+#else
+    for (n = 0; n < NSUMS; n++) gsum[n] = lsum[n];
+#endif
+
+    ac.accr_rate = gsum[SUM_ACCR];
 
 #if SINK_METHOD == SINK_BONDI
 
     // TODO: Do we need all these in the structure?
-    ac.rho_acc = rho_acc / lcount;
-    ac.prs_acc = prs_acc / lcount;
-    ac.snd_acc = snd_acc / lcount;
+    ac.rho_acc = gsum[SUM_RHO] / gsum[SUM_COUNT];
+    ac.prs_acc = gsum[SUM_PRS] / gsum[SUM_COUNT];
+    ac.snd_acc = gsum[SUM_SND] / gsum[SUM_COUNT];
 
 #endif
 
-#endif // ifdef PARALLEL
-
     /* Bondi accretion rate - calculate before increasing BH mass */
 #if SINK_METHOD == SINK_BONDI
 
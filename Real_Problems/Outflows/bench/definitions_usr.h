@@ -0,0 +1,26 @@
+/* -- Benchmark: jet, hot halo, fractal clouds, tabulated cooling -- */
+
+#define NOZZLE                   NOZZLE_JET
+#define NOZZLE_CAP               YES
+
+#define ACCRETION                NO
+
+#define GRAV_POTENTIAL           GRAV_DOUBLE_ISOTHERMAL
+
+#define CLOUDS                   YES
+#define CLOUD_REPEAT	         NO
+#define CLOUDS_MULTI   	         NO
+
+/* The clouds are generated in the code (see fractal.c),
+   so that the benchmark needs no input data */
+#define CLOUD_CUBE               CC_FRACTAL
+#define FRACTAL_SEED             1
+
+#define MU_CALC                  MU_ANALYTIC
+
+/* --- Not usually changed ---- */
+#define CLOUD_TCRIT              3.0e4
+#define CLOUD_MUCRIT             0.6212407755077543
+#define CLOUD_EXTRACT            NONE
+#define JD_MODE                  JD_GRAD
+#define BH_POT_SMOOTH            4.0
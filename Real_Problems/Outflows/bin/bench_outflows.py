@@ -0,0 +1,330 @@
+#!/usr/bin/env python3
+## Outflows benchmark and scaling driver.
+##
+## Runs the benchmark configuration in ../bench (jet, hot halo, fractal
+## clouds generated in the code and tabulated cooling) for a fixed number
+## of steps at several resolutions and numbers of processors, and reports
+## zone updates per second per core, parallel efficiency and the time
+## spent in each phase of the step (from the timers printed in pluto.log).
+##
+## The build command copies the setup into a separate directory, replaces
+## definitions.h and definitions_usr.h with the benchmark ones and runs
+## make there (the setup directory itself is left untouched), e.g.
+##
+##   bin/bench_outflows.py build --arch Linux.mpicc.defs
+##   bin/bench_outflows.py run --np 1,2,4,8 --strong 64,128 --weak 48 --label gcc
+##   bin/bench_outflows.py compare gcc.json icc.json
+##
+## The compiler and flags of the build are saved in build.json next to the
+## executable, and recorded with the CPU model in the results.
+##
+## Strong scaling keeps the resolution fixed (-xres) while increasing the
+## number of processors. Weak scaling starts from --weak zones per side on
+## the smallest number of processors and increases the number of zones
+## with the number of processors. The efficiency is the number of zone
+## updates per second per core relative to the smallest run of the
+## series. The first --warmup steps (reading the cooling table, first
+## touch of the arrays, ...) are not measured, the next --steps are.
+##
+## Results are printed and saved as JSON (--out), which can be compared
+## between builds, compilers and machines with the compare command.
+
+import argparse
+import json
+import math
+import os
+import platform
+import re
+import shutil
+import subprocess
+import sys
+import time
+
+SETUP_DIR = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+BUILD_MK = """
+bench-info:
+	@echo "CC=$(CC)"
+	@echo "CFLAGS=$(CFLAGS)"
+	@echo "LDFLAGS=$(LDFLAGS)"
+"""
+PHASES = ['step/boundary', 'step/boundary/exchange', 'step/boundary/int_boundary',
+          'step/states', 'step/riemann', 'step/rhs', 'step/prim_cons', 'step/source']
+
+
+def write_ini(fname, log_freq):
+    """ Copy the benchmark pluto.ini, setting the log frequency """
+    with open(os.path.join(SETUP_DIR, 'bench', 'pluto.ini')) as fh:
+        ini = fh.read()
+    ini = re.sub(r'(?m)^log\s+.*$', 'log          %d' % log_freq, ini)
+    with open(fname, 'w') as fh:
+        fh.write(ini)
+
+
+def parse_log(fname):
+    """ Return the number of zones, the system description and the timer
+        reports (list of (nsteps, {path: (min, avg, max)})) of a pluto.log """
+    zones, system, reports = 1, [], []
+    path, report = [], None
+    in_system = False
+    with open(fname) as fh:
+        for line in fh:
+            m = re.match(r'\s*X[123]: \[.*\],\s*(\d+) point', line)
+            if m:
+                zones *= int(m.group(1))
+            if line.startswith('> System:'):
+                in_system = True
+                continue
+            if in_system:
+                if line.startswith('> '):
+                    in_system = False
+                elif line.strip() and not line.startswith('!'):
+                    system.append(line.strip())
+            m = re.match(r'> Timers, steps (\d+)-(\d+)', line)
+            if m:
+                report = {}
+                reports.append((int(m.group(2)) - int(m.group(1)) + 1, report))
+                path = []
+                continue
+            m = re.match(r'  ( *)(\w+)\s+(\S+)\s+(\S+)\s+(\S+)\s+\S+%$', line)
+            if m and report is not None:
+                level = len(m.group(1)) // 2
+                path = path[:level] + [m.group(2)]
+                report['/'.join(path)] = tuple(float(m.group(i)) for i in (3, 4, 5))
+            elif report is not None and not line.startswith('  '):
+                report = None
+    return zones, system, reports
+
+
+def run_case(args, mode, xres, np):
+    """ Run one case and return its results, or None """
+    rdir = os.path.join(args.workdir, '%s-x%d-p%d' % (mode, xres, np))
+    if os.path.exists(rdir):
+        shutil.rmtree(rdir)
+    os.makedirs(rdir)
+    # Timer reports every log_freq steps; the first warmup/log_freq are skipped
+    if args.warmup > 0:
+        log_freq = math.gcd(args.warmup, args.steps)
+    else:
+        log_freq = args.steps
+    write_ini(os.path.join(rdir, 'pluto.ini'), log_freq)
+    for f in os.listdir(SETUP_DIR):
+        if f.endswith('.dat'):
+            shutil.copy(os.path.join(SETUP_DIR, f), rdir)
+
+    cmd = args.mpirun.format(np=np).split() + [os.path.abspath(args.pluto),
+          '-xres', str(xres), '-maxsteps', str(args.warmup + args.steps), '-no-write']
+    print('> %s' % ' '.join(cmd))
+    sys.stdout.flush()
+    with open(os.path.join(rdir, 'out.txt'), 'w') as out:
+        err = subprocess.call(cmd, cwd=rdir, stdout=out, stderr=subprocess.STDOUT)
+
+    log = os.path.join(rdir, 'pluto.log')
+    if err != 0 or not os.path.exists(log):
+        print('! %s failed, see %s' % (rdir, os.path.join(rdir, 'out.txt')))
+        return None
+    zones, system, reports = parse_log(log)
+    reports = reports[args.warmup // log_freq:]   # skip the warm-up
+    nsteps = sum(n for n, r in reports)
+    if nsteps == 0 or any('step' not in r for n, r in reports):
+        print('! %s: no timers in pluto.log' % rdir)
+        return None
+
+    phases = {}
+    for p in set(k for n, r in reports for k in r):
+        phases[p] = sum(n * r.get(p, (0., 0., 0.))[1] for n, r in reports) / nsteps
+    tstep = sum(n * r['step'][2] for n, r in reports) / nsteps  # slowest proc
+    return {'mode': mode, 'xres': xres, 'np': np, 'zones': zones,
+            'steps': nsteps, 'sec_per_step': tstep,
+            'zups_per_core': zones / tstep / np,
+            'phases': phases, 'system': system}
+
+
+def print_table(runs):
+    print('\n%-6s %5s %10s %5s %10s %11s %6s  %s' % ('mode', 'xres', 'zones', 'np',
+          's/step', 'Mzups/core', 'eff', '  '.join(p.split('/')[-1][:8].rjust(8) for p in PHASES)))
+    for r in runs:
+        eff = '%6.2f' % r['efficiency'] if 'efficiency' in r else '     -'
+        print('%-6s %5d %10d %5d %10.3e %11.4f %s  %s' % (r['mode'], r['xres'], r['zones'],
+              r['np'], r['sec_per_step'], 1.e-6 * r['zups_per_core'], eff,
+              '  '.join('%7.1f%%' % (100. * r['phases'].get(p, 0.) / r['phases']['step'])
+                        for p in PHASES)))
+    print('(phases in percent of the step time, average over the processors)\n')
+
+
+def efficiency(series):
+    """ Parallel efficiency relative to the run with fewest processors """
+    series = [r for r in series if r is not None]
+    if series:
+        ref = min(series, key=lambda r: r['np'])
+        for r in series:
+            r['efficiency'] = r['zups_per_core'] / ref['zups_per_core']
+    return series
+
+
+def compiler_version(cc):
+    """ First line of cc --version """
+    try:
+        out = subprocess.check_output(cc.split() + ['--version'], stderr=subprocess.STDOUT)
+        return out.decode().splitlines()[0].strip()
+    except (OSError, subprocess.CalledProcessError, IndexError):
+        return ''
+
+
+def cpu_model():
+    """ CPU model name, from /proc/cpuinfo where available """
+    try:
+        with open('/proc/cpuinfo') as fh:
+            for line in fh:
+                if line.startswith('model name'):
+                    return line.split(':', 1)[1].strip()
+    except IOError:
+        pass
+    return platform.processor()
+
+
+def cmd_build(args):
+    bdir = os.path.abspath(args.builddir)
+    if os.path.exists(bdir):
+        shutil.rmtree(bdir)
+    os.makedirs(bdir)
+    for f in os.listdir(SETUP_DIR):
+        if f == 'mappers3D.c':      # not used, as in CMakeLists.txt
+            continue
+        if f.endswith(('.c', '.h')) or f in ('makefile', 'local_make'):
+            shutil.copy(os.path.join(SETUP_DIR, f), bdir)
+    for f in ('definitions.h', 'definitions_usr.h'):
+        shutil.copy(os.path.join(SETUP_DIR, 'bench', f), bdir)
+    with open(os.path.join(bdir, 'bench.mk'), 'w') as fh:
+        fh.write(BUILD_MK)
+
+    make = ['make', '-C', bdir, 'PLUTO_DIR=' + os.path.abspath(args.pluto_dir),
+            'ARCH=' + args.arch]
+    if subprocess.call(make + ['-j%d' % args.jobs, 'pluto']) != 0:
+        sys.exit('! Build failed in %s' % bdir)
+
+    info = {'arch': args.arch}
+    out = subprocess.check_output(make + ['-s', '-f', 'makefile', '-f', 'bench.mk',
+                                          'bench-info']).decode()
+    for line in out.splitlines():
+        var, val = line.split('=', 1)
+        info[var.lower()] = ' '.join(val.split())
+    info['cc_version'] = compiler_version(info.get('cc', ''))
+    with open(os.path.join(bdir, 'build.json'), 'w') as fh:
+        json.dump(info, fh, indent=1)
+    print('> Built %s (%s, %s)' % (os.path.join(bdir, 'pluto'), info['cc_version'],
+                                   info.get('cflags', '')))
+
+
+def cmd_run(args):
+    nps = sorted(int(n) for n in args.np.split(','))
+    runs = []
+    os.makedirs(args.workdir, exist_ok=True)
+    for xres in (int(n) for n in args.strong.split(',') if n):
+        runs += efficiency([run_case(args, 'strong', xres, np) for np in nps])
+    if args.weak > 0:
+        series = []
+        for np in nps:
+            xres = args.weak * (np / float(nps[0])) ** (1. / 3.)
+            series.append(run_case(args, 'weak', 2 * int(round(xres / 2.)), np))
+        runs += efficiency(series)
+    print_table(runs)
+
+    binfo = os.path.join(os.path.dirname(os.path.abspath(args.pluto)), 'build.json')
+    if os.path.exists(binfo):
+        with open(binfo) as fh:
+            build = json.load(fh)
+    else:                    # not built by the build command: flags unknown
+        build = {'cc': args.cc, 'cc_version': compiler_version(args.cc), 'cflags': ''}
+
+    result = {'label': args.label, 'date': time.strftime('%Y-%m-%d %H:%M:%S'),
+              'host': platform.node(), 'platform': platform.platform(),
+              'cpu': cpu_model(), 'ncpu': os.cpu_count(), 'build': build,
+              'pluto': os.path.abspath(args.pluto), 'mpirun': args.mpirun,
+              'steps': args.steps, 'warmup': args.warmup, 'runs': runs}
+    try:
+        result['revision'] = subprocess.check_output(['git', '-C', SETUP_DIR, 'describe',
+                             '--always', '--dirty'], stderr=subprocess.DEVNULL).decode().strip()
+    except (OSError, subprocess.CalledProcessError):
+        pass
+    with open(args.out, 'w') as fh:
+        json.dump(result, fh, indent=1)
+    print('> Results written to %s' % args.out)
+
+
+def cmd_compare(args):
+    res = []
+    for fname in args.files:
+        with open(fname) as fh:
+            res.append(json.load(fh))
+    for r, f in zip(res, args.files):
+        b = r.get('build', {})
+        print('%s: %s, %s, %s %s' % (r['label'] or f, r.get('cpu', ''), r['host'],
+              b.get('cc_version', ''), b.get('cflags', '')))
+    print('\n%-6s %5s %5s  %s' % ('mode', 'xres', 'np',
+          '  '.join(('%s' % (r['label'] or f))[:12].rjust(12) for r, f in zip(res, args.files))))
+    keys = []
+    for r in res:
+        for run in r['runs']:
+            k = (run['mode'], run['xres'], run['np'])
+            if k not in keys:
+                keys.append(k)
+    for k in keys:
+        line = '%-6s %5d %5d ' % k
+        ref = None
+        for r in res:
+            run = [x for x in r['runs'] if (x['mode'], x['xres'], x['np']) == k]
+            if not run:
+                line += '%14s' % '-'
+                continue
+            z = run[0]['zups_per_core']
+            ref = ref or z
+            line += ' %7.3f (%4.2f)' % (1.e-6 * z, z / ref)
+        print(line)
+    print('(Mzups/core, and in parentheses relative to the first file)')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Outflows benchmark and scaling driver')
+    sub = parser.add_subparsers(dest='command')
+
+    p = sub.add_parser('build', help='build PLUTO with the benchmark headers')
+    p.add_argument('--arch', required=True, help='configuration file in Config/')
+    p.add_argument('--pluto-dir', default=os.path.join(SETUP_DIR, '..', '..'),
+                   help='PLUTO directory')
+    p.add_argument('--builddir', default='bench_build', help='build directory')
+    p.add_argument('-j', '--jobs', type=int, default=4, help='parallel make jobs')
+
+    p = sub.add_parser('run', help='run the benchmark')
+    p.add_argument('--pluto', default=os.path.join('bench_build', 'pluto'),
+                   help='PLUTO executable')
+    p.add_argument('--cc', default='mpicc',
+                   help='compiler, recorded if the executable has no build.json')
+    p.add_argument('--mpirun', default='mpirun -np {np}', help='MPI launcher, {np} is replaced')
+    p.add_argument('--np', default='1,2,4,8', help='numbers of processors')
+    p.add_argument('--strong', default='64', help='resolutions (zones in x1) for strong scaling')
+    p.add_argument('--weak', type=int, default=0,
+                   help='zones in x1 on the fewest processors for weak scaling (0: none)')
+    p.add_argument('--steps', type=int, default=20, help='measured steps')
+    p.add_argument('--warmup', type=int, default=5, help='steps not measured')
+    p.add_argument('--workdir', default='bench_runs', help='directory of the runs')
+    p.add_argument('--label', default='', help='name of the build/machine')
+    p.add_argument('--out', default='bench.json', help='JSON results file')
+
+    p = sub.add_parser('compare', help='compare JSON results of different runs')
+    p.add_argument('files', nargs='+')
+
+    args = parser.parse_args()
+    if args.command == 'build':
+        cmd_build(args)
+    elif args.command == 'run':
+        if args.steps < 1 or args.warmup < 0:
+            parser.error('--steps must be positive and --warmup not negative')
+        cmd_run(args)
+    elif args.command == 'compare':
+        cmd_compare(args)
+    else:
+        parser.print_help()
+
+
+if __name__ == '__main__':
+    main()
@@ -7,6 +7,7 @@
 #include "clouds.h"
 #include "idealEOS.h"
 #include "hot_halo.h"
+#include "fractal.h"
 
 /* ************************************************************** */
 int CloudCubePixel(int *el, const double x1,
@@ -80,6 +81,11 @@ void ReadFractalData()
 
     static int once01 = 0;
 
+#if CLOUD_CUBE == CC_FRACTAL
+    /* Generated by Startup, see fractal.c */
+    once01 = 1;
+#endif
+
     if (!once01) {
 
 #if CLOUD_VELOCITY != NONE
@@ -114,10 +120,14 @@ void GetFractalData(double *cloud, const double x1, const double x2, const doubl
 
     /* Cloud data is in cartesian coordiantes
        InputDataInterpolate */
+#if CLOUD_CUBE == CC_FRACTAL
+    FractalData(cloud, x1, x2, x3);
+#else
     x = CART1(x1, x2, x3);
     y = CART2(x1, x2, x3);
     z = CART3(x1, x2, x3);
     InputDataInterpolate(cloud, x, y, z);
+#endif
 
 }
 
@@ -545,13 +555,15 @@ int CloudPrimitives(double *cloud,
 {
 
     double halo[NVAR], vel[COMPONENTS], scrh;
-    int nv, cube_pixel[DIMENSIONS];
+    int nv, tag, cube_pixel[DIMENSIONS];
     int is_cloud = 0;
 
     /* Read in fractal data (once) and put into memory.
      * This needs to happen here because CloudCubePixel
      * requires cube data domain extents. */
+    tag = MemoryTag(MEM_CLOUDS);
     ReadFractalData();
+    MemoryTag(tag);
 
     /* Get cloud pixel coordinates */
     if (CloudCubePixel(cube_pixel, x1, x2, x3)) {
@@ -42,6 +42,13 @@ void ParseCmdLineArgs (int argc, char *argv[], char *ini_file,
   cmd->write     = YES;
   cmd->makegrid  = NO; 
   cmd->jet       = -1; /* -- means no direction -- */
+  cmd->repart    = 0;  /* -- means no run-time repartitioning -- */
+  cmd->activity  = 0;  /* -- means all zones are updated -- */
+  cmd->ensemble  = 0;  /* -- means a single run -- */
+  cmd->node_aware = NO;
+  cmd->async_output = NO;
+  cmd->read_ahead = 0;  /* -- means default MPI-IO read buffers -- */
+  cmd->init_threads = 1;
   cmd->show_dec  = NO;
   cmd->xres      = -1; /* -- means no grid resizing -- */
   /* AYW -- 2012-06-19 09:21 JST 
@@ -134,6 +141,74 @@ void ParseCmdLineArgs (int argc, char *argv[], char *ini_file,
       /* -- AYW */
 
 
+    }else if (!strcmp(argv[i],"-repart")){
+
+      if ((++i) >= argc){
+        if (prank == 0) printf ("! You must specify -repart nn\n");
+        QUIT_PLUTO(1);
+      }else{
+        cmd->repart = atoi(argv[i]);
+        if (cmd->repart <= 0) {
+          if (prank == 0) printf ("! You must specify -repart nn, with nn > 0 \n");
+          QUIT_PLUTO(0);
+        }
+      }
+
+    }else if (!strcmp(argv[i],"-ensemble")){
+
+      if ((++i) >= argc){
+        if (prank == 0) printf ("! You must specify -ensemble nn\n");
+        QUIT_PLUTO(1);
+      }else{
+        cmd->ensemble = atoi(argv[i]);
+        if (cmd->ensemble <= 0) {
+          if (prank == 0) printf ("! You must specify -ensemble nn, with nn > 0 \n");
+          QUIT_PLUTO(0);
+        }
+      }
+
+    }else if (!strcmp(argv[i],"-read-ahead")){
+
+      if ((++i) >= argc){
+        if (prank == 0) printf ("! You must specify -read-ahead nn\n");
+        QUIT_PLUTO(1);
+      }else{
+        cmd->read_ahead = atoi(argv[i]);
+        if (cmd->read_ahead <= 0) {
+          if (prank == 0) printf ("! You must specify -read-ahead nn, with nn > 0 \n");
+          QUIT_PLUTO(0);
+        }
+      }
+
+    }else if (!strcmp(argv[i],"-init-threads")){
+
+      if ((++i) >= argc){
+        if (prank == 0) printf ("! You must specify -init-threads nn\n");
+        QUIT_PLUTO(1);
+      }else{
+        cmd->init_threads = atoi(argv[i]);
+        if (cmd->init_threads <= 0) {
+          if (prank == 0) printf ("! You must specify -init-threads nn, with nn > 0 \n");
+          QUIT_PLUTO(0);
+        }
+      }
+
+    }else if (!strcmp(argv[i],"-async-output")) {
+
+      cmd->async_output = YES;
+
+    }else if (!strcmp(argv[i],"-activity")) {
+
+      cmd->activity = ACTIVITY_SKIP;
+
+    }else if (!strcmp(argv[i],"-activity-check")) {
+
+      cmd->activity = ACTIVITY_CHECK;
+
+    }else if (!strcmp(argv[i],"-node-aware")) {
+
+      cmd->node_aware = YES;
+
     }else if (!strcmp(argv[i],"-no-write")) {
 
       cmd->write = NO;
@@ -219,12 +294,20 @@ void ParseCmdLineArgs (int argc, char *argv[], char *ini_file,
     }
   }
 
-/* -- disable domain decomposition in the 
-      direction specified by -xnjet  -- */
+/* -- disable domain decomposition in the direction specified 
+      by -xnjet, unless the active region is periodically 
+      repartitioned along it (-repart) -- */
+
+  if (cmd->repart > 0 && cmd->jet == -1){
+    if (prank == 0) printf ("! -repart requires one of -x1jet, -x2jet, -x3jet\n");
+    QUIT_PLUTO(1);
+  }
 
-  if      (cmd->jet == IDIR) cmd->parallel_dim[IDIR] = NO;
-  else if (cmd->jet == JDIR) cmd->parallel_dim[JDIR] = NO;
-  else if (cmd->jet == KDIR) cmd->parallel_dim[KDIR] = NO;
+  if (cmd->repart == 0){
+    if      (cmd->jet == IDIR) cmd->parallel_dim[IDIR] = NO;
+    else if (cmd->jet == JDIR) cmd->parallel_dim[JDIR] = NO;
+    else if (cmd->jet == KDIR) cmd->parallel_dim[KDIR] = NO;
+  }
 
 }
 /* ******************************************************************* */
@@ -241,6 +324,19 @@ void PrintUsage()
   printf ("           or \n\n");
   printf ("       mpirun -np NP ./pluto [options]\n\n");
   printf ("[options] are:\n\n");
+  printf (" -activity\n");
+  printf ("    Do not update blocks of zones lying far from any flow\n");
+  printf ("    (see Src/activity.c).\n\n");
+
+  printf (" -activity-check\n");
+  printf ("    Update all zones but report, at every log, the largest change\n");
+  printf ("    in the blocks that -activity would have skipped.\n\n");
+
+  printf (" -async-output\n");
+  printf ("    Write output files from a separate thread while the integration\n");
+  printf ("    goes on (see Src/async_output.c). In parallel mode this requires\n");
+  printf ("    an MPI library supporting MPI_THREAD_MULTIPLE.\n\n");
+
   printf (" -dec n1 [n2] [n3]\n");  
   printf ("    Enable user-defined parallel decomposition mode. The integers\n");
   printf ("    n1, n2 and n3 specify the number of processors along the x1,\n");
@@ -248,6 +344,14 @@ void PrintUsage()
   printf ("    number of dimensions and their product must equal the total\n");
   printf ("    number of processors used by mpirun or an error will occurr.\n\n"); 
 
+  printf (" -ensemble n\n");
+  printf ("    Split the processors into n groups of equal size, each running\n");
+  printf ("    an independent simulation (parallel mode only). Group m reads\n");
+  printf ("    its initialization file from the directory ens.mmmm/ and writes\n");
+  printf ("    its output in the same directory (-i and output_dir must be\n");
+  printf ("    relative paths). Tables and input data are read from the current\n");
+  printf ("    directory and are shared by all groups.\n\n");
+
   printf (" -i <name>\n");
   printf ("    Use <name> as initialization file instead of pluto.ini.\n\n");
 
@@ -258,6 +362,11 @@ void PrintUsage()
   printf ("    Restart computations from the n-th output file in HDF5\n");
   printf ("    double precision format (.dbl.h5).\n\n");
 
+  printf (" -init-threads n\n");
+  printf ("    Assign the initial conditions (Startup) with n threads on each\n");
+  printf ("    processor. Large arrays are first touched by the same number\n");
+  printf ("    of threads, to spread their pages over the NUMA domains.\n\n");
+
   printf (" -makegrid\n");
   printf ("    Generate grid only, do not start computations.\n\n");
 
@@ -267,13 +376,32 @@ void PrintUsage()
   printf (" -no-write\n");
   printf ("    Do not write data to disk.\n\n");
   
+  printf (" -node-aware\n");
+  printf ("    Place processors running on the same host next to each other\n");
+  printf ("    in the domain decomposition and exchange their ghost zones\n");
+  printf ("    through shared memory (parallel mode with MPI-3 only).\n\n");
+
   printf (" -no-x1par, -no-x2par, -no-x3par\n");
   printf ("    Do not perform parallel domain decomposition along the x1, x2\n");
   printf ("    or x3 direction, respectively.\n\n");
 
+  printf (" -read-ahead n\n");
+  printf ("    When restarting in parallel mode, read the data files through\n");
+  printf ("    collective buffers of n MB (MPI-IO hints), so that large\n");
+  printf ("    contiguous blocks are read at once whatever the number of\n");
+  printf ("    processors.\n\n");
+
+  printf (" -repart n\n");
+  printf ("    Together with -x1jet, -x2jet or -x3jet: decompose the domain\n");
+  printf ("    along the jet direction as well, and every n steps\n");
+  printf ("    redistribute it among processors so that the active region\n");
+  printf ("    behind the jet front is evenly shared (parallel mode only).\n\n");
+
   printf (" -restart n\n");
   printf ("    Restart computations from the n-th output file in double in\n");
-  printf ("    precision format (.dbl).\n\n");
+  printf ("    precision format (.dbl). Files written with single_file or\n");
+  printf ("    multiple_files mode can be read with any number of\n");
+  printf ("    processors and decomposition.\n\n");
 
   printf (" -show-dec\n");
   printf ("    Show domain decomposition when running in parallel mode.\n\n");
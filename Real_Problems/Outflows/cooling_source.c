@@ -83,6 +83,7 @@ void CoolingSource (const Data *d, double dt, Time_Step *Dts, Grid *GXYZ)
      if (d->flag[k][j][i] & FLAG_INTERNAL_BOUNDARY) continue;
     #endif
     if (d->flag[k][j][i] & FLAG_SPLIT_CELL) continue;
+    if (!ActivityCell(i,j,k)) continue;
    
    /* DM (12/1/2015): Shut off cooling at the Jet plasma */
      if (d->Vc[TRC][k][j][i] != 0.0)  continue;
@@ -0,0 +1,518 @@
+/* ///////////////////////////////////////////////////////////////////// */
+/*!
+  \file
+  \brief In-code generation of log-normal fractal clouds.
+
+  With CLOUD_CUBE == CC_FRACTAL the fractal factor of the clouds is
+  not read from input.flt but generated by Startup() directly on the
+  computational grid:
+
+  - a Gaussian white noise is assigned to every zone of the global
+    grid, using a counter-based generator seeded by FRACTAL_SEED and
+    the global zone index;
+  - the noise is Fourier transformed and multiplied by the amplitude
+    of a power law energy spectrum \f$E(k)\propto k^{\rm FRACTAL\_INDEX}\f$
+    between FRACTAL_KMIN and FRACTAL_KMAX;
+  - the transform is inverted and the resulting Gaussian field
+    \f$g\f$, normalized to zero mean and unit variance, gives the
+    log-normal factor \f$f\propto\exp(s g)\f$, with mean FRACTAL_MEAN
+    and standard deviation FRACTAL_SIGMA.
+
+  Wavenumbers are in units of \f$2\pi/L\f$, \f$L\f$ being the largest
+  side of the domain, and the field is periodic over the domain.
+  The multidimensional FFT is done one direction at a time on the
+  existing domain decomposition: processors sharing the same position
+  in the other two directions exchange their data so that each of them
+  holds complete lines along the current direction, transform them and
+  send them back. Each processor therefore only ever stores its own
+  part of the field, and the result does not depend on the number of
+  processors (up to round-off in the normalization).
+
+  \note Only for Cartesian grids. The grid spacing is assumed to be
+        uniform: on stretched grids the field is generated in index
+        space. Cloud velocities are set to zero.
+
+  \date   Oct 19, 2026
+*/
+/* ///////////////////////////////////////////////////////////////////// */
+#include "pluto.h"
+#include "pluto_usr.h"
+#include "fractal.h"
+#include <stdint.h>
+
+static double ***fr_f;     /**< Fractal factor on the local grid. */
+static Grid *fr_grid;      /**< Local grid on which fr_f is defined. */
+static THREAD_LOCAL int fr_last[3]; /**< Last index found by FractalData(), per thread. */
+static int fr_on = 0;      /**< Whether fr_f is available. */
+
+static void   FractalNoise(double *, Grid *);
+static void   FractalFilter(double *, Grid *);
+static void   FractalLines(double *, Grid *, int, int);
+static void   FractalFFT(double *, int, int);
+static void   FractalFFT2(double *, int, int);
+static double FractalGauss(uint64_t);
+
+/* ********************************************************************* */
+void FractalGenerate(Grid *grid)
+/*!
+ * Generate the fractal factor on the local grid (ghost zones included)
+ * and set the extent of the clouds region used by CloudCubePixel().
+ *
+ * \param [in] grid  pointer to an array of Grid structures
+ *********************************************************************** */
+{
+    int i, j, k, dir, n[3];
+    long int l, ntot;
+    double *f, s[2], nglob, mean, sig, mu, lgs;
+
+    FractalFree();
+    fr_grid = grid;
+
+    for (dir = 0; dir < 3; dir++) n[dir] = grid[dir].np_int;
+    ntot = (long int) n[IDIR] * n[JDIR] * n[KDIR];
+    f = ARRAY_1D(2 * ntot, double);
+
+    print1("> Fractal clouds: %d x %d x %d, E(k) ~ k^%g, k = [%g, %g]\n",
+           grid[IDIR].np_int_glob, grid[JDIR].np_int_glob, grid[KDIR].np_int_glob,
+           FRACTAL_INDEX, FRACTAL_KMIN, FRACTAL_KMAX);
+    print1("                  mean = %g, sigma = %g, seed = %d\n\n",
+           FRACTAL_MEAN, FRACTAL_SIGMA, FRACTAL_SEED);
+
+    /* Gaussian random field */
+    FractalNoise(f, grid);
+    for (dir = 0; dir < DIMENSIONS; dir++) FractalLines(f, grid, dir, -1);
+    FractalFilter(f, grid);
+    for (dir = 0; dir < DIMENSIONS; dir++) FractalLines(f, grid, dir, 1);
+
+    /* Normalize to zero mean and unit variance */
+    s[0] = s[1] = 0.0;
+    for (l = 0; l < ntot; l++) {
+        s[0] += f[2 * l];
+        s[1] += f[2 * l] * f[2 * l];
+    }
+#ifdef PARALLEL
+    MPI_Allreduce(MPI_IN_PLACE, s, 2, MPI_DOUBLE, MPI_SUM, AL_COMM_WORLD);
+#endif
+    nglob = (double) grid[IDIR].np_int_glob * grid[JDIR].np_int_glob * grid[KDIR].np_int_glob;
+    mean = s[0] / nglob;
+    sig = sqrt(MAX(s[1] / nglob - mean * mean, 1.e-300));
+
+    /* Log-normal field, rescaled to the exact mean */
+    lgs = sqrt(log(1.0 + FRACTAL_SIGMA * FRACTAL_SIGMA / (FRACTAL_MEAN * FRACTAL_MEAN)));
+    s[0] = 0.0;
+    for (l = 0; l < ntot; l++) {
+        f[2 * l] = exp(lgs * (f[2 * l] - mean) / sig);
+        s[0] += f[2 * l];
+    }
+#ifdef PARALLEL
+    MPI_Allreduce(MPI_IN_PLACE, s, 1, MPI_DOUBLE, MPI_SUM, AL_COMM_WORLD);
+#endif
+    mu = FRACTAL_MEAN * nglob / s[0];
+
+    /* Copy to the local grid; ghost zones take the nearest interior value */
+    fr_f = ARRAY_3D(grid[KDIR].np_tot, grid[JDIR].np_tot, grid[IDIR].np_tot, double);
+    for (k = 0; k < grid[KDIR].np_tot; k++) {
+    for (j = 0; j < grid[JDIR].np_tot; j++) {
+    for (i = 0; i < grid[IDIR].np_tot; i++) {
+        l = ((long int) (MIN(MAX(k - grid[KDIR].lbeg, 0), n[KDIR] - 1)) * n[JDIR] +
+             MIN(MAX(j - grid[JDIR].lbeg, 0), n[JDIR] - 1)) * n[IDIR] +
+             MIN(MAX(i - grid[IDIR].lbeg, 0), n[IDIR] - 1);
+        fr_f[k][j][i] = mu * f[2 * l];
+    }}}
+    FreeArray1D((void *) f);
+
+    /* The clouds region, as for the cube read from file */
+    D_EXPAND(g_idBoxBeg[IDIR] = g_inputParam[PAR_WX1L];
+             g_idBoxEnd[IDIR] = g_inputParam[PAR_WX1H];  ,
+             g_idBoxBeg[JDIR] = g_inputParam[PAR_WX2L];
+             g_idBoxEnd[JDIR] = g_inputParam[PAR_WX2H];  ,
+             g_idBoxBeg[KDIR] = g_inputParam[PAR_WX3L];
+             g_idBoxEnd[KDIR] = g_inputParam[PAR_WX3H];)
+    g_idnx1 = grid[IDIR].np_int_glob;
+    g_idnx2 = grid[JDIR].np_int_glob;
+    g_idnx3 = grid[KDIR].np_int_glob;
+
+    for (dir = 0; dir < 3; dir++) fr_last[dir] = 0;
+    fr_on = 1;
+}
+
+/* ********************************************************************* */
+void FractalData(double *v, double x1, double x2, double x3)
+/*!
+ * Fill v with the fractal factor (in v[RHO]) of the zone containing
+ * (x1, x2, x3). Velocities are set to zero.
+ *
+ *********************************************************************** */
+{
+    int dir, i, ind[3];
+    double x[3];
+
+    if (!fr_on) {
+        print("! FractalData: the fractal field has not been generated\n");
+        QUIT_PLUTO(1);
+    }
+
+    x[IDIR] = x1; x[JDIR] = x2; x[KDIR] = x3;
+    for (dir = 0; dir < 3; dir++) {
+        Grid *G = fr_grid + dir;
+
+        /* Start from the last zone found, since points usually come in order */
+        i = fr_last[dir];
+        if (x[dir] < G->xl[i] || x[dir] > G->xr[i]) {
+            for (i = 0; i < G->np_tot - 1 && x[dir] > G->xr[i]; i++);
+        }
+        ind[dir] = fr_last[dir] = i;
+    }
+
+    v[RHO] = fr_f[ind[KDIR]][ind[JDIR]][ind[IDIR]];
+    EXPAND(v[VX1] = 0.0;, v[VX2] = 0.0;, v[VX3] = 0.0;)
+}
+
+/* ********************************************************************* */
+void FractalFree(void)
+/*!
+ * Free the fractal field.
+ *
+ *********************************************************************** */
+{
+    if (!fr_on) return;
+    FreeArray3D((void *) fr_f);
+    fr_on = 0;
+}
+
+/* ********************************************************************* */
+static void FractalNoise(double *f, Grid *grid)
+/*
+ * Gaussian white noise with unit variance on the local interior zones.
+ * The value in each zone only depends on FRACTAL_SEED and on the
+ * global zone index.
+ *
+ *********************************************************************** */
+{
+    int i, j, k, n[3], o[3], dir;
+    long int l = 0;
+    uint64_t gi;
+
+    for (dir = 0; dir < 3; dir++) {
+        n[dir] = grid[dir].np_int;
+        o[dir] = grid[dir].beg - grid[dir].nghost;
+    }
+
+    for (k = 0; k < n[KDIR]; k++) {
+    for (j = 0; j < n[JDIR]; j++) {
+    for (i = 0; i < n[IDIR]; i++) {
+        gi = ((uint64_t) (o[KDIR] + k) * grid[JDIR].np_int_glob + o[JDIR] + j) *
+             grid[IDIR].np_int_glob + o[IDIR] + i;
+        f[2 * l] = FractalGauss(gi);
+        f[2 * l + 1] = 0.0;
+        l++;
+    }}}
+}
+
+/* ********************************************************************* */
+static void FractalFilter(double *f, Grid *grid)
+/*
+ * Multiply the Fourier transform of the noise by the spectrum
+ * amplitude. Modes have the same layout as zones.
+ *
+ *********************************************************************** */
+{
+    int i, j, k, dir, m, n[3], o[3];
+    long int l = 0;
+    double kk, kd[3], a, lmax = 0.0, len[3];
+
+    for (dir = 0; dir < 3; dir++) {
+        n[dir] = grid[dir].np_int;
+        o[dir] = grid[dir].beg - grid[dir].nghost;
+        len[dir] = g_domEnd[dir] - g_domBeg[dir];
+        if (dir < DIMENSIONS) lmax = MAX(lmax, len[dir]);
+    }
+
+    for (k = 0; k < n[KDIR]; k++) {
+    for (j = 0; j < n[JDIR]; j++) {
+    for (i = 0; i < n[IDIR]; i++) {
+        kk = 0.0;
+        for (dir = 0; dir < DIMENSIONS; dir++) {
+            m = o[dir] + (dir == IDIR ? i : (dir == JDIR ? j : k));
+            if (2 * m > grid[dir].np_int_glob) m -= grid[dir].np_int_glob;
+            kd[dir] = m * lmax / len[dir];
+            kk += kd[dir] * kd[dir];
+        }
+        kk = sqrt(kk);
+
+        /* E(k) ~ k^(D-1) |a(k)|^2 */
+        if (kk >= FRACTAL_KMIN && kk > 0.0 && (FRACTAL_KMAX <= 0.0 || kk <= FRACTAL_KMAX)) {
+            a = pow(kk, 0.5 * (FRACTAL_INDEX - (DIMENSIONS - 1)));
+        } else {
+            a = 0.0;
+        }
+        f[2 * l] *= a;
+        f[2 * l + 1] *= a;
+        l++;
+    }}}
+}
+
+/* ********************************************************************* */
+static void FractalLines(double *f, Grid *grid, int dir, int sign)
+/*
+ * Fourier transform the local complex field f along dir.
+ * In parallel, the processors with the same coordinates in the other
+ * two directions split the local lines among themselves: each one
+ * receives its lines in full, transforms them and sends them back.
+ *
+ *********************************************************************** */
+{
+    int a, b, n[3], st[3], nd, ng, np, q, c, me;
+    int *cnt, *ofs, *beg, *sc, *sd, *rc, *rd;
+    long int l, nl, m, lb, le, base;
+    double *line, *sbuf, *rbuf;
+
+    for (a = 0; a < 3; a++) n[a] = grid[a].np_int;
+    st[IDIR] = 1;
+    st[JDIR] = n[IDIR];
+    st[KDIR] = n[IDIR] * n[JDIR];
+    a = (dir == IDIR ? JDIR : IDIR);
+    b = (dir == KDIR ? JDIR : KDIR);
+
+    nd = n[dir];
+    ng = grid[dir].np_int_glob;
+    nl = (long int) n[a] * n[b];
+    if (ng == 1) return;
+
+#define LINE_BASE(l) (((l) % n[a]) * st[a] + ((l) / n[a]) * st[b])
+
+#ifdef PARALLEL
+    np = grid[dir].nproc;
+#else
+    np = 1;
+#endif
+    cnt = ARRAY_1D(np, int);
+    ofs = ARRAY_1D(np, int);
+    beg = ARRAY_1D(np + 1, int);
+    sc = ARRAY_1D(np, int);
+    sd = ARRAY_1D(np, int);
+    rc = ARRAY_1D(np, int);
+    rd = ARRAY_1D(np, int);
+
+    /* Size and global offset along dir of each processor in the row */
+#ifdef PARALLEL
+    MPI_Comm row;
+    int mine[2], *all;
+
+    c = (a < DIMENSIONS ? grid[a].rank_coord : 0) +
+        (b < DIMENSIONS ? grid[b].rank_coord : 0) * grid[a].nproc;
+    MPI_Comm_split(AL_COMM_WORLD, c, grid[dir].rank_coord, &row);
+    mine[0] = nd;
+    mine[1] = grid[dir].beg - grid[dir].nghost;
+    all = ARRAY_1D(2 * np, int);
+    MPI_Allgather(mine, 2, MPI_INT, all, 2, MPI_INT, row);
+    for (q = 0; q < np; q++) {
+        cnt[q] = all[2 * q];
+        ofs[q] = all[2 * q + 1];
+    }
+    FreeArray1D((void *) all);
+    me = grid[dir].rank_coord;
+#else
+    cnt[0] = nd;
+    ofs[0] = 0;
+    me = 0;
+#endif
+
+    /* Lines [beg[q], beg[q+1]) are transformed by processor q */
+    for (q = 0; q <= np; q++) beg[q] = (int) (nl * q / np);
+    lb = beg[me];
+    le = beg[me + 1];
+
+    sbuf = ARRAY_1D(2 * nl * nd + 1, double);
+    rbuf = ARRAY_1D(2 * (le - lb) * ng + 1, double);
+    line = ARRAY_1D(2 * ng, double);
+
+    /* Pack, one processor at a time */
+    m = 0;
+    for (q = 0; q < np; q++) {
+        sd[q] = (int) m;
+        for (l = beg[q]; l < beg[q + 1]; l++) {
+            base = LINE_BASE(l);
+            for (c = 0; c < nd; c++) {
+                sbuf[m++] = f[2 * (base + c * st[dir])];
+                sbuf[m++] = f[2 * (base + c * st[dir]) + 1];
+            }
+        }
+        sc[q] = (int) m - sd[q];
+        rc[q] = (int) (2 * (le - lb) * cnt[q]);
+        rd[q] = (q == 0 ? 0 : rd[q - 1] + rc[q - 1]);
+    }
+
+#ifdef PARALLEL
+    MPI_Alltoallv(sbuf, sc, sd, MPI_DOUBLE, rbuf, rc, rd, MPI_DOUBLE, row);
+#else
+    memcpy(rbuf, sbuf, sc[0] * sizeof(double));
+#endif
+
+    /* Assemble complete lines, transform and put back in place */
+    for (l = 0; l < le - lb; l++) {
+        for (q = 0; q < np; q++) {
+            memcpy(line + 2 * ofs[q], rbuf + rd[q] + 2 * l * cnt[q],
+                   2 * cnt[q] * sizeof(double));
+        }
+        FractalFFT(line, ng, sign);
+        for (q = 0; q < np; q++) {
+            memcpy(rbuf + rd[q] + 2 * l * cnt[q], line + 2 * ofs[q],
+                   2 * cnt[q] * sizeof(double));
+        }
+    }
+
+#ifdef PARALLEL
+    MPI_Alltoallv(rbuf, rc, rd, MPI_DOUBLE, sbuf, sc, sd, MPI_DOUBLE, row);
+    MPI_Comm_free(&row);
+#else
+    memcpy(sbuf, rbuf, sc[0] * sizeof(double));
+#endif
+
+    /* Unpack */
+    m = 0;
+    for (l = 0; l < nl; l++) {
+        base = LINE_BASE(l);
+        for (c = 0; c < nd; c++) {
+            f[2 * (base + c * st[dir])] = sbuf[m++];
+            f[2 * (base + c * st[dir]) + 1] = sbuf[m++];
+        }
+    }
+#undef LINE_BASE
+
+    FreeArray1D((void *) line);
+    FreeArray1D((void *) sbuf);
+    FreeArray1D((void *) rbuf);
+    FreeArray1D((void *) cnt);
+    FreeArray1D((void *) ofs);
+    FreeArray1D((void *) beg);
+    FreeArray1D((void *) sc);
+    FreeArray1D((void *) sd);
+    FreeArray1D((void *) rc);
+    FreeArray1D((void *) rd);
+}
+
+/* ********************************************************************* */
+static void FractalFFT(double *z, int n, int sign)
+/*
+ * Unnormalized discrete Fourier transform of the n complex numbers
+ * in z (interleaved real and imaginary parts), with exponent sign.
+ * Powers of two are done directly, other lengths with Bluestein's
+ * algorithm.
+ *
+ *********************************************************************** */
+{
+    int i, m;
+    long int kk;
+    double *w, *a, *b, re, im;
+
+    if ((n & (n - 1)) == 0) {
+        FractalFFT2(z, n, sign);
+        return;
+    }
+
+    for (m = 1; m < 2 * n - 1; m <<= 1);
+    w = ARRAY_1D(2 * n, double);
+    a = ARRAY_1D(2 * m, double);
+    b = ARRAY_1D(2 * m, double);
+
+    /* Chirp w_i = exp(-sign i pi i^2 / n), with i^2 taken modulo 2n */
+    for (i = 0; i < n; i++) {
+        kk = ((long int) i * i) % (2 * n);
+        w[2 * i] = cos(CONST_PI * kk / n);
+        w[2 * i + 1] = -sign * sin(CONST_PI * kk / n);
+    }
+
+    for (i = 0; i < 2 * m; i++) a[i] = b[i] = 0.0;
+    for (i = 0; i < n; i++) {
+        a[2 * i] = z[2 * i] * w[2 * i] + z[2 * i + 1] * w[2 * i + 1];
+        a[2 * i + 1] = z[2 * i + 1] * w[2 * i] - z[2 * i] * w[2 * i + 1];
+    }
+    b[0] = w[0];
+    b[1] = w[1];
+    for (i = 1; i < n; i++) {
+        b[2 * i] = b[2 * (m - i)] = w[2 * i];
+        b[2 * i + 1] = b[2 * (m - i) + 1] = w[2 * i + 1];
+    }
+
+    /* Convolution */
+    FractalFFT2(a, m, -1);
+    FractalFFT2(b, m, -1);
+    for (i = 0; i < m; i++) {
+        re = a[2 * i] * b[2 * i] - a[2 * i + 1] * b[2 * i + 1];
+        im = a[2 * i] * b[2 * i + 1] + a[2 * i + 1] * b[2 * i];
+        a[2 * i] = re / m;
+        a[2 * i + 1] = im / m;
+    }
+    FractalFFT2(a, m, 1);
+
+    for (i = 0; i < n; i++) {
+        z[2 * i] = a[2 * i] * w[2 * i] + a[2 * i + 1] * w[2 * i + 1];
+        z[2 * i + 1] = a[2 * i + 1] * w[2 * i] - a[2 * i] * w[2 * i + 1];
+    }
+
+    FreeArray1D((void *) w);
+    FreeArray1D((void *) a);
+    FreeArray1D((void *) b);
+}
+
+/* ********************************************************************* */
+static void FractalFFT2(double *z, int n, int sign)
+/*
+ * In-place radix-2 FFT; n must be a power of two.
+ *
+ *********************************************************************** */
+{
+    int i, j, k, len;
+    double t, wr, wi, ur, ui, ang;
+
+    /* Bit reversal */
+    for (i = 1, j = 0; i < n; i++) {
+        for (k = n >> 1; j & k; k >>= 1) j ^= k;
+        j ^= k;
+        if (i < j) {
+            t = z[2 * i]; z[2 * i] = z[2 * j]; z[2 * j] = t;
+            t = z[2 * i + 1]; z[2 * i + 1] = z[2 * j + 1]; z[2 * j + 1] = t;
+        }
+    }
+
+    for (len = 2; len <= n; len <<= 1) {
+        ang = sign * 2.0 * CONST_PI / len;
+        for (k = 0; k < len / 2; k++) {
+            wr = cos(ang * k);
+            wi = sin(ang * k);
+            for (i = k; i < n; i += len) {
+                j = i + len / 2;
+                ur = z[2 * j] * wr - z[2 * j + 1] * wi;
+                ui = z[2 * j] * wi + z[2 * j + 1] * wr;
+                z[2 * j] = z[2 * i] - ur;
+                z[2 * j + 1] = z[2 * i + 1] - ui;
+                z[2 * i] += ur;
+                z[2 * i + 1] += ui;
+            }
+        }
+    }
+}
+
+/* ********************************************************************* */
+static double FractalGauss(uint64_t n)
+/*
+ * Standard normal deviate number n of the sequence seeded by
+ * FRACTAL_SEED (splitmix64 followed by Box-Muller).
+ *
+ *********************************************************************** */
+{
+    int s;
+    uint64_t z, u[2];
+
+    for (s = 0; s < 2; s++) {
+        z = ((uint64_t) FRACTAL_SEED << 32) + 2 * n + s + 0x9e3779b97f4a7c15ULL;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        u[s] = z ^ (z >> 31);
+    }
+
+    /* Uniform deviates in (0, 1] and [0, 1) */
+    return sqrt(-2.0 * log(((u[0] >> 11) + 1.0) / 9007199254740992.0)) *
+           cos(2.0 * CONST_PI * (u[1] >> 11) / 9007199254740992.0);
+}
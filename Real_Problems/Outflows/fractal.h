@@ -0,0 +1,14 @@
+//
+// In-code generation of log-normal fractal clouds (CLOUD_CUBE == CC_FRACTAL).
+//
+
+#ifndef PLUTO_FRACTAL_H
+#define PLUTO_FRACTAL_H
+
+void FractalGenerate(Grid *grid);
+
+void FractalData(double *v, double x1, double x2, double x3);
+
+void FractalFree(void);
+
+#endif //PLUTO_FRACTAL_H
@@ -0,0 +1,248 @@
+/* ///////////////////////////////////////////////////////////////////// */
+/*!
+  \file
+  \brief Initial conditions cache.
+
+  Assigning the halo and the clouds is by far the most expensive part
+  of Startup(), and it is repeated identically by runs that differ in
+  the nozzle parameters only (e.g. a sweep in PAR_OPOW, PAR_OSPD, ...).
+  With IC_CACHE == YES the halo and clouds primitives (see
+  InitBackground()) are written by Startup() to the directory
+  IC_CACHE_DIR, one file per processor:
+
+  \verbatim
+  IC_CACHE_DIR/ic_<key>.bin
+  \endverbatim
+
+  where \c key is a 64-bit hash of everything the background depends
+  on:
+
+  - the compile-time options of the halo and clouds setup;
+  - the local grid (ghost zones included), so that each processor has
+    its own file and a different decomposition gives different keys;
+  - all the user parameters, except the nozzle ones (PAR_OPOW, PAR_OSPD,
+    PAR_OMDT, PAR_OANG, PAR_ORAD, PAR_ODBH, PAR_ODIR, PAR_OOMG,
+    PAR_OPHI);
+  - size and modification time of the input files (grid_in, input.flt
+    and the tables).
+
+  Later runs with the same key read the file back and Startup() only
+  assigns the nozzle on top of it (see InitNozzle()).
+  The file contains, in native byte order:
+
+  \verbatim
+  char   tag[8]           "PLUTOICC"
+  uint64 key
+  int    nvar, nx1_tot, nx2_tot, nx3_tot
+  double Vc[nvar][nx3_tot][nx2_tot][nx1_tot]
+  \endverbatim
+
+  Files are written under a temporary name and then renamed, so that
+  runs sharing the cache directory never read a partial file.
+
+  \date   Oct 19, 2026
+*/
+/* ///////////////////////////////////////////////////////////////////// */
+#include "pluto.h"
+#include "pluto_usr.h"
+#include "ic_cache.h"
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define IC_CACHE_TAG "PLUTOICC"
+
+static uint64_t ICCacheKey(Grid *);
+static uint64_t ICHash(uint64_t, const void *, size_t);
+static uint64_t ICHashFile(uint64_t, char *);
+static void ICCacheName(char *, uint64_t);
+
+static uint64_t ic_key;  /**< Key of the local grid, set by ICCacheLoad(). */
+
+/* ********************************************************************* */
+int ICCacheLoad(Data *d, Grid *grid)
+/*!
+ * Read the halo and clouds primitives of the local grid into d->Vc,
+ * if a cache file with the right key exists.
+ *
+ * \return 1 if d->Vc has been filled on all processors, 0 otherwise.
+ *********************************************************************** */
+{
+    int nv, head[4], hit = 0;
+    size_t n;
+    char fname[512], tag[8];
+    uint64_t key, fkey;
+    FILE *fp;
+
+    key = ic_key = ICCacheKey(grid);
+    ICCacheName(fname, key);
+    n = (size_t) NX1_TOT * NX2_TOT * NX3_TOT;
+
+    fp = fopen(fname, "rb");
+    if (fp != NULL) {
+        if (fread(tag, sizeof(char), 8, fp) == 8 && !strncmp(tag, IC_CACHE_TAG, 8) &&
+            fread(&fkey, sizeof(uint64_t), 1, fp) == 1 && fkey == key &&
+            fread(head, sizeof(int), 4, fp) == 4 && head[0] == NVAR &&
+            head[1] == NX1_TOT && head[2] == NX2_TOT && head[3] == NX3_TOT) {
+            hit = 1;
+            for (nv = 0; nv < NVAR && hit; nv++) {
+                hit = (fread(d->Vc[nv][0][0], sizeof(double), n, fp) == n);
+            }
+        }
+        fclose(fp);
+    }
+
+    /* All processors either use the cache or build the initial conditions */
+#ifdef PARALLEL
+    MPI_Allreduce(MPI_IN_PLACE, &hit, 1, MPI_INT, MPI_MIN, AL_COMM_WORLD);
+#endif
+
+    if (hit) print1("> IC cache: halo and clouds read from %s\n", IC_CACHE_DIR);
+    return hit;
+}
+
+/* ********************************************************************* */
+void ICCacheSave(const Data *d, Grid *grid)
+/*!
+ * Write the halo and clouds primitives of the local grid, currently
+ * in d->Vc, to the cache. ICCacheLoad() must have been called before,
+ * since the key is computed from the parameters as they were before
+ * the initial conditions were assigned.
+ *
+ *********************************************************************** */
+{
+    int nv, head[4];
+    size_t n;
+    char fname[512], tmpname[600];
+    uint64_t key = ic_key;
+    FILE *fp;
+
+    ICCacheName(fname, key);
+    sprintf(tmpname, "%s.%d.tmp", fname, (int) getpid());
+    n = (size_t) NX1_TOT * NX2_TOT * NX3_TOT;
+
+    mkdir(IC_CACHE_DIR, 0755);
+    fp = fopen(tmpname, "wb");
+    if (fp == NULL) {
+        print("! ICCacheSave: cannot open %s\n", tmpname);
+        return;
+    }
+
+    head[0] = NVAR;
+    head[1] = NX1_TOT;
+    head[2] = NX2_TOT;
+    head[3] = NX3_TOT;
+    fwrite(IC_CACHE_TAG, sizeof(char), 8, fp);
+    fwrite(&key, sizeof(uint64_t), 1, fp);
+    fwrite(head, sizeof(int), 4, fp);
+    for (nv = 0; nv < NVAR; nv++) fwrite(d->Vc[nv][0][0], sizeof(double), n, fp);
+
+    if (fclose(fp) != 0 || rename(tmpname, fname) != 0) {
+        print("! ICCacheSave: cannot write %s\n", fname);
+        remove(tmpname);
+        return;
+    }
+    print1("> IC cache: halo and clouds written to %s\n", IC_CACHE_DIR);
+}
+
+/* ********************************************************************* */
+static uint64_t ICCacheKey(Grid *grid)
+/*
+ * Hash of everything the halo and clouds primitives depend on.
+ *
+ *********************************************************************** */
+{
+    int n, dir;
+    uint64_t h = 14695981039346656037ULL;
+    int nozzle[] = {PAR_OPOW, PAR_OSPD, PAR_OMDT, PAR_OANG, PAR_ORAD,
+                    PAR_ODBH, PAR_ODIR, PAR_OOMG, PAR_OPHI, -1};
+
+    /* Compile-time options */
+    int iopt[] = {DIMENSIONS, COMPONENTS, GEOMETRY, PHYSICS, EOS, NVAR,
+                  USE_FOUR_VELOCITY, INTERNAL_BOUNDARY, CLOUDS,
+                  CLOUD_DENSITY, CLOUD_SCALE, CLOUD_VELOCITY,
+                  CLOUD_EXTRACT, GRAV_POTENTIAL, MU_CALC,
+#ifdef CLOUD_REPEAT
+                  CLOUD_REPEAT,
+#endif
+                  CLOUD_CUBE, FRACTAL_SEED, USER_DEF_PARAMETERS};
+    double dopt[] = {UNIT_DENSITY, UNIT_LENGTH, UNIT_VELOCITY,
+                     CLOUD_UNDERPRESSURE, CLOUD_TCRIT, MU_NORM,
+#ifdef CLOUD_MUCRIT
+                     CLOUD_MUCRIT,
+#endif
+                     FRACTAL_INDEX, FRACTAL_KMIN, FRACTAL_KMAX,
+                     FRACTAL_MEAN, FRACTAL_SIGMA, g_gamma};
+
+    h = ICHash(h, IC_CACHE_TAG, 8);
+    h = ICHash(h, iopt, sizeof(iopt));
+    h = ICHash(h, dopt, sizeof(dopt));
+    h = ICHash(h, CUBE_ENDIANNESS, strlen(CUBE_ENDIANNESS));
+
+    /* Local grid */
+    for (dir = 0; dir < 3; dir++) {
+        h = ICHash(h, &grid[dir].np_tot, sizeof(int));
+        h = ICHash(h, grid[dir].x, grid[dir].np_tot * sizeof(double));
+    }
+
+    /* User parameters, but the nozzle ones */
+    for (n = 0; n < USER_DEF_PARAMETERS; n++) {
+        for (dir = 0; nozzle[dir] >= 0 && nozzle[dir] != n; dir++);
+        if (nozzle[dir] < 0) h = ICHash(h, g_inputParam + n, sizeof(double));
+    }
+
+    /* Input files */
+    h = ICHashFile(h, "./grid_in.out");
+    h = ICHashFile(h, "./grid_in.bin");
+    h = ICHashFile(h, "./input.flt");
+    h = ICHashFile(h, GRAV_FNAME);
+    h = ICHashFile(h, HOT_FNAME);
+    h = ICHashFile(h, MU_FNAME);
+
+    return h;
+}
+
+/* ********************************************************************* */
+static uint64_t ICHash(uint64_t h, const void *p, size_t n)
+/*
+ * Update the 64-bit FNV-1a hash h with n bytes at p.
+ *
+ *********************************************************************** */
+{
+    size_t i;
+    const unsigned char *c = (const unsigned char *) p;
+
+    for (i = 0; i < n; i++) {
+        h ^= c[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/* ********************************************************************* */
+static uint64_t ICHashFile(uint64_t h, char *fname)
+/*
+ * Update h with the size and modification time of a file
+ * (nothing if the file does not exist).
+ *
+ *********************************************************************** */
+{
+    struct stat st;
+    int64_t s[2];
+
+    if (stat(fname, &st) != 0) return h;
+    s[0] = (int64_t) st.st_size;
+    s[1] = (int64_t) st.st_mtime;
+    h = ICHash(h, fname, strlen(fname));
+    return ICHash(h, s, sizeof(s));
+}
+
+/* ********************************************************************* */
+static void ICCacheName(char *fname, uint64_t key)
+/*
+ * Name of the cache file for the hash key in IC_CACHE_DIR.
+ *
+ *********************************************************************** */
+{
+    sprintf(fname, "%s/ic_%016llx.bin", IC_CACHE_DIR, (unsigned long long) key);
+}
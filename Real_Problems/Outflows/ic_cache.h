@@ -0,0 +1,12 @@
+//
+// Initial conditions cache: halo and clouds primitives reused by
+// runs that differ in the nozzle parameters only.
+//
+
+#ifndef PLUTO_IC_CACHE_H
+#define PLUTO_IC_CACHE_H
+
+int  ICCacheLoad(Data *d, Grid *grid);
+void ICCacheSave(const Data *d, Grid *grid);
+
+#endif //PLUTO_IC_CACHE_H
@@ -21,9 +21,15 @@
 #include "clouds.h"
 #include "grid_geometry.h"
 #include "hot_halo.h"
+#include "insitu.h"
 #include "outflow.h"
 
 
+static void InitOnce (void);
+static int  NozzlePrimitives (double *, double, double, double);
+static void BackgroundPrimitives (double *, double, double, double);
+static void InitFinish (double *);
+
 /* ********************************************************************* */
 void Init (double *v, double x1, double x2, double x3)
 /*! 
@@ -52,51 +58,95 @@ void Init (double *v, double x1, double x2, double x3)
  *
  *********************************************************************** */
 {
+    InitOnce();
 
-    int nv;
+    /* Initialize nozzle if we're in hemisphere around
+     * nozzle inlet region, otherwise halo */
+    if (!NozzlePrimitives(v, x1, x2, x3)) BackgroundPrimitives(v, x1, x2, x3);
+
+    InitFinish(v);
+}
+
+/* ********************************************************************* */
+void InitBackground (double *v, double x1, double x2, double x3)
+/*!
+ * Same as Init(), but the nozzle is ignored: only the halo (and
+ * clouds) primitives are assigned. Used to build the initial
+ * conditions cache (see ic_cache.c).
+ *
+ *********************************************************************** */
+{
+    InitOnce();
+    BackgroundPrimitives(v, x1, x2, x3);
+    InitFinish(v);
+}
+
+/* ********************************************************************* */
+void InitNozzle (double *v, double x1, double x2, double x3)
+/*!
+ * Same as Init(), for v already set by InitBackground(): only the
+ * nozzle (and flank) regions are assigned, v is left unchanged
+ * elsewhere.
+ *
+ *********************************************************************** */
+{
+    InitOnce();
+    NozzlePrimitives(v, x1, x2, x3);
+    InitFinish(v);
+}
+
+/* ********************************************************************* */
+static void InitOnce (void)
+/*
+ * Some things that only need to be done once
+ *
+ *********************************************************************** */
+{
     double halo_primitives[NVAR], out_primitives[NVAR];
-#if CLOUDS
-    double cloud_primitives[NVAR];
-#endif
     static int once01 = 0;
 
+    if (once01) return;
 
-    /* Some things that only need to be done once */
-    if (!once01) {
-
-        /* Initialize base normalization struct */
-        SetBaseNormalization();
+    /* Initialize base normalization struct */
+    SetBaseNormalization();
 
-        /* Set normalization factors for input parameters */
-        SetIniNormalization();
+    /* Set normalization factors for input parameters */
+    SetIniNormalization();
 
-        /* Set outflow geometry struct with parameters of cone */
-        SetNozzleGeometry();
+    /* Set outflow geometry struct with parameters of cone */
+    SetNozzleGeometry();
 
 #if ACCRETION == YES
-        /* Set outflow geometry struct with parameters of cone */
-        SetAccretionPhysics();
+    /* Set outflow geometry struct with parameters of cone */
+    SetAccretionPhysics();
 #endif
 
-        double dx;
-        dx = FLOWAXIS((g_domEnd[IDIR] - g_domBeg[IDIR]) / NX1;,
-                      (g_domEnd[JDIR] - g_domBeg[JDIR]) / NX2;,
-                      (g_domEnd[KDIR] - g_domBeg[KDIR]) / NX3;);
+    double dx;
+    dx = FLOWAXIS((g_domEnd[IDIR] - g_domBeg[IDIR]) / NX1;,
+                  (g_domEnd[JDIR] - g_domBeg[JDIR]) / NX2;,
+                  (g_domEnd[KDIR] - g_domBeg[KDIR]) / NX3;);
 
-        /* Print some data */
-        OutflowPrimitives(out_primitives, ARG_FLOWAXIS(dx, 0), 0);
-        HotHaloPrimitives(halo_primitives, ARG_FLOWAXIS(dx, 0));
-        PrintInitData01(out_primitives, halo_primitives);
-
-        /* Done once now */
-        once01 = 1;
-    }
+    /* Print some data */
+    OutflowPrimitives(out_primitives, ARG_FLOWAXIS(dx, 0), 0);
+    HotHaloPrimitives(halo_primitives, ARG_FLOWAXIS(dx, 0));
+    PrintInitData01(out_primitives, halo_primitives);
 
+    /* Done once now */
+    once01 = 1;
+}
 
-    /* Initialize nozzle if we're in hemisphere around
-     * nozzle inlet region, otherwise halo */
+/* ********************************************************************* */
+static int NozzlePrimitives (double *v, double x1, double x2, double x3)
+/*
+ * Fill v in the nozzle (and flank) regions.
+ * Return 1 if (x1, x2, x3) is in one of these regions, 0 otherwise.
+ *
+ *********************************************************************** */
+{
+    int nv;
+    double halo_primitives[NVAR], out_primitives[NVAR];
 
-     if (InNozzleRegion(x1, x2, x3) || InNozzleCap(x1, x2, x3)) {
+    if (InNozzleRegion(x1, x2, x3) || InNozzleCap(x1, x2, x3)) {
 
         OutflowPrimitives(out_primitives, x1, x2, x3, 0);
         HotHaloPrimitives(halo_primitives, x1, x2, x3);
@@ -105,6 +155,7 @@ void Init (double *v, double x1, double x2, double x3)
             v[nv] = halo_primitives[nv] +
                     (out_primitives[nv] - halo_primitives[nv]) * Profile(x1, x2, x3);
         }
+        return 1;
     }
 
 #if INTERNAL_BOUNDARY == YES
@@ -115,34 +166,55 @@ void Init (double *v, double x1, double x2, double x3)
         for (nv = 0; nv < NVAR; ++nv) {
             v[nv] = halo_primitives[nv];
         }
+        return 1;
     }
 #endif
 
-        /* Initialize halo. Hot, and warm, if included */
-    else {
+    return 0;
+}
 
-        /* First get primitives array for hot halo */
-        HotHaloPrimitives(halo_primitives, x1, x2, x3);
+/* ********************************************************************* */
+static void BackgroundPrimitives (double *v, double x1, double x2, double x3)
+/*
+ * Initialize halo. Hot, and warm, if included
+ *
+ *********************************************************************** */
+{
+    int nv;
+    double halo_primitives[NVAR];
+#if CLOUDS
+    double cloud_primitives[NVAR];
+#endif
+
+    /* First get primitives array for hot halo */
+    HotHaloPrimitives(halo_primitives, x1, x2, x3);
 
 #if CLOUDS && CLOUDS_MULTI == NO
 
-        /* If we're in the domain of the clouds cube */
-        if (CloudPrimitives(cloud_primitives, x1, x2, x3)){
-          for (nv = 0; nv < NVAR; ++nv) v[nv] = cloud_primitives[nv];
-        }
-        /* If not a cloud pixel then use hot halo primitives*/
-        else{
-          for (nv = 0; nv < NVAR; ++nv) v[nv] = halo_primitives[nv];
-        }
+    /* If we're in the domain of the clouds cube */
+    if (CloudPrimitives(cloud_primitives, x1, x2, x3)){
+      for (nv = 0; nv < NVAR; ++nv) v[nv] = cloud_primitives[nv];
+    }
+    /* If not a cloud pixel then use hot halo primitives*/
+    else{
+      for (nv = 0; nv < NVAR; ++nv) v[nv] = halo_primitives[nv];
+    }
 
 #else
 
-        /* Hot halo */
-        for (nv = 0; nv < NVAR; ++nv) v[nv] = halo_primitives[nv];
+    /* Hot halo */
+    for (nv = 0; nv < NVAR; ++nv) v[nv] = halo_primitives[nv];
 #endif
+}
 
-    }
-
+/* ********************************************************************* */
+static void InitFinish (double *v)
+/*
+ * Set the cooling limits and zero the magnetic field and vector
+ * potential of the primitives v, common to all the regions.
+ *
+ *********************************************************************** */
+{
 #if COOLING
     g_minCoolingTemp = 1.e4;
     g_maxCoolingRate = 0.1;
@@ -159,7 +231,6 @@ void Init (double *v, double x1, double x2, double x3)
     v[AX3] = 0.0;
 
 #endif
-
 }
 
 
@@ -186,6 +257,8 @@ void Analysis (const Data *d, Grid *grid)
 
 #endif
 
+    /* Slices, projections and profiles */
+    InSituAnalysis(d, grid);
 
 }
 
@@ -259,6 +332,9 @@ void UserDefBoundary (const Data *d, RBox *box, int side, Grid *grid)
 
             TOT_LOOP(k, j, i) {
 
+                        /* Internal boundary zones pin their tiles, which therefore stay active */
+                        if (!ActivityCell(i, j, k)) continue;
+
                         if (InNozzleRegion(x1[i], x2[j], x3[k])) {
 
 #if ACCRETION == YES
@@ -326,6 +402,8 @@ void UserDefBoundary (const Data *d, RBox *box, int side, Grid *grid)
             /* Copy solution over in case of using Spherical inward free-flowing broundary conditions */
             TOT_LOOP(k, j, i) {
 
+                        if (!ActivityCell(i, j, k)) continue;
+
                         if (InSinkRegion(x1[i], x2[j], x3[k])) {
                             for (nv = 0; nv < NVAR; ++nv) {
                                 d->Vc[nv][k][j][i] = Vc_new[nv][k][j][i];
@@ -268,7 +268,7 @@ void PrintGridStruct(Grid *grid, int show_for_rank, int k, int j, int i) {
 
     int prank = 0;
 #ifdef PARALLEL
-    MPI_Comm_rank(MPI_COMM_WORLD, &prank);
+    MPI_Comm_rank(AL_COMM_WORLD, &prank);
 #endif
 
     if (prank == show_for_rank) {
@@ -27,12 +27,35 @@
   grid employed by PLUTO using bi- or tri-linear interpolation to fill the 
   data array at the desired coordinate location.
 
+  If InputDataSetRegion() has been called before InputDataRead(), only
+  the part of the input grid covering the given region (plus one zone
+  for interpolation) is read and stored, so that each processor keeps
+  the sub-volume needed by its own sub-domain only.
+  The data file is memory-mapped and read row by row, with endianity
+  swap and conversion to double precision done on whole rows.
+
+  InputDataCache() reads a data file as InputDataRead() but keeps it in
+  memory, keyed by file name, so that several data files can be used at
+  the same time: InputDataCacheUse() selects the one to interpolate from.
+
+  InputDataResample() interpolates the input data on all the zone
+  centers of the local (Cartesian) grid at once: index and weights are
+  computed once per direction, and rows are interpolated with loops
+  that the compiler can vectorize. InputDataInterpolate() then returns
+  the stored values when called at a zone center, until
+  InputDataResampleFree() is called.
+
   \authors A. Mignone (mignone@ph.unito.it)\n
            P. Tzeferacos 
   \date   Aug 27, 2012
 */
 /* ///////////////////////////////////////////////////////////////////// */
 #include "pluto.h"
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 /* AYW -- 2012-11-15 15:35 JST
  * Reduce to reduce memory requirements. Need one extra for the -1 
  * after the last variable ID in get_var.
@@ -75,6 +98,35 @@ static double *id_x3; /**< Array of point coordinates of the x3 input grid. */
 static double ***Vin[ID_MAX_NVAR]; /**< An array of 3D data values containing the
                                         initial data file variables. */
 
+static int id_lo[3];  /**< First input grid index stored in ::Vin. */
+static int id_hi[3];  /**< Last input grid index stored in ::Vin. */
+static int id_nalloc[3]; /**< Size of the ::Vin arrays. */
+
+static int    id_region = 0; /**< Whether a region has been set. */
+static double id_xbeg[3];    /**< Lower limits of the region to be read. */
+static double id_xend[3];    /**< Upper limits of the region to be read. */
+
+static double ***Vrs[ID_MAX_NVAR]; /**< Input data resampled on the local grid. */
+static double *rs_x[3];  /**< Zone centers of the resampling grid. */
+static int rs_n[3];      /**< Number of zones of the resampling grid. */
+static THREAD_LOCAL int rs_last[3]; /**< Last index found by InputDataLookup()
+                                       (per thread). */
+static int rs_on = 0;    /**< Whether ::Vrs is available. */
+
+/* Input data files kept in memory by InputDataCache() */
+static struct InputCube {
+  char   name[256];           /**< Data file name. */
+  int    lo[3], hi[3];        /**< Sub-volume stored (as ::id_lo, ::id_hi). */
+  double ***V[ID_MAX_NVAR];   /**< Data values (as ::Vin). */
+} *id_cube = NULL;
+static int id_ncube = 0;      /**< Number of cached data files. */
+static int id_cube_on = -1;   /**< Cached data file in ::Vin, if any. */
+
+static void InputDataRange (int, int *, int *);
+static void InputDataSwapRow (void *, size_t, size_t);
+static void InputDataLocate (int, double, int *, double *);
+static int  InputDataLookup (double *, double, double, double);
+
 
 /* This function shifts a coordinate by a multiple of the input cube width
    DM 11Aug15: Fixed bug. */
@@ -117,98 +169,58 @@ void InputDataSet (char *grid_fname, int *get_var)
  * The following tasks are performed.
  *********************************************************************** */
 {
-  int    i, ip, nv, success;
-  size_t dsize, dcount;
-  char *sub_str, sline[256];
-  const char delimiters[] = " \t\r\f\n";
-  double xl, xr;
-  fpos_t file_pos;
-  FILE *fp;
+  int    i, nv;
+  char   *geom_name;
+  GridFile *gf;
 
 #if CLOUDS_MULTI != YES  
   print1 ("> Input data:\n\n");
 #endif
 
 /* --------------------------------------------------------------------- */
-/*! - Scan grid data file and try to determine the grid geometry 
-      (::id_geom). Search for tag "GEOMETRY:" and read the word that
-      follows.                                                           */
+/*! - Read the grid file (or its binary descriptor, see ReadGridFile())
+      and get the grid geometry (::id_geom).                             */
 /* --------------------------------------------------------------------- */
 
-  fp = fopen(grid_fname,"r");
-  if (fp == NULL){
-    print1 ("! InputDataSet: grid file %s not found\n",grid_fname);
-    QUIT_PLUTO(1);
-  }
-  success = 0;
-  while(!success){
-    fgets(sline,512,fp);
-    sub_str = strtok(sline, delimiters);
-    while (sub_str != NULL){
-      if (!strcmp(sub_str,"GEOMETRY:")) {
-        sub_str = strtok(NULL, delimiters);     
-        success = 1;
-        break;
-      }
-      sub_str = strtok(NULL, delimiters);     
-    }  
-  }
-  
-  if      (!strcmp(sub_str,"CARTESIAN"))   id_geom = CARTESIAN;
-  else if (!strcmp(sub_str,"CYLINDRICAL")) id_geom = CYLINDRICAL;
-  else if (!strcmp(sub_str,"POLAR"))       id_geom = POLAR;
-  else if (!strcmp(sub_str,"SPHERICAL"))   id_geom = SPHERICAL;
+  gf = ReadGridFile (grid_fname);
+  id_geom = gf->geometry;
+
+  if      (id_geom == CARTESIAN)   geom_name = "CARTESIAN";
+  else if (id_geom == CYLINDRICAL) geom_name = "CYLINDRICAL";
+  else if (id_geom == POLAR)       geom_name = "POLAR";
+  else if (id_geom == SPHERICAL)   geom_name = "SPHERICAL";
   else{
     print1 ("! InputDataSet: unknown geometry\n");
     QUIT_PLUTO(1);
   }
   
 #if CLOUDS_MULTI != YES  
-  print1 ("  Input grid file:       %s\n", grid_fname);
-  print1 ("  Input grid geometry:   %s\n", sub_str);
+  print1 ("  Input grid file:       %s%s\n", grid_fname,
+           gf->binary ? " (binary)":"");
+  print1 ("  Input grid geometry:   %s\n", geom_name);
 #endif
 
 /* --------------------------------------------------------------------- */
-/*! - Move file pointer until the first line that does not
-      begin with a "#".                                                  */
-/* --------------------------------------------------------------------- */
-
-  success = 0;
-  while(!success){
-    fgetpos(fp, &file_pos);
-    fgets(sline,512,fp);
-    if (sline[0] != '#') success = 1;
-  }
-
-  fsetpos(fp, &file_pos);
-  
-/* --------------------------------------------------------------------- */
-/*! - Start reading number of points and grid coordinates. For the
-      input x1 direction these are stored inside the module variables
+/*! - Compute the zone centers of the input grid. For the input x1
+      direction these are stored inside the module variables
       ::id_nx1 and ::id_x1.                                              */
 /* --------------------------------------------------------------------- */
    
-  fscanf (fp,"%d \n",&id_nx1);
-  id_x1 = ARRAY_1D(id_nx1, double);
-  for (i = 0; i < id_nx1; i++){
-    fscanf(fp,"%d  %lf %lf\n", &ip, &xl, &xr);
-    id_x1[i] = 0.5*(xl + xr);
-  }
+  if (id_x1 != NULL) FreeArray1D(id_x1);
+  if (id_x2 != NULL) FreeArray1D(id_x2);
+  if (id_x3 != NULL) FreeArray1D(id_x3);
 
-  fscanf (fp,"%d \n",&id_nx2);
-  id_x2 = ARRAY_1D(id_nx2, double);
-  for (i = 0; i < id_nx2; i++){
-    fscanf(fp,"%d  %lf %lf\n", &ip, &xl, &xr);
-    id_x2[i] = 0.5*(xl + xr);
-  }
+  id_nx1 = gf->np[IDIR];
+  id_x1  = ARRAY_1D(id_nx1, double);
+  for (i = 0; i < id_nx1; i++) id_x1[i] = 0.5*(gf->xl[IDIR][i] + gf->xr[IDIR][i]);
 
-  fscanf (fp,"%d \n",&id_nx3);
-  id_x3 = ARRAY_1D(id_nx3, double);
-  for (i = 0; i < id_nx3; i++){
-    fscanf(fp,"%d  %lf %lf\n", &ip, &xl, &xr);
-    id_x3[i] = 0.5*(xl + xr);
-  }
-  fclose(fp);
+  id_nx2 = gf->np[JDIR];
+  id_x2  = ARRAY_1D(id_nx2, double);
+  for (i = 0; i < id_nx2; i++) id_x2[i] = 0.5*(gf->xl[JDIR][i] + gf->xr[JDIR][i]);
+
+  id_nx3 = gf->np[KDIR];
+  id_x3  = ARRAY_1D(id_nx3, double);
+  for (i = 0; i < id_nx3; i++) id_x3[i] = 0.5*(gf->xl[KDIR][i] + gf->xr[KDIR][i]);
 
 /* -- reset grid with 1 point -- */
 
@@ -270,6 +282,29 @@ void InputDataSet (char *grid_fname, int *get_var)
 
 }
 
+/* ********************************************************************* */
+void InputDataSetRegion (const double *xbeg, const double *xend)
+/*!
+ * Restrict the following calls to InputDataRead() to the part of the
+ * input grid needed to interpolate at points inside the box
+ * [xbeg, xend] (input grid coordinates).
+ * The region is kept until the next call; passing NULL pointers
+ * restores reading of the whole input grid.
+ *
+ * \param [in] xbeg  lower limits of the region
+ * \param [in] xend  upper limits of the region
+ *********************************************************************** */
+{
+  int dir;
+
+  id_region = (xbeg != NULL && xend != NULL);
+  if (!id_region) return;
+  for (dir = 0; dir < 3; dir++){
+    id_xbeg[dir] = xbeg[dir];
+    id_xend[dir] = xend[dir];
+  }
+}
+
 /* ********************************************************************* */
 void InputDataRead (char *data_fname, char *endianity)
 /*!
@@ -277,6 +312,8 @@ void InputDataRead (char *data_fname, char *endianity)
  * array ::Vin. Memory allocation is also done here.  
  * The grid size and number of variables must have 
  * previously set by calling InputDataSet().
+ * Only the sub-volume covering the region set with 
+ * InputDataSetRegion() is stored, if any.
  * 
  * \param [in] data_fname the data file name
  * \param [in] endianity  an input string ("little" or "big") giving 
@@ -288,11 +325,15 @@ void InputDataRead (char *data_fname, char *endianity)
  *********************************************************************** */
 {
   int   i, j, k, nv, swap_endian=NO;
-  size_t dsize, dcount;
-  double udbl;
-  float  uflt;
+  int   dir, n[3];
+  size_t dsize, dcount, nrow;
+  off_t  offset, fsize;
+  float  *uflt;
   char   ext[] = "   ";
-  FILE *fp;
+  char   *row, *map;
+  struct stat st;
+  int    fd;
+  FILE *fp = NULL;
 
 /* ----------------------------------------------------
              Check endianity 
@@ -331,52 +372,206 @@ void InputDataRead (char *data_fname, char *endianity)
   }
   
 /* -------------------------------------------------------
-     Read and store data values
+     Find the sub-volume to be read and (re)allocate 
+     memory if its size has changed
    ------------------------------------------------------- */
 
-  fp = fopen(data_fname, "rb");
-  if (fp == NULL){
+  for (dir = 0; dir < 3; dir++) {
+    InputDataRange (dir, id_lo + dir, id_hi + dir);
+    n[dir] = id_hi[dir] - id_lo[dir] + 1;
+  }
+
+#if CLOUDS_MULTI != YES  
+  if (id_region){
+    print1 ("  Sub-volume:            [%d,%d] x [%d,%d] x [%d,%d]\n",
+             id_lo[IDIR], id_hi[IDIR], id_lo[JDIR], id_hi[JDIR],
+             id_lo[KDIR], id_hi[KDIR]);
+  }
+#endif
+
+  if (id_cube_on >= 0){     /* -- ::Vin belongs to the cache -- */
+    for (nv = 0; nv < ID_MAX_NVAR; nv++) Vin[nv] = NULL;
+    for (dir = 0; dir < 3; dir++) id_nalloc[dir] = 0;
+    id_cube_on = -1;
+  }
+  if (n[IDIR] != id_nalloc[IDIR] || n[JDIR] != id_nalloc[JDIR] ||
+      n[KDIR] != id_nalloc[KDIR]){
+    for (nv = 0; nv < ID_MAX_NVAR; nv++){
+      if (Vin[nv] != NULL) FreeArray3D ((void *) Vin[nv]);
+      Vin[nv] = NULL;
+    }
+    for (dir = 0; dir < 3; dir++) id_nalloc[dir] = n[dir];
+  }
+
+/* -------------------------------------------------------
+     Map the file and check its size
+   ------------------------------------------------------- */
+
+  fd = open (data_fname, O_RDONLY);
+  if (fd < 0){
     print1 ("! InputDataRead: file %s does not exist\n",data_fname);
     QUIT_PLUTO(1);
   }
-  for (nv = 0; nv < id_nvar; nv++){
-    if (Vin[nv] == NULL) Vin[nv] = ARRAY_3D(id_nx3, id_nx2, id_nx1, double);
+  fstat (fd, &st);
+  fsize = (off_t)id_nvar*id_nx1*id_nx2*id_nx3*dsize;
+  if (st.st_size < fsize){
+    print1 ("! InputDataRead: file %s is too short for %d variable(s)\n",
+             data_fname, id_nvar);
+    QUIT_PLUTO(1);
+  }
 
-    dcount  = 1;
+  map = mmap (NULL, fsize, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (map == MAP_FAILED) {        /* -- fall back to stdio -- */
+    map = NULL;
+    fp  = fdopen (fd, "rb");
+  }
 
+/* -------------------------------------------------------
+     Read and store data values, one row at a time
+   ------------------------------------------------------- */
 
-    if (dsize == sizeof(double)){
-      for (k = 0; k < id_nx3; k++){ 
-      for (j = 0; j < id_nx2; j++){
-      for (i = 0; i < id_nx1; i++){
-        if (fread (&udbl, dsize, dcount, fp) != dcount){
-          print1 ("! InputDataRead: error reading data %d.\n",nv);
-          break;
-        }
-        if (swap_endian) SWAP_VAR(udbl);
-        Vin[nv][k][j][i] = udbl;
-      }}}
-    }else{
-      for (k = 0; k < id_nx3; k++){ 
-      for (j = 0; j < id_nx2; j++){
-      for (i = 0; i < id_nx1; i++){
-        if (fread (&uflt, dsize, dcount, fp) != dcount){
+  nrow = n[IDIR];
+  row  = ARRAY_1D(nrow*dsize, char);
+  for (nv = 0; nv < id_nvar; nv++){
+    if (Vin[nv] == NULL) Vin[nv] = ARRAY_3D(n[KDIR], n[JDIR], n[IDIR], double);
+
+    for (k = 0; k < n[KDIR]; k++){ 
+    for (j = 0; j < n[JDIR]; j++){
+      offset = (((off_t)nv*id_nx3 + id_lo[KDIR] + k)*id_nx2 
+                           + id_lo[JDIR] + j)*id_nx1 + id_lo[IDIR];
+      offset *= dsize;
+      if (map != NULL){
+        memcpy (row, map + offset, nrow*dsize);
+      }else{
+        fseeko (fp, offset, SEEK_SET);
+        if (fread (row, dsize, nrow, fp) != nrow){
           print1 ("! InputDataRead: error reading data %d.\n",nv);
-          break;
+          QUIT_PLUTO(1);
         }
-        if (swap_endian) SWAP_VAR(uflt);
-        Vin[nv][k][j][i] = uflt;
-      }}}
-    }
+      }
+
+      if (swap_endian) InputDataSwapRow (row, nrow, dsize);
+      if (dsize == sizeof(double)){
+        memcpy (Vin[nv][k][j], row, nrow*dsize);
+      }else{
+        uflt = (float *) row;
+        for (i = 0; i < nrow; i++) Vin[nv][k][j][i] = uflt[i];
+      }
+    }}
   }
+  FreeArray1D ((void *) row);
 
-  fclose(fp);
+  if (map != NULL) {
+    munmap (map, fsize);
+    close (fd);
+  }else{
+    fclose (fp);
+  }
 
 #if CLOUDS_MULTI != YES  
   print1 ("\n");
 #endif
 }
 
+/* ********************************************************************* */
+int InputDataCache (char *data_fname, char *endianity)
+/*!
+ * Read an input data file as InputDataRead() does, but keep it in
+ * memory together with the files previously read through this 
+ * function, so that several data files (e.g. the cubes of different
+ * clouds) can be used at the same time. 
+ * A file already in the cache is not read again, even if the region
+ * set with InputDataSetRegion() has changed in the meantime.
+ * Data previously read by InputDataRead() are discarded.
+ * The cached file becomes the one used by InputDataInterpolate().
+ *
+ * \param [in] data_fname the data file name
+ * \param [in] endianity  the byte-order of the data file (see 
+ *                        InputDataRead())
+ * \return The cache index of the file, to be passed to 
+ *         InputDataCacheUse().
+ *********************************************************************** */
+{
+  int n, nv, dir;
+  struct InputCube *c;
+
+  for (n = 0; n < id_ncube; n++){
+    if (!strcmp(id_cube[n].name, data_fname)) {
+      InputDataCacheUse (n);
+      return n;
+    }
+  }
+
+/* -- release ::Vin if not cached, so that the file is read
+      into newly allocated arrays -- */
+
+  if (id_cube_on < 0){
+    for (nv = 0; nv < ID_MAX_NVAR; nv++){
+      if (Vin[nv] != NULL) FreeArray3D ((void *) Vin[nv]);
+      Vin[nv] = NULL;
+    }
+    for (dir = 0; dir < 3; dir++) id_nalloc[dir] = 0;
+  }
+  InputDataRead (data_fname, endianity);
+
+  id_cube = realloc (id_cube, (id_ncube + 1)*sizeof(struct InputCube));
+  c = id_cube + id_ncube;
+  strncpy (c->name, data_fname, sizeof(c->name) - 1);
+  c->name[sizeof(c->name) - 1] = '\0';
+  for (dir = 0; dir < 3; dir++){
+    c->lo[dir] = id_lo[dir];
+    c->hi[dir] = id_hi[dir];
+  }
+  for (nv = 0; nv < ID_MAX_NVAR; nv++) c->V[nv] = Vin[nv];
+  id_cube_on = id_ncube++;
+  return id_cube_on;
+}
+
+/* ********************************************************************* */
+void InputDataCacheUse (int n)
+/*!
+ * Make the n-th file cached by InputDataCache() the one used by 
+ * InputDataInterpolate(). No data is copied.
+ *
+ *********************************************************************** */
+{
+  int nv, dir;
+
+  if (n == id_cube_on) return;
+  for (nv = 0; nv < ID_MAX_NVAR; nv++) Vin[nv] = id_cube[n].V[nv];
+  for (dir = 0; dir < 3; dir++){
+    id_lo[dir] = id_cube[n].lo[dir];
+    id_hi[dir] = id_cube[n].hi[dir];
+    id_nalloc[dir] = id_hi[dir] - id_lo[dir] + 1;
+  }
+  id_cube_on = n;
+}
+
+/* ********************************************************************* */
+void InputDataCacheFree (void)
+/*!
+ * Free all the files cached by InputDataCache().
+ *
+ *********************************************************************** */
+{
+  int n, nv, dir;
+
+  for (n = 0; n < id_ncube; n++){
+    for (nv = 0; nv < ID_MAX_NVAR; nv++){
+      if (id_cube[n].V[nv] != NULL) FreeArray3D ((void *) id_cube[n].V[nv]);
+    }
+  }
+  free (id_cube);
+  id_cube  = NULL;
+  id_ncube = 0;
+
+  if (id_cube_on >= 0){
+    for (nv = 0; nv < ID_MAX_NVAR; nv++) Vin[nv] = NULL;
+    for (dir = 0; dir < 3; dir++) id_nalloc[dir] = 0;
+    id_cube_on = -1;
+  }
+}
+
 /* ********************************************************************* */
 void InputDataInterpolate (double *vs, double x1, double x2, double x3)
 /*!
@@ -406,6 +601,13 @@ void InputDataInterpolate (double *vs, double x1, double x2, double x3)
 
  double deltax2,deltax3,deltax1,fractpart,intpart;
 
+/* --------------------------------------------------------------------- */
+/*! - Return the resampled values if (x1,x2,x3) is a zone center of the
+      grid passed to InputDataResample().                                */
+/* --------------------------------------------------------------------- */
+
+  if (rs_on && InputDataLookup (vs, x1, x2, x3)) return;
+
 
 
 // TODO: Actually do this check
@@ -647,6 +849,22 @@ then PLUTO grid is given value eq to boundary value of input grid.
   if (id_nx2 > 1) yy = (x2 - id_x2[jl])/(id_x2[jl+1] - id_x2[jl]);  
   if (id_nx3 > 1) zz = (x3 - id_x3[kl])/(id_x3[kl+1] - id_x3[kl]);
 
+/* --------------------------------------------------------------------- */
+/*! - Convert il, jl and kl to indices of the sub-volume stored in ::Vin. */
+/* --------------------------------------------------------------------- */
+
+  if (il < id_lo[IDIR] || il + (id_nx1 > 1) > id_hi[IDIR] ||
+      jl < id_lo[JDIR] || jl + (id_nx2 > 1) > id_hi[JDIR] ||
+      kl < id_lo[KDIR] || kl + (id_nx3 > 1) > id_hi[KDIR]){
+    print ("! InputDataInterpolate: point (%f, %f, %f) is outside the\n",
+            x1, x2, x3);
+    print ("  region read by InputDataRead()\n");
+    QUIT_PLUTO(1);
+  }
+  il -= id_lo[IDIR];
+  jl -= id_lo[JDIR];
+  kl -= id_lo[KDIR];
+
 /* --------------------------------------------------------------------- */
 /*! - Perform bi- or tri-linear interpolation.                           */
 /* --------------------------------------------------------------------- */
@@ -729,6 +947,272 @@ then PLUTO grid is given value eq to boundary value of input grid.
 
 }
 
+/* ********************************************************************* */
+static void InputDataRange (int dir, int *lo, int *hi)
+/*!
+ * Find the range of input grid indices [lo, hi] along dir needed to 
+ * interpolate at points of the region set by InputDataSetRegion().
+ * Points are folded back or limited to the input grid exactly as 
+ * in InputDataInterpolate(); one extra zone is kept on either side.
+ *
+ *********************************************************************** */
+{
+  int    i, n;
+  double *x, xb, xe;
+#if CLOUD_REPEAT == YES
+  double wl[3] = {g_inputParam[PAR_WX1L], g_inputParam[PAR_WX2L], g_inputParam[PAR_WX3L]};
+  double wh[3] = {g_inputParam[PAR_WX1H], g_inputParam[PAR_WX2H], g_inputParam[PAR_WX3H]};
+#endif
+
+  if      (dir == IDIR) {x = id_x1; n = id_nx1;}
+  else if (dir == JDIR) {x = id_x2; n = id_nx2;}
+  else                  {x = id_x3; n = id_nx3;}
+
+  *lo = 0;
+  *hi = n - 1;
+  if (!id_region || n == 1 || dir >= DIMENSIONS) return;
+
+  xb = id_xbeg[dir];
+  xe = id_xend[dir];
+
+#if CLOUD_REPEAT == YES
+  /* -- the region wraps around the input grid: keep it all -- */
+  if (xe - xb >= x[n-1] - x[0]) return;
+  xb = shift_idx(xb, wl[dir], wh[dir], x[0], x[n-1]);
+  xe = shift_idx(xe, wl[dir], wh[dir], x[0], x[n-1]);
+  if (xb > xe) return;
+#else
+  xb = MAX(xb, x[0]);
+  xe = MIN(xe, x[n-1]);
+#endif
+
+  for (i = 0; i < n - 1 && x[i+1] < xb; i++);
+  *lo = MAX(i - 1, 0);
+  for (i = n - 1; i > 0 && x[i-1] > xe; i--);
+  *hi = MIN(i + 1, n - 1);
+}
+
+/* ********************************************************************* */
+static void InputDataSwapRow (void *row, size_t n, size_t dsize)
+/*!
+ * Swap the byte order of the n values of size dsize (4 or 8 bytes)
+ * in row. Written as plain shifts on integers, so that the loop can
+ * be vectorized by the compiler.
+ *
+ *********************************************************************** */
+{
+  size_t i;
+  uint32_t u4, *r4 = (uint32_t *) row;
+  uint64_t u8, *r8 = (uint64_t *) row;
+
+  if (dsize == 4){
+    for (i = 0; i < n; i++){
+      u4 = r4[i];
+      r4[i] = (u4 >> 24) | ((u4 >> 8) & 0x0000ff00u) |
+              ((u4 << 8) & 0x00ff0000u) | (u4 << 24);
+    }
+  }else{
+    for (i = 0; i < n; i++){
+      u8 = r8[i];
+      u8 = ((u8 >>  8) & 0x00ff00ff00ff00ffull) | ((u8 & 0x00ff00ff00ff00ffull) <<  8);
+      u8 = ((u8 >> 16) & 0x0000ffff0000ffffull) | ((u8 & 0x0000ffff0000ffffull) << 16);
+      r8[i] = (u8 >> 32) | (u8 << 32);
+    }
+  }
+}
+
+/* ********************************************************************* */
+void InputDataResample (Grid *grid)
+/*!
+ * Interpolate the input data at all the zone centers (ghost zones
+ * included) of the local grid and keep the result until 
+ * InputDataResampleFree() is called.
+ * Points are mapped to the input grid as in InputDataInterpolate(), 
+ * so this is possible only when both grids are Cartesian; nothing is 
+ * done otherwise.
+ * The tri-linear interpolation is split in two steps: the four input
+ * rows surrounding each output row are first combined along x2 and x3,
+ * and the result is then interpolated along x1.
+ *
+ * \param [in] grid  pointer to an array of Grid structures
+ *********************************************************************** */
+{
+  int    i, j, k, ii, nv, dir, l, nin;
+  int    *il[3], *ih[3];
+  double *w[3], ww, *row, wx;
+  double a00, a01, a10, a11;
+  double *v00, *v01, *v10, *v11;
+  double ***V, ***B;
+
+#if GEOMETRY != CARTESIAN
+  return;
+#endif
+  if (id_geom != CARTESIAN) return;
+
+  InputDataResampleFree();
+
+/* -- index and weights along each direction -- */
+
+  for (dir = 0; dir < 3; dir++){
+    rs_n[dir]    = grid[dir].np_tot;
+    rs_last[dir] = 0;
+    rs_x[dir] = ARRAY_1D(rs_n[dir], double);
+    il[dir]   = ARRAY_1D(rs_n[dir], int);
+    ih[dir]   = ARRAY_1D(rs_n[dir], int);
+    w[dir]    = ARRAY_1D(rs_n[dir], double);
+    for (i = 0; i < rs_n[dir]; i++){
+      rs_x[dir][i] = grid[dir].x[i];
+      InputDataLocate (dir, rs_x[dir][i], &l, &ww);
+      if (l < id_lo[dir] || l + (ww > 0.0) > id_hi[dir]){
+        print ("! InputDataResample: zone %d along x%d is outside the\n",
+                i, dir + 1);
+        print ("  region read by InputDataRead()\n");
+        QUIT_PLUTO(1);
+      }
+      il[dir][i] = l - id_lo[dir];
+      ih[dir][i] = MIN(l + 1, id_hi[dir]) - id_lo[dir];
+      w[dir][i]  = ww;
+    }
+  }
+
+/* -- interpolate, one output row at a time -- */
+
+  nin = id_hi[IDIR] - id_lo[IDIR] + 1;
+  row = ARRAY_1D(nin, double);
+  for (nv = 0; nv < id_nvar; nv++){
+    V = Vin[nv];
+    B = Vrs[nv] = ARRAY_3D(rs_n[KDIR], rs_n[JDIR], rs_n[IDIR], double);
+    for (k = 0; k < rs_n[KDIR]; k++){
+    for (j = 0; j < rs_n[JDIR]; j++){
+      a00 = (1.0 - w[KDIR][k])*(1.0 - w[JDIR][j]);
+      a01 = (1.0 - w[KDIR][k])*w[JDIR][j];
+      a10 = w[KDIR][k]*(1.0 - w[JDIR][j]);
+      a11 = w[KDIR][k]*w[JDIR][j];
+      v00 = V[il[KDIR][k]][il[JDIR][j]];
+      v01 = V[il[KDIR][k]][ih[JDIR][j]];
+      v10 = V[ih[KDIR][k]][il[JDIR][j]];
+      v11 = V[ih[KDIR][k]][ih[JDIR][j]];
+      for (ii = 0; ii < nin; ii++){
+        row[ii] = a00*v00[ii] + a01*v01[ii] + a10*v10[ii] + a11*v11[ii];
+      }
+      for (i = 0; i < rs_n[IDIR]; i++){
+        wx = w[IDIR][i];
+        B[k][j][i] = (1.0 - wx)*row[il[IDIR][i]] + wx*row[ih[IDIR][i]];
+      }
+    }}
+  }
+  FreeArray1D ((void *) row);
+
+  for (dir = 0; dir < 3; dir++){
+    FreeArray1D ((void *) il[dir]);
+    FreeArray1D ((void *) ih[dir]);
+    FreeArray1D ((void *) w[dir]);
+  }
+  rs_on = 1;
+}
+
+/* ********************************************************************* */
+void InputDataResampleFree (void)
+/*!
+ * Free the data stored by InputDataResample().
+ *
+ *********************************************************************** */
+{
+  int nv, dir;
+
+  if (!rs_on) return;
+  for (nv = 0; nv < id_nvar; nv++){
+    FreeArray3D ((void *) Vrs[nv]);
+    Vrs[nv] = NULL;
+  }
+  for (dir = 0; dir < 3; dir++) FreeArray1D ((void *) rs_x[dir]);
+  rs_on = 0;
+}
+
+/* ********************************************************************* */
+static void InputDataLocate (int dir, double x, int *il, double *w)
+/*!
+ * Find the input grid zone il along dir such that x falls between 
+ * [il, il+1], and the normalized distance w of x from zone il.
+ * Points are folded back or limited to the input grid as in 
+ * InputDataInterpolate().
+ *
+ *********************************************************************** */
+{
+  int    n, ih, im;
+  double *xin;
+#if CLOUD_REPEAT == YES
+  double wl[3] = {g_inputParam[PAR_WX1L], g_inputParam[PAR_WX2L], g_inputParam[PAR_WX3L]};
+  double wh[3] = {g_inputParam[PAR_WX1H], g_inputParam[PAR_WX2H], g_inputParam[PAR_WX3H]};
+#endif
+
+  if      (dir == IDIR) {xin = id_x1; n = id_nx1;}
+  else if (dir == JDIR) {xin = id_x2; n = id_nx2;}
+  else                  {xin = id_x3; n = id_nx3;}
+
+  *il = 0;
+  *w  = 0.0;
+  if (n == 1) return;
+
+  if (dir < DIMENSIONS){
+#if CLOUD_REPEAT == YES
+    x = shift_idx(x, wl[dir], wh[dir], xin[0], xin[n-1]);
+#else
+    if      (x < xin[0])   x = xin[0];
+    else if (x > xin[n-1]) x = xin[n-1];
+#endif
+  }
+
+  ih = n - 1;
+  while (*il != (ih-1)){
+    im = (*il + ih)/2;
+    if (x <= xin[im]) ih  = im;
+    else              *il = im;
+  }
+  *w = (x - xin[*il])/(xin[*il+1] - xin[*il]);
+}
+
+/* ********************************************************************* */
+static int InputDataLookup (double *vs, double x1, double x2, double x3)
+/*!
+ * Copy into vs the values resampled by InputDataResample() if
+ * (x1,x2,x3) is one of its zone centers.
+ *
+ * \return 1 if the point has been found, 0 otherwise.
+ *********************************************************************** */
+{
+  int    dir, i, l, h, m, n, ind[3];
+  double x[3], *xg;
+
+  x[IDIR] = x1; x[JDIR] = x2; x[KDIR] = x3;
+  for (dir = 0; dir < 3; dir++){
+    xg = rs_x[dir];
+    n  = rs_n[dir];
+
+  /* -- points usually come in grid order: try the last index first -- */
+
+    i = rs_last[dir];
+    if      (xg[i] == x[dir]) ind[dir] = i;
+    else if (i + 1 < n && xg[i+1] == x[dir]) ind[dir] = i + 1;
+    else {
+      l = 0; h = n - 1;
+      while (l < h){
+        m = (l + h)/2;
+        if (xg[m] < x[dir]) l = m + 1;
+        else                h = m;
+      }
+      if (xg[l] != x[dir]) return 0;
+      ind[dir] = l;
+    }
+    rs_last[dir] = ind[dir];
+  }
+
+  for (i = 0; i < id_nvar; i++){
+    vs[id_var_indx[i]] = Vrs[i][ind[KDIR]][ind[JDIR]][ind[IDIR]];
+  }
+  return 1;
+}
+
 /* ********************************************************************* */
 void InputDataFree (void)
 /*!
@@ -738,21 +1222,7 @@ void InputDataFree (void)
 {
   int nv;
   for (nv = 0; nv < id_nvar; nv++){
-   /* free ((char *) Vin[nv][0][0]);    
-    free ((char *) Vin[nv][0]);
-    free ((char *) Vin[nv]);
-   */
- 
-  printf("inputdata free \n");
-
-  printf("test again: %lf %d \n",Vin[RHO][10][10][10],id_nvar);
-  // FreeArray3D(Vin[nv]);
-  free ((char *) Vin[nv][0][0]);
-printf(" r 1\n");
-  free ((char *) Vin[nv][0]);
-printf(" r 2\n");
-  free ((char *) Vin[nv]);
-  printf("done once \n");
+    FreeArray3D ((void *) Vin[nv]);
   }
 }
 
@@ -0,0 +1,745 @@
+/* ///////////////////////////////////////////////////////////////////// */
+/*!
+  \file
+  \brief In-situ reduced data products.
+
+  InSituAnalysis() is called by Analysis() and computes, each at its own
+  cadence, a few data products that are much smaller than a full dump:
+
+  - slices: the primitive variables and the temperature on the plane
+    of cells crossed by x<dir> = c;
+  - projections along a coordinate axis (Cartesian geometry only):
+    the column density (sigma), the emission measure (em) computed
+    with the bremsstrahlung weight w = rho^2 sqrt(T), and the
+    emission-weighted temperature (te_em) and line-of-sight velocity
+    (vlos_em);
+  - mass-weighted profiles in spherical radius (0 <= r < rmax) and in
+    polar angle (0 <= theta <= pi, for r < rmax) of density,
+    temperature and radial velocity, together with the mass rate
+    (mdot) and its outflowing part (mdot_out).
+    For radial bins mdot = sum(rho v_r dV)/dr is the mass rate through
+    the spheres lying in the bin; for angular bins dr is replaced by
+    rmax.
+
+  The products are enabled by the following lines in pluto.ini
+  ([Static Grid Output] block):
+
+  \verbatim
+  insitu_slice   dt   x3 0.0   x1 0.5  ...
+  insitu_proj    dt   x1 x2 ...
+  insitu_prof    dt   nbins  rmax
+  \endverbatim
+
+  where dt is the interval (in code units) between two records.
+  With dt <= 0 a record is written every time Analysis() is called,
+  i.e. with the cadence of the \c analysis line.
+  A slice normal to an axis that is not integrated (e.g. x3 in 2D) is
+  the whole computational domain.
+
+  Each processor works on its own subdomain only; slices and
+  projections are collected on rank 0 with GatherPlane() and profiles
+  with MPI_Reduce.
+  Rank 0 appends a record to one binary file per product in the
+  output directory: insitu_slice_x<dir>_<n>.bin, insitu_proj_x<dir>.bin,
+  insitu_prof_r.bin and insitu_prof_th.bin.
+  Each file begins with the header
+
+  \verbatim
+  char   magic[8]        "PLUTOINS"
+  int    nvar, n1, n2
+  char   name[nvar][16]
+  double x1[n1], x2[n2]  coordinates along the two axes of the product
+  \endverbatim
+
+  followed by one record per output
+
+  \verbatim
+  double t, step
+  float  data[nvar][n2][n1]
+  \endverbatim
+
+  in native byte order and code units.
+  A file is created at step 0 (or when it does not exist) and appended
+  to otherwise.
+  When restarting, the records left by the previous run at or after
+  the time of the first new record are discarded; a file
+  whose header does not match the product is left untouched and the
+  product is not written.
+*/
+/* ///////////////////////////////////////////////////////////////////// */
+
+#include "pluto.h"
+#include "pluto_usr.h"
+#include "insitu.h"
+#include "abundances.h"
+#include "idealEOS.h"
+#include <unistd.h>
+
+#define INSITU_NAME_LEN  16
+
+/* One data product, i.e. one output file */
+typedef struct {
+    char   fname[64];       // File name in the output directory
+    int    dir;             // Axis normal to the product (slices, projections)
+    int    ax[2];           // Axes spanned by the product
+    int    n[2];            // Global size along ax[0], ax[1]
+    int    gidx;            // Global index of the sliced cells along dir
+    int    nvar;
+    int    created;         // File has been (re)created by this run
+    int    disabled;        // Existing file does not match, not written
+    char   name[64][INSITU_NAME_LEN];
+    double *x[2];           // Coordinates along ax[0], ax[1]
+    double *plane;          // nvar*n[0]*n[1] values, rank 0 only
+} Product;
+
+static int initialized = 0;
+
+/* Products requested in pluto.ini */
+static struct {
+    int    nslices, nprojs, nbins;
+    int    slice_dir[INSITU_MAX_SLICES];
+    int    proj_dir[3];
+    double slice_x[INSITU_MAX_SLICES];
+    double dt_slice, dt_proj, dt_prof;
+    double rmax;
+} cfg;
+
+static long int last_slice = -1, last_proj = -1, last_prof = -1;
+
+static Product slice[INSITU_MAX_SLICES];
+static Product proj[DIMENSIONS];
+static Product prof[2];
+
+static void InSituReadConfig(void);
+static void InSituInit(Grid *grid);
+static int  InSituDue(double dt, long int *last);
+static int  ReadAxis(const char *label, int pos);
+static void SetProduct(Product *p, int dir, Grid *grid);
+static void GetPatch(Grid *grid, int *lbeg, int *ln, int *goff);
+static FILE *ReopenRecords(Product *p, const char *fname);
+static void WriteRecord(Product *p, double *data);
+static double Temperature(const Data *d, int k, int j, int i);
+
+static void InSituSlice(const Data *d, Grid *grid, Product *p);
+static void InSituProjection(const Data *d, Grid *grid, Product *p);
+static void InSituProfiles(const Data *d, Grid *grid);
+
+
+/* ************************************************ */
+void InSituAnalysis(const Data *d, Grid *grid) {
+/*!
+ * Compute and write the in-situ products that are due.
+ * Must be called by all processors.
+ *
+ ************************************************** */
+
+    int n;
+
+    if (!initialized) InSituInit(grid);
+
+    if (cfg.nslices > 0 && InSituDue(cfg.dt_slice, &last_slice)) {
+        for (n = 0; n < cfg.nslices; n++) InSituSlice(d, grid, slice + n);
+    }
+
+    if (cfg.nprojs > 0 && InSituDue(cfg.dt_proj, &last_proj)) {
+        for (n = 0; n < cfg.nprojs; n++) InSituProjection(d, grid, proj + n);
+    }
+
+    if (cfg.nbins > 0 && InSituDue(cfg.dt_prof, &last_prof)) {
+        InSituProfiles(d, grid);
+    }
+}
+
+
+/* ************************************************ */
+static void InSituReadConfig(void) {
+/*!
+ * Read the insitu_* lines of pluto.ini into cfg.
+ * Called by rank 0 only, since only rank 0 parses pluto.ini.
+ *
+ ************************************************** */
+
+    int n, nw;
+
+    /* -- Slices -- */
+
+    nw = ParamFileNWords("insitu_slice");
+    if (nw > 0) {
+        if (nw % 2 == 0 || (nw - 1) / 2 > INSITU_MAX_SLICES) {
+            print1("! InSituInit: insitu_slice needs dt followed by at most %d\n", INSITU_MAX_SLICES);
+            print1("  pairs <axis> <coordinate>\n");
+            QUIT_PLUTO(1);
+        }
+        cfg.dt_slice = atof(ParamFileGet("insitu_slice", 1));
+        cfg.nslices = (nw - 1) / 2;
+        for (n = 0; n < cfg.nslices; n++) {
+            cfg.slice_dir[n] = ReadAxis("insitu_slice", 2 + 2 * n);
+            cfg.slice_x[n] = atof(ParamFileGet("insitu_slice", 3 + 2 * n));
+        }
+    }
+
+    /* -- Projections -- */
+
+    nw = ParamFileNWords("insitu_proj");
+    if (nw > 0) {
+#if GEOMETRY != CARTESIAN
+        print1("! InSituInit: insitu_proj requires Cartesian geometry\n");
+        QUIT_PLUTO(1);
+#endif
+        if (nw < 2 || nw - 1 > DIMENSIONS) {
+            print1("! InSituInit: insitu_proj needs dt followed by at most %d axes\n", DIMENSIONS);
+            QUIT_PLUTO(1);
+        }
+        cfg.dt_proj = atof(ParamFileGet("insitu_proj", 1));
+        cfg.nprojs = nw - 1;
+        for (n = 0; n < cfg.nprojs; n++) {
+            cfg.proj_dir[n] = ReadAxis("insitu_proj", 2 + n);
+            if (cfg.proj_dir[n] >= DIMENSIONS) {
+                print1("! InSituInit: cannot project along x%d\n", cfg.proj_dir[n] + 1);
+                QUIT_PLUTO(1);
+            }
+        }
+    }
+
+    /* -- Radial and angular profiles -- */
+
+    nw = ParamFileNWords("insitu_prof");
+    if (nw > 0) {
+        if (nw != 3) {
+            print1("! InSituInit: insitu_prof needs dt, nbins and rmax\n");
+            QUIT_PLUTO(1);
+        }
+        cfg.dt_prof = atof(ParamFileGet("insitu_prof", 1));
+        cfg.nbins = atoi(ParamFileGet("insitu_prof", 2));
+        cfg.rmax = atof(ParamFileGet("insitu_prof", 3));
+        if (cfg.nbins < 1 || cfg.rmax <= 0.0) {
+            print1("! InSituInit: insitu_prof needs nbins > 0 and rmax > 0\n");
+            QUIT_PLUTO(1);
+        }
+    }
+}
+
+
+/* ************************************************ */
+static void InSituInit(Grid *grid) {
+/*!
+ * Get the configuration from rank 0 and set up the products.
+ *
+ ************************************************** */
+
+    int n, nv, dir, size;
+    double c, *xl, *xr;
+    static Output out;
+
+    initialized = 1;
+
+    if (prank == 0) InSituReadConfig();
+#ifdef PARALLEL
+    MPI_Bcast(&cfg, sizeof(cfg), MPI_BYTE, 0, AL_COMM_WORLD);
+#endif
+
+    /* Names of the primitive variables, as in the dumps */
+    out.var_name = ARRAY_2D(64, 128, char);
+    SetDefaultVarNames(&out);
+
+    /* -- Slices -- */
+
+    for (n = 0; n < cfg.nslices; n++) {
+        Product *p = slice + n;
+
+        dir = cfg.slice_dir[n];
+        c = cfg.slice_x[n];
+        SetProduct(p, dir, grid);
+        sprintf(p->fname, "insitu_slice_x%d_%d.bin", dir + 1, n);
+
+        /* Find the global index of the cell containing c */
+        p->gidx = 0;
+        if (dir < DIMENSIONS) {
+            xl = grid[dir].xl_glob + grid[dir].gbeg;
+            xr = grid[dir].xr_glob + grid[dir].gbeg;
+            for (p->gidx = 0; p->gidx < grid[dir].np_int_glob; p->gidx++) {
+                if (c >= xl[p->gidx] && c < xr[p->gidx]) break;
+            }
+            if (c == xr[grid[dir].np_int_glob - 1]) p->gidx--;
+            if (p->gidx == grid[dir].np_int_glob) {
+                print1("! InSituInit: slice x%d = %f lies outside the domain\n", dir + 1, c);
+                QUIT_PLUTO(1);
+            }
+        }
+
+        p->nvar = NVAR + 1;
+        for (nv = 0; nv < NVAR; nv++) {
+            strncpy(p->name[nv], out.var_name[nv], INSITU_NAME_LEN - 1);
+        }
+        strcpy(p->name[NVAR], "te");
+    }
+
+    /* -- Projections -- */
+
+    for (n = 0; n < cfg.nprojs; n++) {
+        Product *p = proj + n;
+
+        SetProduct(p, cfg.proj_dir[n], grid);
+        sprintf(p->fname, "insitu_proj_x%d.bin", p->dir + 1);
+
+        p->nvar = 4;
+        strcpy(p->name[0], "sigma");
+        strcpy(p->name[1], "em");
+        strcpy(p->name[2], "te_em");
+        strcpy(p->name[3], "vlos_em");
+    }
+
+    /* -- Radial and angular profiles -- */
+
+    for (n = 0; n < 2 && cfg.nbins > 0; n++) {
+        Product *p = prof + n;
+
+        p->dir = -1;
+        p->n[0] = cfg.nbins;
+        p->n[1] = 1;
+        p->x[0] = ARRAY_1D(cfg.nbins, double);
+        p->x[1] = ARRAY_1D(1, double);
+        p->x[1][0] = 0.0;
+        for (nv = 0; nv < cfg.nbins; nv++) {
+            p->x[0][nv] = (nv + 0.5) / cfg.nbins * (n == 0 ? cfg.rmax : CONST_PI);
+        }
+        sprintf(p->fname, "insitu_prof_%s.bin", n == 0 ? "r" : "th");
+
+        p->nvar = 5;
+        strcpy(p->name[0], "rho");
+        strcpy(p->name[1], "te");
+        strcpy(p->name[2], "vr");
+        strcpy(p->name[3], "mdot");
+        strcpy(p->name[4], "mdot_out");
+    }
+
+    /* Global products are only assembled on rank 0 */
+    if (prank == 0) {
+        for (n = 0; n < cfg.nslices; n++) {
+            size = slice[n].nvar * slice[n].n[0] * slice[n].n[1];
+            slice[n].plane = ARRAY_1D(size, double);
+        }
+        for (n = 0; n < cfg.nprojs; n++) {
+            size = proj[n].nvar * proj[n].n[0] * proj[n].n[1];
+            proj[n].plane = ARRAY_1D(size, double);
+        }
+        for (n = 0; n < 2 && cfg.nbins > 0; n++) {
+            prof[n].plane = ARRAY_1D(prof[n].nvar * cfg.nbins, double);
+        }
+    }
+}
+
+
+/* ************************************************ */
+static int InSituDue(double dt, long int *last) {
+/*!
+ * Return 1 if a product with time interval dt has to be written,
+ * i.e. if g_time has entered a new interval since the last record.
+ *
+ ************************************************** */
+
+    long int n;
+
+    if (dt <= 0.0) return 1;
+
+    n = (long int) floor(g_time / dt);
+    if (n <= *last) return 0;
+    *last = n;
+    return 1;
+}
+
+
+/* ************************************************ */
+static int ReadAxis(const char *label, int pos) {
+/*!
+ * Return the direction (IDIR, JDIR, KDIR) given as x1, x2 or x3 in
+ * the pos-th field of the line beginning with label.
+ *
+ ************************************************** */
+
+    char *w = ParamFileGet(label, pos);
+
+    if (w[0] != 'x' || w[1] < '1' || w[1] > '3' || w[2] != '\0') {
+        print1("! InSituInit: %s: invalid axis '%s' (use x1, x2 or x3)\n", label, w);
+        QUIT_PLUTO(1);
+    }
+    return w[1] - '1';
+}
+
+
+/* ************************************************ */
+static void SetProduct(Product *p, int dir, Grid *grid) {
+/*!
+ * Set the axes, the global size and the coordinates of a product
+ * normal to dir.
+ *
+ ************************************************** */
+
+    int a, m, n, ax;
+
+    p->dir = dir;
+    for (a = 0, m = 0; a < 3; a++) {
+        if (a != dir) p->ax[m++] = a;
+    }
+
+    for (m = 0; m < 2; m++) {
+        ax = p->ax[m];
+        p->n[m] = ax < DIMENSIONS ? grid[ax].np_int_glob : 1;
+        p->x[m] = ARRAY_1D(p->n[m], double);
+        for (n = 0; n < p->n[m]; n++) {
+            p->x[m][n] = ax < DIMENSIONS ? grid[ax].x_glob[grid[ax].gbeg + n] : grid[ax].x[0];
+        }
+    }
+}
+
+
+/* ************************************************ */
+static void GetPatch(Grid *grid, int *lbeg, int *ln, int *goff) {
+/*!
+ * Return, for each of the three directions, the first local index
+ * (lbeg) and the number (ln) of the interior cells of this processor,
+ * and the global index of its first interior cell (goff).
+ *
+ ************************************************** */
+
+    int a;
+
+    lbeg[IDIR] = IBEG; ln[IDIR] = NX1;
+    lbeg[JDIR] = JBEG; ln[JDIR] = NX2;
+    lbeg[KDIR] = KBEG; ln[KDIR] = NX3;
+
+    for (a = 0; a < 3; a++) {
+        goff[a] = a < DIMENSIONS ? grid[a].beg - grid[a].gbeg : 0;
+    }
+}
+
+
+/* ************************************************ */
+static FILE *ReopenRecords(Product *p, const char *fname) {
+/*
+ * Open the existing file of product p when restarting, check that its
+ * header matches p and discard the records with t >= g_time, which
+ * will be written again.
+ * Return the file positioned after the last record kept, or NULL if
+ * the file does not exist or does not match (p->disabled is set).
+ *
+ ************************************************** */
+
+    int m, hdr[3], ok;
+    char magic[8], name[INSITU_NAME_LEN];
+    off_t off, rsize, fsize;
+    double tstep[2];
+    FILE *fp;
+
+    fp = fopen(fname, "r+b");
+    if (fp == NULL) return NULL;
+
+    ok = fread(magic, 1, 8, fp) == 8 && !memcmp(magic, "PLUTOINS", 8) &&
+         fread(hdr, sizeof(int), 3, fp) == 3 && hdr[0] == p->nvar &&
+         hdr[1] == p->n[0] && hdr[2] == p->n[1];
+    for (m = 0; ok && m < p->nvar; m++) {
+        ok = fread(name, 1, INSITU_NAME_LEN, fp) == INSITU_NAME_LEN &&
+             !strncmp(name, p->name[m], INSITU_NAME_LEN - 1);
+    }
+    if (!ok) {
+        print1("! WriteRecord: %s does not match the current setup, "
+               "not written\n", fname);
+        fclose(fp);
+        p->disabled = 1;
+        return NULL;
+    }
+
+    /* Skip the coordinates, then keep the complete records
+     * written before the current time */
+    off   = ftello(fp) + (off_t) sizeof(double) * (p->n[0] + p->n[1]);
+    rsize = 2 * sizeof(double) +
+            (off_t) sizeof(float) * p->nvar * p->n[0] * p->n[1];
+    fseeko(fp, 0, SEEK_END);
+    fsize = ftello(fp);
+    while (off + rsize <= fsize) {
+        fseeko(fp, off, SEEK_SET);
+        if (fread(tstep, sizeof(double), 2, fp) != 2) break;
+        if (tstep[0] >= g_time) break;
+        off += rsize;
+    }
+    fflush(fp);
+    if (ftruncate(fileno(fp), off) != 0) {
+        print1("! WriteRecord: cannot truncate %s\n", fname);
+    }
+    fseeko(fp, off, SEEK_SET);
+    return fp;
+}
+
+
+/* ************************************************ */
+static void WriteRecord(Product *p, double *data) {
+/*!
+ * Append the record data[nvar][n[1]][n[0]] to the file of product p,
+ * writing the header first if the file is being created.
+ * Called by rank 0 only.
+ *
+ ************************************************** */
+
+    int m, size = p->nvar * p->n[0] * p->n[1];
+    char fname[512], name[INSITU_NAME_LEN];
+    double tstep[2];
+    float *buf;
+    FILE *fp = NULL;
+
+    if (p->disabled) return;
+    sprintf(fname, "%s/%s", GetOutputDir(), p->fname);
+
+    /* Append if this run has already written the file; when restarting
+     * (step > 0) continue the file of the previous run */
+    if (p->created) {
+        fp = fopen(fname, "ab");
+    }
+    else if (g_stepNumber > 0) {
+        fp = ReopenRecords(p, fname);
+        if (p->disabled) return;
+    }
+
+    if (fp == NULL) {
+        fp = fopen(fname, "wb");
+        if (fp == NULL) {
+            print1("! WriteRecord: cannot open %s\n", fname);
+            return;
+        }
+        fwrite("PLUTOINS", 1, 8, fp);
+        fwrite(&p->nvar, sizeof(int), 1, fp);
+        fwrite(p->n, sizeof(int), 2, fp);
+        for (m = 0; m < p->nvar; m++) {
+            memset(name, 0, INSITU_NAME_LEN);
+            strncpy(name, p->name[m], INSITU_NAME_LEN - 1);
+            fwrite(name, 1, INSITU_NAME_LEN, fp);
+        }
+        fwrite(p->x[0], sizeof(double), p->n[0], fp);
+        fwrite(p->x[1], sizeof(double), p->n[1], fp);
+    }
+    p->created = 1;
+
+    tstep[0] = g_time;
+    tstep[1] = (double) g_stepNumber;
+    fwrite(tstep, sizeof(double), 2, fp);
+
+    buf = ARRAY_1D(size, float);
+    for (m = 0; m < size; m++) buf[m] = (float) data[m];
+    fwrite(buf, sizeof(float), size, fp);
+    FreeArray1D((void *) buf);
+
+    fclose(fp);
+}
+
+
+/* ************************************************ */
+static double Temperature(const Data *d, int k, int j, int i) {
+/*!
+ * Return the temperature (code units) of cell (k, j, i), as for the
+ * te user-defined output variable.
+ *
+ ************************************************** */
+
+    int nv;
+    double v[NVAR];
+
+    for (nv = 0; nv < NVAR; nv++) v[nv] = d->Vc[nv][k][j][i];
+    return TempIdealEOS(v[RHO], v[PRS], MeanMolecularWeight(v));
+}
+
+
+/* ************************************************ */
+static void InSituSlice(const Data *d, Grid *grid, Product *p) {
+/*!
+ * Extract and write slice p.
+ *
+ ************************************************** */
+
+    int nv, m0, m1, l, size, ind[3];
+    int lbeg[3], ln[3], goff[3], pn[2], poff[2];
+    double *patch;
+
+    GetPatch(grid, lbeg, ln, goff);
+
+    /* Does the plane cross the local domain? */
+    l = p->gidx - goff[p->dir];
+    for (m0 = 0; m0 < 2; m0++) {
+        pn[m0] = ln[p->ax[m0]];
+        poff[m0] = goff[p->ax[m0]];
+    }
+    if (l < 0 || l >= ln[p->dir]) pn[0] = pn[1] = 0;
+
+    size = pn[0] * pn[1];
+    patch = ARRAY_1D(MAX(p->nvar * size, 1), double);
+
+    ind[p->dir] = lbeg[p->dir] + l;
+    for (m1 = 0; m1 < pn[1]; m1++) {
+        for (m0 = 0; m0 < pn[0]; m0++) {
+            ind[p->ax[0]] = lbeg[p->ax[0]] + m0;
+            ind[p->ax[1]] = lbeg[p->ax[1]] + m1;
+            for (nv = 0; nv < NVAR; nv++) {
+                patch[nv * size + m1 * pn[0] + m0] = d->Vc[nv][ind[KDIR]][ind[JDIR]][ind[IDIR]];
+            }
+            patch[NVAR * size + m1 * pn[0] + m0] = Temperature(d, ind[KDIR], ind[JDIR], ind[IDIR]);
+        }
+    }
+
+    GatherPlane(patch, p->nvar, pn, poff, p->plane, p->n);
+    FreeArray1D((void *) patch);
+
+    if (prank == 0) WriteRecord(p, p->plane);
+}
+
+
+/* ************************************************ */
+static void InSituProjection(const Data *d, Grid *grid, Product *p) {
+/*!
+ * Compute and write projection p: column density, emission measure,
+ * emission-weighted temperature and line-of-sight velocity.
+ *
+ ************************************************** */
+
+    int i, j, k, m, n, size, ind[3];
+    int lbeg[3], ln[3], goff[3], pn[2], poff[2];
+    double rho, te, w, dl, vlos;
+    double *patch;
+
+    GetPatch(grid, lbeg, ln, goff);
+    for (m = 0; m < 2; m++) {
+        pn[m] = ln[p->ax[m]];
+        poff[m] = goff[p->ax[m]];
+    }
+    size = pn[0] * pn[1];
+    patch = ARRAY_1D(p->nvar * size, double);
+    for (m = 0; m < p->nvar * size; m++) patch[m] = 0.0;
+
+    DOM_LOOP(k, j, i) {
+        ind[IDIR] = i;
+        ind[JDIR] = j;
+        ind[KDIR] = k;
+        m = (ind[p->ax[0]] - lbeg[p->ax[0]]) + pn[0] * (ind[p->ax[1]] - lbeg[p->ax[1]]);
+
+        rho = d->Vc[RHO][k][j][i];
+        te = Temperature(d, k, j, i);
+        w = rho * rho * sqrt(te);
+        dl = grid[p->dir].dx[ind[p->dir]];
+        vlos = p->dir < COMPONENTS ? d->Vc[VX1 + p->dir][k][j][i] : 0.0;
+
+        patch[m] += rho * dl;
+        patch[size + m] += w * dl;
+        patch[2 * size + m] += w * te * dl;
+        patch[3 * size + m] += w * vlos * dl;
+    }
+
+    GatherPlane(patch, p->nvar, pn, poff, p->plane, p->n);
+    FreeArray1D((void *) patch);
+
+    if (prank == 0) {
+        size = p->n[0] * p->n[1];
+        for (n = 0; n < size; n++) {
+            w = p->plane[size + n];
+            p->plane[2 * size + n] = w > 0.0 ? p->plane[2 * size + n] / w : 0.0;
+            p->plane[3 * size + n] = w > 0.0 ? p->plane[3 * size + n] / w : 0.0;
+        }
+        WriteRecord(p, p->plane);
+    }
+}
+
+
+/* ************************************************ */
+static void InSituProfiles(const Data *d, Grid *grid) {
+/*!
+ * Compute and write the mass-weighted radial and angular profiles.
+ *
+ ************************************************** */
+
+    int i, j, k, b, n, m;
+    int nbins = cfg.nbins;
+    double rmax = cfg.rmax;
+    double *x1, *x2;
+    double r, th, dV, rho, te, vr, vx1, vx2, vx3, dr;
+    double *V, *M;
+#if DIMENSIONS == 3
+    double *x3;
+#endif
+
+    /* Sums over each bin of the radial (n = 0) and angular (n = 1)
+     * profiles, stored as sum[n][m][b] */
+    enum {SUM_VOL, SUM_MASS, SUM_MTE, SUM_MVR, SUM_MVR_OUT, NSUMS};
+    static double *lsum, *gsum;
+    #define SUM(a, n, m, b)  (a)[((n) * NSUMS + (m)) * nbins + (b)]
+
+    if (lsum == NULL) {
+        lsum = ARRAY_1D(2 * NSUMS * nbins, double);
+        gsum = ARRAY_1D(2 * NSUMS * nbins, double);
+    }
+
+    x1 = grid[IDIR].x;
+    x2 = grid[JDIR].x;
+#if DIMENSIONS == 3
+    x3 = grid[KDIR].x;     /* Discarded by SPH1(), SPH2() and VSPH1() in 2D */
+#endif
+
+    for (m = 0; m < 2 * NSUMS * nbins; m++) lsum[m] = 0.0;
+
+    DOM_LOOP(k, j, i) {
+
+        r = SPH1(x1[i], x2[j], x3[k]);
+        if (r >= rmax) continue;
+
+        dV = 1.0;
+        D_EXPAND(dV *= grid[IDIR].dV[i];,
+                 dV *= grid[JDIR].dV[j];,
+                 dV *= grid[KDIR].dV[k];);
+
+        rho = d->Vc[RHO][k][j][i];
+        te = Temperature(d, k, j, i);
+        vx1 = vx2 = vx3 = 0;
+        EXPAND(vx1 = d->Vc[VX1][k][j][i];,
+               vx2 = d->Vc[VX2][k][j][i];,
+               vx3 = d->Vc[VX3][k][j][i];);
+        vr = r > 0.0 ? VSPH1(x1[i], x2[j], x3[k], vx1, vx2, vx3) : 0.0;
+
+        for (n = 0; n < 2; n++) {
+            if (n == 0) {
+                b = (int) (r / rmax * nbins);
+            }
+            else {
+                if (r == 0.0) continue;
+                th = SPH2(x1[i], x2[j], x3[k]);
+                b = (int) (th / CONST_PI * nbins);
+            }
+            b = MIN(MAX(b, 0), nbins - 1);
+
+            SUM(lsum, n, SUM_VOL, b) += dV;
+            SUM(lsum, n, SUM_MASS, b) += rho * dV;
+            SUM(lsum, n, SUM_MTE, b) += rho * te * dV;
+            SUM(lsum, n, SUM_MVR, b) += rho * vr * dV;
+            SUM(lsum, n, SUM_MVR_OUT, b) += rho * MAX(vr, 0.0) * dV;
+        }
+    }
+
+#ifdef PARALLEL
+    MPI_Reduce(lsum, gsum, 2 * NSUMS * nbins, MPI_DOUBLE, MPI_SUM, 0, AL_COMM_WORLD);
+#else
+    for (m = 0; m < 2 * NSUMS * nbins; m++) gsum[m] = lsum[m];
+#endif
+
+    if (prank != 0) return;
+
+    for (n = 0; n < 2; n++) {
+        double *out = prof[n].plane;
+
+        dr = n == 0 ? rmax / nbins : rmax;
+        V = &SUM(gsum, n, SUM_VOL, 0);
+        M = &SUM(gsum, n, SUM_MASS, 0);
+        for (b = 0; b < nbins; b++) {
+            out[b] = V[b] > 0.0 ? M[b] / V[b] : 0.0;
+            out[nbins + b] = M[b] > 0.0 ? SUM(gsum, n, SUM_MTE, b) / M[b] : 0.0;
+            out[2 * nbins + b] = M[b] > 0.0 ? SUM(gsum, n, SUM_MVR, b) / M[b] : 0.0;
+            out[3 * nbins + b] = SUM(gsum, n, SUM_MVR, b) / dr;
+            out[4 * nbins + b] = SUM(gsum, n, SUM_MVR_OUT, b) / dr;
+        }
+        WriteRecord(prof + n, out);
+    }
+    #undef SUM
+}
@@ -0,0 +1,13 @@
+//
+// In-situ reduced data products: slices, projections and profiles.
+//
+
+#ifndef PLUTO_INSITU_H
+#define PLUTO_INSITU_H
+
+/* Maximum number of slices in the insitu_slice line */
+#define INSITU_MAX_SLICES  8
+
+void InSituAnalysis(const Data *d, Grid *grid);
+
+#endif //PLUTO_INSITU_H
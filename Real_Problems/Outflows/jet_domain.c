@@ -13,7 +13,10 @@
   size.
   Useful for problems involving jet propagation.
   \note In parallel, the domain shall not be decomposed along the
-        propagation direction.
+        propagation direction unless it is repartitioned at run time
+        (-repart, see repartition.c). In that case the front position
+        is reduced in global index space and processors lying entirely
+        beyond it only integrate a few zones.
   
   \author A. Mignone (mignone@ph.unito.it)
   \date   Oct 3, 2012
@@ -27,6 +30,7 @@
 /*-- AYW */
 
 static int NBEG, NEND, NPT, NPT_TOT, rbound;
+static int front = -1;  /* front index + guard cells (global) */
 
 /* AYW -- 2012-11-15 16:05 JST */
 //static int GetRightmostIndex(int, double ***);
@@ -48,7 +52,7 @@ void SetJetDomain (const Data *d, int dir, int log_freq, Grid *grid)
  *********************************************************************** */
 {
   int i, j, k, ngh;
-  int n, n_glob;
+  int n, n_glob, offset;
   static int first_call = 1;
   double ***pr, ***dn, dp;
 
@@ -61,22 +65,23 @@ void SetJetDomain (const Data *d, int dir, int log_freq, Grid *grid)
 
   ngh = grid[dir].nghost;
 
-/* -- save original domain offsets 
+/* -- save original domain offsets (they are refreshed at 
+      every call since repartitioning may change them) 
       and return for the first time -- */
 
+  if (dir == IDIR) {
+    NBEG = IBEG; NEND    = IEND; 
+    NPT  = NX1;  NPT_TOT = NX1_TOT;
+  }else if (dir == JDIR){
+    NBEG = JBEG; NEND    = JEND; 
+    NPT  = NX2;  NPT_TOT = NX2_TOT;
+  }else if (dir == KDIR){
+    NBEG = KBEG; NEND    = KEND; 
+    NPT  = NX3;  NPT_TOT = NX3_TOT;
+  }
+  rbound = grid[dir].rbound;
+
   if (first_call){
-    if (dir == IDIR) {
-      NBEG = IBEG; NEND    = IEND; 
-      NPT  = NX1;  NPT_TOT = NX1_TOT;
-    }else if (dir == JDIR){
-      NBEG = JBEG; NEND    = JEND; 
-      NPT  = NX2;  NPT_TOT = NX2_TOT;
-    }else if (dir == KDIR){
-      NBEG = KBEG; NEND    = KEND; 
-      NPT  = NX3;  NPT_TOT = NX3_TOT;
-    }
-
-    rbound = grid[dir].rbound;
     first_call = 0;
     return;
   }
@@ -88,17 +93,26 @@ void SetJetDomain (const Data *d, int dir, int log_freq, Grid *grid)
 
   /* AYW -- 2012-11-15 16:07 JST */
   //n = GetRightmostIndex(dir, pr) + 2*ngh;
-  n = GetRightmostIndex(dir, pr, dn, grid) + 2*ngh;
+  n = GetRightmostIndex(dir, pr, dn, grid);
   /* -- AYW */
 
-  if (n < NBEG + ngh) n = NBEG + ngh;
-  if (n > NEND)       n = NEND;
+/* -- the front is located in global index space, which is the 
+      same as the local one unless the domain is decomposed 
+      along dir -- */
+
+  offset = grid[dir].beg - NBEG;
+  if (n >= 0) n += offset;
 
   #ifdef PARALLEL
-   MPI_Allreduce (&n, &n_glob, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+   MPI_Allreduce (&n, &n_glob, 1, MPI_INT, MPI_MAX, AL_COMM_WORLD);
    n = n_glob;
   #endif
 
+  n = n - offset + 2*ngh;
+  front = n + offset;
+  if (n < NBEG + ngh) n = NBEG + ngh;
+  if (n > NEND)       n = NEND;
+
   /*if (g_stepNumber%log_freq==0){
     print1 ("- SetJetDomain: index %d / %d\n",n,NEND);
   }*/
@@ -189,6 +203,19 @@ void UnsetJetDomain (const Data *d, int dir, Grid *grid)
 
 }
 
+/* ********************************************************************* */
+int JetDomainFront (void)
+/*!
+ * Return the global index of the jet front (safety guard cells 
+ * included) found by the most recent call to SetJetDomain(), or -1 
+ * if the domain has not been adjusted yet. The value is the same on 
+ * all processors.
+ *
+ *********************************************************************** */
+{
+  return front;
+}
+
 /* ********************************************************************* */
 /* AYW -- 2012-11-15 16:09 JST */
 //int GetRightmostIndex (int dir, double ***q)
@@ -48,6 +48,7 @@
 /* ///////////////////////////////////////////////////////////////////// */
 #include "pluto.h"
 #include "globals.h"
+#include "repartition.h"
 
 /* AYW -- made this YES */
 #define SHOW_TIME_STEPS  YES   /* -- show time steps due to advection,
@@ -82,6 +83,7 @@ int main (int argc, char *argv[])
     double t_elapsed;
 #ifdef PARALLEL
     double tbeg_mpi, tend_mpi;
+    int thread_level = MPI_THREAD_SINGLE;
 #endif
     //struct tm * ptm;
     /* -- AYW */
@@ -93,11 +95,18 @@ int main (int argc, char *argv[])
     Output *output;
 
 #ifdef PARALLEL
-    AL_Init (&argc, &argv);
-    MPI_Comm_rank (MPI_COMM_WORLD, &prank);
+    /* -- the I/O thread of -async-output needs MPI_THREAD_MULTIPLE,
+          which is not requested otherwise since it may slow down
+          every message -- */
+    for (nv = 1; nv < argc; nv++) {
+        if (!strcmp(argv[nv], "-async-output")) thread_level = MPI_THREAD_MULTIPLE;
+    }
+    AL_Init_thread (&argc, &argv, thread_level);
+    MPI_Comm_rank (AL_COMM_WORLD, &prank);
 #endif
 
     Initialize(argc, argv, &data, &ini, grd, &cmd_line);
+    MemoryReport("startup");
 
     double *dbl_pnt;
     int *int_pnt;
@@ -147,7 +156,7 @@ int main (int argc, char *argv[])
     /* AYW -- 2012-06-26 11:43 JST */
 #ifdef PARALLEL
     if (prank == 0) tbeg_mpi = MPI_Wtime();
-    MPI_Bcast(&tbeg_mpi, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    MPI_Bcast(&tbeg_mpi, 1, MPI_DOUBLE, 0, AL_COMM_WORLD);
 #else
     time(&tbeg);
 #endif
@@ -234,6 +243,8 @@ int main (int argc, char *argv[])
             print1 (", Nrkc = %d",Dts.Nrkc);
 #endif
             print1("]\n");
+            if (cmd_line.activity) ActivityReport();
+            TimerReport();
         }
 
         /* ------------------------------------------------------
@@ -250,9 +261,16 @@ int main (int argc, char *argv[])
             g_dt = dt(n)
            ------------------------------------------------------ */
 
+        if (cmd_line.repart > 0 && g_stepNumber > 0 && g_stepNumber % cmd_line.repart == 0) {
+            JetRepartition(&data, &ini, grd, cmd_line.jet);
+        }
+        if (cmd_line.activity) ActivityUpdate(&data, cmd_line.activity, grd);
         if (cmd_line.jet != -1) SetJetDomain(&data, cmd_line.jet, ini.log_freq, grd);
+        TimerStart(TIMER_STEP);
         err = Integrate(&data, Solver, &Dts, grd);
+        TimerStop(TIMER_STEP);
         if (cmd_line.jet != -1) UnsetJetDomain(&data, cmd_line.jet, grd);
+        if (cmd_line.activity == ACTIVITY_CHECK) ActivityCheck(&data, grd);
 
         /* ------------------------------------------------------
              Integration didn't go through. Step must
@@ -285,13 +303,13 @@ int main (int argc, char *argv[])
             dtp = 0.5 / Dts.inv_dtp;
             dtc = Dts.dt_cool;
 #ifdef PARALLEL
-            MPI_Allreduce (&dta, &cg, 1, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD);
+            MPI_Allreduce (&dta, &cg, 1, MPI_DOUBLE, MPI_MIN, AL_COMM_WORLD);
             dta = cg;
 
-            MPI_Allreduce (&dtp, &cg, 1, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD);
+            MPI_Allreduce (&dtp, &cg, 1, MPI_DOUBLE, MPI_MIN, AL_COMM_WORLD);
             dtp = cg;
 
-            MPI_Allreduce (&dtc, &cg, 1, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD);
+            MPI_Allreduce (&dtc, &cg, 1, MPI_DOUBLE, MPI_MIN, AL_COMM_WORLD);
             dtc = cg;
 #endif
             /*
@@ -312,7 +330,7 @@ int main (int argc, char *argv[])
 
 #ifdef PARALLEL
         if (prank == 0) tend_mpi = MPI_Wtime();
-        MPI_Bcast(&tend_mpi, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+        MPI_Bcast(&tend_mpi, 1, MPI_DOUBLE, 0, AL_COMM_WORLD);
 #else
         time(&tend);
 #endif
@@ -355,14 +373,15 @@ int main (int argc, char *argv[])
 
 #ifdef PARALLEL
         MPI_Allreduce (&g_maxMach, &scrh, 1,
-                       MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+                       MPI_DOUBLE, MPI_MAX, AL_COMM_WORLD);
         g_maxMach = scrh;
 
-        MPI_Allreduce (&g_maxRiemannIter, &nv, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+        MPI_Allreduce (&g_maxRiemannIter, &nv, 1, MPI_INT, MPI_MAX, AL_COMM_WORLD);
         g_maxRiemannIter = nv;
 #endif
 
         g_stepNumber++;
+        if (first_step) MemoryReport("first step");
 
         first_step = 0;
     }
@@ -412,13 +431,13 @@ int main (int argc, char *argv[])
          dtp = 0.5/Dts.inv_dtp;
          dtc = Dts.dt_cool;
 #ifdef PARALLEL
-          MPI_Allreduce (&dta, &cg, 1, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD);
+          MPI_Allreduce (&dta, &cg, 1, MPI_DOUBLE, MPI_MIN, AL_COMM_WORLD);
           dta = cg;
 
-          MPI_Allreduce (&dtp, &cg, 1, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD);
+          MPI_Allreduce (&dtp, &cg, 1, MPI_DOUBLE, MPI_MIN, AL_COMM_WORLD);
           dtp = cg;
 
-          MPI_Allreduce (&dtc, &cg, 1, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD);
+          MPI_Allreduce (&dtc, &cg, 1, MPI_DOUBLE, MPI_MIN, AL_COMM_WORLD);
           dtc = cg;
 #endif
          print1 ("\t[dt/dta = %10.4e, dt/dtp = %10.4e, dt/dtc = %10.4e \n",
@@ -432,10 +451,10 @@ int main (int argc, char *argv[])
 
 #ifdef PARALLEL
        MPI_Allreduce (&g_maxMach, &scrh, 1,
-                      MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+                      MPI_DOUBLE, MPI_MAX, AL_COMM_WORLD);
        g_maxMach = scrh;
 
-       MPI_Allreduce (&g_maxRiemannIter, &nv, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+       MPI_Allreduce (&g_maxRiemannIter, &nv, 1, MPI_INT, MPI_MAX, AL_COMM_WORLD);
        g_maxRiemannIter = nv;
 #endif
 
@@ -462,6 +481,8 @@ int main (int argc, char *argv[])
          print1 (", Nrkc = %d",Dts.Nrkc);
 #endif
         print1 ("]\n");
+        if (cmd_line.activity) ActivityReport ();
+        TimerReport ();
       }
 
     /* ------------------------------------------------------
@@ -469,9 +490,13 @@ int main (int argc, char *argv[])
         g_dt = dt(n)
        ------------------------------------------------------ */
 
+      if (cmd_line.activity) ActivityUpdate (&data, cmd_line.activity, grd);
       if (cmd_line.jet != -1) SetJetDomain (&data, cmd_line.jet, ini.log_freq, grd);
+      TimerStart (TIMER_STEP);
       err = Integrate (&data, Solver, &Dts, grd);
+      TimerStop (TIMER_STEP);
       if (cmd_line.jet != -1) UnsetJetDomain (&data, cmd_line.jet, grd);
+      if (cmd_line.activity == ACTIVITY_CHECK) ActivityCheck (&data, grd);
 
     /* ------------------------------------------------------
          Integration didn't go through. Step must
@@ -500,7 +525,7 @@ int main (int argc, char *argv[])
 
 #ifdef PARALLEL
       if (prank == 0) tend_mpi = MPI_Wtime();
-      MPI_Bcast(&tend_mpi, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+      MPI_Bcast(&tend_mpi, 1, MPI_DOUBLE, 0, AL_COMM_WORLD);
 #else
       time(&tend);
 #endif
@@ -531,6 +556,7 @@ int main (int argc, char *argv[])
 
       g_dt = NextTimeStep(&Dts, &ini, grd);
       g_stepNumber++;
+      if (first_step) MemoryReport("first step");
       first_step = 0;
     }
 #endif /* USE_ASYNC_IO */
@@ -548,15 +574,11 @@ int main (int argc, char *argv[])
         Async_EndWriteData (&ini);
 #endif
     }
+    AsyncOutputStop();
 
-#ifdef PARALLEL
-    MPI_Barrier (MPI_COMM_WORLD);
-    print1  ("\n> Total allocated memory  %6.2f Mb (proc #%d)\n",
-              (float)g_usedMemory/1.e6,prank);
-    MPI_Barrier (MPI_COMM_WORLD);
-#else
-    print1("\n> Total allocated memory  %6.2f Mb\n", (float) g_usedMemory / 1.e6);
-#endif
+    print1("\n");
+    MemoryReport("end");
+    TimerDump(ini.output_dir);
 
     time(&tend);
     g_dt = difftime(tend, tbeg);
@@ -573,7 +595,7 @@ int main (int argc, char *argv[])
 
     FreeArray4D((void *) data.Vc);
 #ifdef PARALLEL
-    MPI_Barrier (MPI_COMM_WORLD);
+    MPI_Barrier (AL_COMM_WORLD);
     AL_Finalize ();
 #endif
 
@@ -630,10 +652,14 @@ int Integrate (Data *d, Riemann_Solver *Solver, Time_Step *Dts, Grid *grid)
         if (UpdateSolution (d, Solver, Dts, grid) != 0) return(1);
 #endif
         g_operatorStep = PARABOLIC_STEP;
+        TimerStart(TIMER_SOURCE);
         SplitSource(d, g_dt, Dts, grid);
+        TimerStop(TIMER_SOURCE);
     } else {
         g_operatorStep = PARABOLIC_STEP;
+        TimerStart(TIMER_SOURCE);
         SplitSource(d, g_dt, Dts, grid);
+        TimerStop(TIMER_SOURCE);
         g_operatorStep = HYPERBOLIC_STEP;
 #if DIMENSIONAL_SPLITTING == YES
         for (g_dir = DIMENSIONS - 1; g_dir >= 0; g_dir--) {
@@ -697,16 +723,16 @@ double NextTimeStep (Time_Step *Dts, struct INPUT *ini, Grid *grid)
 
 #ifdef PARALLEL
     xloc = Dts->inv_dta;
-    MPI_Allreduce (&xloc, &xglob, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    MPI_Allreduce (&xloc, &xglob, 1, MPI_DOUBLE, MPI_MAX, AL_COMM_WORLD);
     Dts->inv_dta = xglob;
 #if (PARABOLIC_FLUX != NO)
      xloc = Dts->inv_dtp;
-     MPI_Allreduce (&xloc, &xglob, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+     MPI_Allreduce (&xloc, &xglob, 1, MPI_DOUBLE, MPI_MAX, AL_COMM_WORLD);
      Dts->inv_dtp = xglob;
 #endif
 #if COOLING != NO
      xloc = Dts->dt_cool;
-     MPI_Allreduce (&xloc, &xglob, 1, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD);
+     MPI_Allreduce (&xloc, &xglob, 1, MPI_DOUBLE, MPI_MIN, AL_COMM_WORLD);
      Dts->dt_cool = xglob;
 #endif
 #endif
@@ -794,7 +820,7 @@ void CheckForOutput(Data *d, Input *ini, Grid *grid)
 {
     static int first_call = 1;
     int n, check_dt, check_dn, check_dclock;
-    int restart_update, last_step;
+    int restart_update, last_step, written = 0;
     double t, tnext;
     Output *output;
     static time_t clock_beg[MAX_OUTPUT_TYPES], clock_end;
@@ -820,7 +846,7 @@ void CheckForOutput(Data *d, Input *ini, Grid *grid)
           tstart = MPI_Wtime();
           for (n = 0; n < MAX_OUTPUT_TYPES; n++) tbeg[n] = tstart;
         }
-        MPI_Bcast(tbeg, MAX_OUTPUT_TYPES, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+        MPI_Bcast(tbeg, MAX_OUTPUT_TYPES, MPI_DOUBLE, 0, AL_COMM_WORLD);
 #else
         for (n = 0; n < MAX_OUTPUT_TYPES; n++) time(clock_beg + n);
 #endif
@@ -830,7 +856,7 @@ void CheckForOutput(Data *d, Input *ini, Grid *grid)
 
 #ifdef PARALLEL
     if (prank == 0) tend = MPI_Wtime();
-    MPI_Bcast(&tend, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    MPI_Bcast(&tend, 1, MPI_DOUBLE, 0, AL_COMM_WORLD);
 #else
     time(&clock_end);
 #endif
@@ -882,6 +908,7 @@ void CheckForOutput(Data *d, Input *ini, Grid *grid)
 
         if (check_dt || check_dn || check_dclock) {
 
+            TimerStart(TIMER_OUTPUT);
 #ifdef USE_ASYNC_IO
             if (!strcmp(output->mode,"single_file_async")){
               Async_BegWriteData (d, output, grid);
@@ -891,6 +918,8 @@ void CheckForOutput(Data *d, Input *ini, Grid *grid)
 #else
             WriteData(d, output, grid);
 #endif
+            TimerStop(TIMER_OUTPUT);
+            written = 1;
 
             /* ----------------------------------------------------------
                 save the file number of the dbl and dbl.h5 output format
@@ -911,6 +940,7 @@ void CheckForOutput(Data *d, Input *ini, Grid *grid)
    ------------------------------------------------------- */
 
     if (restart_update) RestartDump(ini);
+    if (written) MemoryReport("output");
 
     first_call = 0;
 }
@@ -939,7 +969,11 @@ void CheckForAnalysis(Data *d, Input *ini, Grid *grid)
 
     /* AYW -- 2013-01-08 18:04 JST
      * Last step condition from main loop */
-    if (check_dt || check_dn || g_lastStep) Analysis(d, grid);
+    if (check_dt || check_dn || g_lastStep) {
+        TimerStart(TIMER_ANALYSIS);
+        Analysis(d, grid);
+        TimerStop(TIMER_ANALYSIS);
+    }
     //if (check_dt || check_dn) Analysis (d, grid);
     /* -- AYW */
 }
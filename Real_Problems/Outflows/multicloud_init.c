@@ -137,18 +137,28 @@ int MultiCloudPrimitives(double* cloud,
 }
 
 /* ************************************************************** */
-void Read_Multicld(char *fname)
+int Read_Multicld(char *fname, double *xbeg, double *xend)
 /*!
- * Read in external density from a input filename. 
+ * Read in external density from a input filename, only the part
+ * covering the region [xbeg, xend] of the input grid. Each file
+ * is read once and kept in memory (see InputDataCache).
  *
+ * Returns the cache index of the file, to be passed to
+ * InputDataCacheUse.
  **************************************************************** */
 {
-  int get_var[] = {RHO, -1};
+    static int once01 = 0;
+    int get_var[] = {RHO, -1};
 
-  /* Read cloud data from external file */
-    InputDataSet("./grid_in.out", get_var);
-    InputDataRead(fname, CUBE_ENDIANNESS);
+    /* The input grid is the same for all the clouds */
+    if (!once01) {
+        InputDataSet("./grid_in.out", get_var);
+        once01 = 1;
+    }
 
+    /* Read cloud data from external file */
+    InputDataSetRegion(xbeg, xend);
+    return InputDataCache(fname, CUBE_ENDIANNESS);
 }
 
 
@@ -158,69 +168,29 @@ void Read_Multicld(char *fname)
 /* ***********************************************************************/
 void readgridfile (struct InGrid *Gin)
 /* 
- * Read in external input grid from grid_in.out and store coordinate axes &
- * number of elements in structure InGrid
+ * Read in external input grid from grid_in.out (or its binary
+ * descriptor grid_in.bin, see ReadGridFile) and store coordinate
+ * axes & number of elements in structure InGrid
  *
  *********************************************************************** */
 {
-    int i, ip, nv, success;
-    size_t dsize, dcount;
-    char *sub_str, sline[256];
-    const char delimiters[] = " \t\r\f\n";
-    double xl, xr;
-    fpos_t file_pos;
-    int id_nx1, id_nx2, id_nx3;
-    double *temp;
-    FILE *fp;
-
-    fp = fopen("grid_in.out", "r");
-    if (fp == NULL) {
-        printf("! InputDataSet: grid file not found\n");
-        exit(1);
-    }
-/* --------------------------------------------------------------------- */
-/*! - Move file pointer until the first line that does not
-      begin with a "#".                                                  */
-/* --------------------------------------------------------------------- */
-
-    success = 0;
-    while (!success) {
-        fgetpos(fp, &file_pos);
-        fgets(sline, 512, fp);
-        if (sline[0] != '#') success = 1;
-    }
-
-    fsetpos(fp, &file_pos);
-
-/* --------------------------------------------------------------------- */
-/*! - Start reading number of points and grid coordinates. For the
-      input x1 direction these are stored inside the module variables
-      ::id_nx1 and ::id_x1.                                              */
-/* --------------------------------------------------------------------- */
+    int i;
+    GridFile *gf;
 
-    fscanf(fp, "%d \n", &Gin->id_nx1);
+    /* The same file is read by InputDataSet, so it is parsed only once */
+    gf = ReadGridFile("./grid_in.out");
 
+    Gin->id_nx1 = gf->np[IDIR];
     Gin->x1 = (double *) malloc(sizeof(double) * Gin->id_nx1);
+    for (i = 0; i < Gin->id_nx1; i++) Gin->x1[i] = 0.5 * (gf->xl[IDIR][i] + gf->xr[IDIR][i]);
 
-    for (i = 0; i < Gin->id_nx1; i++) {
-        fscanf(fp, "%d  %lf %lf\n", &ip, &xl, &xr);
-        Gin->x1[i] = 0.5 * (xl + xr);
-    }
-
-    fscanf(fp, "%d \n", &Gin->id_nx2);
+    Gin->id_nx2 = gf->np[JDIR];
     Gin->x2 = (double *) malloc(sizeof(double) * Gin->id_nx2);
-    for (i = 0; i < Gin->id_nx2; i++) {
-        fscanf(fp, "%d  %lf %lf\n", &ip, &xl, &xr);
-        Gin->x2[i] = 0.5 * (xl + xr);
-    }
+    for (i = 0; i < Gin->id_nx2; i++) Gin->x2[i] = 0.5 * (gf->xl[JDIR][i] + gf->xr[JDIR][i]);
 
-    fscanf(fp, "%d \n", &Gin->id_nx3);
+    Gin->id_nx3 = gf->np[KDIR];
     Gin->x3 = (double *) malloc(sizeof(double) * Gin->id_nx3);
-    for (i = 0; i < Gin->id_nx3; i++) {
-        fscanf(fp, "%d  %lf %lf\n", &ip, &xl, &xr);
-        Gin->x3[i] = 0.5 * (xl + xr);
-    }
-    fclose(fp);
+    for (i = 0; i < Gin->id_nx3; i++) Gin->x3[i] = 0.5 * (gf->xl[KDIR][i] + gf->xr[KDIR][i]);
 
 /* -- reset grid with 1 point -- */
 
@@ -245,11 +215,13 @@ void readgridfile (struct InGrid *Gin)
     long int vseed1 = -5555, vseed2 = -99999, vseed3 = -222222;
     int ll, count;
     FILE *fp_cldlist;
+    char fname[512];
 
 
     //---Open cloud position list file---//
 
-    fp_cldlist = fopen("cloud_pos_list.dat", "w");
+    sprintf(fname, "%s/cloud_pos_list.dat", GetOutputDir());
+    fp_cldlist = fopen(fname, "w");
     if (fp_cldlist == NULL) {
         print1("Can't open cloud_pos_list.dat \n");
         QUIT_PLUTO(1);
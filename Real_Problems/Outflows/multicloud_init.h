@@ -1,5 +1,8 @@
 //---for multi clouds---//
 
+/* Size (in zones) of the bins used to index clouds in Startup */
+#define CLD_BIN_SIZE 8
+
 struct InGrid {
     double *x1;
     double *x2;
@@ -20,7 +23,7 @@ struct cld_domain {
 
 void readgridfile(struct InGrid *);
 void Init_multiclds(double *, double, double, double, struct cld_domain);
-void Read_Multicld(char *);
+int Read_Multicld(char *, double *, double *);
 int MultiCloudPrimitives(double*, const double, const double, const double, struct cld_domain);
 
 double ran1(long int *);
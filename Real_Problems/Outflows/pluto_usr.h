@@ -82,6 +82,13 @@
 #define CS_SCALE_HEIGHT          1
 #define CS_VELOCITY_DISPERSION   1
 
+/* CLOUD_CUBE values.
+ * Where the fractal cube comes from.
+ * CC_FILE reads input.flt on the grid_in.out grid,
+ * CC_FRACTAL generates a log-normal field in the code (see fractal.c) */
+#define CC_FILE                  0
+#define CC_FRACTAL               1
+
 
 /* Static Gravity */
 
@@ -230,6 +237,42 @@
 #define CLOUD_EXTRACT NONE
 #endif
 
+#ifndef CLOUD_CUBE
+#define CLOUD_CUBE CC_FILE
+#endif
+
+/* Parameters of the generated fractal cube (CLOUD_CUBE == CC_FRACTAL):
+ * slope of the energy spectrum, wavenumber range in units of 2 pi / L
+ * (L the largest domain side, FRACTAL_KMAX <= 0 for no upper cutoff),
+ * mean and standard deviation of the log-normal factor, random seed. */
+#ifndef FRACTAL_INDEX
+#define FRACTAL_INDEX (-5./3.)
+#endif
+
+#ifndef FRACTAL_KMIN
+#define FRACTAL_KMIN 2.0
+#endif
+
+#ifndef FRACTAL_KMAX
+#define FRACTAL_KMAX 0.0
+#endif
+
+#ifndef FRACTAL_MEAN
+#define FRACTAL_MEAN 1.0
+#endif
+
+#ifndef FRACTAL_SIGMA
+#define FRACTAL_SIGMA 5.0
+#endif
+
+#ifndef FRACTAL_SEED
+#define FRACTAL_SEED 1
+#endif
+
+#if CLOUD_CUBE == CC_FRACTAL && GEOMETRY != CARTESIAN
+#error CLOUD_CUBE == CC_FRACTAL requires GEOMETRY == CARTESIAN
+#endif
+
 /* A factor with which to underpressure clouds w.r.t. ambient medium (<1)*/
 #ifndef CLOUD_UNDERPRESSURE
 #define CLOUD_UNDERPRESSURE 0.98
@@ -245,6 +288,10 @@
 #define CLOUDS_MULTI NO
 #endif
 
+#if CLOUD_CUBE == CC_FRACTAL && CLOUDS_MULTI == YES
+#error CLOUD_CUBE == CC_FRACTAL cannot be used with CLOUDS_MULTI == YES
+#endif
+
 /* Turn off default cloud init if clouds_multi = yes to prevent double initialisation.
    Comment out lines below if both are needed for a set up.
 */
@@ -282,6 +329,53 @@
   #endif
 #endif
 
+/* Run-time repartitioning along the jet direction (-repart, see
+ * repartition.c). A slab of cells behind the jet front costs one unit
+ * per cell plus REPART_COOL_WEIGHT for each cell above the cooling
+ * cutoff temperature; cells ahead of the front cost REPART_IDLE_WEIGHT.
+ * The domain is repartitioned when the most loaded processor exceeds
+ * the mean by more than REPART_TOLERANCE, and no processor may own 
+ * more than REPART_MAX_FACTOR times the points of a uniform split. */
+#ifndef REPART_COOL_WEIGHT
+#define REPART_COOL_WEIGHT 1.0
+#endif
+
+#ifndef REPART_IDLE_WEIGHT
+#define REPART_IDLE_WEIGHT 0.05
+#endif
+
+#ifndef REPART_TOLERANCE
+#define REPART_TOLERANCE 1.1
+#endif
+
+#ifndef REPART_MAX_FACTOR
+#define REPART_MAX_FACTOR 4.0
+#endif
+
+/* With INITIAL_SMOOTHING == YES, zones whose initial conditions at
+ * the outermost sub-sample points agree within this relative
+ * tolerance are not super-sampled, but take the value at the center.
+ * 0 super-samples all zones. */
+#ifndef SMOOTHING_TOLERANCE
+#define SMOOTHING_TOLERANCE 0.0
+#endif
+
+/* Initial conditions cache (see ic_cache.c). The halo and clouds
+ * primitives computed by Startup are stored in IC_CACHE_DIR and read
+ * back by the following runs with the same grid, input files and
+ * parameters, apart from the nozzle ones. */
+#ifndef IC_CACHE
+#define IC_CACHE NO
+#endif
+
+#ifndef IC_CACHE_DIR
+#define IC_CACHE_DIR "./ic_cache"
+#endif
+
+#if IC_CACHE == YES && INITIAL_SMOOTHING == YES
+#error IC_CACHE requires INITIAL_SMOOTHING == NO
+#endif
+
 
 
 /* For further refinement modes define these variables in TagCells.cpp */
@@ -320,4 +414,16 @@ extern int last_step;
 /* Generally, prototypes are in the header of the file they are
  * first used. But in cases where the variable is used very often
  * or in cases where there isn't a header, e.g. because it's just
- * a little edit of a source code file, include the prototype here. */
\ No newline at end of file
+ * a little edit of a source code file, include the prototype here. */
+
+/* Declared in input_data.c */
+void InputDataSetRegion(const double *xbeg, const double *xend);
+void InputDataResample(Grid *grid);
+void InputDataResampleFree(void);
+int  InputDataCache(char *data_fname, char *endianity);
+void InputDataCacheUse(int n);
+void InputDataCacheFree(void);
+
+/* Declared in init.c */
+void InitBackground(double *v, double x1, double x2, double x3);
+void InitNozzle(double *v, double x1, double x2, double x3);
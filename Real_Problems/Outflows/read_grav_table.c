@@ -27,7 +27,7 @@ void ReadGravTable() {
   FILE *f;
 
   double buf;
-  int i;
+  int i, tag;
 
   /* Open file */
   if ((f = fopen(GRAV_FNAME, "r")) == NULL) {
@@ -42,6 +42,7 @@ void ReadGravTable() {
   }
 
   /* Allocate memory for potential profile arrays */
+  tag = MemoryTag(MEM_TABLES);
   gr_rad = ARRAY_1D(gr_ndata, double);
 #if BODY_FORCE == POTENTIAL
   gr_phi = ARRAY_1D(gr_ndata, double);
@@ -49,6 +50,7 @@ void ReadGravTable() {
 #else
   gr_vec = ARRAY_1D(gr_ndata, sizeof(double));
 #endif
+  MemoryTag(tag);
 
   /* Read data */
   fseek(f, 0, SEEK_SET);
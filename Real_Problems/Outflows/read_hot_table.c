@@ -25,7 +25,7 @@ void ReadHotTable() {
     FILE *f;
 
     double buf;
-    int i;
+    int i, tag;
 
     /* Open file */
     if ((f = fopen(HOT_FNAME, "r")) == NULL) {
@@ -40,9 +40,11 @@ void ReadHotTable() {
     }
 
     /* Allocate memory for profile arrays */
+    tag = MemoryTag(MEM_TABLES);
     hot_rad = ARRAY_1D(hot_ndata, double);
     hot_rho = ARRAY_1D(hot_ndata, double);
     hot_prs = ARRAY_1D(hot_ndata, double);
+    MemoryTag(tag);
 
     /* Read data */
     fseek(f, 0, SEEK_SET);
@@ -25,7 +25,7 @@ void ReadMuTable() {
     FILE *f;
 
     double buf;
-    int i;
+    int i, tag;
 
     /* Open file */
     if ((f = fopen(MU_FNAME, "r")) == NULL) {
@@ -40,8 +40,10 @@ void ReadMuTable() {
     }
 
     /* Allocate memory for potential profile arrays */
+    tag = MemoryTag(MEM_TABLES);
     mu_por = ARRAY_1D(mu_ndata, double);
     mu_mu = ARRAY_1D(mu_ndata, double);
+    MemoryTag(tag);
 
     /* Read data */
     fseek(f, 0, SEEK_SET);
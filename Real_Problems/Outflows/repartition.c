@@ -0,0 +1,457 @@
+/* ///////////////////////////////////////////////////////////////////// */
+/*!
+  \file
+  \brief Run-time repartitioning of the domain along the jet direction.
+
+  When the domain is decomposed along the direction of jet propagation
+  (-xNjet together with -repart n), SetJetDomain() lets processors lying
+  ahead of the jet front integrate only a few zones, so that all the work
+  falls on the processors behind it.
+  Every n steps JetRepartition() builds a cost profile along the jet
+  direction and, if the most loaded processor exceeds the mean by more
+  than REPART_TOLERANCE, moves the processor boundaries along that
+  direction so that each processor gets roughly the same cost.
+
+  A cell behind the front costs one unit, plus REPART_COOL_WEIGHT if it
+  is above the cooling cutoff temperature; a cell ahead of the front
+  costs REPART_IDLE_WEIGHT (see pluto_usr.h).
+
+  Only the primitive variables are migrated: conservative variables are
+  recomputed from them at the beginning of every step. The distributed
+  array descriptors are rebuilt with AL_Set_partition(), the local grid,
+  geometry and interpolation coefficients are recomputed and
+  ::g_gridEpoch is incremented so that arrays kept elsewhere on the
+  local grid size are reallocated.
+
+  \note Only available in parallel, with Cartesian or cylindrical
+        geometry, Runge-Kutta time stepping and no staggered fields.
+        Asynchronous output is not supported.
+*/
+/* ///////////////////////////////////////////////////////////////////// */
+
+#include "pluto.h"
+#include "pluto_usr.h"
+#include "repartition.h"
+
+#if defined PARALLEL && !defined STAGGERED_MHD && !defined USE_ASYNC_IO && \
+    (GEOMETRY == CARTESIAN || GEOMETRY == CYLINDRICAL) && \
+    (TIME_STEPPING == RK2 || TIME_STEPPING == RK3)
+  #define REPART_AVAILABLE
+#endif
+
+#ifdef REPART_AVAILABLE
+static void BalancedPartition(const double *cost, int npt, int nproc,
+                              int nmin, int nmax, int *npts);
+static double MaxLoad(const double *cost, int nproc, const int *beg,
+                      const int *end, int ngh);
+static void RebuildDescriptor(int *sz, AL_Datatype type, int nelem,
+                              Grid *grid, int dir, int *npts);
+static void Overlap(int beg1, int end1, int beg2, int end2, int *lo, int *hi);
+#endif
+
+/* ********************************************************************* */
+void JetRepartition(Data *d, Input *ini, Grid *grid, int dir)
+/*!
+ * Rebalance the parallel decomposition along the jet direction.
+ * Must be called with the full (untrimmed) domain, i.e. outside
+ * SetJetDomain() / UnsetJetDomain().
+ *
+ * \param [in,out] d     pointer to Data structure
+ * \param [in,out] ini   pointer to Input structure
+ * \param [in,out] grid  pointer to array of Grid structures
+ * \param [in]     dir   the direction of propagation
+ *
+ *********************************************************************** */
+{
+#ifdef REPART_AVAILABLE
+    int i, j, k, n, nv, p, m, idim, tag;
+    int ngh, npt, nproc, me, front, slab, nmin, nmax, nsnd, nrcv, obeg_me;
+    int lo[3], hi[3], remain[3], lsize[3], beg[3], end[3], ghosts[3];
+    int *npts, *obeg, *oend, *nbeg, *nend;
+    int *scount, *sdispl, *rcount, *rdispl;
+    double c, cmax_old, cmax_new;
+    double *cost, *cost_glob, *snd, *rcv;
+    double ****Vc;
+    MPI_Comm cart_comm, line_comm;
+    Output *output;
+#if COOLING != NO
+    double v[NVAR], mu;
+#endif
+
+    if (grid[dir].nproc < 2) return;
+
+    front = JetDomainFront();
+    if (front < 0) return;
+
+    ngh   = grid[dir].nghost;
+    npt   = grid[dir].np_int_glob;
+    nproc = grid[dir].nproc;
+
+/* -----------------------------------------------------------
+    Cost profile along dir (global interior indices)
+   ----------------------------------------------------------- */
+
+    cost      = ARRAY_1D(npt, double);
+    cost_glob = ARRAY_1D(npt, double);
+    for (n = 0; n < npt; n++) cost[n] = 0.0;
+
+    DOM_LOOP(k, j, i) {
+        n = (dir == IDIR ? i : (dir == JDIR ? j : k));
+        n += grid[dir].beg - grid[dir].lbeg;
+
+        if (n > front) {
+            c = REPART_IDLE_WEIGHT;
+        } else {
+            c = 1.0;
+#if COOLING != NO
+            for (nv = 0; nv < NVAR; nv++) v[nv] = d->Vc[nv][k][j][i];
+            mu = MeanMolecularWeight(v);
+            if (v[PRS] / v[RHO] * KELVIN * mu > g_minCoolingTemp) c += REPART_COOL_WEIGHT;
+#endif
+        }
+        cost[n - ngh] += c;
+    }
+    MPI_Allreduce(cost, cost_glob, npt, MPI_DOUBLE, MPI_SUM, AL_COMM_WORLD);
+
+/* -----------------------------------------------------------
+    Current and proposed partitions. Processors along dir
+    are ranked by their coordinate in line_comm.
+   ----------------------------------------------------------- */
+
+    AL_Get_cart_comm(SZ, &cart_comm);
+    for (idim = 0; idim < DIMENSIONS; idim++) remain[idim] = (idim == dir);
+    MPI_Cart_sub(cart_comm, remain, &line_comm);
+    MPI_Comm_rank(line_comm, &me);
+
+    npts = ARRAY_1D(nproc, int);
+    obeg = ARRAY_1D(nproc, int);
+    oend = ARRAY_1D(nproc, int);
+    nbeg = ARRAY_1D(nproc, int);
+    nend = ARRAY_1D(nproc, int);
+
+    MPI_Allgather(&grid[dir].beg, 1, MPI_INT, obeg, 1, MPI_INT, line_comm);
+    MPI_Allgather(&grid[dir].end, 1, MPI_INT, oend, 1, MPI_INT, line_comm);
+
+    nmin = ngh;
+    nmax = MAX((int) (REPART_MAX_FACTOR * npt / nproc), (npt + nproc - 1) / nproc);
+    BalancedPartition(cost_glob, npt, nproc, nmin, nmax, npts);
+
+    nbeg[0] = ngh;
+    for (p = 0; p < nproc; p++) {
+        if (p > 0) nbeg[p] = nend[p - 1] + 1;
+        nend[p] = nbeg[p] + npts[p] - 1;
+    }
+
+    cmax_old = MaxLoad(cost_glob, nproc, obeg, oend, ngh);
+    cmax_new = MaxLoad(cost_glob, nproc, nbeg, nend, ngh);
+
+    c = 0.0;
+    for (n = 0; n < npt; n++) c += cost_glob[n];
+    c /= (double) nproc;
+
+    FreeArray1D(cost);
+    FreeArray1D(cost_glob);
+
+    if (cmax_old <= REPART_TOLERANCE * c || cmax_new >= cmax_old) {
+        FreeArray1D(npts);
+        FreeArray1D(obeg);
+        FreeArray1D(oend);
+        FreeArray1D(nbeg);
+        FreeArray1D(nend);
+        MPI_Comm_free(&line_comm);
+        return;
+    }
+
+    /* The I/O thread may still be writing with the old partition */
+    AsyncOutputWait();
+
+/* -----------------------------------------------------------
+    Pack the primitive variables overlapping each new
+    partition (full extent in the other directions).
+    Ghost zones are migrated as well, since internal boundary
+    conditions may read them before they are exchanged: each
+    zone is sent by the processor owning it, the first and last
+    ones owning the physical ghost zones too.
+   ----------------------------------------------------------- */
+
+    obeg_me = obeg[me];
+    obeg[0]         -= ngh;
+    oend[nproc - 1] += ngh;
+
+    slab = NVAR;
+    for (idim = 0; idim < 3; idim++) if (idim != dir) slab *= grid[idim].np_tot;
+
+    scount = ARRAY_1D(nproc, int);
+    sdispl = ARRAY_1D(nproc, int);
+    rcount = ARRAY_1D(nproc, int);
+    rdispl = ARRAY_1D(nproc, int);
+
+    nsnd = nrcv = 0;
+    for (p = 0; p < nproc; p++) {
+        Overlap(obeg[me], oend[me], nbeg[p] - ngh, nend[p] + ngh, lo + dir, hi + dir);
+        scount[p] = slab * (hi[dir] - lo[dir] + 1);
+        sdispl[p] = nsnd;
+        nsnd += scount[p];
+
+        Overlap(obeg[p], oend[p], nbeg[me] - ngh, nend[me] + ngh, lo + dir, hi + dir);
+        rcount[p] = slab * (hi[dir] - lo[dir] + 1);
+        rdispl[p] = nrcv;
+        nrcv += rcount[p];
+    }
+
+    tag = MemoryTag(MEM_PARALLEL);
+    snd = ARRAY_1D(MAX(nsnd, 1), double);
+    rcv = ARRAY_1D(MAX(nrcv, 1), double);
+    MemoryTag(tag);
+
+    m = 0;
+    for (p = 0; p < nproc; p++) {
+        for (idim = 0; idim < 3; idim++) {
+            lo[idim] = 0;
+            hi[idim] = grid[idim].np_tot - 1;
+        }
+        Overlap(obeg[me], oend[me], nbeg[p] - ngh, nend[p] + ngh, lo + dir, hi + dir);
+        lo[dir] += ngh - obeg_me;
+        hi[dir] += ngh - obeg_me;
+        for (nv = 0; nv < NVAR; nv++) {
+            for (k = lo[KDIR]; k <= hi[KDIR]; k++) {
+            for (j = lo[JDIR]; j <= hi[JDIR]; j++) {
+            for (i = lo[IDIR]; i <= hi[IDIR]; i++) {
+                snd[m++] = d->Vc[nv][k][j][i];
+            }}}
+        }
+    }
+
+    MPI_Alltoallv(snd, scount, sdispl, MPI_DOUBLE,
+                  rcv, rcount, rdispl, MPI_DOUBLE, line_comm);
+
+/* -----------------------------------------------------------
+    Rebuild the distributed array descriptors
+   ----------------------------------------------------------- */
+
+    RebuildDescriptor(&SZ, MPI_DOUBLE, 1, grid, dir, npts);
+    RebuildDescriptor(&SZ_float, MPI_FLOAT, 1, grid, dir, npts);
+    RebuildDescriptor(&SZ_char, MPI_CHAR, 1, grid, dir, npts);
+    RebuildDescriptor(&SZ_Float_Vect, MPI_FLOAT, 3, grid, dir, npts);
+
+    AL_Get_local_dim(SZ, lsize);
+    AL_Get_bounds(SZ, beg, end, ghosts, AL_C_INDEXES);
+
+/* -----------------------------------------------------------
+    Update the local grid along dir and everything
+    that depends on it
+   ----------------------------------------------------------- */
+
+    grid[dir].np_int = lsize[dir];
+    grid[dir].np_tot = lsize[dir] + 2 * ngh;
+    grid[dir].beg    = beg[dir];
+    grid[dir].end    = end[dir];
+    grid[dir].lend   = grid[dir].lbeg + grid[dir].np_int - 1;
+
+    grid[dir].x  = grid[dir].x_glob  + grid[dir].beg - ngh;
+    grid[dir].xr = grid[dir].xr_glob + grid[dir].beg - ngh;
+    grid[dir].xl = grid[dir].xl_glob + grid[dir].beg - ngh;
+    grid[dir].dx = grid[dir].dx_glob + grid[dir].beg - ngh;
+    grid[dir].xi = grid[dir].xl[grid[dir].lbeg];
+    grid[dir].xf = grid[dir].xr[grid[dir].lend];
+
+    for (idim = 0; idim < 3; idim++) {
+        FreeArray1D(grid[idim].A - 1);
+        FreeArray1D(grid[idim].xgc);
+        FreeArray1D(grid[idim].dV);
+        FreeArray1D(grid[idim].r_1);
+        FreeArray1D(grid[idim].ct);
+        FreeArray1D(grid[idim].inv_dx);
+        FreeArray1D(grid[idim].inv_dxi);
+    }
+    MakeGeometry(grid);
+
+    IEND = grid[IDIR].lend; NX1 = grid[IDIR].np_int; NX1_TOT = grid[IDIR].np_tot;
+    JEND = grid[JDIR].lend; NX2 = grid[JDIR].np_int; NX2_TOT = grid[JDIR].np_tot;
+    KEND = grid[KDIR].lend; NX3 = grid[KDIR].np_int; NX3_TOT = grid[KDIR].np_tot;
+
+    PLM_CoefficientsSet(grid);
+#if INTERPOLATION == PARABOLIC
+    PPM_CoefficientsSet(grid);
+#endif
+
+/* -----------------------------------------------------------
+    Unpack into the new primitive array and reallocate
+    the remaining 3D arrays
+   ----------------------------------------------------------- */
+
+    tag = MemoryTag(MEM_STATE);
+    Vc = ARRAY_4D(NVAR, NX3_TOT, NX2_TOT, NX1_TOT, double);
+    MemoryTag(tag);
+
+    m = 0;
+    for (p = 0; p < nproc; p++) {
+        for (idim = 0; idim < 3; idim++) {
+            lo[idim] = 0;
+            hi[idim] = grid[idim].np_tot - 1;
+        }
+        Overlap(obeg[p], oend[p], nbeg[me] - ngh, nend[me] + ngh, lo + dir, hi + dir);
+        lo[dir] += ngh - nbeg[me];
+        hi[dir] += ngh - nbeg[me];
+        for (nv = 0; nv < NVAR; nv++) {
+            for (k = lo[KDIR]; k <= hi[KDIR]; k++) {
+            for (j = lo[JDIR]; j <= hi[JDIR]; j++) {
+            for (i = lo[IDIR]; i <= hi[IDIR]; i++) {
+                Vc[nv][k][j][i] = rcv[m++];
+            }}}
+        }
+    }
+
+    FreeArray4D((void *) d->Vc);
+    FreeArray4D((void *) d->Uc);
+    FreeArray3D((void *) d->flag);
+    tag = MemoryTag(MEM_STATE);
+    d->Vc   = Vc;
+    d->Uc   = ARRAY_4D(NX3_TOT, NX2_TOT, NX1_TOT, NVAR, double);
+    d->flag = ARRAY_3D(NX3_TOT, NX2_TOT, NX1_TOT, unsigned char);
+    MemoryTag(tag);
+
+    for (k = 0; k < MAX_OUTPUT_TYPES; k++) {
+        output = ini->output + k;
+        for (nv = 0; nv < NVAR; nv++) output->V[nv] = d->Vc[nv];
+    }
+    SetUserVar(d, ini);
+
+    g_gridEpoch++;
+    Boundary(d, ALL_DIR, grid);
+
+    print1("> JetRepartition: max load %.3f -> %.3f (mean = 1), local points [",
+           cmax_old / c, cmax_new / c);
+    for (p = 0; p < nproc; p++) print1(p ? " %d" : "%d", npts[p]);
+    print1("]\n");
+
+    FreeArray1D(snd);
+    FreeArray1D(rcv);
+    FreeArray1D(scount);
+    FreeArray1D(sdispl);
+    FreeArray1D(rcount);
+    FreeArray1D(rdispl);
+    FreeArray1D(npts);
+    FreeArray1D(obeg);
+    FreeArray1D(oend);
+    FreeArray1D(nbeg);
+    FreeArray1D(nend);
+    MPI_Comm_free(&line_comm);
+#else
+    static int first_call = 1;
+
+    if (first_call) {
+        print1("! JetRepartition: not available with this configuration, ignored\n");
+        first_call = 0;
+    }
+#endif
+}
+
+#ifdef REPART_AVAILABLE
+/* ********************************************************************* */
+static void BalancedPartition(const double *cost, int npt, int nproc,
+                              int nmin, int nmax, int *npts)
+/*!
+ * Split npt points into nproc contiguous parts of similar cost.
+ * Each part is closed at the cell whose midpoint crosses an equal
+ * share of the remaining cost, and is kept within [nmin, nmax]
+ * points while leaving the remaining parts feasible.
+ *
+ *********************************************************************** */
+{
+    int p, i, n, left, nlo, nhi;
+    double c, ctot, cum, target;
+
+    ctot = 0.0;
+    for (i = 0; i < npt; i++) ctot += cost[i];
+
+    i = 0;
+    cum = 0.0;
+    for (p = 0; p < nproc - 1; p++) {
+        target = cum + (ctot - cum) / (double) (nproc - p);
+        left = npt - i;
+
+        n = 0;
+        c = cum;
+        while (i + n < npt && c + 0.5 * cost[i + n] <= target) c += cost[i + n++];
+
+        nlo = MAX(nmin, left - (nproc - p - 1) * nmax);
+        nhi = MIN(nmax, left - (nproc - p - 1) * nmin);
+        n = MIN(MAX(n, nlo), nhi);
+
+        npts[p] = n;
+        for (; n > 0; n--) cum += cost[i++];
+    }
+    npts[nproc - 1] = npt - i;
+}
+
+/* ********************************************************************* */
+static double MaxLoad(const double *cost, int nproc, const int *beg,
+                      const int *end, int ngh)
+/*!
+ * Return the largest cost among nproc parts given by their
+ * global (ghost-offset) index bounds.
+ *
+ *********************************************************************** */
+{
+    int p, n;
+    double c, cmax = 0.0;
+
+    for (p = 0; p < nproc; p++) {
+        c = 0.0;
+        for (n = beg[p]; n <= end[p]; n++) c += cost[n - ngh];
+        cmax = MAX(cmax, c);
+    }
+    return cmax;
+}
+
+/* ********************************************************************* */
+static void RebuildDescriptor(int *sz, AL_Datatype type, int nelem,
+                              Grid *grid, int dir, int *npts)
+/*!
+ * Replace the distributed array descriptor *sz with one having the
+ * same attributes and processor layout, but with npts points per
+ * processor along dir.
+ *
+ *********************************************************************** */
+{
+    int idim;
+    int gsize[DIMENSIONS], ghosts[DIMENSIONS], periods[DIMENSIONS];
+    int pardim[DIMENSIONS], procs[DIMENSIONS];
+
+    AL_Get_global_dim(*sz, gsize);
+    AL_Get_ghosts(*sz, ghosts);
+    AL_Get_periodic_dim(*sz, periods);
+    AL_Get_parallel_dim(*sz, pardim);
+    for (idim = 0; idim < DIMENSIONS; idim++) procs[idim] = grid[idim].nproc;
+
+    AL_Sz_free(*sz);
+
+    AL_Sz_init(AL_COMM_WORLD, sz);
+    AL_Set_type(type, nelem, *sz);
+    AL_Set_dimensions(DIMENSIONS, *sz);
+    AL_Set_global_dim(gsize, *sz);
+    AL_Set_ghosts(ghosts, *sz);
+    AL_Set_periodic_dim(periods, *sz);
+    AL_Set_parallel_dim(pardim, *sz);
+    if (AL_Set_partition(dir, grid[dir].nproc, npts, *sz) != AL_SUCCESS) {
+        print1("! JetRepartition: cannot set partition\n");
+        QUIT_PLUTO(1);
+    }
+
+    AL_Decompose(*sz, procs, AL_USER_DECOMP);
+}
+
+/* ********************************************************************* */
+static void Overlap(int beg1, int end1, int beg2, int end2, int *lo, int *hi)
+/*!
+ * Intersection [lo, hi] of two index ranges; hi = lo - 1 when
+ * they do not overlap.
+ *
+ *********************************************************************** */
+{
+    *lo = MAX(beg1, beg2);
+    *hi = MIN(end1, end2);
+    if (*hi < *lo) *hi = *lo - 1;
+}
+#endif
@@ -0,0 +1,13 @@
+//
+// Run-time repartitioning of the parallel domain along the jet direction.
+//
+
+#ifndef PLUTO_REPARTITION_H
+#define PLUTO_REPARTITION_H
+
+void JetRepartition(Data *d, Input *ini, Grid *grid, int dir);
+
+/* Defined in jet_domain.c */
+int JetDomainFront(void);
+
+#endif //PLUTO_REPARTITION_H
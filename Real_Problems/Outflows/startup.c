@@ -19,7 +19,35 @@
 #include "read_grav_table.h"
 #include "read_hot_table.h"
 #include "multicloud_init.h"
-
+#include "clouds.h"
+#include "ic_cache.h"
+#include "fractal.h"
+#include <pthread.h>
+
+/* Rows of zones (fixed j and k) are handed out one at a time to the
+   threads assigning the initial conditions. */
+typedef struct STARTUP_WORK {
+    Data *d;
+    Grid *grid;
+    int background;         /* Assign the halo and clouds only */
+    long int nrows;         /* Number of rows */
+    long int next;          /* Next row to be assigned */
+    pthread_mutex_t lock;
+    long int beg[3], end[3], nx[3], nx_tot[3];  /* Thread-local globals */
+    long int step;                              /* of the calling thread */
+    double time, dt;
+} StartupWork;
+
+#if CLOUDS == YES && CLOUDS_MULTI == NO && GEOMETRY == CARTESIAN
+static void  StartupClouds(Grid *);
+#endif
+static void  StartupLoop(Data *, Grid *, int);
+static void *StartupThread(void *);
+static void  StartupZone(Data *, Grid *, int, int, int, int);
+#if INITIAL_SMOOTHING == YES
+static int   StartupUniform(double *, double, double, double,
+                            double, double, double);
+#endif
 
 /* ********************************************************************* */
 void Startup(Data *d, Grid *G)
@@ -31,15 +59,10 @@ void Startup(Data *d, Grid *G)
  *********************************************************************** */
 {
     int i, j, k;
-    int isub, jsub, ksub, nsub = 5;
     int nv, l_convert;
     static double **ucons, **uprim;
     double x1, x2, x3;
-    double x1p, x2p, x3p;
-    double x1s, x2s, x3s;
-    double dx1, dx2, dx3;
-    double us[256], u_av[256], b[3];
-    double scrh;
+    double us[256];
     struct GRID *GX, *GY, *GZ;
 
     double *x1cld, *x2cld, *x3cld, *v1cld, *v2cld, *v3cld;
@@ -52,6 +75,18 @@ void Startup(Data *d, Grid *G)
     double x1beg, x1end, x2beg, x2end, x3beg, x3end;
     double x1cl, x1ch, x2cl, x2ch, x3cl, x3ch, delx1cin, delx2cin, delx3cin;
     int ibeg, iend, jbeg, jend, kbeg, kend;
+#if IC_CACHE == YES
+    int ic_hit;
+#endif
+#if CLOUDS_MULTI == YES
+    int dir;
+    double xbeg[3], xend[3];
+    double u_av[256];
+    struct cld_domain *cldl;
+    int ncl, c, ib, m, nbt, nbin[3];
+    int *cldf, **cbox, *fcube, *bstart, *blist;
+    double **fbeg, **fend;
+#endif
 
 
     Gin = (struct InGrid *) malloc(sizeof(struct InGrid));
@@ -86,123 +121,55 @@ void Startup(Data *d, Grid *G)
 
     print1("> Assigning initial conditions (Startup) ...\n");
 
-/* --------------------------------------------------------------
-                    Assign initial conditions   
-   -------------------------------------------------------------- */
-
-    KTOT_LOOP(k) {
-        JTOT_LOOP(j) {
-            ITOT_LOOP(i) {
-
-#if GEOMETRY == CYLINDRICAL
-                x1 = GX->xgc[i]; x1p = GX->xr[i]; dx1 = GX->dx[i];
-                x2 = GY->xgc[j]; x2p = GY->xr[j]; dx2 = GY->dx[j];
-                x3 = GZ->xgc[k]; x3p = GZ->xr[k]; dx3 = GZ->dx[k];
-#else
-                x1 = GX->x[i];
-                x1p = GX->xr[i];
-                dx1 = GX->dx[i];
-                x2 = GY->x[j];
-                x2p = GY->xr[j];
-                dx2 = GY->dx[j];
-                x3 = GZ->x[k];
-                x3p = GZ->xr[k];
-                dx3 = GZ->dx[k];
-#endif
-
-                for (nv = NVAR; nv--;) d->Vc[nv][k][j][i] = u_av[nv] = 0.0;
-
-/*  ----------------------------------------------------------------
-                Compute volume averages      
-    ---------------------------------------------------------------- */
+/* ----------------------------------------------------------
+    Try to read the halo and clouds from the initial
+    conditions cache; only the nozzle is assigned below.
+   ---------------------------------------------------------- */
 
-#ifdef PSI_GLM
-                u_av[PSI_GLM] = us[PSI_GLM] = 0.0;
+#if IC_CACHE == YES
+    ic_hit = ICCacheLoad(d, G);
 #endif
 
-#if INITIAL_SMOOTHING == YES
-
-                for (ksub = 0; ksub < nsub; ksub++){
-                for (jsub = 0; jsub < nsub; jsub++){
-                for (isub = 0; isub < nsub; isub++){
-
-                  x1s = x1 + (double)(1.0 - nsub + 2.0*isub)/(double)(2.0*nsub)*dx1;
-                  x2s = x2 + (double)(1.0 - nsub + 2.0*jsub)/(double)(2.0*nsub)*dx2;
-                  x3s = x3 + (double)(1.0 - nsub + 2.0*ksub)/(double)(2.0*nsub)*dx3;
-
-                  Init (us, x1s, x2s, x3s);
-                  for (nv = 0; nv < NVAR; nv++) {
-                    u_av[nv] += us[nv]/(double)(nsub*nsub*nsub);
-                  }
-                }}}
+/* ----------------------------------------------------------
+    Read only the part of the clouds cube covering the local
+    domain (ghost zones included) and resample it on all zone
+    centers at once. The cube is in Cartesian coordinates, so
+    this is done for Cartesian grids only.
+   ---------------------------------------------------------- */
 
+#if CLOUDS == YES && CLOUDS_MULTI == NO && GEOMETRY == CARTESIAN
+#if IC_CACHE == YES
+    if (!ic_hit) StartupClouds(G);
 #else
-
-                Init(u_av, x1, x2, x3);
-
+    StartupClouds(G);
+#endif
 #endif
 
-                for (nv = NVAR; nv--;) d->Vc[nv][k][j][i] = u_av[nv];
-
-/* -----------------------------------------------------
-        Initialize cell-centered vector potential 
-        (only for output purposes)
-   ----------------------------------------------------- */
+/* ----------------------------------------------------------
+    On a cache miss, assign the halo and clouds everywhere
+    and store them for the next runs.
+   ---------------------------------------------------------- */
 
-#if PHYSICS == MHD || PHYSICS == RMHD
-#if UPDATE_VECTOR_POTENTIAL == YES
-                D_EXPAND(                     ,
-                  d->Ax3[k][j][i] = u_av[AX3];  ,
-                  d->Ax1[k][j][i] = u_av[AX1];
-                  d->Ax2[k][j][i] = u_av[AX2];)
-#endif
+#if IC_CACHE == YES
+    if (!ic_hit) {
+        StartupLoop(d, G, 1);
+        ICCacheSave(d, G);
+    }
 #endif
 
-                /* -------------------------------------------------------------
-                    Assign staggered components;
-                    If a vector potential is used (ASSIGN_VECTOR_POTENTIAL == YES),
-                    use the STAGGERED_INIT routine;
-                    otherwise assign staggered components directly from
-                    the init.c and ignore the vector potential.
+/* --------------------------------------------------------------
+                    Assign initial conditions   
+   -------------------------------------------------------------- */
 
-                    NOTE: in N dimensions only N components are assigned
-                            through this call.
-                   ------------------------------------------------------------- */
+    StartupLoop(d, G, 0);
 
-#if PHYSICS == MHD || PHYSICS == RMHD
-#if ASSIGN_VECTOR_POTENTIAL == YES
-                VectorPotentialDiff(b, i, j, k, G);
-
-#ifdef STAGGERED_MHD
-                 for (nv = 0; nv < DIMENSIONS; nv++) {
-                   d->Vs[nv][k][j][i] = b[nv];
-                 }
+#if CLOUDS == YES && CLOUDS_MULTI == NO && GEOMETRY == CARTESIAN
+#if CLOUD_CUBE == CC_FRACTAL
+    FractalFree();
 #else
-                 for (nv = 0; nv < DIMENSIONS; nv++) {
-                   d->Vc[BX+nv][k][j][i] = b[nv];
-                 }
+    InputDataResampleFree();
 #endif
-
-#else
-
-#ifdef STAGGERED_MHD
-                 D_EXPAND(
-                   Init (u_av, x1p, x2, x3);
-                   d->Vs[BX1s][k][j][i] = u_av[BX1];       ,
-
-                   Init (u_av, x1, x2p, x3);
-                   d->Vs[BX2s][k][j][i] = u_av[BX2];       ,
-
-                   Init (u_av, x1, x2, x3p);
-                   d->Vs[BX3s][k][j][i] = u_av[BX3];
-                 )
 #endif
-#endif  /* ASSIGN_VECTOR_POTENTIAL */
-#endif /* PHYSICS == MHD || PHYSICS == RMHD */
-
-            }
-        }
-    }
 
     oncefilelist = 0;
     oncecloudlist = 0;
@@ -235,10 +202,8 @@ void Startup(Data *d, Grid *G)
 
 
 #ifdef PARALLEL
-    if (prank == 0){
-        gen_cldlist(nclouds, nfiles);
-        MPI_Barrier(MPI_COMM_WORLD);
-    }
+    if (prank == 0) gen_cldlist(nclouds, nfiles);
+    MPI_Barrier(AL_COMM_WORLD);
 #else
     gen_cldlist(nclouds, nfiles);
 #endif
@@ -248,7 +213,9 @@ void Startup(Data *d, Grid *G)
     // Read cloud position list & number of clouds //
     if (oncefilelist == 0) {
         FILE *fp_cldposlist;
-        fp_cldposlist = fopen("cloud_pos_list.dat", "r");
+        char fname[512];
+        sprintf(fname, "%s/cloud_pos_list.dat", GetOutputDir());
+        fp_cldposlist = fopen(fname, "r");
         if (fp_cldposlist == NULL) {
             print1("Input cloud_pos_list.dat not found \n");
             QUIT_PLUTO(1);
@@ -309,62 +276,140 @@ void Startup(Data *d, Grid *G)
     print1("X2: %lf to %lf \n", x2cl, x2ch);
     print1("X3: %lf to %lf \n", x3cl, x3ch);
 
-    //----Loop over cloud position list to check for clouds in domain----//
-    for (nc = 0; nc < nclouds; nc++) {
-        if (((x1cld[nc] - delx1cin >= x1beg) && (x1cld[nc] - delx1cin <= x1end))
-            || ((x1cld[nc] + delx1cin >= x1beg) && (x1cld[nc] + delx1cin <= x1end))) {
-            if (((x2cld[nc] - delx2cin >= x2beg) && (x2cld[nc] - delx2cin <= x2end))
-                || ((x2cld[nc] + delx2cin >= x2beg) && (x2cld[nc] + delx2cin <= x2end))) {
-                if (((x3cld[nc] - delx3cin >= x3beg) && (x3cld[nc] - delx3cin <= x3end))
-                    || ((x3cld[nc] + delx3cin >= x3beg) && (x3cld[nc] + delx3cin <= x3end))) {
-
-                    /*----Store cloud centres in cld_domain structure----//
-                      Stored values are cloud centres relative to centre of
-                      input grid, for ease in interpolation -------------*/
-
-                    cld.x1c = x1cld[nc] - (x1ch + x1cl) * 0.5;
-                    cld.x2c = x2cld[nc] - (x2ch + x2cl) * 0.5;
-                    cld.x3c = x3cld[nc] - (x3ch + x3cl) * 0.5;
-
-                    cld.v1 = v1cld[nc];
-                    cld.v2 = v2cld[nc];
-                    cld.v3 = v3cld[nc];
-
-                    //---Read in cloud density---//
-                    Read_Multicld(cldfile_list[cldnum[nc]]);
-
+    //----Select the clouds overlapping the local domain----//
+    ncl = 0;
+    cldl = (struct cld_domain *) malloc(nclouds * sizeof(struct cld_domain));
+    cldf = ARRAY_1D(nclouds, int);
+    cbox = ARRAY_2D(nclouds, 6, int);
+    fbeg = ARRAY_2D(nfiles, 3, double);
+    fend = ARRAY_2D(nfiles, 3, double);
+    fcube = ARRAY_1D(nfiles, int);
+    for (nc = 0; nc < nfiles; nc++) fcube[nc] = -1;
 
-                    //----Locate array indices of cloud domain---//
-                    ibeg = (x1cld[nc] - delx1cin < x1beg) ? 0 : locate(GX->x, x1cld[nc] - delx1cin, NX1_TOT);
-                    iend = (x1cld[nc] + delx1cin > x1end) ? NX1_TOT - 1 : locate(GX->x, x1cld[nc] + delx1cin, NX1_TOT);
-                    jbeg = (x2cld[nc] - delx2cin < x2beg) ? 0 : locate(GY->x, x2cld[nc] - delx2cin, NX2_TOT);
-                    jend = (x2cld[nc] + delx2cin > x2end) ? NX2_TOT - 1 : locate(GY->x, x2cld[nc] + delx2cin, NX2_TOT);
-                    kbeg = (x3cld[nc] - delx3cin < x3beg) ? 0 : locate(GZ->x, x3cld[nc] - delx3cin, NX3_TOT);
-                    kend = (x3cld[nc] + delx3cin > x3end) ? NX3_TOT - 1 : locate(GZ->x, x3cld[nc] + delx3cin, NX3_TOT);
+    for (nc = 0; nc < nclouds; nc++) {
+        if (x1cld[nc] - delx1cin > x1end || x1cld[nc] + delx1cin < x1beg) continue;
+        if (x2cld[nc] - delx2cin > x2end || x2cld[nc] + delx2cin < x2beg) continue;
+        if (x3cld[nc] - delx3cin > x3end || x3cld[nc] + delx3cin < x3beg) continue;
+
+        /*----Store cloud centres in cld_domain structure----//
+          Stored values are cloud centres relative to centre of
+          input grid, for ease in interpolation -------------*/
+
+        cld.x1c = x1cld[nc] - (x1ch + x1cl) * 0.5;
+        cld.x2c = x2cld[nc] - (x2ch + x2cl) * 0.5;
+        cld.x3c = x3cld[nc] - (x3ch + x3cl) * 0.5;
+
+        cld.v1 = v1cld[nc];
+        cld.v2 = v2cld[nc];
+        cld.v3 = v3cld[nc];
+
+        //----Locate array indices of cloud domain---//
+        ibeg = (x1cld[nc] - delx1cin < x1beg) ? 0 : locate(GX->x, x1cld[nc] - delx1cin, NX1_TOT);
+        iend = (x1cld[nc] + delx1cin > x1end) ? NX1_TOT - 1 : locate(GX->x, x1cld[nc] + delx1cin, NX1_TOT);
+        jbeg = (x2cld[nc] - delx2cin < x2beg) ? 0 : locate(GY->x, x2cld[nc] - delx2cin, NX2_TOT);
+        jend = (x2cld[nc] + delx2cin > x2end) ? NX2_TOT - 1 : locate(GY->x, x2cld[nc] + delx2cin, NX2_TOT);
+        kbeg = (x3cld[nc] - delx3cin < x3beg) ? 0 : locate(GZ->x, x3cld[nc] - delx3cin, NX3_TOT);
+        kend = (x3cld[nc] + delx3cin > x3end) ? NX3_TOT - 1 : locate(GZ->x, x3cld[nc] + delx3cin, NX3_TOT);
+        if (ibeg >= iend || jbeg >= jend || kbeg >= kend) continue;
+
+        cldl[ncl] = cld;
+        cldf[ncl] = cldnum[nc];
+        cbox[ncl][0] = ibeg + 1; cbox[ncl][1] = iend;
+        cbox[ncl][2] = jbeg + 1; cbox[ncl][3] = jend;
+        cbox[ncl][4] = kbeg + 1; cbox[ncl][5] = kend;
+
+        //---Part of the cloud cube overlapping the local domain,---//
+        //---merged over all clouds using the same cube---//
+        xbeg[0] = GX->xl[0] - cld.x1c;
+        xend[0] = GX->xr[NX1_TOT - 1] - cld.x1c;
+        xbeg[1] = GY->xl[0] - cld.x2c;
+        xend[1] = GY->xr[NX2_TOT - 1] - cld.x2c;
+        xbeg[2] = GZ->xl[0] - cld.x3c;
+        xend[2] = GZ->xr[NX3_TOT - 1] - cld.x3c;
+        for (dir = 0; dir < 3; dir++) {
+            if (fcube[cldf[ncl]] < 0 || xbeg[dir] < fbeg[cldf[ncl]][dir]) fbeg[cldf[ncl]][dir] = xbeg[dir];
+            if (fcube[cldf[ncl]] < 0 || xend[dir] > fend[cldf[ncl]][dir]) fend[cldf[ncl]][dir] = xend[dir];
+        }
+        fcube[cldf[ncl]] = 0;
+        ncl++;
+    }
 
+    //----Read each cube once----//
+    for (nc = 0; nc < nfiles; nc++) {
+        if (fcube[nc] == 0) fcube[nc] = Read_Multicld(cldfile_list[nc], fbeg[nc], fend[nc]);
+    }
 
-                    for (i = ibeg + 1; i <= iend; i++) {
-                        for (j = jbeg + 1; j <= jend; j++) {
-                            for (k = kbeg + 1; k <= kend; k++) {
-                                x1 = GX->x[i];
-                                x2 = GY->x[j];
-                                x3 = GZ->x[k];
+    /* ----------------------------------------------------------
+        Bin index from cells to clouds: the local grid is split
+        in bins of CLD_BIN_SIZE^3 zones and each bin keeps the
+        list of clouds overlapping it, in cloud list order.
+       ---------------------------------------------------------- */
+
+    nbin[IDIR] = (NX1_TOT + CLD_BIN_SIZE - 1) / CLD_BIN_SIZE;
+    nbin[JDIR] = (NX2_TOT + CLD_BIN_SIZE - 1) / CLD_BIN_SIZE;
+    nbin[KDIR] = (NX3_TOT + CLD_BIN_SIZE - 1) / CLD_BIN_SIZE;
+    nbt = nbin[IDIR] * nbin[JDIR] * nbin[KDIR];
+    bstart = ARRAY_1D(nbt + 1, int);
+    for (ib = 0; ib <= nbt; ib++) bstart[ib] = 0;
+
+    /* -- count clouds per bin (m = 0), then fill the lists (m = 1) -- */
+    for (m = 0; m < 2; m++) {
+        if (m == 1) {
+            for (ib = 0; ib < nbt; ib++) bstart[ib + 1] += bstart[ib];
+            blist = ARRAY_1D(bstart[nbt] + 1, int);
+        }
+        for (c = 0; c < ncl; c++) {
+            for (k = cbox[c][4] / CLD_BIN_SIZE; k <= cbox[c][5] / CLD_BIN_SIZE; k++) {
+            for (j = cbox[c][2] / CLD_BIN_SIZE; j <= cbox[c][3] / CLD_BIN_SIZE; j++) {
+            for (i = cbox[c][0] / CLD_BIN_SIZE; i <= cbox[c][1] / CLD_BIN_SIZE; i++) {
+                ib = (k * nbin[JDIR] + j) * nbin[IDIR] + i;
+                if (m == 0) bstart[ib + 1]++;
+                else        blist[bstart[ib]++] = c;
+            }}}
+        }
+    }
+    for (ib = nbt; ib > 0; ib--) bstart[ib] = bstart[ib - 1];
+    bstart[0] = 0;
 
-                                //----Initialise cloud cube---//
-                                for (nv = NVAR; nv--;) u_av[nv] = 0.0;
-                                Init_multiclds(u_av, x1, x2, x3, cld);
+    print1("%d clouds overlap the local domain\n", ncl);
 
-                                for (nv = NVAR; nv--;) d->Vc[nv][k][j][i] = u_av[nv];
+    //----Single pass over the local domain----//
+    //----The last cloud of the list containing a zone sets its value---//
+    KTOT_LOOP(k) {
+        JTOT_LOOP(j) {
+            ITOT_LOOP(i) {
+                ib = ((k / CLD_BIN_SIZE) * nbin[JDIR] + j / CLD_BIN_SIZE) * nbin[IDIR] + i / CLD_BIN_SIZE;
+                for (m = bstart[ib + 1] - 1; m >= bstart[ib]; m--) {
+                    c = blist[m];
+                    if (i >= cbox[c][0] && i <= cbox[c][1] &&
+                        j >= cbox[c][2] && j <= cbox[c][3] &&
+                        k >= cbox[c][4] && k <= cbox[c][5]) break;
+                }
+                if (m < bstart[ib]) continue;
 
-                            }
-                        }
-                    }
+                x1 = GX->x[i];
+                x2 = GY->x[j];
+                x3 = GZ->x[k];
 
+                //----Initialise cloud cube---//
+                InputDataCacheUse(fcube[cldf[c]]);
+                for (nv = NVAR; nv--;) u_av[nv] = 0.0;
+                Init_multiclds(u_av, x1, x2, x3, cldl[c]);
 
-                }
+                for (nv = NVAR; nv--;) d->Vc[nv][k][j][i] = u_av[nv];
             }
-        }//--if in cld domain
-    }//for nc
+        }
+    }
+
+    InputDataCacheFree();
+    FreeArray1D(bstart);
+    FreeArray1D(blist);
+    FreeArray1D(fcube);
+    FreeArray2D((void **) fbeg);
+    FreeArray2D((void **) fend);
+    FreeArray2D((void **) cbox);
+    FreeArray1D(cldf);
+    free(cldl);
 
 
 #endif
@@ -451,4 +496,312 @@ void Startup(Data *d, Grid *G)
 }
 
 
+#if CLOUDS == YES && CLOUDS_MULTI == NO && GEOMETRY == CARTESIAN
+/* ********************************************************************* */
+static void StartupClouds(Grid *G)
+/*
+ * Generate the clouds cube or read the part of it covering the
+ * local domain, and resample it on all the zone centers.
+ *
+ *********************************************************************** */
+{
+    int tag;
+#if CLOUD_CUBE != CC_FRACTAL
+    int dir;
+    double xbeg[3], xend[3];
+#endif
+
+#if CLOUD_CUBE == CC_FRACTAL
+    tag = MemoryTag(MEM_CLOUDS);
+    FractalGenerate(G);
+    MemoryTag(tag);
+#else
+    for (dir = 0; dir < 3; dir++) {
+        xbeg[dir] = G[dir].xl[0];
+        xend[dir] = G[dir].xr[G[dir].np_tot - 1];
+    }
+    InputDataSetRegion(xbeg, xend);
+    tag = MemoryTag(MEM_CLOUDS);
+    ReadFractalData();
+    InputDataResample(G);
+    MemoryTag(tag);
+#endif
+}
+#endif
 
+/* ********************************************************************* */
+static void StartupLoop(Data *d, Grid *G, int background)
+/*
+ * Assign the initial conditions in all the zones of the local grid
+ * (ghost zones included), using up to g_initThreads threads.
+ * With background == 1 only the halo and clouds are assigned
+ * (see InitBackground()).
+ *
+ * The first row is assigned by the calling thread before the other
+ * threads start, so that the one-time initializations done by Init()
+ * (normalization, tables, ...) are not executed concurrently.
+ *
+ *********************************************************************** */
+{
+    int i, n, nthreads;
+    pthread_t *tid;
+    StartupWork w;
+#if CLOUDS == YES && CLOUDS_MULTI == NO
+    int tag;
+#endif
+
+    w.d = d;
+    w.grid = G;
+    w.background = background;
+    w.nrows = NX2_TOT * NX3_TOT;
+    w.next = 1;
+    pthread_mutex_init(&w.lock, NULL);
+    w.beg[IDIR] = IBEG; w.end[IDIR] = IEND; w.nx[IDIR] = NX1; w.nx_tot[IDIR] = NX1_TOT;
+    w.beg[JDIR] = JBEG; w.end[JDIR] = JEND; w.nx[JDIR] = NX2; w.nx_tot[JDIR] = NX2_TOT;
+    w.beg[KDIR] = KBEG; w.end[KDIR] = KEND; w.nx[KDIR] = NX3; w.nx_tot[KDIR] = NX3_TOT;
+    w.step = g_stepNumber;
+    w.time = g_time;
+    w.dt = g_dt;
+
+#if CLOUDS == YES && CLOUDS_MULTI == NO
+    tag = MemoryTag(MEM_CLOUDS);
+    ReadFractalData();
+    MemoryTag(tag);
+#endif
+    ITOT_LOOP(i) StartupZone(d, G, i, 0, 0, background);
+
+    nthreads = (int) MIN(g_initThreads, w.nrows);
+    tid = ARRAY_1D(MAX(nthreads, 1), pthread_t);
+    for (n = 1; n < nthreads; n++) {
+        if (pthread_create(tid + n, NULL, StartupThread, &w) != 0) {
+            print("! StartupLoop: cannot start thread %d\n", n);
+            break;
+        }
+    }
+    nthreads = n;
+
+    StartupThread(&w);
+    for (n = 1; n < nthreads; n++) pthread_join(tid[n], NULL);
+
+    FreeArray1D((void *) tid);
+    pthread_mutex_destroy(&w.lock);
+}
+
+/* ********************************************************************* */
+static void *StartupThread(void *arg)
+/*
+ * Take rows from the StartupWork structure until none is left.
+ *
+ *********************************************************************** */
+{
+    int i, j, k;
+    long int r;
+    StartupWork *w = (StartupWork *) arg;
+
+    /* The grid indices and the time are private to each thread */
+    IBEG = w->beg[IDIR]; IEND = w->end[IDIR];
+    JBEG = w->beg[JDIR]; JEND = w->end[JDIR];
+    KBEG = w->beg[KDIR]; KEND = w->end[KDIR];
+    NX1 = w->nx[IDIR]; NX1_TOT = w->nx_tot[IDIR];
+    NX2 = w->nx[JDIR]; NX2_TOT = w->nx_tot[JDIR];
+    NX3 = w->nx[KDIR]; NX3_TOT = w->nx_tot[KDIR];
+    g_stepNumber = w->step;
+    g_time = w->time;
+    g_dt = w->dt;
+
+    for (;;) {
+        pthread_mutex_lock(&w->lock);
+        r = w->next++;
+        pthread_mutex_unlock(&w->lock);
+        if (r >= w->nrows) break;
+
+        k = (int) (r / NX2_TOT);
+        j = (int) (r % NX2_TOT);
+        ITOT_LOOP(i) StartupZone(w->d, w->grid, i, j, k, w->background);
+    }
+    return NULL;
+}
+
+/* ********************************************************************* */
+static void StartupZone(Data *d, Grid *G, int i, int j, int k, int background)
+/*
+ * Assign the initial conditions in zone (i, j, k).
+ *
+ *********************************************************************** */
+{
+    int nv;
+    double x1, x2, x3;
+    double u_av[256];
+    struct GRID *GX, *GY, *GZ;
+#if INITIAL_SMOOTHING == YES
+    int isub, jsub, ksub, nsub = 5;
+    double x1s, x2s, x3s;
+    double dx1, dx2, dx3;
+    double us[256], scrh;
+#endif
+#if PHYSICS == MHD || PHYSICS == RMHD
+#if ASSIGN_VECTOR_POTENTIAL == YES
+    double b[3];
+#endif
+#endif
+
+    GX = G;
+    GY = G + 1;
+    GZ = G + 2;
+
+#if GEOMETRY == CYLINDRICAL
+    x1 = GX->xgc[i];
+    x2 = GY->xgc[j];
+    x3 = GZ->xgc[k];
+#else
+    x1 = GX->x[i];
+    x2 = GY->x[j];
+    x3 = GZ->x[k];
+#endif
+
+#if IC_CACHE == YES
+    if (background) {
+        InitBackground(u_av, x1, x2, x3);
+        for (nv = NVAR; nv--;) d->Vc[nv][k][j][i] = u_av[nv];
+        return;
+    }
+    for (nv = NVAR; nv--;) u_av[nv] = d->Vc[nv][k][j][i];
+#else
+    for (nv = NVAR; nv--;) d->Vc[nv][k][j][i] = u_av[nv] = 0.0;
+#endif
+
+/*  ----------------------------------------------------------------
+    Compute volume averages      
+    ---------------------------------------------------------------- */
+
+#ifdef PSI_GLM
+    u_av[PSI_GLM] = 0.0;
+#endif
+
+#if INITIAL_SMOOTHING == YES
+
+    dx1 = GX->dx[i];
+    dx2 = GY->dx[j];
+    dx3 = GZ->dx[k];
+    scrh = (nsub - 1.0)/nsub;
+    if (SMOOTHING_TOLERANCE > 0.0 &&
+        StartupUniform(us, x1, x2, x3, scrh*dx1, scrh*dx2, scrh*dx3)) {
+        Init(u_av, x1, x2, x3);
+    } else {
+    for (ksub = 0; ksub < nsub; ksub++){
+    for (jsub = 0; jsub < nsub; jsub++){
+    for (isub = 0; isub < nsub; isub++){
+
+      x1s = x1 + (double)(1.0 - nsub + 2.0*isub)/(double)(2.0*nsub)*dx1;
+      x2s = x2 + (double)(1.0 - nsub + 2.0*jsub)/(double)(2.0*nsub)*dx2;
+      x3s = x3 + (double)(1.0 - nsub + 2.0*ksub)/(double)(2.0*nsub)*dx3;
+
+      Init (us, x1s, x2s, x3s);
+      for (nv = 0; nv < NVAR; nv++) {
+        u_av[nv] += us[nv]/(double)(nsub*nsub*nsub);
+      }
+    }}}
+    }
+
+#elif IC_CACHE == YES
+
+    InitNozzle(u_av, x1, x2, x3);
+
+#else
+
+    Init(u_av, x1, x2, x3);
+
+#endif
+
+    for (nv = NVAR; nv--;) d->Vc[nv][k][j][i] = u_av[nv];
+
+/* -----------------------------------------------------
+        Initialize cell-centered vector potential 
+        (only for output purposes)
+   ----------------------------------------------------- */
+
+#if PHYSICS == MHD || PHYSICS == RMHD
+#if UPDATE_VECTOR_POTENTIAL == YES
+    D_EXPAND(                     ,
+      d->Ax3[k][j][i] = u_av[AX3];  ,
+      d->Ax1[k][j][i] = u_av[AX1];
+      d->Ax2[k][j][i] = u_av[AX2];)
+#endif
+#endif
+
+    /* -------------------------------------------------------------
+        Assign staggered components;
+        If a vector potential is used (ASSIGN_VECTOR_POTENTIAL == YES),
+        use the STAGGERED_INIT routine;
+        otherwise assign staggered components directly from
+        the init.c and ignore the vector potential.
+
+        NOTE: in N dimensions only N components are assigned
+                through this call.
+       ------------------------------------------------------------- */
+
+#if PHYSICS == MHD || PHYSICS == RMHD
+#if ASSIGN_VECTOR_POTENTIAL == YES
+    VectorPotentialDiff(b, i, j, k, G);
+
+#ifdef STAGGERED_MHD
+     for (nv = 0; nv < DIMENSIONS; nv++) {
+       d->Vs[nv][k][j][i] = b[nv];
+     }
+#else
+     for (nv = 0; nv < DIMENSIONS; nv++) {
+       d->Vc[BX+nv][k][j][i] = b[nv];
+     }
+#endif
+
+#else
+
+#ifdef STAGGERED_MHD
+     D_EXPAND(
+       Init (u_av, GX->xr[i], x2, x3);
+       d->Vs[BX1s][k][j][i] = u_av[BX1];       ,
+
+       Init (u_av, x1, GY->xr[j], x3);
+       d->Vs[BX2s][k][j][i] = u_av[BX2];       ,
+
+       Init (u_av, x1, x2, GZ->xr[k]);
+       d->Vs[BX3s][k][j][i] = u_av[BX3];
+     )
+#endif
+#endif  /* ASSIGN_VECTOR_POTENTIAL */
+#endif /* PHYSICS == MHD || PHYSICS == RMHD */
+}
+
+#if INITIAL_SMOOTHING == YES
+/* ********************************************************************* */
+static int StartupUniform(double *v, double x1, double x2, double x3,
+                          double dx1, double dx2, double dx3)
+/*
+ * Return 1 if the initial conditions at the corners of the box of
+ * size (dx1, dx2, dx3) centered in (x1, x2, x3) agree within
+ * SMOOTHING_TOLERANCE, in which case the zone does not need to be
+ * super-sampled. The box spans the outermost sub-zones, so that its
+ * corners never lie on zone faces. v is used as workspace.
+ *
+ *********************************************************************** */
+{
+    int n, nv;
+    double v0[256], x1c, x2c, x3c;
+
+    for (n = 0; n < (1 << DIMENSIONS); n++) {
+        x1c = x1 + ((n & 1) ? 0.5 : -0.5) * dx1;
+        x2c = x2 + D_SELECT(0.0, ((n & 2) ? 0.5 : -0.5) * dx2, ((n & 2) ? 0.5 : -0.5) * dx2);
+        x3c = x3 + D_SELECT(0.0, 0.0, ((n & 4) ? 0.5 : -0.5) * dx3);
+
+        Init(n == 0 ? v0 : v, x1c, x2c, x3c);
+        if (n == 0) continue;
+
+        for (nv = 0; nv < NVAR; nv++) {
+            if (fabs(v[nv] - v0[nv]) > SMOOTHING_TOLERANCE * MAX(fabs(v[nv]), fabs(v0[nv]))) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+#endif
@@ -3,92 +3,112 @@
 #include "idealEOS.h"
 #include "abundances.h"
 
+/* User-defined variables are computed on the fly by the kernels
+ * below (see SetUserVarKernel), only for the outputs writing them.
+ * The geometrical factors use the volumetric central points. */
+
 /* *************************************************************** */
-void ComputeUserVar (const Data *d, Grid *grid)
+static double UserVarTemp (const Data *d, Grid *grid, int k, int j, int i)
 /*
+ *  Temperature
  *
- *  PURPOSE
- *
- *    Define user-defined output variables
- *
- *
+ ***************************************************************** */
+{
+  int nv;
+  double v[NVAR];
+
+  for (nv = 0; nv < NVAR; nv++) v[nv] = d->Vc[nv][k][j][i];
+  return TempIdealEOS(v[RHO], v[PRS], MeanMolecularWeight(v));
+}
+
+/* *************************************************************** */
+static double UserVarSpeed (const Data *d, Grid *grid, int k, int j,
+                            int i, double *lorentz)
+/*
+ *  Speed (three-velocity). The Lorentz factor is also returned
+ *  (1 if USE_FOUR_VELOCITY is NO).
  *
  ***************************************************************** */
 {
-  int i, j, k, nv;
-  double ***te, ***spd;
-  double ***prs, ***rho, ***vx1, ***vx2, ***vx3, dummy[NVAR];
-  double mu, sp1, sp2, sp3;
-  double *x1, *x2, *x3;
+  double sp1, sp2, sp3, speed;
 #if USE_FOUR_VELOCITY == YES
-  double ***v1, ***v2, ***v3;
-  double vel, speed, lorentz;
+  double vel;
 #endif
 
-  /* New variables - names must exist under uservar */
-  te = GetUserVar("te");
-  spd = GetUserVar("spd");
+  sp1 = sp2 = sp3 = 0;
+  EXPAND(sp1 = d->Vc[VX1][k][j][i];,
+         sp2 = d->Vc[VX2][k][j][i];,
+         sp3 = d->Vc[VX3][k][j][i];);
+  speed = VMAG(grid[IDIR].xgc[i], grid[JDIR].xgc[j], grid[KDIR].xgc[k],
+               sp1, sp2, sp3);
+  *lorentz = 1.;
 
-/* Change to v instead of u = lorentz v */
 #if USE_FOUR_VELOCITY == YES
-  v1  = GetUserVar("v1");
-  v2  = GetUserVar("v2");
-  v3  = GetUserVar("v3");
-#endif
-
-  /* State variables */
-  rho = d->Vc[RHO];
-  prs = d->Vc[PRS];
-  vx1 = d->Vc[VX1];
-  vx2 = d->Vc[VX2];
-  vx3 = d->Vc[VX3];
-
-  /* These are the geometrical central points */
-  //x1 = grid[IDIR].x;
-  //x2 = grid[JDIR].x;
-  //x3 = grid[KDIR].x;
-
-  /* These are the volumetric central points */
-  x1 = grid[IDIR].xgc;
-  x2 = grid[JDIR].xgc;
-  x3 = grid[KDIR].xgc;
-
-  DOM_LOOP(k, j, i) {
-
-    /* Temperature */
-    for (nv = 0; nv < NVAR; nv++) dummy[nv] = d->Vc[nv][k][j][i];
-    mu = MeanMolecularWeight(dummy);
-    te[k][j][i] = TempIdealEOS(rho[k][j][i], prs[k][j][i], mu);
-
-    /* Speed */
-    sp1 = sp2 = sp3 = 0;
-    EXPAND(sp1 = vx1[k][j][i];,
-           sp2 = vx2[k][j][i];,
-           sp3 = vx3[k][j][i];);
-    spd[k][j][i] = VMAG(x1[i], x2[j], x3[k], sp1, sp2, sp3);
+  /* speed at this point is gamma * vel.
+   * Solve for vel. Then get gamma.
+   * Note, c=1 if USE_FOUR_VELOCITY = YES. */
+  if (speed > 0){
+      vel = speed / sqrt(1 + speed * speed);
+      *lorentz = speed / vel;
+  }
+  else{
+      vel = 0.;
+  }
+  speed = vel;
+#endif
 
-#if USE_FOUR_VELOCITY == YES
-    /* speed at this point is gamma * vel.
-     * Solve for vel. Then get gamma.
-     * Note, c=1 if USE_FOUR_VELOCITY = YES. */
-    speed = spd[k][j][i];
-    if (speed > 0){
-        vel = speed / sqrt(1 + speed * speed);
-        lorentz = speed / vel;
-    }
-    else{
-        vel = 0.;
-        lorentz = 1.;
-    }
-
-    spd[k][j][i] = vel;
-    EXPAND(v1[k][j][i] = sp1 / lorentz;,
-           v2[k][j][i] = sp2 / lorentz;,
-           v3[k][j][i] = sp3 / lorentz;);
+  return speed;
+}
+
+static double UserVarSpd (const Data *d, Grid *grid, int k, int j, int i)
+{
+  double lorentz;
+  return UserVarSpeed(d, grid, k, j, i, &lorentz);
+}
+
+/* Change to v instead of u = lorentz v. Components not evolved are 0 */
+static double UserVarV1 (const Data *d, Grid *grid, int k, int j, int i)
+{
+  double lorentz;
+  UserVarSpeed(d, grid, k, j, i, &lorentz);
+  return d->Vc[VX1][k][j][i] / lorentz;
+}
+
+static double UserVarV2 (const Data *d, Grid *grid, int k, int j, int i)
+{
+#if COMPONENTS > 1
+  double lorentz;
+  UserVarSpeed(d, grid, k, j, i, &lorentz);
+  return d->Vc[VX2][k][j][i] / lorentz;
+#else
+  return 0.;
 #endif
+}
 
-  }
+static double UserVarV3 (const Data *d, Grid *grid, int k, int j, int i)
+{
+#if COMPONENTS > 2
+  double lorentz;
+  UserVarSpeed(d, grid, k, j, i, &lorentz);
+  return d->Vc[VX3][k][j][i] / lorentz;
+#else
+  return 0.;
+#endif
+}
 
+/* *************************************************************** */
+void ComputeUserVar (const Data *d, Grid *grid)
+/*
+ *
+ *  PURPOSE
+ *
+ *    Define user-defined output variables. Nothing to do here,
+ *    all of them are set as kernels in ChangeDumpVar().
+ *
+ *
+ *
+ ***************************************************************** */
+{
 }
 /* ************************************************************* */
 void ChangeDumpVar ()
@@ -99,6 +119,13 @@ void ChangeDumpVar ()
 {
   Image *image;
 
+  /* New variables - names must exist under uservar */
+  SetUserVarKernel("te",  UserVarTemp);
+  SetUserVarKernel("spd", UserVarSpd);
+  SetUserVarKernel("v1",  UserVarV1);
+  SetUserVarKernel("v2",  UserVarV2);
+  SetUserVarKernel("v3",  UserVarV3);
+
   /* HDF5 output cannot be controlled yet. Everything is output.*/
 
   /* VTK output */
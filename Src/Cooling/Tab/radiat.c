@@ -10,7 +10,7 @@ void Radiat (double *v, double *rhs)
  * 
  ******************************************************************* */
 {
-  int    klo, khi, kmid;
+  int    klo, khi, kmid, tag;
   static int ntab;
   double  mu, T, Tmid, scrh, dT, prs;
   static double *L_tab, *T_tab, E_cost;
@@ -28,8 +28,10 @@ void Radiat (double *v, double *rhs)
       print1 ("! Radiat: cooltable.dat could not be found.\n");
       QUIT_PLUTO(1);
     }
+    tag = MemoryTag (MEM_TABLES);
     L_tab = ARRAY_1D(20000, double);
     T_tab = ARRAY_1D(20000, double);
+    MemoryTag (tag);
 
     ntab = 0;
     while (fscanf(fcool, "%lf  %lf\n", T_tab + ntab, 
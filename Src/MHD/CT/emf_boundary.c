@@ -60,7 +60,7 @@ void EMF_BOUNDARY (EMF *emf, Grid *grid)
            par_dim[2] = grid[KDIR].nproc > 1;)
 
   #ifdef PARALLEL
-   MPI_Barrier (MPI_COMM_WORLD);
+   MPI_Barrier (AL_COMM_WORLD);
 
    AL_Exchange_dim ((char *)emf->ezj[0][0], par_dim, SZ);
    AL_Exchange_dim ((char *)emf->ezi[0][0], par_dim, SZ);
@@ -80,7 +80,7 @@ void EMF_BOUNDARY (EMF *emf, Grid *grid)
     AL_Exchange (emf->eyk[0][0], SZ);
    #endif
 */
-   MPI_Barrier (MPI_COMM_WORLD);
+   MPI_Barrier (AL_COMM_WORLD);
 
   #endif
 
@@ -31,8 +31,8 @@
   )
 
   #ifdef PARALLEL
-   MPI_Allreduce (tot + n, &gtot, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
-   MPI_Allreduce (&max,    &gmax, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+   MPI_Allreduce (tot + n, &gtot, 1, MPI_DOUBLE, MPI_SUM, AL_COMM_WORLD);
+   MPI_Allreduce (&max,    &gmax, 1, MPI_DOUBLE, MPI_MAX, AL_COMM_WORLD);
    tot[n] = gtot;
    max    = gmax;
   #endif
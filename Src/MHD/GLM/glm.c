@@ -406,7 +406,7 @@ void GLM_Init (const Data *d, const Time_Step *Dts, Grid *grid)
   #endif
 
   #ifdef PARALLEL
-   MPI_Allreduce (&glm_ch, &gmaxc, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+   MPI_Allreduce (&glm_ch, &gmaxc, 1, MPI_DOUBLE, MPI_MAX, AL_COMM_WORLD);
    glm_ch = gmaxc;
   #endif
 }
@@ -555,9 +555,9 @@ void SB_CorrectEMF (EMF *emf, Data_Arr V0, Grid *grid)
   /* -- Ex at Z faces: force periodicty  -- */
                                                                      
    #ifdef PARALLEL
-    MPI_Barrier (MPI_COMM_WORLD);
+    MPI_Barrier (AL_COMM_WORLD);
     AL_Exchange_dim (emf->ex[0][0], dimz, SZ);
-    MPI_Barrier (MPI_COMM_WORLD);
+    MPI_Barrier (AL_COMM_WORLD);
    #else
     for (j = JBEG - 1; j <= JEND; j++){
     for (i = IBEG    ; i <= IEND; i++){
@@ -579,9 +579,9 @@ void SB_CorrectEMF (EMF *emf, Data_Arr V0, Grid *grid)
    /*  Ey at Z faces: force periodicity   */
 
    #ifdef PARALLEL
-    MPI_Barrier (MPI_COMM_WORLD);
+    MPI_Barrier (AL_COMM_WORLD);
     AL_Exchange_dim (emf->ey[0][0], dimz, SZ);
-    MPI_Barrier (MPI_COMM_WORLD);
+    MPI_Barrier (AL_COMM_WORLD);
    #else
     for (j = JBEG    ; j <= JEND; j++){
     for (i = IBEG - 1; i <= IEND; i++){
@@ -621,7 +621,7 @@ void ExchangeX (double *bufL, double *bufR, int nel, Grid *grid)
   static  int nprocs[3], periods[3], coords[3];
 
   AL_Get_cart_comm(SZ, &cartcomm);
-  MPI_Barrier (MPI_COMM_WORLD);
+  MPI_Barrier (AL_COMM_WORLD);
 
 /* --------------------------------------
      get rank of the processor lying 
@@ -646,7 +646,7 @@ void ExchangeX (double *bufL, double *bufR, int nel, Grid *grid)
     if (prank != dest){
       MPI_Sendrecv (bufL, nel, MPI_DOUBLE, dest, stag,
                     bufR, nel, MPI_DOUBLE, dest, rtag,
-                    MPI_COMM_WORLD, &istat);
+                    AL_COMM_WORLD, &istat);
     }
   }
 
@@ -654,11 +654,11 @@ void ExchangeX (double *bufL, double *bufR, int nel, Grid *grid)
     if (prank != dest){
       MPI_Sendrecv (bufR, nel, MPI_DOUBLE, dest, stag,
                     bufL, nel, MPI_DOUBLE, dest, rtag,
-                    MPI_COMM_WORLD, &istat);
+                    AL_COMM_WORLD, &istat);
     }
   }
 
-  MPI_Barrier (MPI_COMM_WORLD);
+  MPI_Barrier (AL_COMM_WORLD);
 }
 
 #endif
@@ -88,7 +88,7 @@
 #define AL_LONG_DOUBLE_INT  MPI_LONG_DOUBLE_INT
 
 /* Communicators */
-#define AL_COMM_WORLD       MPI_COMM_WORLD 
+#define AL_COMM_WORLD       AL_Comm_world() 
 #define AL_COMM_SELF        MPI_COMM_SELF 
 
 /* Groups */
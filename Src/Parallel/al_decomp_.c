@@ -79,7 +79,7 @@ int AL_Decomp_3d_(int nproc,int npdim,int *ldims, int *gdims)
   register int ipz;
   int l2dims[AL_MAX_DIM], g2dims[AL_MAX_DIM];
 
-  MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
+  MPI_Comm_rank(AL_COMM_WORLD, &myrank);
 
   ndim = npdim;
 
@@ -202,7 +202,7 @@ int AL_Decomp_2d_(int nproc,int npdim,int *ldims, int *gdims)
   int myrank;
   register int ip;
 
-  MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
+  MPI_Comm_rank(AL_COMM_WORLD, &myrank);
 
   if( nproc == 1 ){
     ldims[0] = 1;
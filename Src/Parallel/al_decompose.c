@@ -99,6 +99,13 @@ int AL_Decompose(int sz_ptr, int *procs, int mode)
       s->lsize[nd] = procs[nd];
     }
   }
+
+  /*
+    With node-aware decomposition, nodes may be renumbered
+    so that those on the same host are close to each other
+  */
+  AL_Node_order_(sz_ptr);
+  myrank = s->rank;
   
   /*
     Now we set the MPI datatypes for the ghost points
@@ -495,6 +502,17 @@ printf("%d, lsubarr_stag[%d]: gdims[0:2] %d,%d,%d, ldims[0:2] %d,%d,%d, starts[0
 
   }
 
+  /*
+    Shared-memory window for the ghost points exchange
+    among nodes on the same host (node-aware mode only)
+  */
+  AL_Shm_init_(sz_ptr);
+
+  /*
+    Communicator used by the I/O thread, if any
+  */
+  AL_Io_init_(sz_ptr);
+
   /* 
      Now array is officially compiled
   */
@@ -708,7 +726,13 @@ int AL_Global_to_local_(int sz_ptr)
     /* We apply the following trick if the array is staggered */
     if( s->isstaggered[i] == AL_TRUE ){ gdim = gdim-1;}
 
-    AL_Decomp1d_(gdim, lproc, lloc, &start, &end);
+    if( s->partition[i] != NULL ){
+      start = 0;
+      for(j=0;j<lloc;j++) start += s->partition[i][j];
+      end = start + s->partition[i][lloc] - 1;
+    } else {
+      AL_Decomp1d_(gdim, lproc, lloc, &start, &end);
+    }
 
     s->beg[i] = start+s->bg[i];
     s->end[i] = end+s->bg[i];
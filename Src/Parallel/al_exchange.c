@@ -60,7 +60,9 @@ int AL_Exchange(void *vbuf, int sz_ptr)
   for(nd=0;nd<ndim;nd++){
     gp = s->bg[nd];
     /* If gp=0, do nothing */
-    if( gp > 0 ){
+    if( gp > 0 && s->shm_win != MPI_WIN_NULL ){
+      AL_Shm_exchange_(buf, nd, s);
+    } else if( gp > 0 ){
       nleft = s->left[nd];
       nright = s->right[nd];
       itype = s->type_rl[nd];
@@ -58,7 +58,9 @@ int AL_Exchange_dim(char *buf, int *dims, int sz_ptr)
     gp = s->bg[nd];
     
     /* If gp=0, do nothing */
-    if( gp > 0 && dims[nd] != 0 ){
+    if( gp > 0 && dims[nd] != 0 && s->shm_win != MPI_WIN_NULL ){
+      AL_Shm_exchange_(buf, nd, s);
+    } else if( gp > 0 && dims[nd] != 0 ){
       nleft = s->left[nd];
       nright = s->right[nd];
       itype = s->type_rl[nd];
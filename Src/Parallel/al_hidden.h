@@ -81,6 +81,9 @@ typedef struct szz{
                                   this dimension [Default: AL_TRUE] */
   int isstaggered[AL_MAX_DIM]; /* AL_TRUE if the array is staggered in 
                                   this dimension [Default: AL_FALSE]*/
+  int *partition[AL_MAX_DIM];  /* Number of points owned by each node along
+                                  this dimension, or NULL for the default
+                                  uniform split (see AL_Set_partition) */
   int left[AL_MAX_DIM];  /* Rank of left node in this dimension in the
                             cartesian communicator topology */
   int right[AL_MAX_DIM]; /* Rank of right node in this dimension in the
@@ -116,8 +119,34 @@ typedef struct szz{
   MPI_Offset io_offset;  /* Offset used to store file pointer */
   MPI_File ifp;          /* Pointer to the file this array is to be
                             written using MPI-IO */
+
+  /* Shared-memory ghost exchange among nodes of the same host 
+     (see al_node.c) */
+  MPI_Comm host_comm;    /* Nodes running on the same host */
+  MPI_Comm node_comm;    /* comm when created by AL_Node_order_() and
+                            owned by the array, or MPI_COMM_NULL */
+  MPI_Win  shm_win;      /* Shared window, MPI_WIN_NULL if not used */
+  char    *shm_buf;      /* Local part of the window */
+  MPI_Aint shm_off[AL_MAX_DIM][2];  /* Offset of the packed Right->Left (0) 
+                                       and Left->Right (1) ghost points */
+  int      shm_size[AL_MAX_DIM][2]; /* ... and their size in bytes */
+  int      host_left[AL_MAX_DIM];   /* Rank of left and right node in 
+                                       host_comm, or MPI_UNDEFINED if */
+  int      host_right[AL_MAX_DIM];  /* they run on a different host */
+  char    *shm_left[AL_MAX_DIM];    /* Window of left and right node */
+  char    *shm_right[AL_MAX_DIM];
+
+  MPI_Comm io_comm;      /* Duplicate of comm for the I/O thread 
+                            (see al_thread.c), or MPI_COMM_NULL */
 } SZ;
 
+/* Internal prototypes using the SZ structure (al_node.c) */
+int AL_Shm_exchange_(char *, int, SZ *);
+int AL_Shm_free_(SZ *);
+
+/* ... (al_thread.c) */
+MPI_Comm AL_Io_comm_(SZ *);
+
 
 #endif /* End ifndef __AL_HIDDEN */
 /*------------------------------------------------------------*/
@@ -13,6 +13,7 @@
 #include "al_hidden.h"  /*I "al_hidden.h" I*/
 
 static int AL_initialized = AL_FALSE;
+static MPI_Comm AL_comm_world;
 
 /* ********************************************************************* */
 int AL_Init(int *argc, char ***argv)
@@ -22,18 +23,45 @@ int AL_Init(int *argc, char ***argv)
  * \param [in] argc  integer pointer to number of arguments
  * \param [in] argv  pointer to argv list
  ********************************************************************* */
+{
+  return AL_Init_thread(argc, argv, MPI_THREAD_SINGLE);
+}
+
+/* ********************************************************************* */
+int AL_Init_thread(int *argc, char ***argv, int required)
+/*!
+ * Initialize the AL Tool requesting the thread support level
+ * required from MPI. MPI_THREAD_MULTIPLE is needed only when output
+ * is written by a separate thread (see al_thread.c); since it may
+ * slow down every message, MPI_Init() is used for MPI_THREAD_SINGLE.
+ *
+ * \param [in] argc      integer pointer to number of arguments
+ * \param [in] argv      pointer to argv list
+ * \param [in] required  the MPI thread support level
+ ********************************************************************* */
 {
   int myrank, nproc, errcode;
   int flag;
 
   errcode = MPI_Initialized(&flag);
 
-  if( !flag ) 
+  if( !flag ){
+#if MPI_VERSION >= 2
+    if (required != MPI_THREAD_SINGLE) {
+      errcode = MPI_Init_thread(argc, argv, required, &flag);
+    } else {
+      errcode = MPI_Init(argc, argv);
+    }
+#else
     errcode = MPI_Init(argc, argv);
+#endif
+  }
 
   MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
   MPI_Comm_size(MPI_COMM_WORLD, &nproc);
 
+  AL_comm_world = MPI_COMM_WORLD;
+
 #ifdef DEBUG
   printf("AL_Init: Called MPI_init from C: %d\n",errcode);
 #endif
@@ -60,3 +88,66 @@ int AL_Initialized()
 }
 
 
+
+/* ********************************************************************* */
+int AL_Split_world(int color)
+/*!
+ * Split MPI_COMM_WORLD into disjoint groups of nodes, each of which
+ * then behaves as an independent job: after this call AL_COMM_WORLD
+ * refers to the group of the calling node.
+ * Nodes are ranked within each group in the same order as in 
+ * MPI_COMM_WORLD.
+ * Must be called by all nodes after AL_Init() and before creating 
+ * any distributed array.
+ *
+ * \param [in] color  the group the calling node belongs to (>= 0)
+ *
+ * \return  AL_SUCCESS if the communicator was split correctly, 
+ *          AL_FAILURE otherwise. 
+ *********************************************************************** */
+{
+  int myrank;
+  MPI_Comm comm;
+
+  if( !AL_initialized ){
+    printf("AL_Split_world: AL was not initialized\n");
+    return (int) AL_FAILURE;
+  }
+
+  MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
+  if( MPI_Comm_split(MPI_COMM_WORLD, color, myrank, &comm) != MPI_SUCCESS ){
+    printf("AL_Split_world: MPI_Comm_split failed\n");
+    return (int) AL_FAILURE;
+  }
+  AL_comm_world = comm;
+
+  return (int) AL_SUCCESS;
+}
+
+/* ********************************************************************* */
+int AL_Set_world_(MPI_Comm comm)
+/*!
+ * Replace the communicator returned by AL_Comm_world() with comm,
+ * which must span the same nodes (e.g. after renumbering them).
+ * The previous one is freed unless it is MPI_COMM_WORLD, and must
+ * not be used any longer.
+ *********************************************************************** */
+{
+  if( AL_comm_world != MPI_COMM_WORLD && AL_comm_world != comm ){
+    MPI_Comm_free(&AL_comm_world);
+  }
+  AL_comm_world = comm;
+  return (int) AL_SUCCESS;
+}
+
+/* ********************************************************************* */
+MPI_Comm AL_Comm_world()
+/*!
+ * Return the communicator spanning the nodes of the current job,
+ * i.e. MPI_COMM_WORLD unless AL_Split_world() has been called.
+ * This is what the AL_COMM_WORLD macro expands to.
+ * In the I/O thread a duplicate of it is returned (see al_thread.c).
+ *********************************************************************** */
+{
+  return AL_Io_world_(AL_initialized ? AL_comm_world : MPI_COMM_WORLD);
+}
@@ -23,6 +23,8 @@
 extern SZ *sz_stack[AL_MAX_ARRAYS];
 extern int stack_ptr[AL_MAX_ARRAYS];
 
+static MPI_Info AL_read_info = MPI_INFO_NULL; /* hints for AL_File_open_read */
+
 /* ********************************************************************* */
  int AL_File_open(char *filename, int sz_ptr )
 /*!
@@ -52,7 +54,7 @@ extern int stack_ptr[AL_MAX_ARRAYS];
   myrank = s->rank;
   nproc = s->size;
 
-  comm = s->comm;
+  comm = AL_Io_comm_(s);
 
   MPI_Barrier(comm);
 
@@ -67,7 +69,7 @@ extern int stack_ptr[AL_MAX_ARRAYS];
 #ifdef DEBUG
   int myid, len;
   char es[128];
-  MPI_Comm_rank(MPI_COMM_WORLD, &myid);
+  MPI_Comm_rank(AL_COMM_WORLD, &myid);
   if( errcode ){
      MPI_Error_string(errcode, es, &len);
      printf("Errcode from MPI_File_open: %d | %s\n", errcode, es);
@@ -79,6 +81,67 @@ extern int stack_ptr[AL_MAX_ARRAYS];
 }
 
 
+/* ********************************************************************* */
+int AL_File_open_read(char *filename, int sz_ptr)
+/*!
+ * Open an existing file associated with a distributed array for
+ * reading only, using the hints set by AL_Set_read_ahead().
+ * Since data are read through the subarray types of the array, the
+ * file may have been written with any number of processors and any
+ * decomposition.
+ *
+ * \param [in] filename    name of the file
+ * \param [in] sz_ptr      integer pointer to the distributed array descriptor
+ *
+ * \return  AL_SUCCESS, or AL_FAILURE if the file cannot be opened
+ *********************************************************************** */
+{
+  int errcode;
+  MPI_Comm comm;
+  SZ *s;
+
+  if( stack_ptr[sz_ptr] == AL_STACK_FREE){
+    printf("AL_File_open_read: wrong SZ pointer\n");
+  }
+
+  s = sz_stack[sz_ptr];
+  comm = AL_Io_comm_(s);
+
+  MPI_Barrier(comm);
+
+  errcode = MPI_File_open(comm, filename, MPI_MODE_RDONLY,
+                          AL_read_info, &(s->ifp));
+  s->io_offset = 0;
+
+  if( errcode != MPI_SUCCESS ) return (int) AL_FAILURE;
+  return (int) AL_SUCCESS;
+}
+
+/* ********************************************************************* */
+int AL_Set_read_ahead(long int nbytes)
+/*!
+ * Set the size of the buffers used by the MPI-IO layer when reading
+ * with AL_File_open_read(): collective buffering is enabled and each
+ * aggregator reads ahead nbytes of contiguous data at a time.
+ * nbytes = 0 restores the defaults of the MPI library.
+ *
+ * \param [in] nbytes   size of the read buffers, in bytes
+ *********************************************************************** */
+{
+  char str[32];
+
+  if( AL_read_info != MPI_INFO_NULL ) MPI_Info_free(&AL_read_info);
+  if( nbytes <= 0 ) return (int) AL_SUCCESS;
+
+  sprintf(str, "%ld", nbytes);
+  MPI_Info_create(&AL_read_info);
+  MPI_Info_set(AL_read_info, "access_style",       "read_once,sequential");
+  MPI_Info_set(AL_read_info, "romio_cb_read",      "enable");
+  MPI_Info_set(AL_read_info, "cb_buffer_size",     str);
+  MPI_Info_set(AL_read_info, "ind_rd_buffer_size", str);
+  return (int) AL_SUCCESS;
+}
+
 /* ********************************************************************* */
 int AL_File_close(int sz_ptr)
 /*!
@@ -101,7 +164,7 @@ int AL_File_close(int sz_ptr)
   int myid, len;
   char es[128];
   if( errcode ){
-     MPI_Comm_rank(MPI_COMM_WORLD, &myid);
+     MPI_Comm_rank(AL_COMM_WORLD, &myid);
      MPI_Error_string(errcode, es, &len);
      printf("Errcode from MPI_File_close: %d | %s\n", errcode, es);
   }
@@ -154,7 +217,7 @@ int AL_Write_array(void *va, int sz_ptr, int istag)
     lsub_arr = s->lsubarr_stag[istag];
   }
 
-  MPI_Barrier(s->comm);
+  MPI_Barrier(AL_Io_comm_(s));
 
   errcode = MPI_File_set_view(ifp, offset, MPI_BYTE, gsub_arr,
                     "native", MPI_INFO_NULL);
@@ -162,7 +225,7 @@ int AL_Write_array(void *va, int sz_ptr, int istag)
 #ifdef DEBUG
     int myid, len;
     char es[256];
-    MPI_Comm_rank(MPI_COMM_WORLD, &myid);
+    MPI_Comm_rank(AL_COMM_WORLD, &myid);
     if( errcode ){
       MPI_Error_string(errcode, es, &len);
       printf("Errcode from MPI_File_set_view: %d | %s\n", errcode, es);
@@ -247,7 +310,7 @@ int AL_Read_array(void *va, int sz_ptr, int istag)
     lsub_arr = s->lsubarr_stag[istag];
   }
 
-  MPI_Barrier(s->comm);
+  MPI_Barrier(AL_Io_comm_(s));
 
   MPI_File_set_view(ifp, offset, MPI_BYTE, gsub_arr,
 		    "native", MPI_INFO_NULL);
@@ -309,7 +372,7 @@ int AL_Write_header(void *vbuffer, int nelem, AL_Datatype type, int sz_ptr)
 
   ifp    = s->ifp;
   offset = s->io_offset;
-  MPI_Barrier(s->comm);
+  MPI_Barrier(AL_Io_comm_(s));
   MPI_File_set_view(ifp, offset, MPI_BYTE, MPI_CHAR,
                     "native", MPI_INFO_NULL);
   if( myrank == 0 ){
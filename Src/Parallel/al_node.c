@@ -0,0 +1,397 @@
+/* ///////////////////////////////////////////////////////////////////// */
+/*!
+  \file
+  \brief Node-aware decomposition and shared-memory ghost exchange.
+
+  When enabled with AL_Set_node_aware(), the nodes (MPI processes)
+  running on the same physical host (\e host) are treated as a group:
+
+  - AL_Decompose() ranks the nodes so that the processes of each host
+    form a compact sub-block of the cartesian topology, which reduces
+    the surface exchanged across the network;
+  - ghost points shared with a neighbour on the same host are no longer
+    sent through MPI, but are packed into a buffer of an MPI-3 shared
+    memory window and unpacked by the neighbour directly from it.
+    Neighbours on other hosts keep using point-to-point communication.
+
+  Since the communicator of the array may be renumbered, the rank of a
+  node in AL_COMM_WORLD can change during the first call to
+  AL_Decompose().
+  This requires MPI-3; with older libraries the functions in this file
+  do nothing.
+
+  \date   Oct 19, 2026
+*/
+/* ///////////////////////////////////////////////////////////////////// */
+#include "al_hidden.h"  /*I "al_hidden.h" I*/
+
+/*
+   The SZ structure stack is defined and maintained
+   in al_szptr_.c
+   Here we include an external reference to it in
+   order to be able to make internal references to it.
+*/
+extern SZ *sz_stack[AL_MAX_ARRAYS];
+extern int stack_ptr[AL_MAX_ARRAYS];
+
+static int AL_node_aware = AL_FALSE;
+
+/* Header at the beginning of each shared buffer: offset and
+   size of the packed Right->Left and Left->Right ghost points */
+typedef struct {
+  MPI_Aint off[AL_MAX_DIM][2];
+  int      size[AL_MAX_DIM][2];
+} AL_Shm_header;
+
+/* ********************************************************************* */
+int AL_Set_node_aware(int flag)
+/*!
+ * Enable (flag = AL_TRUE) or disable node-aware decomposition and
+ * shared-memory ghost exchange for the arrays decomposed from now on.
+ *
+ * \return  AL_SUCCESS, or AL_FAILURE if MPI-3 is not available.
+ *********************************************************************** */
+{
+#if MPI_VERSION >= 3
+  AL_node_aware = flag;
+  return (int) AL_SUCCESS;
+#else
+  printf("AL_Set_node_aware: MPI-3 is required\n");
+  return (int) AL_FAILURE;
+#endif
+}
+
+#if MPI_VERSION >= 3
+/* ********************************************************************* */
+int AL_Node_order_(int sz_ptr)
+/*!
+ * Renumber the nodes of the array communicator so that, once the
+ * cartesian topology is created (in row-major order, without
+ * reordering), the nodes of each host fill a sub-block of the
+ * topology. The sub-block shape is the one minimizing the surface
+ * across hosts. Nothing is done if hosts run different numbers of
+ * nodes or if no sub-block fits the decomposition.
+ * Called by AL_Decompose() once the number of nodes along each
+ * dimension (s->lsize) is known.
+ *
+ * \param [in] sz_ptr integer pointer to the SZ structure
+ *********************************************************************** */
+{
+  register int nd;
+  int ndim, myrank, nproc, hrank, hsize, hmin, hmax, host;
+  int leader, nlead, key, moved, nmoved;
+  int dims[3], nb[3], best[3], hb[3], hc[3], lc[3];
+  int n0, n1, n2;
+  double cells[3], surf, best_surf;
+  MPI_Comm comm, host_comm, new_comm;
+  SZ *s;
+
+  if( !AL_node_aware ) return (int) AL_SUCCESS;
+
+  s = sz_stack[sz_ptr];
+  comm   = s->comm;
+  myrank = s->rank;
+  nproc  = s->size;
+  ndim   = s->ndim;
+
+  MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, myrank, MPI_INFO_NULL, &host_comm);
+  MPI_Comm_rank(host_comm, &hrank);
+  MPI_Comm_size(host_comm, &hsize);
+
+  /* -- hosts are numbered in the order of their first node -- */
+
+  leader = (hrank == 0);
+  MPI_Scan(&leader, &nlead, 1, MPI_INT, MPI_SUM, comm);
+  host = nlead - 1;
+  MPI_Bcast(&host, 1, MPI_INT, 0, host_comm);
+  MPI_Comm_free(&host_comm);
+
+  MPI_Allreduce(&hsize, &hmin, 1, MPI_INT, MPI_MIN, comm);
+  MPI_Allreduce(&hsize, &hmax, 1, MPI_INT, MPI_MAX, comm);
+  if( hmin != hmax || hsize == 1 || hsize == nproc ) return (int) AL_SUCCESS;
+
+  /* -- find the host sub-block with the smallest outer surface -- */
+
+  for(nd=0;nd<3;nd++){
+    dims[nd]  = (nd < ndim ? s->lsize[nd] : 1);
+    cells[nd] = (nd < ndim ? (double)s->arrdim[nd]/(double)dims[nd] : 1.0);
+  }
+
+  best[0] = 0;
+  best_surf = -1.0;
+  for(n0=1;n0<=dims[0];n0++){
+    if( dims[0] % n0 != 0 || hsize % n0 != 0 ) continue;
+    for(n1=1;n1<=dims[1];n1++){
+      if( dims[1] % n1 != 0 || (hsize/n0) % n1 != 0 ) continue;
+      n2 = hsize/(n0*n1);
+      if( dims[2] % n2 != 0 ) continue;
+      nb[0] = n0; nb[1] = n1; nb[2] = n2;
+      surf = 0.0;
+      for(nd=0;nd<3;nd++){
+        if( nb[nd] == dims[nd] && !s->isperiodic[nd] ) continue;
+        surf +=   nb[(nd+1)%3]*cells[(nd+1)%3]
+                * nb[(nd+2)%3]*cells[(nd+2)%3];
+      }
+      if( best_surf < 0.0 || surf < best_surf ){
+        best_surf = surf;
+        best[0] = n0; best[1] = n1; best[2] = n2;
+      }
+    }
+  }
+
+  if( best[0] == 0 ){
+    if( myrank == 0 ){
+      printf("AL_Node_order_: %d nodes per host do not fit the decomposition\n", hsize);
+    }
+    return (int) AL_SUCCESS;
+  }
+
+  /* -- coordinates of this node: host sub-block + position inside it -- */
+
+  for(nd=0;nd<3;nd++) hb[nd] = dims[nd]/best[nd];
+  hc[2] = host % hb[2];  hc[1] = (host/hb[2]) % hb[1];  hc[0] = host/(hb[2]*hb[1]);
+  lc[2] = hrank % best[2];  lc[1] = (hrank/best[2]) % best[1];  lc[0] = hrank/(best[2]*best[1]);
+
+  key = 0;
+  for(nd=0;nd<3;nd++) key = key*dims[nd] + hc[nd]*best[nd] + lc[nd];
+
+  moved = (key != myrank);
+  MPI_Allreduce(&moved, &nmoved, 1, MPI_INT, MPI_SUM, comm);
+  if( nmoved == 0 ) return (int) AL_SUCCESS;
+
+  /* -- the renumbered communicator replaces the one of the job, which
+        is freed, or is owned by the array (the one it was created
+        with belongs to the caller) -- */
+
+  MPI_Comm_split(comm, 0, key, &new_comm);
+  if( comm == AL_COMM_WORLD ){
+    AL_Set_world_(new_comm);
+  }else{
+    s->node_comm = new_comm;
+  }
+  s->comm = new_comm;
+  MPI_Comm_rank(new_comm, &(s->rank));
+
+#ifdef DEBUG
+  printf("AL_Node_order_: node %d -> %d (host %d)\n", myrank, s->rank, host);
+#endif
+
+  return (int) AL_SUCCESS;
+}
+
+/* ********************************************************************* */
+int AL_Shm_init_(int sz_ptr)
+/*!
+ * Allocate the shared-memory window used to exchange ghost points
+ * with the neighbours running on the same host.
+ * Called by AL_Decompose() after the exchange datatypes are created.
+ *
+ * \param [in] sz_ptr integer pointer to the SZ structure
+ *********************************************************************** */
+{
+  register int nd;
+  int ndim, disp, nbr[2], hnbr[2], side;
+  MPI_Aint size, wsize;
+  MPI_Group group, host_group;
+  AL_Shm_header *hdr;
+  SZ *s;
+
+  s = sz_stack[sz_ptr];
+  ndim = s->ndim;
+
+  s->host_comm = MPI_COMM_NULL;
+  s->shm_win   = MPI_WIN_NULL;
+  if( !AL_node_aware ) return (int) AL_SUCCESS;
+
+  MPI_Comm_split_type(s->cart_comm, MPI_COMM_TYPE_SHARED, s->rank,
+                      MPI_INFO_NULL, &(s->host_comm));
+  MPI_Comm_group(s->cart_comm, &group);
+  MPI_Comm_group(s->host_comm, &host_group);
+
+  /* -- neighbours on the same host and size of the buffers -- */
+
+  wsize = sizeof(AL_Shm_header);
+  for(nd=0;nd<ndim;nd++){
+    nbr[0] = s->left[nd];
+    nbr[1] = s->right[nd];
+    MPI_Group_translate_ranks(group, 2, nbr, host_group, hnbr);
+    s->host_left[nd]  = (nbr[0] == MPI_PROC_NULL ? MPI_UNDEFINED : hnbr[0]);
+    s->host_right[nd] = (nbr[1] == MPI_PROC_NULL ? MPI_UNDEFINED : hnbr[1]);
+    for(side=0;side<2;side++){
+      MPI_Pack_size(1, side == 0 ? s->type_rl[nd] : s->type_lr[nd],
+                    s->host_comm, &(s->shm_size[nd][side]));
+      s->shm_off[nd][side] = wsize;
+      wsize += s->shm_size[nd][side];
+    }
+  }
+  MPI_Group_free(&group);
+  MPI_Group_free(&host_group);
+
+  MPI_Win_allocate_shared(wsize, 1, MPI_INFO_NULL, s->host_comm,
+                          &(s->shm_buf), &(s->shm_win));
+  MPI_Win_lock_all(MPI_MODE_NOCHECK, s->shm_win);
+
+  hdr = (AL_Shm_header *) s->shm_buf;
+  for(nd=0;nd<ndim;nd++){
+    for(side=0;side<2;side++){
+      hdr->off[nd][side]  = s->shm_off[nd][side];
+      hdr->size[nd][side] = s->shm_size[nd][side];
+    }
+  }
+  MPI_Win_sync(s->shm_win);
+  MPI_Barrier(s->host_comm);
+  MPI_Win_sync(s->shm_win);
+
+  /* -- base address of the neighbours' buffers -- */
+
+  for(nd=0;nd<ndim;nd++){
+    s->shm_left[nd] = s->shm_right[nd] = NULL;
+    if( s->host_left[nd] != MPI_UNDEFINED ){
+      MPI_Win_shared_query(s->shm_win, s->host_left[nd], &size, &disp,
+                           &(s->shm_left[nd]));
+    }
+    if( s->host_right[nd] != MPI_UNDEFINED ){
+      MPI_Win_shared_query(s->shm_win, s->host_right[nd], &size, &disp,
+                           &(s->shm_right[nd]));
+    }
+  }
+
+  return (int) AL_SUCCESS;
+}
+
+/* ********************************************************************* */
+int AL_Shm_exchange_(char *buf, int nd, SZ *s)
+/*!
+ * Fill the ghost points of buf along dimension nd: ghost points
+ * owned by neighbours on the same host are copied from their shared
+ * buffers, the others are exchanged with point-to-point messages.
+ * Equivalent to the two MPI_Sendrecv calls of AL_Exchange().
+ *
+ * \param [in] buf  pointer to buffer
+ * \param [in] nd   the dimension
+ * \param [in] s    pointer to the SZ structure
+ *********************************************************************** */
+{
+  int nleft, nright, hleft, hright, pos, nreq, nsig;
+  int tag_ready, tag_done;
+  char *src, sig[4];
+  MPI_Comm comm;
+  MPI_Request req[4], sreq[4];
+  AL_Shm_header *hdr;
+
+  comm   = s->comm;
+  nleft  = s->left[nd];
+  nright = s->right[nd];
+  hleft  = s->host_left[nd];
+  hright = s->host_right[nd];
+  tag_ready = nd*100 + 2;
+  tag_done  = nd*100 + 3;
+
+  /* -- 1. post off-host messages -- */
+
+  nreq = 0;
+  if( nright != MPI_PROC_NULL && hright == MPI_UNDEFINED ){
+    MPI_Irecv(&buf[s->recvb1[nd]], 1, s->type_rl[nd], nright, s->tag1[nd],
+              comm, req + nreq++);
+    MPI_Isend(&buf[s->sendb2[nd]], 1, s->type_lr[nd], nright, s->tag2[nd],
+              comm, req + nreq++);
+  }
+  if( nleft != MPI_PROC_NULL && hleft == MPI_UNDEFINED ){
+    MPI_Irecv(&buf[s->recvb2[nd]], 1, s->type_lr[nd], nleft, s->tag2[nd],
+              comm, req + nreq++);
+    MPI_Isend(&buf[s->sendb1[nd]], 1, s->type_rl[nd], nleft, s->tag1[nd],
+              comm, req + nreq++);
+  }
+
+  /* -- 2. pack boundary points for on-host neighbours -- */
+
+  if( hleft != MPI_UNDEFINED ){
+    pos = 0;
+    MPI_Pack(&buf[s->sendb1[nd]], 1, s->type_rl[nd], s->shm_buf + s->shm_off[nd][0],
+             s->shm_size[nd][0], &pos, s->host_comm);
+  }
+  if( hright != MPI_UNDEFINED ){
+    pos = 0;
+    MPI_Pack(&buf[s->sendb2[nd]], 1, s->type_lr[nd], s->shm_buf + s->shm_off[nd][1],
+             s->shm_size[nd][1], &pos, s->host_comm);
+  }
+
+  /* -- 3. signal that the buffers are ready and wait for
+           the neighbours to do the same -- */
+
+  MPI_Win_sync(s->shm_win);
+  nsig = 0;
+  if( hleft != MPI_UNDEFINED ){
+    MPI_Irecv(sig,   0, MPI_CHAR, hleft, tag_ready, s->host_comm, sreq + nsig++);
+    MPI_Isend(sig+2, 0, MPI_CHAR, hleft, tag_ready, s->host_comm, sreq + nsig++);
+  }
+  if( hright != MPI_UNDEFINED ){
+    MPI_Irecv(sig+1, 0, MPI_CHAR, hright, tag_ready, s->host_comm, sreq + nsig++);
+    MPI_Isend(sig+3, 0, MPI_CHAR, hright, tag_ready, s->host_comm, sreq + nsig++);
+  }
+  MPI_Waitall(nsig, sreq, MPI_STATUSES_IGNORE);
+  MPI_Win_sync(s->shm_win);
+
+  /* -- 4. unpack directly from the neighbours' buffers -- */
+
+  if( hright != MPI_UNDEFINED ){
+    hdr = (AL_Shm_header *) s->shm_right[nd];
+    src = s->shm_right[nd] + hdr->off[nd][0];
+    pos = 0;
+    MPI_Unpack(src, hdr->size[nd][0], &pos, &buf[s->recvb1[nd]], 1,
+               s->type_rl[nd], s->host_comm);
+  }
+  if( hleft != MPI_UNDEFINED ){
+    hdr = (AL_Shm_header *) s->shm_left[nd];
+    src = s->shm_left[nd] + hdr->off[nd][1];
+    pos = 0;
+    MPI_Unpack(src, hdr->size[nd][1], &pos, &buf[s->recvb2[nd]], 1,
+               s->type_lr[nd], s->host_comm);
+  }
+
+  /* -- 5. buffers can be overwritten only after the
+           neighbours have read them -- */
+
+  nsig = 0;
+  if( hleft != MPI_UNDEFINED ){
+    MPI_Irecv(sig,   0, MPI_CHAR, hleft, tag_done, s->host_comm, sreq + nsig++);
+    MPI_Isend(sig+2, 0, MPI_CHAR, hleft, tag_done, s->host_comm, sreq + nsig++);
+  }
+  if( hright != MPI_UNDEFINED ){
+    MPI_Irecv(sig+1, 0, MPI_CHAR, hright, tag_done, s->host_comm, sreq + nsig++);
+    MPI_Isend(sig+3, 0, MPI_CHAR, hright, tag_done, s->host_comm, sreq + nsig++);
+  }
+  MPI_Waitall(nsig, sreq, MPI_STATUSES_IGNORE);
+
+  MPI_Waitall(nreq, req, MPI_STATUSES_IGNORE);
+
+  return (int) AL_SUCCESS;
+}
+
+/* ********************************************************************* */
+int AL_Shm_free_(SZ *s)
+/*!
+ * Release the shared-memory window of an array descriptor.
+ *********************************************************************** */
+{
+  if( s->shm_win != MPI_WIN_NULL ){
+    MPI_Win_unlock_all(s->shm_win);
+    MPI_Win_free(&(s->shm_win));
+  }
+  if( s->host_comm != MPI_COMM_NULL ) MPI_Comm_free(&(s->host_comm));
+  return (int) AL_SUCCESS;
+}
+
+#else  /* MPI_VERSION < 3 */
+
+int AL_Node_order_(int sz_ptr) { return (int) AL_SUCCESS; }
+int AL_Shm_init_(int sz_ptr)
+{
+  sz_stack[sz_ptr]->host_comm = MPI_COMM_NULL;
+  sz_stack[sz_ptr]->shm_win   = MPI_WIN_NULL;
+  return (int) AL_SUCCESS;
+}
+int AL_Shm_exchange_(char *buf, int nd, SZ *s) { return (int) AL_FAILURE; }
+int AL_Shm_free_(SZ *s) { return (int) AL_SUCCESS; }
+
+#endif
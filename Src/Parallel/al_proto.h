@@ -22,8 +22,14 @@ extern "C" {
 #endif
 /* External prototypes */
 extern int AL_Init(int *, char ***);
+extern int AL_Init_thread(int *, char ***, int);
 extern int AL_Finalize();
 extern int AL_Initialized();
+extern int AL_Split_world(int);
+extern MPI_Comm AL_Comm_world();
+extern int AL_Set_node_aware(int);
+extern int AL_Set_io_thread(int);
+extern int AL_Attach_io_thread();
 extern int AL_Sz_init(MPI_Comm, int *);
 extern int AL_Free(int);
 extern int AL_Sz_free(int);
@@ -38,6 +44,7 @@ extern int AL_Set_parallel_dim(int *, int);
 extern int AL_Set_periodic_dim(int *, int);
 extern int AL_Set_staggered_dim(int *, int);
 extern int AL_Set_ghosts(int *, int);
+extern int AL_Set_partition(int, int, int *, int);
 
 extern int AL_Get_size(int, int *);
 extern int AL_Get_comm(int, MPI_Comm *);
@@ -70,6 +77,8 @@ extern int AL_Exchange_dim(char *, int *, int);
 extern int AL_Exchange_periods (void *vbuf, int *periods, int sz_ptr);
 
 extern int AL_File_open(char *, int);
+extern int AL_File_open_read(char *, int);
+extern int AL_Set_read_ahead(long int);
 extern long long AL_Get_offset(int);
 extern int AL_Set_offset(int, long long);
 
@@ -92,6 +101,11 @@ extern int AL_Allocate_sz_();
 extern int AL_Deallocate_sz_(int);
 extern int AL_Auto_Decomp_(int, int, int *, int *);
 extern int AL_Sort_(int, int *, int *);
+extern int AL_Set_world_(MPI_Comm);
+extern int AL_Node_order_(int);
+extern int AL_Shm_init_(int);
+extern int AL_Io_init_(int);
+extern MPI_Comm AL_Io_world_(MPI_Comm);
 
 #ifdef __cplusplus
 }
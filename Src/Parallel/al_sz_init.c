@@ -78,11 +78,17 @@ int AL_Sz_init(MPI_Comm comm, int *sz_ptr)
     sz_stack[*sz_ptr]->eg[i]=0;
     sz_stack[*sz_ptr]->offset[i]=1;
     sz_stack[*sz_ptr]->stride[i]=1;
+    sz_stack[*sz_ptr]->partition[i]=NULL;
   }
 
   sz_stack[*sz_ptr]->begs = NULL;
   sz_stack[*sz_ptr]->ends = NULL;
 
+  sz_stack[*sz_ptr]->host_comm = MPI_COMM_NULL;
+  sz_stack[*sz_ptr]->node_comm = MPI_COMM_NULL;
+  sz_stack[*sz_ptr]->shm_win   = MPI_WIN_NULL;
+  sz_stack[*sz_ptr]->io_comm   = MPI_COMM_NULL;
+
   return (int) AL_SUCCESS;
 }
 
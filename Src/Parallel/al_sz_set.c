@@ -368,3 +368,76 @@ int AL_Set_ghosts(int *ghosts, int isz)
   return (int) AL_SUCCESS;
 }
 
+
+/* ********************************************************************* */
+int AL_Set_partition(int dim, int nproc, int *npoints, int isz)
+/*!
+ * Set a non-uniform distribution of a distributed array along one
+ * dimension. The default (uniform) split is replaced by the given 
+ * number of points per node; it is used by the next call to 
+ * AL_Decompose.
+ *
+ * \param [in]  dim     the dimension (C-convention)
+ * \param [in]  nproc   number of nodes along dim
+ * \param [in]  npoints array of nproc integers with the number of 
+ *                      points (ghost points excluded) owned by each 
+ *                      node along dim; pass NULL to restore the 
+ *                      uniform split
+ * \param [out] isz     Integer pointer to the input array descriptor
+ *
+ * \return  AL_SUCCESS if the partition is set correctly, 
+ *          AL_FAILURE otherwise. 
+ *********************************************************************** */ 
+{
+  register int i;
+  int ntot;
+  SZ *s;
+
+  /* 
+     Check that isz points to an allocated SZ
+  */
+  if( stack_ptr[isz] == AL_STACK_FREE ){
+    printf("AL_Set_partition: wrong SZ pointer\n");
+    return (int) AL_FAILURE;
+  }
+
+  /*
+    Get the SZ structure isz is pointing at
+  */
+  s = sz_stack[isz];
+
+  if( dim < 0 || dim >= s->ndim ){
+    printf("AL_Set_partition: wrong dimension %d\n", dim);
+    return (int) AL_FAILURE;
+  }
+
+  if( s->partition[dim] != NULL ){
+    free(s->partition[dim]);
+    s->partition[dim] = NULL;
+  }
+  if( npoints == NULL ) return (int) AL_SUCCESS;
+
+  /*
+    The partition must cover the global dimension
+  */
+  ntot = 0;
+  for(i=0;i<nproc;i++){ 
+    if( npoints[i] < s->bg[dim] ){
+      printf("AL_Set_partition: node %d owns fewer points than ghosts\n", i);
+      return (int) AL_FAILURE;
+    }
+    ntot += npoints[i];
+  }
+  if( ntot != s->arrdim[dim] - (s->isstaggered[dim] == AL_TRUE) ){
+    printf("AL_Set_partition: partition does not match the global dimension\n");
+    return (int) AL_FAILURE;
+  }
+
+  if( !(s->partition[dim] = (int *)malloc(sizeof(int)*nproc)) ){
+    printf("AL_Set_partition: could not allocate partition\n");
+    return (int) AL_FAILURE;
+  }
+  for(i=0;i<nproc;i++) s->partition[dim][i] = npoints[i];
+
+  return (int) AL_SUCCESS;
+}
@@ -44,7 +44,7 @@ int AL_Init_stack_()
 
   for( i=0; i<AL_MAX_ARRAYS;i++){ stack_ptr[i] = AL_STACK_FREE ;}
 
-  MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
+  MPI_Comm_rank(AL_COMM_WORLD, &myrank);
   
 #ifdef DEBUG
   printf("AL_Init_stack_: SZ stack initialized\n");
@@ -121,18 +121,23 @@ int AL_Deallocate_sz_(int sz_ptr)
   */
   if( s->compiled == AL_TRUE ){
     for( i=0; i<ndim; i++){
-      MPI_Type_free(&(s->strided[i]));
+      MPI_Type_free(&(s->strided[i]));  /* type_rl[i] is the same handle */
       MPI_Type_free(&(s->type_lr[i]));
-      MPI_Type_free(&(s->type_rl[i]));
       MPI_Comm_free(&(s->oned_comm[i]));
     }
 
     MPI_Type_free(&(s->gsubarr));
     MPI_Type_free(&(s->lsubarr));
+    AL_Shm_free_(s);
+    if( s->io_comm != MPI_COMM_NULL ) MPI_Comm_free(&(s->io_comm));
     MPI_Comm_free(&(s->cart_comm));
   }
+  if( s->node_comm != MPI_COMM_NULL ) MPI_Comm_free(&(s->node_comm));
 
   if( (s->begs != NULL) ) free(s->begs);
+  for( i=0; i<AL_MAX_DIM; i++){
+    if( s->partition[i] != NULL ) free(s->partition[i]);
+  }
 
   /*
     Begin by dellocating the SZ structure 
@@ -0,0 +1,114 @@
+/* ///////////////////////////////////////////////////////////////////// */
+/*!
+  \file
+  \brief Communicators for a dedicated I/O thread.
+
+  Data can be written by a second thread while the main one keeps on
+  computing (see async_output.c).
+  Since collective MPI calls on the same communicator cannot be issued
+  concurrently by two threads, once AL_Set_io_thread() has been called:
+
+  - every array decomposed from then on gets a duplicate of its
+    communicator (\c io_comm) which is used by the MPI-IO functions in
+    al_io.c when they are called from the I/O thread;
+  - in the thread that called AL_Attach_io_thread(), AL_COMM_WORLD
+    refers to a duplicate of the job communicator.
+
+  The main thread keeps using the original communicators, so that the
+  two threads never share a communicator.
+  This requires the MPI library to provide MPI_THREAD_MULTIPLE.
+
+  \date   Oct 19, 2026
+*/
+/* ///////////////////////////////////////////////////////////////////// */
+#include "al_hidden.h"  /*I "al_hidden.h" I*/
+
+extern SZ *sz_stack[AL_MAX_ARRAYS];
+extern int stack_ptr[AL_MAX_ARRAYS];
+
+static int AL_io_enabled = AL_FALSE;
+static MPI_Comm AL_io_world     = MPI_COMM_NULL; /* Duplicate of ...   */
+static MPI_Comm AL_io_world_src = MPI_COMM_NULL; /* ... this communicator */
+static __thread int AL_in_io_thread = AL_FALSE;
+
+/* ********************************************************************* */
+int AL_Set_io_thread(int flag)
+/*!
+ * Enable (flag = AL_TRUE) the creation of separate communicators for
+ * an I/O thread for the arrays decomposed from now on.
+ *
+ * \return  AL_SUCCESS, or AL_FAILURE if the MPI library does not
+ *          support concurrent calls from several threads.
+ *********************************************************************** */
+{
+  int provided = MPI_THREAD_SINGLE;
+
+#if MPI_VERSION >= 2
+  MPI_Query_thread(&provided);
+#endif
+  if( flag && provided < MPI_THREAD_MULTIPLE ){
+    AL_io_enabled = AL_FALSE;
+    return (int) AL_FAILURE;
+  }
+  AL_io_enabled = flag;
+  return (int) AL_SUCCESS;
+}
+
+/* ********************************************************************* */
+int AL_Attach_io_thread()
+/*!
+ * Mark the calling thread as the I/O thread: from now on its MPI-IO
+ * calls and AL_COMM_WORLD use the duplicated communicators.
+ *********************************************************************** */
+{
+  AL_in_io_thread = AL_TRUE;
+  return (int) AL_SUCCESS;
+}
+
+/* ********************************************************************* */
+int AL_Io_init_(int sz_ptr)
+/*!
+ * Duplicate the communicator of the distributed array sz_ptr and,
+ * if it has changed, the one of the job.
+ * Collective; called by AL_Decompose().
+ *********************************************************************** */
+{
+  SZ *s;
+  MPI_Comm world;
+
+  s = sz_stack[sz_ptr];
+  s->io_comm = MPI_COMM_NULL;
+  if( !AL_io_enabled ) return (int) AL_SUCCESS;
+
+  MPI_Comm_dup(s->comm, &(s->io_comm));
+
+  world = AL_Comm_world();
+  if( world != AL_io_world_src ){
+    if( AL_io_world != MPI_COMM_NULL ) MPI_Comm_free(&AL_io_world);
+    MPI_Comm_dup(world, &AL_io_world);
+    AL_io_world_src = world;
+  }
+  return (int) AL_SUCCESS;
+}
+
+/* ********************************************************************* */
+MPI_Comm AL_Io_comm_(SZ *s)
+/*!
+ * Return the communicator to be used for the MPI-IO operations on
+ * the array s by the calling thread.
+ *********************************************************************** */
+{
+  if( AL_in_io_thread && s->io_comm != MPI_COMM_NULL ) return s->io_comm;
+  return s->comm;
+}
+
+/* ********************************************************************* */
+MPI_Comm AL_Io_world_(MPI_Comm world)
+/*!
+ * Return the duplicate of the job communicator world when called from
+ * the I/O thread, world itself otherwise.
+ *********************************************************************** */
+{
+  if( AL_in_io_thread && AL_io_world != MPI_COMM_NULL ) return AL_io_world;
+  return world;
+}
@@ -48,7 +48,7 @@ int AL_Write_array_begin(void *va, int sz_ptr, int *output_stag, int *output_dum
   int errcode;
 
   int myrank;
-  MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
+  MPI_Comm_rank(AL_COMM_WORLD, &myrank);
 
   a = (char *) va;
 
@@ -149,7 +149,7 @@ int AL_Write_array_end(void *va, int sz_ptr)
   int errcode;
 
   int myrank;
-  MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
+  MPI_Comm_rank(AL_COMM_WORLD, &myrank);
 
   a = (char *) va;
 
@@ -96,7 +96,7 @@ void SET_PARTICLES (HEAD *list, HEAD *temp_list, struct GRID gxyz[],
             }
 
             BUILD_PARTICLES_TYPE(&pl, type_ptr);
-            MPI_Bcast( &pl, 1, type_PARTICLES, 0, MPI_COMM_WORLD );
+            MPI_Bcast( &pl, 1, type_PARTICLES, 0, AL_COMM_WORLD );
 
             /* find the processor associated to particle position */
             MPI_Cart_rank(cart_comm, coords, &rank_part);       
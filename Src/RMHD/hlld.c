@@ -115,9 +115,9 @@ void HLLD_Solver (const State_1D *state, int beg, int end,
    }
    if (last_step != g_stepNumber){ /* -- at the beginning of new step -- */
      #ifdef PARALLEL
-      MPI_Allreduce (&totfail, &scrh, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+      MPI_Allreduce (&totfail, &scrh, 1, MPI_DOUBLE, MPI_SUM, AL_COMM_WORLD);
       totfail = scrh;
-      MPI_Allreduce (&totzones, &scrh, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+      MPI_Allreduce (&totzones, &scrh, 1, MPI_DOUBLE, MPI_SUM, AL_COMM_WORLD);
       totzones = scrh;
      #endif
      if (prank == 0){
@@ -7,9 +7,19 @@
   methods (RK3).
   Time stepping include Euler, RK2 and RK3.
 
+  The conservative variables saved at the beginning of the step (U0)
+  are stored in double precision for nv < RK_FLOAT_BEG and in single
+  precision for the remaining ones (e.g. the passive tracers when
+  RK_FLOAT_BEG == TRC), halving the memory and bandwidth they take.
+  The stage combinations are always computed in double precision.
+  The total energy (and the variables before it) must be kept in
+  double precision, since the pressure of highly supersonic flows is
+  recovered from a small difference of energies; UpdateSolution()
+  quits if RK_FLOAT_BEG <= ENG.
+
   \authors A. Mignone (mignone@ph.unito.it)\n
            P. Tzeferacos (petros.tzeferacos@ph.unito.it)
-  \date    March 2, 2014
+  \date    Oct 19, 2026
 */
 /* ///////////////////////////////////////////////////////////////////// */
 #include "pluto.h"
@@ -38,19 +48,49 @@ int UpdateSolution (const Data *d, Riemann_Solver *Riemann,
  *    
  *********************************************************************** */
 {
-  int  i, j, k, nv;
+  int  i, j, k, nv, tag;
   static double  one_third = 1.0/3.0;
   static Data_Arr U0, Bs0;
+  static float ****U0f;  /* -- variables nv >= RK_FLOAT_BEG of U0 -- */
+  static int epoch;
 
 /* ----------------------------------------------------
-    0. Allocate memory 
+    0. Allocate memory (again, if the local grid 
+       has changed size since the last call)
    ---------------------------------------------------- */
 
-  if (U0 == NULL){
-    U0 = ARRAY_4D(NX3_TOT, NX2_TOT, NX1_TOT, NVAR, double);
+  if ((U0 != NULL || U0f != NULL) && epoch != g_gridEpoch){
+    if (U0  != NULL) FreeArray4D ((void *) U0);
+    if (U0f != NULL) FreeArray4D ((void *) U0f);
+    #ifdef STAGGERED_MHD
+     FreeArray4D ((void *) Bs0);
+    #endif
+    U0  = NULL;
+    U0f = NULL;
+  }
+
+  if (U0 == NULL && U0f == NULL){
+    #if HAVE_ENERGY
+     if (RK_FLOAT_BEG <= ENG){
+       print1 ("! UpdateSolution: RK_FLOAT_BEG must be > ENG\n");
+       QUIT_PLUTO(1);
+     }
+    #endif
+    tag = MemoryTag (MEM_RK);
+    if (RK_FLOAT_BEG > 0){
+      U0 = ARRAY_4D(grid[KDIR].np_tot, grid[JDIR].np_tot, 
+                    grid[IDIR].np_tot, RK_FLOAT_BEG, double);
+    }
+    if (RK_FLOAT_BEG < NVAR){
+      U0f = ARRAY_4D(grid[KDIR].np_tot, grid[JDIR].np_tot, 
+                     grid[IDIR].np_tot, NVAR - RK_FLOAT_BEG, float);
+    }
     #ifdef STAGGERED_MHD
-     Bs0 = ARRAY_4D(DIMENSIONS, NX3_TOT, NX2_TOT, NX1_TOT, double);
+     Bs0 = ARRAY_4D(DIMENSIONS, grid[KDIR].np_tot, grid[JDIR].np_tot, 
+                                grid[IDIR].np_tot, double);
     #endif
+    MemoryTag (tag);
+    epoch = g_gridEpoch;
   }
 
   #ifdef FARGO
@@ -73,10 +113,21 @@ int UpdateSolution (const Data *d, Riemann_Solver *Riemann,
 
 /* -- Convert primitive to conservative, save initial stage  -- */
 
+  TimerStart (TIMER_PRIM_CONS);
   PrimToCons3D(d->Vc, d->Uc, grid);
-  KDOM_LOOP(k) JDOM_LOOP(j){
-    memcpy ((void *)U0[k][j][IBEG], d->Uc[k][j][IBEG], NX1*NVAR*sizeof(double));
-  }
+  TimerStop (TIMER_PRIM_CONS);
+  #if RK_FLOAT_BEG == NVAR
+   KDOM_LOOP(k) JDOM_LOOP(j){
+     memcpy ((void *)U0[k][j][IBEG], d->Uc[k][j][IBEG], NX1*NVAR*sizeof(double));
+   }
+  #else
+   DOM_LOOP(k,j,i){
+     for (nv = 0; nv < RK_FLOAT_BEG; nv++) U0[k][j][i][nv] = d->Uc[k][j][i][nv];
+     for (nv = RK_FLOAT_BEG; nv < NVAR; nv++){
+       U0f[k][j][i][nv - RK_FLOAT_BEG] = (float) d->Uc[k][j][i][nv];
+     }
+   }
+  #endif
   #ifdef STAGGERED_MHD
    DIM_LOOP(nv) TOT_LOOP(k,j,i) Bs0[nv][k][j][i] = d->Vs[nv][k][j][i];
   #endif
@@ -85,7 +136,9 @@ int UpdateSolution (const Data *d, Riemann_Solver *Riemann,
   #ifdef STAGGERED_MHD
    CT_AverageMagneticField (d->Vs, d->Uc, grid);
   #endif
+  TimerStart (TIMER_PRIM_CONS);
   ConsToPrim3D (d->Uc, d->Vc, grid);
+  TimerStop (TIMER_PRIM_CONS);
 
 /* ----------------------------------------------------
     STEP 2: Corrector (RK2, RK3)
@@ -100,12 +153,20 @@ int UpdateSolution (const Data *d, Riemann_Solver *Riemann,
       [note: done only with dimensional splitting for backward compat.] -- */
 
    #if (INTERNAL_BOUNDARY == YES) && (DIMENSIONAL_SPLITTING == YES)
+    TimerStart (TIMER_PRIM_CONS);
     PrimToCons3D (d->Vc, d->Uc, grid);
+    TimerStop (TIMER_PRIM_CONS);
    #endif   
 
    UpdateStage(d, d->Uc, NULL, Riemann, g_dt, Dts, grid);
-   DOM_LOOP(k, j, i) VAR_LOOP(nv){
-     d->Uc[k][j][i][nv] = w0*U0[k][j][i][nv] + wc*d->Uc[k][j][i][nv];
+   DOM_LOOP(k, j, i){
+     for (nv = 0; nv < RK_FLOAT_BEG; nv++){
+       d->Uc[k][j][i][nv] = w0*U0[k][j][i][nv] + wc*d->Uc[k][j][i][nv];
+     }
+     for (nv = RK_FLOAT_BEG; nv < NVAR; nv++){
+       d->Uc[k][j][i][nv] =   w0*(double)U0f[k][j][i][nv - RK_FLOAT_BEG]
+                            + wc*d->Uc[k][j][i][nv];
+     }
    }
    #ifdef STAGGERED_MHD
     DIM_LOOP(nv) TOT_LOOP(k,j,i) {
@@ -117,7 +178,9 @@ int UpdateSolution (const Data *d, Riemann_Solver *Riemann,
    #if (defined FARGO) && (TIME_STEPPING == RK2)
     FARGO_ShiftSolution (d->Uc, d->Vs, grid);
    #endif 
+   TimerStart (TIMER_PRIM_CONS);
    ConsToPrim3D (d->Uc, d->Vc, grid);
+   TimerStop (TIMER_PRIM_CONS);
 
   #endif  /* TIME_STEPPING == RK2/RK3 */
 
@@ -132,12 +195,20 @@ int UpdateSolution (const Data *d, Riemann_Solver *Riemann,
 /* -- need an extra conversion if INTERNAL_BOUNDARY is enabled -- */
 
    #if (INTERNAL_BOUNDARY == YES) && (DIMENSIONAL_SPLITTING == YES)
+    TimerStart (TIMER_PRIM_CONS);
     PrimToCons3D (d->Vc, d->Uc, grid);
+    TimerStop (TIMER_PRIM_CONS);
    #endif
 
    UpdateStage(d, d->Uc, NULL, Riemann, g_dt, Dts, grid);
-   DOM_LOOP(k,j,i) VAR_LOOP(nv){
-     d->Uc[k][j][i][nv] = one_third*(U0[k][j][i][nv] + 2.0*d->Uc[k][j][i][nv]);
+   DOM_LOOP(k,j,i){
+     for (nv = 0; nv < RK_FLOAT_BEG; nv++){
+       d->Uc[k][j][i][nv] = one_third*(U0[k][j][i][nv] + 2.0*d->Uc[k][j][i][nv]);
+     }
+     for (nv = RK_FLOAT_BEG; nv < NVAR; nv++){
+       d->Uc[k][j][i][nv] = one_third*(  (double)U0f[k][j][i][nv - RK_FLOAT_BEG]
+                                       + 2.0*d->Uc[k][j][i][nv]);
+     }
    }
    #ifdef STAGGERED_MHD
     DIM_LOOP(nv) TOT_LOOP(k,j,i){
@@ -149,7 +220,9 @@ int UpdateSolution (const Data *d, Riemann_Solver *Riemann,
    #ifdef FARGO
     FARGO_ShiftSolution (d->Uc, d->Vs, grid);
    #endif
+   TimerStart (TIMER_PRIM_CONS);
    ConsToPrim3D (d->Uc, d->Vc, grid);
+   TimerStop (TIMER_PRIM_CONS);
   #endif /* TIME_STEPPING == RK3 */
 
   #ifdef FARGO
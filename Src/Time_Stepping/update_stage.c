@@ -53,6 +53,7 @@ void UpdateStage(const Data *d, Data_Arr UU, double **aflux,
 {
   int  i, j, k;
   int  nv, dir, beg_dir, end_dir;
+  int  beg, end, tag;
   int  *ip;
   double *inv_dl, dl2;
   static double ***T, ***C_dt[NVAR], **dcoeff;
@@ -74,10 +75,12 @@ void UpdateStage(const Data *d, Data_Arr UU, double **aflux,
    -------------------------------------------------------------- */
 
   if (state.v == NULL){
+    tag = MemoryTag (MEM_SOLVER);
     MakeState (&state);
     #if (PARABOLIC_FLUX & EXPLICIT)
      dcoeff = ARRAY_2D(NMAX_POINT, NVAR, double);
     #endif
+    MemoryTag (tag);
   }
 
 /* --------------------------------------------------------------
@@ -92,9 +95,11 @@ void UpdateStage(const Data *d, Data_Arr UU, double **aflux,
 
   #if DIMENSIONAL_SPLITTING == NO
    if (C_dt[RHO] == NULL){
+     tag = MemoryTag (MEM_SOLVER);
      FOR_EACH(nv, 0, (&cdt_list)) {
        C_dt[nv] = ARRAY_3D(NX3_MAX, NX2_MAX, NX1_MAX, double);
      }
+     MemoryTag (tag);
    }
 
    if (g_intStage == 1) KTOT_LOOP(k) JTOT_LOOP(j){
@@ -137,6 +142,13 @@ void UpdateStage(const Data *d, Data_Arr UU, double **aflux,
 
     TRANSVERSE_LOOP(indx,ip,i,j,k){
       g_i = i;  g_j = j;  g_k = k;
+
+    /* -- restrict the sweep to active tiles (see activity.c) -- */
+
+      beg = indx.beg;
+      end = indx.end;
+      if (!ActivityRange (i, j, k, &beg, &end)) continue;
+
       for ((*ip) = 0; (*ip) < indx.ntot; (*ip)++) {
         VAR_LOOP(nv) state.v[(*ip)][nv] = d->Vc[nv][k][j][i];
         #ifdef STAGGERED_MHD
@@ -144,13 +156,17 @@ void UpdateStage(const Data *d, Data_Arr UU, double **aflux,
         #endif
       }
       CheckNaN (state.v, 0, indx.ntot-1,0);
-      States  (&state, indx.beg - 1, indx.end + 1, grid); 
-      Riemann (&state, indx.beg - 1, indx.end, Dts->cmax, grid);
+      TimerStart (TIMER_STATES);
+      States  (&state, beg - 1, end + 1, grid); 
+      TimerStop (TIMER_STATES);
+      TimerStart (TIMER_RIEMANN);
+      Riemann (&state, beg - 1, end, Dts->cmax, grid);
+      TimerStop (TIMER_RIEMANN);
       #ifdef STAGGERED_MHD
-       CT_StoreEMF (&state, indx.beg - 1, indx.end, grid);
+       CT_StoreEMF (&state, beg - 1, end, grid);
       #endif
       #if (PARABOLIC_FLUX & EXPLICIT)
-       ParabolicFlux(d->Vc, d->J, T, &state, dcoeff, indx.beg-1, indx.end, grid);
+       ParabolicFlux(d->Vc, d->J, T, &state, dcoeff, beg-1, end, grid);
       #endif
       #if UPDATE_VECTOR_POTENTIAL == YES
        VectorPotentialUpdate (d, NULL, &state, grid);
@@ -158,17 +174,19 @@ void UpdateStage(const Data *d, Data_Arr UU, double **aflux,
       #ifdef SHEARINGBOX
        SB_SaveFluxes (&state, grid);
       #endif
-      RightHandSide (&state, Dts, indx.beg, indx.end, dt, grid);
+      TimerStart (TIMER_RHS);
+      RightHandSide (&state, Dts, beg, end, dt, grid);
+      TimerStop (TIMER_RHS);
 
     /* -- update:  U = U + dt*R -- */
 
       #ifdef CHOMBO
-       for ((*ip) = indx.beg; (*ip) <= indx.end; (*ip)++) { 
+       for ((*ip) = beg; (*ip) <= end; (*ip)++) { 
          VAR_LOOP(nv) UU[nv][k][j][i] += state.rhs[*ip][nv];
        }
-       SaveAMRFluxes (&state, aflux, indx.beg-1, indx.end, grid);
+       SaveAMRFluxes (&state, aflux, beg-1, end, grid);
       #else
-       for ((*ip) = indx.beg; (*ip) <= indx.end; (*ip)++) { 
+       for ((*ip) = beg; (*ip) <= end; (*ip)++) { 
          VAR_LOOP(nv) UU[k][j][i][nv] += state.rhs[*ip][nv];
        }
       #endif
@@ -178,7 +196,7 @@ void UpdateStage(const Data *d, Data_Arr UU, double **aflux,
     /* -- compute inverse dt coefficients when g_intStage = 1 -- */
 
       inv_dl = GetInverse_dl(grid);
-      for ((*ip) = indx.beg; (*ip) <= indx.end; (*ip)++) { 
+      for ((*ip) = beg; (*ip) <= end; (*ip)++) { 
         #if DIMENSIONAL_SPLITTING == NO
 
          #if !GET_MAX_DT
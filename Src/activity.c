@@ -0,0 +1,335 @@
+/* ///////////////////////////////////////////////////////////////////// */
+/*!
+  \file
+  \brief Block activity tracker used to skip quiescent regions.
+
+  The global domain is covered by cubic tiles of ACTIVITY_TILE zones
+  per side. A tile is \e disturbed when one of its zones moves faster
+  than ACTIVITY_MACH times the local sound speed or carries a passive
+  scalar larger than ACTIVITY_TRC; tiles containing internal boundary
+  zones are \e pinned and remain disturbed for the rest of the run.
+  A tile is \e active when it lies within ACTIVITY_GUARD tiles of a
+  disturbed one.
+
+  ActivityUpdate() rebuilds the tile map at the beginning of every
+  step. Since inactive tiles are not evolved, they cannot become
+  disturbed on their own: only zones of active tiles (plus ghost zones,
+  which carry information from neighbouring processors and boundaries)
+  are scanned. The map is global and is shared among processors with a
+  single reduction, so it does not depend on the domain decomposition.
+
+  With mode ::ACTIVITY_SKIP, UpdateStage(), CoolingSource() and the
+  internal boundary skip inactive tiles (see ActivityRange() and
+  ActivityCell()).
+  With mode ::ACTIVITY_CHECK the full update is performed and
+  ActivityCheck() measures, after the step, the largest relative
+  change in the zones that would have been skipped; ActivityReport()
+  prints it together with the fraction of active tiles.
+
+  Fluxes through the surface between active and inactive tiles are
+  not conserved: the guard must be large enough for this to happen
+  only where the solution is in equilibrium.
+*/
+/* ///////////////////////////////////////////////////////////////////// */
+#include "pluto.h"
+
+#ifndef ACTIVITY_TILE
+ #define ACTIVITY_TILE   16    /* -- tile size (zones per side) -- */
+#endif
+#ifndef ACTIVITY_GUARD
+ #define ACTIVITY_GUARD   1    /* -- guard width (tiles) -- */
+#endif
+#ifndef ACTIVITY_MACH
+ #define ACTIVITY_MACH   1.e-3 /* -- Mach number threshold -- */
+#endif
+#ifndef ACTIVITY_TRC
+ #define ACTIVITY_TRC    1.e-8 /* -- passive scalar threshold -- */
+#endif
+
+#define TILE_DISTURBED  1
+#define TILE_PINNED     2
+#define TILE_ACTIVE     4
+
+#define TILE(tk,tj,ti)  tile[((tk)*ntile[JDIR] + (tj))*ntile[IDIR] + (ti)]
+#define CELL_TILE(k,j,i)  TILE(tloc[KDIR][k], tloc[JDIR][j], tloc[IDIR][i])
+
+static int mode;
+static int ntile[3], ntiles;
+static int *tloc[3];            /* -- tile index of each local zone -- */
+static unsigned char *tile;
+static double ****V0;           /* -- solution before the step (check mode) -- */
+static double max_change;
+
+static void ActivityLocalIndex (Grid *);
+
+/* ********************************************************************* */
+void ActivityUpdate (const Data *d, int act_mode, Grid *grid)
+/*!
+ * Rebuild the map of active tiles.
+ * Must be called before FlagReset(), so that zones tagged with
+ * FLAG_INTERNAL_BOUNDARY during the last step can pin their tiles.
+ *
+ * \param [in] d         pointer to Data structure
+ * \param [in] act_mode  ::ACTIVITY_SKIP or ::ACTIVITY_CHECK
+ * \param [in] grid      pointer to array of Grid structures
+ *
+ *********************************************************************** */
+{
+  int  i, j, k, nv, n, di, dj, dk, ti, tj, tk;
+  int  g[3];
+  static int epoch = -1;
+  double v2, cs2;
+  unsigned char *t, *buf;
+
+  mode = act_mode;
+
+/* -------------------------------------------------
+    Allocate the global tile map at the first call
+    and (re)build the local-to-tile index arrays
+    whenever the local grid changes.
+   ------------------------------------------------- */
+
+  if (tile == NULL){
+    ntiles = 1;
+    for (n = 0; n < 3; n++){
+      ntile[n] = 1;
+      if (n < DIMENSIONS) {
+        ntile[n] = (grid[n].np_int_glob + ACTIVITY_TILE - 1)/ACTIVITY_TILE;
+      }
+      ntiles *= ntile[n];
+    }
+    tile = ARRAY_1D(ntiles, unsigned char);
+
+  /* -- nothing is known yet: everything is active -- */
+
+    for (n = 0; n < ntiles; n++) tile[n] = TILE_ACTIVE;
+  }
+
+  if (epoch != g_gridEpoch){
+    ActivityLocalIndex (grid);
+    if (V0 != NULL) FreeArray4D ((void *) V0);
+    V0 = NULL;
+    epoch = g_gridEpoch;
+  }
+
+/* -------------------------------------------------
+    Tag disturbed tiles. Zones of inactive tiles
+    are not scanned, ghost zones always are.
+   ------------------------------------------------- */
+
+  buf = ARRAY_1D(ntiles, unsigned char);
+  for (n = 0; n < ntiles; n++) buf[n] = tile[n] & TILE_PINNED;
+
+  TOT_LOOP(k,j,i){
+    t = &CELL_TILE(k,j,i);
+    if (!(*t & TILE_ACTIVE)){
+      D_EXPAND(if (i < IBEG || i > IEND) goto scan;  ,
+               if (j < JBEG || j > JEND) goto scan;  ,
+               if (k < KBEG || k > KEND) goto scan;)
+      continue;
+    }
+    scan:
+    n = t - tile;
+    if (buf[n] & TILE_DISTURBED) continue;
+
+    if (d->flag[k][j][i] & FLAG_INTERNAL_BOUNDARY){
+      buf[n] |= TILE_PINNED|TILE_DISTURBED;
+      continue;
+    }
+
+    v2 = EXPAND(  d->Vc[VX1][k][j][i]*d->Vc[VX1][k][j][i],
+                + d->Vc[VX2][k][j][i]*d->Vc[VX2][k][j][i],
+                + d->Vc[VX3][k][j][i]*d->Vc[VX3][k][j][i]);
+    #if HAVE_ENERGY
+     cs2 = g_gamma*d->Vc[PRS][k][j][i]/d->Vc[RHO][k][j][i];
+    #elif EOS == ISOTHERMAL
+     cs2 = g_isoSoundSpeed*g_isoSoundSpeed;
+    #else
+     cs2 = 1.0;
+    #endif
+    if (v2 > ACTIVITY_MACH*ACTIVITY_MACH*cs2) buf[n] |= TILE_DISTURBED;
+
+    for (nv = TRC; nv < TRC + NTRACER; nv++){
+      if (fabs(d->Vc[nv][k][j][i]) > ACTIVITY_TRC) buf[n] |= TILE_DISTURBED;
+    }
+  }
+
+  #ifdef PARALLEL
+   MPI_Allreduce (buf, tile, ntiles, MPI_UNSIGNED_CHAR, MPI_BOR, AL_COMM_WORLD);
+  #else
+   for (n = 0; n < ntiles; n++) tile[n] = buf[n];
+  #endif
+  for (n = 0; n < ntiles; n++) if (tile[n] & TILE_PINNED) tile[n] |= TILE_DISTURBED;
+
+/* -------------------------------------------------
+    Active tiles: disturbed ones plus a guard
+   ------------------------------------------------- */
+
+  for (tk = 0; tk < ntile[KDIR]; tk++){
+  for (tj = 0; tj < ntile[JDIR]; tj++){
+  for (ti = 0; ti < ntile[IDIR]; ti++){
+    if (!(TILE(tk,tj,ti) & TILE_DISTURBED)) continue;
+    for (dk = -ACTIVITY_GUARD*KOFFSET; dk <= ACTIVITY_GUARD*KOFFSET; dk++){
+    for (dj = -ACTIVITY_GUARD*JOFFSET; dj <= ACTIVITY_GUARD*JOFFSET; dj++){
+    for (di = -ACTIVITY_GUARD; di <= ACTIVITY_GUARD; di++){
+      g[IDIR] = ti + di; g[JDIR] = tj + dj; g[KDIR] = tk + dk;
+      if (   g[IDIR] < 0 || g[IDIR] >= ntile[IDIR]
+          || g[JDIR] < 0 || g[JDIR] >= ntile[JDIR]
+          || g[KDIR] < 0 || g[KDIR] >= ntile[KDIR]) continue;
+      buf[(g[KDIR]*ntile[JDIR] + g[JDIR])*ntile[IDIR] + g[IDIR]] = TILE_ACTIVE;
+    }}}
+  }}}
+
+  for (n = 0; n < ntiles; n++){
+    tile[n] = (tile[n] & (TILE_PINNED|TILE_DISTURBED)) | (buf[n] & TILE_ACTIVE);
+  }
+  FreeArray1D(buf);
+
+/* -------------------------------------------------
+    Save the solution for ActivityCheck()
+   ------------------------------------------------- */
+
+  if (mode == ACTIVITY_CHECK){
+    if (V0 == NULL){
+      V0 = ARRAY_4D(NVAR, grid[KDIR].np_tot, grid[JDIR].np_tot,
+                          grid[IDIR].np_tot, double);
+    }
+    for (nv = 0; nv < NVAR; nv++) DOM_LOOP(k,j,i) V0[nv][k][j][i] = d->Vc[nv][k][j][i];
+  }
+}
+
+/* ********************************************************************* */
+int ActivityRange (int i, int j, int k, int *beg, int *end)
+/*!
+ * Restrict the range [beg, end] of a one-dimensional sweep in the
+ * direction ::g_dir to the zones lying in active tiles. The index
+ * corresponding to ::g_dir among (i, j, k) is ignored.
+ *
+ * \return 0 if the sweep does not cross any active tile, 1 otherwise.
+ *
+ *********************************************************************** */
+{
+  int n, *ip, b, e;
+
+  if (mode != ACTIVITY_SKIP) return 1;
+
+  if      (g_dir == IDIR) ip = &i;
+  else if (g_dir == JDIR) ip = &j;
+  else                    ip = &k;
+
+  for (n = *beg; n <= *end; n++){
+    *ip = n;
+    if (CELL_TILE(k,j,i) & TILE_ACTIVE) break;
+  }
+  if (n > *end) return 0;
+  b = n;
+
+  for (n = *end; n > b; n--){
+    *ip = n;
+    if (CELL_TILE(k,j,i) & TILE_ACTIVE) break;
+  }
+  e = n;
+
+  *beg = b;
+  *end = e;
+  return 1;
+}
+
+/* ********************************************************************* */
+int ActivityCell (int i, int j, int k)
+/*!
+ * Return 1 if zone (i,j,k) has to be updated, 0 if it lies in an
+ * inactive tile and can be skipped.
+ *
+ *********************************************************************** */
+{
+  if (mode != ACTIVITY_SKIP) return 1;
+  return (CELL_TILE(k,j,i) & TILE_ACTIVE) != 0;
+}
+
+/* ********************************************************************* */
+void ActivityCheck (const Data *d, Grid *grid)
+/*!
+ * Compare the solution in inactive tiles with the one saved by
+ * ActivityUpdate() before the (full) update, and keep the largest
+ * relative change of density, pressure and velocity (in units of
+ * the sound speed) until the next call to ActivityReport().
+ *
+ *********************************************************************** */
+{
+  int    i, j, k;
+  double dv, cs, scrh;
+
+  if (mode != ACTIVITY_CHECK || V0 == NULL) return;
+
+  scrh = 0.0;
+  DOM_LOOP(k,j,i){
+    if (CELL_TILE(k,j,i) & TILE_ACTIVE) continue;
+
+    scrh = MAX(scrh, fabs(d->Vc[RHO][k][j][i]/V0[RHO][k][j][i] - 1.0));
+    #if HAVE_ENERGY
+     scrh = MAX(scrh, fabs(d->Vc[PRS][k][j][i]/V0[PRS][k][j][i] - 1.0));
+     cs   = sqrt(g_gamma*V0[PRS][k][j][i]/V0[RHO][k][j][i]);
+    #elif EOS == ISOTHERMAL
+     cs   = g_isoSoundSpeed;
+    #else
+     cs   = 1.0;
+    #endif
+    dv = EXPAND(  fabs(d->Vc[VX1][k][j][i] - V0[VX1][k][j][i]),
+                + fabs(d->Vc[VX2][k][j][i] - V0[VX2][k][j][i]),
+                + fabs(d->Vc[VX3][k][j][i] - V0[VX3][k][j][i]));
+    scrh = MAX(scrh, dv/cs);
+  }
+
+  #ifdef PARALLEL
+   MPI_Allreduce (&scrh, &dv, 1, MPI_DOUBLE, MPI_MAX, AL_COMM_WORLD);
+   scrh = dv;
+  #endif
+  max_change = MAX(max_change, scrh);
+}
+
+/* ********************************************************************* */
+void ActivityReport (void)
+/*!
+ * Print the fraction of active tiles and, in check mode, the largest
+ * relative change found in inactive tiles since the last report.
+ *
+ *********************************************************************** */
+{
+  int n, nact = 0;
+
+  if (tile == NULL) return;
+  for (n = 0; n < ntiles; n++) nact += (tile[n] & TILE_ACTIVE) != 0;
+
+  print1 ("> Activity: %5.1f%% of %d tiles active", 100.0*nact/ntiles, ntiles);
+  if (mode == ACTIVITY_CHECK) {
+    print1 ("; max change in inactive tiles = %10.4e", max_change);
+    max_change = 0.0;
+  }
+  print1 ("\n");
+}
+
+/* ********************************************************************* */
+static void ActivityLocalIndex (Grid *grid)
+/*!
+ * Compute the tile index of every local zone (ghost zones included)
+ * from its global index.
+ *
+ *********************************************************************** */
+{
+  int n, m, ngh, np;
+
+  for (n = 0; n < 3; n++){
+    if (tloc[n] != NULL) FreeArray1D(tloc[n]);
+    np = grid[n].np_tot;
+    tloc[n] = ARRAY_1D(np, int);
+    ngh = grid[n].nghost;
+    for (m = 0; m < np; m++){
+      tloc[n][m] = 0;
+      if (n >= DIMENSIONS) continue;
+      tloc[n][m] = (m - grid[n].lbeg + grid[n].beg - ngh)/ACTIVITY_TILE;
+      if (m - grid[n].lbeg + grid[n].beg - ngh < 0) tloc[n][m] = 0;
+      tloc[n][m] = MIN(tloc[n][m], ntile[n] - 1);
+    }
+  }
+}
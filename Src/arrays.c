@@ -24,15 +24,108 @@
 
   The functions ArrayMap() can be used to convert a one-dimensional
   array into a 3D array.
+
+  The data area of the arrays (but not the tables of pointers) is
+  carved out of a memory arena:
+
+  - every data block is aligned to ARRAY_ALIGNMENT bytes;
+  - small blocks are packed into chunks of ARRAY_CHUNK_SIZE bytes,
+    while larger blocks get a chunk of their own. A chunk is returned
+    to the system when all of its blocks have been freed;
+  - with ARRAY_PADDING == YES the start of each block is shifted by a
+    different multiple of ARRAY_ALIGNMENT, so that arrays with the
+    same (power of two) size do not map onto the same cache sets.
+    Arrays remain contiguous, as required by the I/O and
+    communication routines;
+  - with ARRAY_HUGE_PAGES == YES, transparent huge pages are requested
+    for chunks larger than 2 Mb;
+  - when g_initThreads > 1 (-init-threads), the pages of large blocks
+    are first touched by that many threads, so that on multi-socket
+    nodes they are spread over the NUMA domains rather than all
+    placed next to the master thread.
+
+  Data areas must be released with the FreeArray functions, never
+  with free().
+
+  Every data block is charged to the subsystem selected with
+  MemoryTag() (one of the MEM_* tags) by the thread that allocates it.
+  The bytes currently in use and the peak usage of each subsystem are
+  printed by MemoryReport(), together with the total of the processes
+  running on the same node; a warning is issued when the latter
+  exceeds MEMORY_WARN_FRACTION of the physical memory.
   
   \author A. Mignone (mignone@ph.unito.it)
-  \date   Sep 18, 2012
+  \date   Oct 19, 2026
 */
 /* ///////////////////////////////////////////////////////////////////// */
 #include "pluto.h"
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
 #define NONZERO_INITIALIZE YES /* Fill arrays to nonsense values to catch
                                   uninitialized values later in the code */
 
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+ #define MAP_ANONYMOUS MAP_ANON
+#endif
+
+#define ARRAY_HUGE_PAGE   (2UL << 20)  /* Size of a transparent huge page */
+#define ARRAY_TOUCH_MIN   (1UL << 20)  /* Smallest block touched in parallel */
+#define ARRAY_COLORS      16           /* Number of different block offsets */
+
+/* -- The header of an arena chunk; it is stored at the beginning
+      of the chunk itself -- */
+
+typedef struct ARENA_CHUNK{
+  size_t size;    /* Size of the mapping in bytes */
+  size_t used;    /* Bytes handed out so far */
+  long   nlive;   /* Number of blocks not yet freed */
+} ArenaChunk;
+
+/* -- The header of a block; it is stored in the ARRAY_ALIGNMENT
+      bytes preceding the block -- */
+
+typedef struct ARENA_BLOCK{
+  ArenaChunk *chunk;  /* Chunk the block belongs to */
+  size_t size;        /* Size requested in bytes */
+  int    tag;         /* Subsystem (MEM_*) */
+} ArenaBlock;
+
+/* -- Argument of the first-touch threads -- */
+
+typedef struct ARENA_TOUCH{
+  char  *p;       /* Beginning of the block */
+  size_t nrep;    /* Number of repetitions of a slab */
+  size_t slab;    /* Size of a slab in bytes */
+  int    rank;    /* Thread number */
+  int    nthreads;
+} ArenaTouch;
+
+#if ARRAY_ALIGNMENT < 32
+ #error ARRAY_ALIGNMENT must be at least 32
+#endif
+
+static char *ArrayBlock (size_t, size_t);
+static void  ArrayBlockFree (void *);
+static void  ArrayTouch (char *, size_t, size_t);
+static void *ArrayTouchThread (void *);
+
+static ArenaChunk *arena_chunk = NULL;  /* Chunk used for small blocks */
+static int arena_color = 0;
+static pthread_mutex_t arena_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static THREAD_LOCAL int mem_tag = MEM_OTHER;  /* Tag of new blocks */
+static long int mem_used[MEM_NTAGS];    /* Bytes in use per subsystem */
+static long int mem_peak[MEM_NTAGS];    /* Peak of mem_used */
+static long int mem_peak_total;         /* Peak of g_usedMemory */
+static long int mem_mapped;             /* Bytes mapped by the arena */
+static long int mem_peak_mapped;        /* Peak of mem_mapped */
+static char *mem_name[MEM_NTAGS] = {"other", "state", "rk", "solver",
+                                    "tables", "clouds", "output",
+                                    "parallel"};
+
+static void MemoryCount (ArenaBlock *, long int);
+
 /* ********************************************************************* */
 void FreeArray1D (void *v)
 /*! 
@@ -40,7 +133,7 @@ void FreeArray1D (void *v)
  *
  *********************************************************************** */
 {
-  free ((char *)v);
+  ArrayBlockFree (v);
 }
 /* ********************************************************************* */
 void FreeArray2D (void **m)
@@ -49,7 +142,7 @@ void FreeArray2D (void **m)
  *
  *********************************************************************** */
 {
-  free ((char *) m[0]);
+  ArrayBlockFree (m[0]);
   free ((char *) m);
 }
 /* ********************************************************************* */
@@ -59,7 +152,7 @@ void FreeArray3D (void ***m)
  *
  *********************************************************************** */
 {
-  free ((char *) m[0][0]);
+  ArrayBlockFree (m[0][0]);
   free ((char *) m[0]);
   free ((char *) m);
 }
@@ -70,7 +163,7 @@ void FreeArray4D (void ****m)
  *
  *********************************************************************** */
 {
-  free ((char *) m[0][0][0]);
+  ArrayBlockFree (m[0][0][0]);
   free ((char *) m[0][0]);
   free ((char *) m[0]);
   free ((char *) m);
@@ -89,9 +182,8 @@ char *Array1D (int nx, size_t dsize)
  *********************************************************************** */
 {
   char *v;
-  v = (char *) malloc (nx*dsize);
+  v = ArrayBlock ((size_t) nx*dsize, 1);
   PlutoError (!v, "Allocation failure in Array1D");
-  g_usedMemory += nx*dsize;
 
   #if NONZERO_INITIALIZE == YES
    if (dsize==sizeof(double)){
@@ -123,12 +215,11 @@ char **Array2D (int nx, int ny, size_t dsize)
  
   m    = (char **)malloc ((size_t) nx*sizeof(char *));
   PlutoError (!m, "Allocation failure in Array2D (1)");
-  m[0] = (char *) malloc ((size_t) nx*ny*dsize);
+  m[0] = ArrayBlock ((size_t) nx*ny*dsize, 1);
   PlutoError (!m[0],"Allocation failure in Array2D (2)");
  
   for (i = 1; i < nx; i++) m[i] = m[(i - 1)] + ny*dsize;
  
-  g_usedMemory += nx*ny*dsize;
 
   #if NONZERO_INITIALIZE == YES
    if (dsize==sizeof(double)){
@@ -169,7 +260,7 @@ char ***Array3D (int nx, int ny, int nz, size_t dsize)
   m[0] = (char **) malloc ((size_t) nx*ny*sizeof(char *));
   PlutoError (!m[0],"Allocation failure in Array3D (2)");
 
-  m[0][0] = (char *) malloc ((size_t) nx*ny*nz*dsize);
+  m[0][0] = ArrayBlock ((size_t) nx*ny*nz*dsize, 1);
   PlutoError (!m[0][0],"Allocation failure in Array3D (3)");
 
 /* ---------------------------
@@ -201,7 +292,6 @@ char ***Array3D (int nx, int ny, int nz, size_t dsize)
     }
   }}
   
-  g_usedMemory += nx*ny*nz*dsize;
 
   #if NONZERO_INITIALIZE == YES
    if (dsize==sizeof(double)){
@@ -246,7 +336,7 @@ char ****Array4D (int nx, int ny, int nz, int nv, size_t dsize)
   m[0][0] = (char **) malloc ((size_t) nx*ny*nz*sizeof (char *));
   PlutoError (!m[0][0], "Allocation failure in Array4D (3)");
 
-  m[0][0][0] = (char *) malloc ((size_t) nx*ny*nz*nv*dsize);
+  m[0][0][0] = ArrayBlock ((size_t) nx*ny*nz*nv*dsize, nx);
   PlutoError (!m[0][0][0], "Allocation failure in Array4D (4)");
 
 /* ---------------------------
@@ -317,7 +407,6 @@ char ****Array4D (int nx, int ny, int nz, int nv, size_t dsize)
     }
   }
       
-  g_usedMemory += nx*ny*nz*nv*dsize;
 
   #if NONZERO_INITIALIZE == YES
    if (dsize==sizeof(double)){
@@ -381,7 +470,7 @@ double ***ArrayBox(long int nrl, long int nrh,
 
 /* allocate rows and set pointers to them */
 
-  t[nrl][ncl]=(double *) malloc((unsigned int)(nrow*ncol*ndep*sizeof(double)));
+  t[nrl][ncl]=(double *) ArrayBlock((size_t)(nrow*ncol*ndep*sizeof(double)), 1);
   if (!t[nrl][ncl]) {
     print ("! ArrayBox: allocation failure (3)\n");
     QUIT_PLUTO(1);
@@ -411,7 +500,7 @@ void FreeArrayBox(double ***t, long nrl, long ncl, long ndl)
  *
  *********************************************************************** */
 {
-  free((char *) (t[nrl][ncl]+ndl));
+  ArrayBlockFree(t[nrl][ncl]+ndl);
   free((char *) (t[nrl]+ncl));
   free((char *) (t+nrl));
 }
@@ -595,4 +684,310 @@ void FreeArrayBoxMap(double ***t, int nrl, int nrh,
   free((char*) (t+nrl));
 }
 
-    
+/* ********************************************************************* */
+static char *ArrayBlock (size_t n, size_t nrep)
+/*!
+ * Return a block of n bytes aligned to ARRAY_ALIGNMENT, taken from
+ * the arena.
+ * Blocks larger than ARRAY_CHUNK_SIZE/8 have a chunk of their own
+ * and, being fresh memory, are touched in parallel as nrep slabs
+ * (see ArrayTouch()).
+ * The ARRAY_ALIGNMENT bytes preceding the block hold its header
+ * (::ArenaBlock).
+ *
+ * \param [in] n     size of the block in bytes
+ * \param [in] nrep  number of slabs the block is made of (e.g. the
+ *                   number of variables of a 4D array)
+ *
+ * \return A pointer to the block, or NULL on failure.
+ *********************************************************************** */
+{
+  size_t head, offset, need, size;
+  char  *base, *v;
+  ArenaChunk *c;
+  ArenaBlock *b;
+
+  head   = ((sizeof(ArenaChunk) - 1)/ARRAY_ALIGNMENT + 1)*ARRAY_ALIGNMENT;
+  offset = 0;
+  pthread_mutex_lock (&arena_lock);
+  #if ARRAY_PADDING == YES
+   offset = (arena_color++ % ARRAY_COLORS)*ARRAY_ALIGNMENT;
+  #endif
+  need = ((n + offset + ARRAY_ALIGNMENT - 1)/ARRAY_ALIGNMENT + 1)*ARRAY_ALIGNMENT;
+
+/* --------------------------------------------------------
+    Small blocks: use the current chunk if there is room,
+    or start a new one. A full chunk is released by
+    ArrayBlockFree() when its last block is freed.
+   -------------------------------------------------------- */
+
+  if (need <= ARRAY_CHUNK_SIZE/8){
+    c = arena_chunk;
+    if (c == NULL || c->used + need > c->size){
+      if (c != NULL && c->nlive == 0){
+        mem_mapped -= c->size;
+        munmap ((void *) c, c->size);
+      }
+      base = (char *) mmap (NULL, ARRAY_CHUNK_SIZE, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (base == (char *) MAP_FAILED){
+        arena_chunk = NULL;
+        pthread_mutex_unlock (&arena_lock);
+        print ("! ArrayBlock: cannot allocate %ld bytes for '%s' (%.1f Mb in use)\n",
+               (long) n, mem_name[mem_tag], g_usedMemory/1.e6);
+        return NULL;
+      }
+      mem_mapped += ARRAY_CHUNK_SIZE;
+      c = arena_chunk = (ArenaChunk *) base;
+      c->size  = ARRAY_CHUNK_SIZE;
+      c->used  = head;
+      c->nlive = 0;
+    }
+    v = (char *) c + c->used + offset + ARRAY_ALIGNMENT;
+    c->used += need;
+    c->nlive++;
+    b = (ArenaBlock *) (v - ARRAY_ALIGNMENT);
+    b->chunk = c;
+    b->size  = n;
+    b->tag   = mem_tag;
+    MemoryCount (b, 1);
+    pthread_mutex_unlock (&arena_lock);
+    return v;
+  }
+  pthread_mutex_unlock (&arena_lock);
+
+/* --------------------------------------------------------
+    Large blocks: one chunk each
+   -------------------------------------------------------- */
+
+  size = head + need;
+  #if ARRAY_HUGE_PAGES == YES
+   if (size > ARRAY_HUGE_PAGE) size = ((size - 1)/ARRAY_HUGE_PAGE + 1)*ARRAY_HUGE_PAGE;
+  #endif
+  base = (char *) mmap (NULL, size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == (char *) MAP_FAILED){
+    print ("! ArrayBlock: cannot allocate %ld bytes for '%s' (%.1f Mb in use)\n",
+           (long) n, mem_name[mem_tag], g_usedMemory/1.e6);
+    return NULL;
+  }
+  #if ARRAY_HUGE_PAGES == YES && defined(MADV_HUGEPAGE)
+   if (size >= ARRAY_HUGE_PAGE) madvise ((void *) base, size, MADV_HUGEPAGE);
+  #endif
+
+  c = (ArenaChunk *) base;
+  c->size  = size;
+  c->used  = size;
+  c->nlive = 1;
+  v = base + head + offset + ARRAY_ALIGNMENT;
+  b = (ArenaBlock *) (v - ARRAY_ALIGNMENT);
+  b->chunk = c;
+  b->size  = n;
+  b->tag   = mem_tag;
+
+  pthread_mutex_lock (&arena_lock);
+  mem_mapped += size;
+  MemoryCount (b, 1);
+  pthread_mutex_unlock (&arena_lock);
+
+  if (n >= ARRAY_TOUCH_MIN) ArrayTouch (v, n, nrep);
+  return v;
+}
+
+/* ********************************************************************* */
+static void ArrayBlockFree (void *v)
+/*!
+ * Return a block obtained with ArrayBlock() to the arena, and its
+ * chunk to the system when it has no more blocks in use.
+ *
+ *********************************************************************** */
+{
+  ArenaChunk *c;
+  ArenaBlock *b;
+
+  if (v == NULL) return;
+  b = (ArenaBlock *) ((char *) v - ARRAY_ALIGNMENT);
+  c = b->chunk;
+
+  pthread_mutex_lock (&arena_lock);
+  MemoryCount (b, -1);
+  if (--c->nlive > 0){
+    pthread_mutex_unlock (&arena_lock);
+    return;
+  }
+
+/* -- the current chunk is kept and reused from the beginning -- */
+
+  if (c == arena_chunk){
+    c->used = ((sizeof(ArenaChunk) - 1)/ARRAY_ALIGNMENT + 1)*ARRAY_ALIGNMENT;
+    pthread_mutex_unlock (&arena_lock);
+    return;
+  }
+  mem_mapped -= c->size;
+  pthread_mutex_unlock (&arena_lock);
+  munmap ((void *) c, c->size);
+}
+
+/* ********************************************************************* */
+static void MemoryCount (ArenaBlock *b, long int sign)
+/*
+ * Add (sign = 1) or subtract (sign = -1) a block to the usage of
+ * its subsystem and update the peaks. Called with arena_lock held.
+ *
+ *********************************************************************** */
+{
+  mem_used[b->tag] += sign*(long int) b->size;
+  g_usedMemory     += sign*(long int) b->size;
+  if (mem_used[b->tag] > mem_peak[b->tag]) mem_peak[b->tag] = mem_used[b->tag];
+  if (g_usedMemory > mem_peak_total)       mem_peak_total   = g_usedMemory;
+  if (mem_mapped > mem_peak_mapped)        mem_peak_mapped  = mem_mapped;
+}
+
+/* ********************************************************************* */
+int MemoryTag (int tag)
+/*!
+ * Charge the arrays allocated from now on by the calling thread to
+ * the subsystem \c tag (one of the MEM_* tags).
+ * Typically used as
+ * \code
+ *   int tag = MemoryTag (MEM_STATE);
+ *   ...   allocate arrays ...
+ *   MemoryTag (tag);
+ * \endcode
+ *
+ * \return The previous tag.
+ *********************************************************************** */
+{
+  int old = mem_tag;
+
+  if (tag >= 0 && tag < MEM_NTAGS) mem_tag = tag;
+  return old;
+}
+
+/* ********************************************************************* */
+void MemoryReport (char *when)
+/*!
+ * Print the memory currently in use and the peak usage of each
+ * subsystem (maximum over the processors), and the total of the
+ * processes sharing a node compared to its physical memory.
+ * The "mapped" line gives the memory reserved by the arena, which
+ * includes the unused part of the chunks.
+ * Must be called by all processors.
+ *
+ * \param [in] when  a label for the report (e.g. "startup")
+ *********************************************************************** */
+{
+  int    n;
+  double loc[2*MEM_NTAGS + 4], max[2*MEM_NTAGS + 4];
+  double node[2], node_max[2], phys;
+
+  pthread_mutex_lock (&arena_lock);
+  for (n = 0; n < MEM_NTAGS; n++){
+    loc[2*n]     = mem_used[n]/1.e6;
+    loc[2*n + 1] = mem_peak[n]/1.e6;
+  }
+  loc[2*MEM_NTAGS]     = g_usedMemory/1.e6;
+  loc[2*MEM_NTAGS + 1] = mem_peak_total/1.e6;
+  loc[2*MEM_NTAGS + 2] = mem_mapped/1.e6;
+  loc[2*MEM_NTAGS + 3] = mem_peak_mapped/1.e6;
+  pthread_mutex_unlock (&arena_lock);
+
+  phys = (double) sysconf(_SC_PHYS_PAGES)*(double) sysconf(_SC_PAGESIZE)/1.e6;
+  node[0] = loc[2*MEM_NTAGS];
+  node[1] = loc[2*MEM_NTAGS + 1];
+
+  #ifdef PARALLEL
+  {
+    MPI_Comm node_comm;
+
+    MPI_Reduce (loc, max, 2*MEM_NTAGS + 4, MPI_DOUBLE, MPI_MAX, 0, AL_COMM_WORLD);
+    #if MPI_VERSION >= 3
+     MPI_Comm_split_type (AL_COMM_WORLD, MPI_COMM_TYPE_SHARED, prank,
+                          MPI_INFO_NULL, &node_comm);
+     MPI_Allreduce (MPI_IN_PLACE, node, 2, MPI_DOUBLE, MPI_SUM, node_comm);
+     MPI_Comm_free (&node_comm);
+    #endif
+    MPI_Reduce (node, node_max, 2, MPI_DOUBLE, MPI_MAX, 0, AL_COMM_WORLD);
+  }
+  #else
+   for (n = 0; n < 2*MEM_NTAGS + 4; n++) max[n] = loc[n];
+   node_max[0] = node[0];
+   node_max[1] = node[1];
+  #endif
+
+  print1 ("> Memory usage (%s), Mb per processor (max):\n", when);
+  print1 ("  %-10s %10s %10s\n", "", "current", "peak");
+  for (n = 0; n < MEM_NTAGS; n++){
+    if (max[2*n + 1] == 0.0) continue;
+    print1 ("  %-10s %10.2f %10.2f\n", mem_name[n], max[2*n], max[2*n + 1]);
+  }
+  print1 ("  %-10s %10.2f %10.2f\n", "total", max[2*MEM_NTAGS], max[2*MEM_NTAGS + 1]);
+  print1 ("  %-10s %10.2f %10.2f\n", "mapped", max[2*MEM_NTAGS + 2],
+                                               max[2*MEM_NTAGS + 3]);
+  print1 ("  node       %10.2f %10.2f  (of %.0f Mb)\n", node_max[0], node_max[1], phys);
+  if (phys > 0.0 && node_max[1] > MEMORY_WARN_FRACTION*phys){
+    print1 ("! MemoryReport: arrays take %.0f%% of the memory of a node\n",
+            100.0*node_max[1]/phys);
+  }
+  print1 ("\n");
+}
+
+/* ********************************************************************* */
+static void ArrayTouch (char *v, size_t n, size_t nrep)
+/*!
+ * Write zeros to the n bytes at v using g_initThreads threads, so
+ * that the operating system places each page in the NUMA domain of
+ * the thread that touches it first.
+ * The block is seen as nrep consecutive slabs (e.g. the variables
+ * of a 4D array) and thread t touches the t-th portion of each one,
+ * i.e. the same k-range of every variable.
+ *
+ *********************************************************************** */
+{
+  int t, nthreads = g_initThreads;
+  pthread_t  *tid;
+  ArenaTouch *arg;
+
+  if (nthreads <= 1) return;
+  if (nrep == 0 || n % nrep != 0) nrep = 1;
+
+  tid = (pthread_t *)  malloc (nthreads*sizeof(pthread_t));
+  arg = (ArenaTouch *) malloc (nthreads*sizeof(ArenaTouch));
+  for (t = 0; t < nthreads; t++){
+    arg[t].p    = v;
+    arg[t].nrep = nrep;
+    arg[t].slab = n/nrep;
+    arg[t].rank = t;
+    arg[t].nthreads = nthreads;
+  }
+
+  for (t = 1; t < nthreads; t++){
+    if (pthread_create (tid + t, NULL, ArrayTouchThread, arg + t) != 0) break;
+  }
+/* -- portions of threads that could not be started are
+      touched by the calling thread -- */
+
+  nthreads = t;
+  for (t = nthreads; t < arg[0].nthreads; t++) ArrayTouchThread (arg + t);
+  ArrayTouchThread (arg);
+  for (t = 1; t < nthreads; t++) pthread_join (tid[t], NULL);
+
+  free ((char *) tid);
+  free ((char *) arg);
+}
+
+/* ********************************************************************* */
+static void *ArrayTouchThread (void *arg)
+/*
+ * Touch the portion of each slab that belongs to one thread.
+ *
+ *********************************************************************** */
+{
+  size_t r, beg, end;
+  ArenaTouch *a = (ArenaTouch *) arg;
+
+  beg = a->slab*a->rank/a->nthreads;
+  end = a->slab*(a->rank + 1)/a->nthreads;
+  for (r = 0; r < a->nrep; r++) memset (a->p + r*a->slab + beg, 0, end - beg);
+  return NULL;
+}
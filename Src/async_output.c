@@ -0,0 +1,282 @@
+/* ///////////////////////////////////////////////////////////////////// */
+/*!
+  \file
+  \brief Write output files from a separate thread.
+
+  When AsyncOutputStart() has been called (\c -async-output command
+  line option), WriteData() no longer writes the output files itself:
+  the variables selected for output are copied into one of two staging
+  buffers, and the files are written by WriteDataFiles() from a
+  dedicated I/O thread while the main thread goes on with the
+  integration.
+  A new output has to wait only when both buffers are still being
+  written.
+
+  The grid indices (IBEG, NX1_TOT, ...) and the integration time are
+  private to each thread (see pluto.h): the I/O thread sets its own
+  copy to the values they had when the output was requested.
+  The Grid structures are copied into the staging buffer as well,
+  since SetJetDomain() changes their \c lend and \c rbound members;
+  the coordinate arrays they point to are shared and must not change
+  while an output is pending.
+  In parallel mode the I/O thread uses its own communicators (see
+  Parallel/al_thread.c), which requires an MPI library supporting
+  MPI_THREAD_MULTIPLE; otherwise output remains synchronous.
+
+  AsyncOutputWait() must be called before the grid changes (e.g. when
+  repartitioning) and AsyncOutputStop() before the end of the run.
+
+  \date   Oct 19, 2026
+*/
+/* ///////////////////////////////////////////////////////////////////// */
+#include "pluto.h"
+#include <pthread.h>
+
+#define NSTAGE  2
+
+typedef struct STAGE {
+  Output output;      /* copy of the output, V points to buf */
+  Grid   grid[3];     /* copy of the grid at the time of the output */
+  double ***buf[64];  /* staged variables (same size as Output.V) */
+  int    stag[64];    /* staggering of buf[nv], -2 if not allocated */
+  long int buf_tot[3]; /* NX1_TOT, NX2_TOT, NX3_TOT of buf */
+  long int beg[3], end[3], nx[3], nx_tot[3];
+  long int step;
+  double time, dt;
+} Stage;
+
+static Stage stage[NSTAGE];
+static int async_on = 0;
+static int quit;
+static int head;     /* next stage to be written */
+static int count;    /* number of stages posted and not yet written */
+static pthread_t       io_thread;
+static pthread_mutex_t io_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  io_cond = PTHREAD_COND_INITIALIZER;
+
+static void *AsyncOutputThread (void *);
+static void StageOutput (Stage *, const Data *, Output *, Grid *);
+
+/* ********************************************************************* */
+void AsyncOutputStart (void)
+/*!
+ * Start the I/O thread: from now on WriteData() is asynchronous.
+ *
+ *********************************************************************** */
+{
+  int n, nv;
+
+  if (async_on) return;
+  for (n = 0; n < NSTAGE; n++){
+    for (nv = 0; nv < 64; nv++) stage[n].stag[nv] = -2;
+  }
+  head = count = quit = 0;
+
+  if (pthread_create (&io_thread, NULL, AsyncOutputThread, NULL) != 0){
+    print1 ("! AsyncOutputStart: cannot create I/O thread, ");
+    print1 ("output will be synchronous\n");
+    return;
+  }
+  async_on = 1;
+}
+
+/* ********************************************************************* */
+int AsyncOutputPost (const Data *d, Output *output, Grid *grid)
+/*!
+ * Copy the variables of output into a free staging buffer and let
+ * the I/O thread write them. User-defined variables given as kernels
+ * are evaluated directly into the staging buffer.
+ *
+ * \return 1 if the output has been posted, 0 if output is synchronous
+ *         and has to be written by the caller.
+ *********************************************************************** */
+{
+  int n;
+
+  if (!async_on) return 0;
+
+  pthread_mutex_lock (&io_lock);
+  while (count == NSTAGE) pthread_cond_wait (&io_cond, &io_lock);
+  n = (head + count) % NSTAGE;
+  pthread_mutex_unlock (&io_lock);
+
+  StageOutput (stage + n, d, output, grid);
+
+  pthread_mutex_lock (&io_lock);
+  count++;
+  pthread_cond_broadcast (&io_cond);
+  pthread_mutex_unlock (&io_lock);
+  return 1;
+}
+
+/* ********************************************************************* */
+void AsyncOutputWait (void)
+/*!
+ * Wait until all the posted outputs have been written.
+ *
+ *********************************************************************** */
+{
+  if (!async_on) return;
+  pthread_mutex_lock (&io_lock);
+  while (count > 0) pthread_cond_wait (&io_cond, &io_lock);
+  pthread_mutex_unlock (&io_lock);
+}
+
+/* ********************************************************************* */
+void AsyncOutputStop (void)
+/*!
+ * Write the pending outputs, terminate the I/O thread and free the
+ * staging buffers.
+ *
+ *********************************************************************** */
+{
+  int n, nv, *s;
+
+  if (!async_on) return;
+
+  pthread_mutex_lock (&io_lock);
+  quit = 1;
+  pthread_cond_broadcast (&io_cond);
+  pthread_mutex_unlock (&io_lock);
+  pthread_join (io_thread, NULL);
+  async_on = 0;
+
+  for (n = 0; n < NSTAGE; n++){
+    for (nv = 0; nv < 64; nv++){
+      s = stage[n].stag + nv;
+      if (*s == -2) continue;
+      FreeArrayBox (stage[n].buf[nv], -(*s == KDIR), -(*s == JDIR),
+                                      -(*s == IDIR));
+      *s = -2;
+    }
+  }
+}
+
+/* ********************************************************************* */
+static void *AsyncOutputThread (void *arg)
+/*!
+ * Body of the I/O thread: write the posted outputs in the order they
+ * were posted until AsyncOutputStop() is called.
+ *
+ *********************************************************************** */
+{
+  Stage *s;
+
+  #ifdef PARALLEL
+   AL_Attach_io_thread ();
+  #endif
+
+  for (;;){
+    pthread_mutex_lock (&io_lock);
+    while (count == 0 && !quit) pthread_cond_wait (&io_cond, &io_lock);
+    if (count == 0){
+      pthread_mutex_unlock (&io_lock);
+      break;
+    }
+    s = stage + head;
+    pthread_mutex_unlock (&io_lock);
+
+  /* -- restore the state at the time of the output -- */
+
+    IBEG = s->beg[IDIR]; IEND = s->end[IDIR];
+    JBEG = s->beg[JDIR]; JEND = s->end[JDIR];
+    KBEG = s->beg[KDIR]; KEND = s->end[KDIR];
+    NX1  = s->nx[IDIR];  NX1_TOT = s->nx_tot[IDIR];
+    NX2  = s->nx[JDIR];  NX2_TOT = s->nx_tot[JDIR];
+    NX3  = s->nx[KDIR];  NX3_TOT = s->nx_tot[KDIR];
+    g_stepNumber = s->step;
+    g_time       = s->time;
+    g_dt         = s->dt;
+
+    WriteDataFiles (&s->output, s->grid);
+
+    pthread_mutex_lock (&io_lock);
+    head = (head + 1) % NSTAGE;
+    count--;
+    pthread_cond_broadcast (&io_cond);
+    pthread_mutex_unlock (&io_lock);
+  }
+  return NULL;
+}
+
+/* ********************************************************************* */
+static void StageOutput (Stage *s, const Data *d, Output *output, Grid *grid)
+/*!
+ * Copy output and the variables it dumps into the staging buffer s,
+ * together with the grid, the grid indices and the integration time.
+ *
+ *********************************************************************** */
+{
+  int  nv, st, lo[3], stage_var[64], tag;
+  long int size;
+
+  s->output = *output;
+  s->grid[IDIR] = grid[IDIR];
+  s->grid[JDIR] = grid[JDIR];
+  s->grid[KDIR] = grid[KDIR];
+
+/* -- grid size has changed: free all buffers -- */
+
+  if (s->buf_tot[IDIR] != NX1_TOT || s->buf_tot[JDIR] != NX2_TOT ||
+      s->buf_tot[KDIR] != NX3_TOT){
+    for (nv = 0; nv < 64; nv++){
+      st = s->stag[nv];
+      if (st == -2) continue;
+      FreeArrayBox (s->buf[nv], -(st == KDIR), -(st == JDIR), -(st == IDIR));
+      s->stag[nv] = -2;
+    }
+    s->buf_tot[IDIR] = NX1_TOT;
+    s->buf_tot[JDIR] = NX2_TOT;
+    s->buf_tot[KDIR] = NX3_TOT;
+  }
+
+/* -- select the variables being written: a VTK vector
+      also needs the components following it -- */
+
+  for (nv = 0; nv < output->nvar; nv++) stage_var[nv] = 0;
+  for (nv = 0; nv < output->nvar; nv++){
+    if (output->dump_var[nv] == VTK_VECTOR){
+      for (st = nv; st < MIN(nv + COMPONENTS, output->nvar); st++){
+        stage_var[st] = 1;
+      }
+    }else if (output->dump_var[nv]) stage_var[nv] = 1;
+  }
+
+  for (nv = 0; nv < output->nvar; nv++){
+    if (!stage_var[nv]) continue;
+
+    st = output->stag_var[nv];
+    lo[IDIR] = -(st == IDIR);
+    lo[JDIR] = -(st == JDIR);
+    lo[KDIR] = -(st == KDIR);
+    if (s->stag[nv] != st){
+      if (s->stag[nv] != -2){
+        FreeArrayBox (s->buf[nv], -(s->stag[nv] == KDIR),
+                      -(s->stag[nv] == JDIR), -(s->stag[nv] == IDIR));
+      }
+      tag = MemoryTag (MEM_OUTPUT);
+      s->buf[nv]  = ArrayBox (lo[KDIR], NX3_TOT-1, lo[JDIR], NX2_TOT-1,
+                              lo[IDIR], NX1_TOT-1);
+      MemoryTag (tag);
+      s->stag[nv] = st;
+    }
+    if (output->V[nv] == NULL){   /* -- computed on the fly -- */
+      EvalUserVar (d, nv, s->buf[nv], grid);
+    }else{
+      size = (NX3_TOT - lo[KDIR])*(NX2_TOT - lo[JDIR])*(NX1_TOT - lo[IDIR]);
+      memcpy (&s->buf[nv][lo[KDIR]][lo[JDIR]][lo[IDIR]],
+              &output->V[nv][lo[KDIR]][lo[JDIR]][lo[IDIR]], size*sizeof(double));
+    }
+    s->output.V[nv] = s->buf[nv];
+  }
+
+  s->beg[IDIR] = IBEG; s->end[IDIR] = IEND;
+  s->beg[JDIR] = JBEG; s->end[JDIR] = JEND;
+  s->beg[KDIR] = KBEG; s->end[KDIR] = KEND;
+  s->nx[IDIR]  = NX1;  s->nx_tot[IDIR] = NX1_TOT;
+  s->nx[JDIR]  = NX2;  s->nx_tot[JDIR] = NX2_TOT;
+  s->nx[KDIR]  = NX3;  s->nx_tot[KDIR] = NX3_TOT;
+  s->step = g_stepNumber;
+  s->time = g_time;
+  s->dt   = g_dt;
+}
@@ -61,7 +61,12 @@ FILE *OpenBinaryFile (char *filename, int sz, char *mode)
    ------------------------------------------------ */
   
   #ifdef PARALLEL
-   AL_File_open(filename, sz); 
+   if (strcmp(mode,"r") == 0){
+     if (AL_File_open_read(filename, sz) != AL_SUCCESS){
+       print1 ("! OpenBinaryFile: cannot open %s\n", filename);
+       QUIT_PLUTO(1);
+     }
+   }else AL_File_open(filename, sz);
    return NULL;
   #else
    if      (strcmp(mode,"w") == 0) fp = fopen(filename, "wb");
@@ -123,7 +128,7 @@ void WriteBinaryArray (void *V, size_t dsize, int sz, FILE *fl, int istag)
   char *Vc;
 
   #ifdef PARALLEL
-   MPI_Barrier (MPI_COMM_WORLD);
+   MPI_Barrier (AL_COMM_WORLD);
    AL_Write_array (V, sz, istag);
    return;
   #else
@@ -226,11 +231,21 @@ float ***Convert_dbl2flt (double ***Vdbl, double unit, int swap_endian)
  * \return a pointer to a 3D array in single precision.
  *********************************************************************** */
 {
-  int i, j, k;
+  int i, j, k, tag;
   float  flt;
   static float ***Vflt;
+  static int epoch;
   
-  if (Vflt == NULL) Vflt = ARRAY_3D(NX3_TOT, NX2_TOT, NX1_TOT, float);
+  if (Vflt != NULL && epoch != g_gridEpoch){
+    FreeArray3D ((void *) Vflt);
+    Vflt = NULL;
+  }
+  if (Vflt == NULL) {
+    tag   = MemoryTag (MEM_OUTPUT);
+    Vflt  = ARRAY_3D(NX3_TOT, NX2_TOT, NX1_TOT, float);
+    MemoryTag (tag);
+    epoch = g_gridEpoch;
+  }
 
   if (!swap_endian){
     DOM_LOOP(k,j,i){
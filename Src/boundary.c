@@ -56,18 +56,20 @@ void Boundary (const Data *d, int idim, Grid *grid)
   int  side[6] = {X1_BEG, X1_END, X2_BEG, X2_END, X3_BEG, X3_END};
   int  type[6], sbeg, send, vsign[NVAR];
   int  par_dim[3] = {0, 0, 0};
-  static int first_call = 1;
+  static int epoch = -1;
   double ***q;
   static RBox center[8], x1face[8], x2face[8], x3face[8];
 
+  TimerStart (TIMER_BOUNDARY);
+
 /* -----------------------------------------------------
      Set the boundary boxes on the six domain sides
    ----------------------------------------------------- */
 
   #ifndef CH_SPACEDIM
-  if (first_call){
+  if (epoch != g_gridEpoch){  /* -- first call or the local grid has changed -- */
     SetRBox(center, x1face, x2face, x3face);
-    first_call = 0;
+    epoch = g_gridEpoch;
   }
   #else /* -- with dynamic grids we need to re-define the RBox at each time -- */
    SetRBox(center, x1face, x2face, x3face);
@@ -101,7 +103,9 @@ void Boundary (const Data *d, int idim, Grid *grid)
    -------------------------------------------------  */
 
   #if INTERNAL_BOUNDARY == YES
+   TimerStart (TIMER_INT_BOUNDARY);
    UserDefBoundary (d, NULL, 0, grid);
+   TimerStop (TIMER_INT_BOUNDARY);
   #endif
   
 /* -------------------------------------
@@ -109,7 +113,8 @@ void Boundary (const Data *d, int idim, Grid *grid)
    ------------------------------------- */
    
   #ifdef PARALLEL
-   MPI_Barrier (MPI_COMM_WORLD);
+   TimerStart (TIMER_EXCHANGE);
+   MPI_Barrier (AL_COMM_WORLD);
    for (nv = 0; nv < NVAR; nv++) {
      AL_Exchange_dim ((char *)d->Vc[nv][0][0], par_dim, SZ);
    }
@@ -119,7 +124,8 @@ void Boundary (const Data *d, int idim, Grid *grid)
       AL_Exchange_dim ((char *)d->Vs[BX2s][0][-1]     , par_dim, SZ_stagy);  ,
       AL_Exchange_dim ((char *)d->Vs[BX3s][-1][0]     , par_dim, SZ_stagz);)
    #endif
-   MPI_Barrier (MPI_COMM_WORLD);
+   MPI_Barrier (AL_COMM_WORLD);
+   TimerStop (TIMER_EXCHANGE);
   #endif
 
 /* ----------------------------------------------------------------
@@ -309,7 +315,8 @@ void Boundary (const Data *d, int idim, Grid *grid)
   #if (SHOCK_FLATTENING == MULTID || ENTROPY_SWITCH == YES) && !(defined CHOMBO)
    if (g_intStage == 1 || g_stepNumber == 0) FlagShock (d, grid);
   #endif
-  
+
+  TimerStop (TIMER_BOUNDARY);
 }
 
 /* ********************************************************************* */
@@ -14,7 +14,7 @@ void GetRankCoordinates (int periods[3], int nprocs[3], int coords[3])
    int nprocs[3], periods[3], coords[3];
    int rank;
 
-   MPI_Comm_rank(MPI_COMM_WORLD, &prank);
+   MPI_Comm_rank(AL_COMM_WORLD, &prank);
 
    coords[0]  = coords[1]  = coords[2]  = 0;
    periods[0] = periods[1] = periods[2] = 0;
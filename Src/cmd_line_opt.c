@@ -42,6 +42,13 @@ void ParseCmdLineArgs (int argc, char *argv[], char *ini_file,
   cmd->write     = YES;
   cmd->makegrid  = NO; 
   cmd->jet       = -1; /* -- means no direction -- */
+  cmd->repart    = 0;  /* -- means no run-time repartitioning -- */
+  cmd->activity  = 0;  /* -- means all zones are updated -- */
+  cmd->ensemble  = 0;  /* -- means a single run -- */
+  cmd->node_aware = NO;
+  cmd->async_output = NO;
+  cmd->read_ahead = 0;  /* -- means default MPI-IO read buffers -- */
+  cmd->init_threads = 1;
   cmd->show_dec  = NO;
   cmd->xres      = -1; /* -- means no grid resizing -- */
 
@@ -83,6 +83,7 @@ void CoolingSource (const Data *d, double dt, Time_Step *Dts, Grid *GXYZ)
      if (d->flag[k][j][i] & FLAG_INTERNAL_BOUNDARY) continue;
     #endif
     if (d->flag[k][j][i] & FLAG_SPLIT_CELL) continue;
+    if (!ActivityCell(i,j,k)) continue;
     
   /* ----------------------------------------------
       Compute temperature and internal energy from
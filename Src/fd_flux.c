@@ -343,7 +343,7 @@ void FD_GetMaxEigenvalues (const Data *d, State_1D *state, Grid *grid)
   }
 
   #ifdef PARALLEL
-   MPI_Allreduce (state->lmax, lambda[0], NFLX, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+   MPI_Allreduce (state->lmax, lambda[0], NFLX, MPI_DOUBLE, MPI_MAX, AL_COMM_WORLD);
    for (nv = 0; nv < NFLX; nv++) state->lmax[nv] = lambda[0][nv];
   #endif
 }
@@ -36,7 +36,7 @@ void FlagReset (const Data *d)
    flag = d->flag;
    if (g_intStage == 1) TOT_LOOP(k,j,i) flag[k][j][i] = 0;
   #else
-   if (flag == NULL) flag = d->flag;
+   flag = d->flag;  /* d->flag may be re-allocated at run time */
    TOT_LOOP(k,j,i) flag[k][j][i] = 0;
   #endif
 
@@ -0,0 +1,108 @@
+/* ///////////////////////////////////////////////////////////////////// */
+/*!
+  \file
+  \brief Collect a two-dimensional plane of data on processor #0.
+
+  Each processor holds a rectangular patch of the plane (possibly
+  empty, e.g. when its sub-domain does not intersect a slice).
+  GatherPlane() gathers the patch extents and then the patches
+  themselves on processor #0, which adds them to the plane at their
+  global position.
+  Used by the image output (write_img.c) and by the in-situ slices
+  and projections of the Outflows setup.
+
+  \date   Oct 19, 2026
+*/
+/* ///////////////////////////////////////////////////////////////////// */
+#include "pluto.h"
+
+/* ********************************************************************* */
+void GatherPlane (double *patch, int nvar, int *ln, int *goff,
+                  double *plane, int *n)
+/*!
+ * Add the patches patch[nvar][ln[1]][ln[0]] of all processors,
+ * starting at the plane indices goff[0], goff[1], to
+ * plane[nvar][n[1]][n[0]] on processor #0.
+ * The plane is zeroed first; patches of different processors may
+ * overlap (e.g. projections), in which case their values are summed.
+ * Must be called by all processors; plane is used on processor #0
+ * only.
+ *
+ * \param [in]  patch  the local patch (ln[0]*ln[1]*nvar values)
+ * \param [in]  nvar   the number of variables
+ * \param [in]  ln     the number of local points in the two directions
+ * \param [in]  goff   the plane indices of the first local point
+ * \param [out] plane  the assembled plane (processor #0 only)
+ * \param [in]  n      the size of the plane in the two directions
+ *********************************************************************** */
+{
+  int  nv, m0, m1, r, nprocs;
+  int  size = n[0]*n[1];
+  int  myinfo[4], *info, *counts, *displs;
+  double *buf, *src;
+
+  if (prank == 0){
+    for (m0 = 0; m0 < nvar*size; m0++) plane[m0] = 0.0;
+  }
+
+  #ifdef PARALLEL
+   MPI_Comm_size (AL_COMM_WORLD, &nprocs);
+  #else
+   nprocs = 1;
+  #endif
+
+  myinfo[0] = goff[0];
+  myinfo[1] = ln[0];
+  myinfo[2] = goff[1];
+  myinfo[3] = ln[1];
+
+/* ------------------------------------------------
+    Gather patch sizes and offsets, then the
+    patches themselves, on proc #0
+   ------------------------------------------------ */
+
+  info = counts = displs = NULL;
+  buf  = patch;
+  if (prank == 0){
+    info   = ARRAY_1D(4*nprocs, int);
+    counts = ARRAY_1D(nprocs, int);
+    displs = ARRAY_1D(nprocs, int);
+  }
+
+  #ifdef PARALLEL
+   MPI_Gather (myinfo, 4, MPI_INT, info, 4, MPI_INT, 0, AL_COMM_WORLD);
+   if (prank == 0){
+     for (r = 0; r < nprocs; r++){
+       counts[r] = nvar*info[4*r + 1]*info[4*r + 3];
+       displs[r] = (r == 0 ? 0 : displs[r-1] + counts[r-1]);
+     }
+     buf = ARRAY_1D(MAX(displs[nprocs-1] + counts[nprocs-1], 1), double);
+   }
+   MPI_Gatherv (patch, nvar*ln[0]*ln[1], MPI_DOUBLE,
+                buf, counts, displs, MPI_DOUBLE, 0, AL_COMM_WORLD);
+  #else
+   for (r = 0; r < 4; r++) info[r] = myinfo[r];
+   displs[0] = 0;
+  #endif
+
+  if (prank != 0) return;
+
+/* ------------------------------------------------
+    Add the patches to the plane
+   ------------------------------------------------ */
+
+  for (r = 0; r < nprocs; r++){
+    src = buf + displs[r];
+    for (nv = 0; nv < nvar; nv++){
+      for (m1 = 0; m1 < info[4*r + 3]; m1++){
+      for (m0 = 0; m0 < info[4*r + 1]; m0++){
+        plane[nv*size + (info[4*r + 2] + m1)*n[0] + info[4*r] + m0] += *src++;
+      }}
+    }
+  }
+
+  if (buf != patch) FreeArray1D ((void *) buf);
+  FreeArray1D ((void *) info);
+  FreeArray1D ((void *) counts);
+  FreeArray1D ((void *) displs);
+}
@@ -32,32 +32,32 @@
 
 int prank; /**< Processor rank. In serial mode it is defined to be 0. */
 
-long int IBEG; /**< Lower grid index of the computational domain in the 
-                    the X1 direction for the local processor. */
-long int IEND; /**< Upper grid index of the computational domain in the 
-                    the X1 direction for the local processor. */
-long int JBEG; /**< Lower grid index of the computational domain in the 
-                    the X2 direction for the local processor. */
-long int JEND; /**< Upper grid index of the computational domain in the 
-                    the X2 direction for the local processor. */
-long int KBEG; /**< Lower grid index of the computational domain in the 
-                    the X3 direction for the local processor. */
-long int KEND; /**< Upper grid index of the computational domain in the 
-                    the X3 direction for the local processor. */
-
-long int NX1; /**< Number of interior zones in the X1 directions (boundaries
-                   \e excluded) for the local processor. */
-long int NX2; /**< Number of interior zones in the X2 directions (boundaries
-                   \e excluded) for the local processor. */
-long int NX3; /**< Number of interior zones in the X3 directions (boundaries
-                   \e excluded) for the local processor. */
-
-long int NX1_TOT; /**< Total number of zones in the X1 direction (boundaries
-                       \e included) for the local processor.*/
-long int NX2_TOT; /**< Total number of zones in the X2 direction (boundaries
-                       \e included) for the local processor.*/
-long int NX3_TOT; /**< Total number of zones in the X3 direction (boundaries
-                       \e included) for the local processor.*/
+THREAD_LOCAL long int IBEG; /**< Lower grid index of the computational domain in the 
+                                 the X1 direction for the local processor. */
+THREAD_LOCAL long int IEND; /**< Upper grid index of the computational domain in the 
+                                 the X1 direction for the local processor. */
+THREAD_LOCAL long int JBEG; /**< Lower grid index of the computational domain in the 
+                                 the X2 direction for the local processor. */
+THREAD_LOCAL long int JEND; /**< Upper grid index of the computational domain in the 
+                                 the X2 direction for the local processor. */
+THREAD_LOCAL long int KBEG; /**< Lower grid index of the computational domain in the 
+                                 the X3 direction for the local processor. */
+THREAD_LOCAL long int KEND; /**< Upper grid index of the computational domain in the 
+                                 the X3 direction for the local processor. */
+
+THREAD_LOCAL long int NX1; /**< Number of interior zones in the X1 directions (boundaries
+                                \e excluded) for the local processor. */
+THREAD_LOCAL long int NX2; /**< Number of interior zones in the X2 directions (boundaries
+                                \e excluded) for the local processor. */
+THREAD_LOCAL long int NX3; /**< Number of interior zones in the X3 directions (boundaries
+                                \e excluded) for the local processor. */
+
+THREAD_LOCAL long int NX1_TOT; /**< Total number of zones in the X1 direction (boundaries
+                                    \e included) for the local processor.*/
+THREAD_LOCAL long int NX2_TOT; /**< Total number of zones in the X2 direction (boundaries
+                                    \e included) for the local processor.*/
+THREAD_LOCAL long int NX3_TOT; /**< Total number of zones in the X3 direction (boundaries
+                                    \e included) for the local processor.*/
 
 long int NMAX_POINT;  /**< Maximum number of points among the three 
                            directions, boundaries \a excluded.*/
@@ -90,7 +90,14 @@ int      g_maxRiemannIter;  /**< Maximum number of iterations for
                                  iterative Riemann Solver.       */
 int      g_maxRootIter;  /**< Maximum number of iterations for root finder */
 long int g_usedMemory;   /**< Amount of used memory in bytes. */
-long int g_stepNumber;  /**< Gives the current integration step number. */
+THREAD_LOCAL long int g_stepNumber;  /**< Gives the current integration step number. */
+int      g_initThreads; /**< Number of threads that Startup() may use to
+                             assign the initial conditions and that first
+                             touch large arrays (-init-threads). */
+int      g_gridEpoch;   /**< Incremented every time the local grid size 
+                             changes at run time (e.g. after repartitioning).
+                             Static arrays sized on NX1_TOT, NX2_TOT and 
+                             NX3_TOT must be re-allocated when it changes. */
 int      g_intStage;    /**< Gives the current integration stage of the time
                              stepping method (predictor = 0, 1st
                              corrector = 1, and so on). */
@@ -116,8 +123,8 @@ double g_smallPressure = 1.e-12; /**< Small value for pressure fix. */
  double g_isoSoundSpeed = 1.0; /* g_isoSoundSpeed */
 #endif
 
-double g_time;     /**< The current integration time. */
-double g_dt;       /**< The current integration time step. */
+THREAD_LOCAL double g_time;     /**< The current integration time. */
+THREAD_LOCAL double g_dt;       /**< The current integration time step. */
 double g_maxMach;  /**< The maximum Mach number computed during integration. */
 #if ROTATING_FRAME
  double g_OmegaZ;  /**< The angular rotation frequency when rotation is
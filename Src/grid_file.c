@@ -0,0 +1,270 @@
+/* ///////////////////////////////////////////////////////////////////// */
+/*!
+  \file
+  \brief Read and write grid files.
+
+  Besides the ASCII grid file (grid.out), a compact binary grid
+  descriptor with the same name and extension ".bin" (e.g. grid.bin)
+  is written by SetGrid().
+  The binary descriptor contains, in native byte order:
+
+  - the 8-character tag "PLUTOGRD";
+  - the integers: version, 1 (used to detect the byte order),
+    dimensions, geometry and number of points in the three directions;
+  - for each direction, the left and then the right interface
+    coordinates of all the zones (double precision).
+
+  ReadGridFile() returns the content of a grid file in a ::GridFile
+  structure. When a binary descriptor not older than the ASCII file
+  is found, it is used in place of the ASCII file.
+  The last file read is kept in memory, so that subsequent calls
+  with the same name do not access the disk again.
+
+  \date   Oct 19, 2026
+*/
+/* ///////////////////////////////////////////////////////////////////// */
+#include "pluto.h"
+#include <sys/stat.h>
+
+#define GRID_FILE_TAG      "PLUTOGRD"
+#define GRID_FILE_VERSION  1
+
+static GridFile gf_cache;        /**< Last grid file read. */
+static char gf_name[512] = "";   /**< Name of the cached grid file. */
+
+static void GridFileBinaryName (char *, char *);
+static int  GridFileReadBinary (char *, GridFile *);
+static void GridFileReadASCII  (char *, GridFile *);
+
+/* ********************************************************************* */
+void WriteGridFile (char *fname, Grid *GXYZ)
+/*!
+ * Write the binary grid descriptor corresponding to the ASCII
+ * grid file \c fname (only the global interior zones are written).
+ * Should be called by one processor only.
+ *
+ * \param [in] fname  the name of the ASCII grid file
+ * \param [in] GXYZ   pointer to array of Grid structures
+ *********************************************************************** */
+{
+  int  idim, head[7];
+  char bname[512];
+  Grid *G;
+  FILE *fg;
+
+  GridFileBinaryName (fname, bname);
+  fg = fopen(bname, "wb");
+  if (fg == NULL){
+    print ("! WriteGridFile: cannot open %s\n", bname);
+    return;
+  }
+
+  head[0] = GRID_FILE_VERSION;
+  head[1] = 1;
+  head[2] = DIMENSIONS;
+  head[3] = GEOMETRY;
+  for (idim = 0; idim < 3; idim++) head[4 + idim] = GXYZ[idim].np_int_glob;
+
+  fwrite (GRID_FILE_TAG, sizeof(char), 8, fg);
+  fwrite (head, sizeof(int), 7, fg);
+  for (idim = 0; idim < 3; idim++) {
+    G = GXYZ + idim;
+    fwrite (G->xl_glob + G->gbeg, sizeof(double), G->np_int_glob, fg);
+    fwrite (G->xr_glob + G->gbeg, sizeof(double), G->np_int_glob, fg);
+  }
+  fclose(fg);
+}
+
+/* ********************************************************************* */
+GridFile *ReadGridFile (char *fname)
+/*!
+ * Read the grid file \c fname, using the binary descriptor when
+ * available.
+ * The returned structure is owned by this module and remains valid
+ * until the next call with a different file name.
+ *
+ * \param [in] fname  the name of the ASCII grid file
+ *
+ * \return A pointer to the GridFile structure.
+ *********************************************************************** */
+{
+  int    dir;
+  char   bname[512];
+  struct stat st_asc, st_bin;
+
+  if (!strcmp(fname, gf_name)) return &gf_cache;
+
+/* -- free the previously cached grid -- */
+
+  if (gf_name[0] != '\0'){
+    for (dir = 0; dir < 3; dir++){
+      FreeArray1D(gf_cache.xl[dir]);
+      FreeArray1D(gf_cache.xr[dir]);
+    }
+    gf_name[0] = '\0';
+  }
+
+/* -- prefer the binary descriptor unless it is older than fname -- */
+
+  GridFileBinaryName (fname, bname);
+  if (stat(bname, &st_bin) == 0 &&
+     (stat(fname, &st_asc) != 0 || st_bin.st_mtime >= st_asc.st_mtime) &&
+      GridFileReadBinary (bname, &gf_cache)){
+    gf_cache.binary = 1;
+  }else{
+    GridFileReadASCII (fname, &gf_cache);
+    gf_cache.binary = 0;
+  }
+
+  strncpy (gf_name, fname, sizeof(gf_name) - 1);
+  return &gf_cache;
+}
+
+/* ********************************************************************* */
+static void GridFileBinaryName (char *fname, char *bname)
+/*!
+ * Build the name of the binary descriptor by replacing the ".out"
+ * extension of \c fname with ".bin" (or by appending ".bin").
+ *********************************************************************** */
+{
+  size_t len = strlen(fname);
+
+  strcpy (bname, fname);
+  if (len > 4 && !strcmp(fname + len - 4, ".out")) bname[len - 4] = '\0';
+  strcat (bname, ".bin");
+}
+
+/* ********************************************************************* */
+static int GridFileReadBinary (char *bname, GridFile *gf)
+/*!
+ * Read a binary grid descriptor.
+ *
+ * \return 1 on success, 0 if the file could not be read (nothing is
+ *         allocated in this case).
+ *********************************************************************** */
+{
+  int    dir, i, swap, head[7];
+  char   tag[8];
+  size_t n;
+  FILE  *fg;
+
+  fg = fopen(bname, "rb");
+  if (fg == NULL) return 0;
+
+  if (fread(tag, sizeof(char), 8, fg) != 8 || strncmp(tag, GRID_FILE_TAG, 8) ||
+      fread(head, sizeof(int), 7, fg) != 7){
+    print1 ("! ReadGridFile: %s is not a valid grid file\n", bname);
+    fclose(fg);
+    return 0;
+  }
+
+  swap = (head[1] != 1);
+  if (swap) for (i = 0; i < 7; i++) SWAP_VAR(head[i]);
+  if (head[0] != GRID_FILE_VERSION || head[1] != 1){
+    print1 ("! ReadGridFile: %s has unknown version\n", bname);
+    fclose(fg);
+    return 0;
+  }
+
+  gf->dimensions = head[2];
+  gf->geometry   = head[3];
+  for (dir = 0; dir < 3; dir++){
+    gf->np[dir] = head[4 + dir];
+    gf->xl[dir] = ARRAY_1D(gf->np[dir], double);
+    gf->xr[dir] = ARRAY_1D(gf->np[dir], double);
+  }
+
+  for (dir = 0; dir < 3; dir++){
+    n  = fread(gf->xl[dir], sizeof(double), gf->np[dir], fg);
+    n += fread(gf->xr[dir], sizeof(double), gf->np[dir], fg);
+    if (n != 2*gf->np[dir]){
+      print1 ("! ReadGridFile: %s is truncated\n", bname);
+      for (dir = 0; dir < 3; dir++){
+        FreeArray1D(gf->xl[dir]);
+        FreeArray1D(gf->xr[dir]);
+      }
+      fclose(fg);
+      return 0;
+    }
+    if (swap) for (i = 0; i < gf->np[dir]; i++){
+      SWAP_VAR(gf->xl[dir][i]);
+      SWAP_VAR(gf->xr[dir][i]);
+    }
+  }
+  fclose(fg);
+  return 1;
+}
+
+/* ********************************************************************* */
+static void GridFileReadASCII (char *fname, GridFile *gf)
+/*!
+ * Read an ASCII grid file written using the PLUTO 4 grid format.
+ * Geometry and dimensions are taken from the "GEOMETRY:" and
+ * "DIMENSIONS:" tags in the header.
+ *********************************************************************** */
+{
+  int    i, ip, dir;
+  char   *sub_str, sline[512];
+  const char delimiters[] = " \t\r\f\n";
+  fpos_t file_pos;
+  FILE  *fp;
+
+  fp = fopen(fname,"r");
+  if (fp == NULL){
+    print1 ("! ReadGridFile: grid file %s not found\n",fname);
+    QUIT_PLUTO(1);
+  }
+
+/* --------------------------------------------------------
+    Scan the header for the "GEOMETRY:" and "DIMENSIONS:"
+    tags and stop at the first line not beginning with "#"
+   -------------------------------------------------------- */
+
+  gf->geometry   = -1;
+  gf->dimensions = 3;
+  for (;;){
+    fgetpos(fp, &file_pos);
+    if (fgets(sline, sizeof(sline), fp) == NULL || sline[0] != '#') break;
+    sub_str = strtok(sline, delimiters);
+    while (sub_str != NULL){
+      if (!strcmp(sub_str,"GEOMETRY:")) {
+        sub_str = strtok(NULL, delimiters);
+        if (sub_str == NULL) break;
+        if      (!strcmp(sub_str,"CARTESIAN"))   gf->geometry = CARTESIAN;
+        else if (!strcmp(sub_str,"CYLINDRICAL")) gf->geometry = CYLINDRICAL;
+        else if (!strcmp(sub_str,"POLAR"))       gf->geometry = POLAR;
+        else if (!strcmp(sub_str,"SPHERICAL"))   gf->geometry = SPHERICAL;
+        break;
+      }
+      if (!strcmp(sub_str,"DIMENSIONS:")) {
+        sub_str = strtok(NULL, delimiters);
+        if (sub_str != NULL) gf->dimensions = atoi(sub_str);
+        break;
+      }
+      sub_str = strtok(NULL, delimiters);
+    }
+  }
+  fsetpos(fp, &file_pos);
+
+  if (gf->geometry < 0){
+    print1 ("! ReadGridFile: unknown geometry in %s\n",fname);
+    QUIT_PLUTO(1);
+  }
+
+/* --------------------------------------------------------
+    Read number of points and interfaces for each direction
+   -------------------------------------------------------- */
+
+  for (dir = 0; dir < 3; dir++){
+    if (fscanf (fp,"%d \n",&gf->np[dir]) != 1){
+      print1 ("! ReadGridFile: error reading %s\n",fname);
+      QUIT_PLUTO(1);
+    }
+    gf->xl[dir] = ARRAY_1D(gf->np[dir], double);
+    gf->xr[dir] = ARRAY_1D(gf->np[dir], double);
+    for (i = 0; i < gf->np[dir]; i++){
+      fscanf(fp,"%d  %lf %lf\n", &ip, gf->xl[dir] + i, gf->xr[dir] + i);
+    }
+  }
+  fclose(fp);
+}
@@ -11,6 +11,17 @@
 
   The ReadHDF5() function allows to read double precision data 
   in serial or parrallel mode.
+
+  By default datasets are stored contiguously.
+  When the "chunked" keyword is given on the dbl.h5 or flt.h5 line of
+  pluto.ini, cell-centered variables are split in chunks as large as
+  the (largest) local domain, so that each processor writes whole
+  chunks when the decomposition is even, and the file is opened with
+  collective buffering hints and 1 MB alignment.
+  The "deflate" keyword, in addition, compresses each chunk with the
+  shuffle and deflate filters (lossless).
+  In parallel, compression requires HDF5 1.10.2 or later.
+  Compressed files are read back transparently by ReadHDF5().
   
   \note 
   By turning "MPI_POSIX" to "YES", HDF5 uses another parallel IO driver
@@ -41,6 +52,12 @@
  #define MPI_POSIX NO
 #endif
 
+#define H5_CHUNK_MAX_BYTES  (1 << 30)  /* HDF5 does not allow chunks > 4 GB */
+#define H5_DEFLATE_LEVEL    1          /* fast, yet effective on smooth data */
+
+static hid_t FileAccessList (int, size_t);
+static hid_t ChunkedCreateList (Grid **, int, size_t, size_t *);
+
 /* ********************************************************************* */
 void WriteHDF5 (Output *output, Grid *grid)
 /*!
@@ -58,6 +75,7 @@ void WriteHDF5 (Output *output, Grid *grid)
   hid_t tspace, tattr;
   hid_t file_identifier, group, timestep;
   hid_t file_access = 0;
+  hid_t dataset_create;
  #if MPI_POSIX == NO
   hid_t plist_id_mpiio = 0; /* for collective MPI I/O */
  #endif
@@ -71,19 +89,29 @@ void WriteHDF5 (Output *output, Grid *grid)
 
   time_t tbeg, tend;
   static float ****node_coords, ****cell_coords;
+  static int epoch;
   char filename[512], filenamexmf[512], tstepname[32];
   char *coords = "/cell_coords/X /cell_coords/Y /cell_coords/Z ";
   char *cname[] = {"X", "Y", "Z"};
   char xmfext[8];
   int  rank, nd, nv, ns, nc, ngh, ii, jj, kk;
-  int n1p, n2p, n3p, nprec;
+  int n1p, n2p, n3p, nprec, chunked;
+  size_t chunk_bytes;
+  double ***V;
   Grid *wgrid[3];
   FILE *fxmf;
  
 /* ----------------------------------------------------------------
-                 compute coordinates just once
+     compute coordinates just once (or whenever the local grid
+     has changed size)
    ---------------------------------------------------------------- */
 
+  if (node_coords != NULL && epoch != g_gridEpoch) {
+    FreeArray4D ((void *) node_coords);
+    FreeArray4D ((void *) cell_coords);
+    node_coords = NULL;
+  }
+
   if (node_coords == NULL) {
     double x1, x2, x3;
 
@@ -156,6 +184,7 @@ void WriteHDF5 (Output *output, Grid *grid)
       #endif
     }}}
 
+    epoch = g_gridEpoch;
   } 
 
 /* --------------------------------------------------------------
@@ -166,7 +195,7 @@ void WriteHDF5 (Output *output, Grid *grid)
   for (nd = 0; nd < DIMENSIONS; nd++) wgrid[nd] = grid + DIMENSIONS - nd - 1;
 
   #ifdef PARALLEL
-   MPI_Barrier (MPI_COMM_WORLD);
+   MPI_Barrier (AL_COMM_WORLD);
    if (prank == 0)time(&tbeg);
   #endif
 
@@ -175,18 +204,21 @@ void WriteHDF5 (Output *output, Grid *grid)
   rank   = DIMENSIONS;
   dimstr = 3;
 
-  #ifdef PARALLEL
-   file_access = H5Pcreate(H5P_FILE_ACCESS);
-   #if MPI_POSIX == YES
-    H5Pset_fapl_mpiposix(file_access, MPI_COMM_WORLD, 1); 
-   #else
-    H5Pset_fapl_mpio(file_access,  MPI_COMM_WORLD, MPI_INFO_NULL);
-   #endif
-   file_identifier = H5Fcreate(filename, H5F_ACC_TRUNC, H5P_DEFAULT, file_access);
-   H5Pclose(file_access);
-  #else
-   file_identifier = H5Fcreate(filename, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
-  #endif
+/* -- chunked / compressed layout of cell-centered data -- */
+
+  chunked = !strcmp(output->mode,"chunked") || !strcmp(output->mode,"deflate");
+  chunk_bytes = 0;
+  dataset_create = H5P_DEFAULT;
+  if (chunked){
+    dataset_create = ChunkedCreateList (wgrid, !strcmp(output->mode,"deflate"),
+                         output->type == DBL_H5_OUTPUT ? sizeof(double)
+                                                       : sizeof(float),
+                         &chunk_bytes);
+  }
+
+  file_access = FileAccessList (chunked, chunk_bytes);
+  file_identifier = H5Fcreate(filename, H5F_ACC_TRUNC, H5P_DEFAULT, file_access);
+  H5Pclose(file_access);
 
   sprintf (tstepname, "Timestep_%d", output->nfile);
   timestep = H5Gcreate(file_identifier, tstepname, 0);
@@ -249,23 +281,24 @@ void WriteHDF5 (Output *output, Grid *grid)
   /* -- skip variable if excluded from output or if it is staggered -- */
 
     if (!output->dump_var[nv] || output->stag_var[nv] != -1) continue;
+    V = GetOutputVar(output, nv, grid);
 
     if (output->type == DBL_H5_OUTPUT){
       dataset = H5Dcreate(group, output->var_name[nv], H5T_NATIVE_DOUBLE,
-                          dataspace, H5P_DEFAULT);
+                          dataspace, dataset_create);
      #if MPI_POSIX == NO
       err = H5Dwrite(dataset, H5T_NATIVE_DOUBLE, memspace, dataspace,
-                     plist_id_mpiio, output->V[nv][0][0]);
+                     plist_id_mpiio, V[0][0]);
      #else
       err = H5Dwrite(dataset, H5T_NATIVE_DOUBLE, memspace, dataspace,
-                     H5P_DEFAULT, output->V[nv][0][0]);
+                     H5P_DEFAULT, V[0][0]);
      #endif
     }else if (output->type == FLT_H5_OUTPUT){
       void *Vpt;
-      Vpt = (void *)(Convert_dbl2flt(output->V[nv],1.0, 0))[0][0];
+      Vpt = (void *)(Convert_dbl2flt(V,1.0, 0))[0][0];
 
       dataset = H5Dcreate(group, output->var_name[nv], H5T_NATIVE_FLOAT,
-                          dataspace, H5P_DEFAULT);
+                          dataspace, dataset_create);
 
      #if MPI_POSIX == NO
       err = H5Dwrite(dataset, H5T_NATIVE_FLOAT, memspace,
@@ -281,6 +314,7 @@ void WriteHDF5 (Output *output, Grid *grid)
  #if MPI_POSIX == NO
   H5Pclose(plist_id_mpiio);
  #endif
+  if (chunked) H5Pclose(dataset_create);
   H5Sclose(memspace);
   H5Sclose(dataspace);
   H5Gclose(group); /* Close group "vars" */
@@ -570,7 +604,7 @@ void WriteHDF5 (Output *output, Grid *grid)
 /* XDMF file */
 
   #ifdef PARALLEL
-   MPI_Barrier (MPI_COMM_WORLD);
+   MPI_Barrier (AL_COMM_WORLD);
    if (prank == 0){
      time(&tend);
      print1 (" [%5.2f sec]",difftime(tend,tbeg));
@@ -604,6 +638,7 @@ void ReadHDF5 (Output *output, Grid *grid)
 
   char filename[128], tstepname[32];
   int ierr, rank, nd, nv, ns;
+  size_t cache_bytes;
   Grid *wgrid[3];
 
 /* --------------------------------------------------------------
@@ -618,18 +653,15 @@ void ReadHDF5 (Output *output, Grid *grid)
 
   rank = DIMENSIONS;
 
-  #ifdef PARALLEL
-   file_access = H5Pcreate (H5P_FILE_ACCESS);
-   #if MPI_POSIX == YES
-    H5Pset_fapl_mpiposix(file_access, MPI_COMM_WORLD, 1);
-   #else
-    H5Pset_fapl_mpio(file_access,  MPI_COMM_WORLD, MPI_INFO_NULL);
-   #endif
-   file_identifier = H5Fopen(filename, H5F_ACC_RDONLY, file_access);
-   H5Pclose(file_access);
-  #else
-   file_identifier = H5Fopen(filename, H5F_ACC_RDONLY, H5P_DEFAULT);
-  #endif
+/* -- collective buffering hints and a chunk cache large enough
+      to hold the local domain of one (possibly compressed) variable -- */
+
+  cache_bytes = sizeof(double);
+  for (nd = 0; nd < DIMENSIONS; nd++) cache_bytes *= wgrid[nd]->np_int;
+
+  file_access = FileAccessList (1, cache_bytes);
+  file_identifier = H5Fopen(filename, H5F_ACC_RDONLY, file_access);
+  H5Pclose(file_access);
 
   if (file_identifier < 0){
     print1 ("! HDF5_READ: file %s does not exist\n");
@@ -651,9 +683,26 @@ void ReadHDF5 (Output *output, Grid *grid)
 
     if (!output->dump_var[nv] || output->stag_var[nv] != -1) continue;
 
+  /* -- user variables computed on the fly are not read -- */
+
+    if (output->V[nv] == NULL) continue;
+
     dataset   = H5Dopen(group, output->var_name[nv]);
     dataspace = H5Dget_space(dataset);
 
+  /* -- the file may come from a different decomposition,
+        but must have the same global size -- */
+
+    H5Sget_simple_extent_dims(dataspace, dimens, NULL);
+    for (nd = 0; nd < DIMENSIONS; nd++) {
+      if (dimens[nd] != wgrid[nd]->np_int_glob){
+        print1 ("! ReadHDF5: %s has %d zones in direction %d, %d expected\n",
+                output->var_name[nv], (int)dimens[nd], DIMENSIONS - nd,
+                wgrid[nd]->np_int_glob);
+        QUIT_PLUTO(1);
+      }
+    }
+
     #ifdef PARALLEL
      for (nd = 0; nd < DIMENSIONS; nd++) {
        start[nd]  = wgrid[nd]->beg - wgrid[nd]->nghost;
@@ -757,3 +806,114 @@ void ReadHDF5 (Output *output, Grid *grid)
   H5Gclose(timestep);
   H5Fclose(file_identifier);
 }
+
+/* ********************************************************************* */
+static hid_t FileAccessList (int tuned, size_t cache_bytes)
+/*!
+ * Create the file access property list used by WriteHDF5() and 
+ * ReadHDF5().
+ *
+ * \param [in] tuned        when 1, set collective buffering hints,
+ *                          1 MB alignment of large objects and the 
+ *                          size of the chunk cache.
+ * \param [in] cache_bytes  size of the chunk cache in bytes.
+ *
+ * \return The property list, to be closed by the caller.
+ *********************************************************************** */
+{
+  hid_t file_access;
+
+  file_access = H5Pcreate(H5P_FILE_ACCESS);
+
+  #ifdef PARALLEL
+   #if MPI_POSIX == YES
+    H5Pset_fapl_mpiposix(file_access, AL_COMM_WORLD, 1);
+   #else
+    if (tuned){
+      MPI_Info info;
+
+      MPI_Info_create (&info);
+      MPI_Info_set (info, "romio_cb_write", "enable");
+      MPI_Info_set (info, "romio_cb_read",  "enable");
+      MPI_Info_set (info, "cb_buffer_size", "16777216");
+      H5Pset_fapl_mpio(file_access, AL_COMM_WORLD, info);
+      MPI_Info_free (&info);
+    }else{
+      H5Pset_fapl_mpio(file_access, AL_COMM_WORLD, MPI_INFO_NULL);
+    }
+   #endif
+  #endif
+
+  if (tuned){
+    H5Pset_alignment(file_access, 1048576, 1048576);
+    if (cache_bytes > 1048576) {
+      H5Pset_cache(file_access, 0, 521, cache_bytes, 1.0);
+    }
+  }
+  return file_access;
+}
+
+/* ********************************************************************* */
+static hid_t ChunkedCreateList (Grid **wgrid, int deflate, size_t dsize,
+                                size_t *chunk_bytes)
+/*!
+ * Create the dataset creation property list for chunked (and
+ * optionally compressed) cell-centered data.
+ * A chunk has the size of the largest local domain (interior zones),
+ * halved along the slowest index until it fits H5_CHUNK_MAX_BYTES.
+ *
+ * \param [in]  wgrid        grid pointers in reverse (Z-Y-X) order
+ * \param [in]  deflate      when 1, enable the shuffle and deflate filters
+ * \param [in]  dsize        size of a data element in bytes
+ * \param [out] chunk_bytes  size of a chunk in bytes
+ *
+ * \return The property list, to be closed by the caller.
+ *********************************************************************** */
+{
+  int   nd, np;
+  hid_t dataset_create;
+  hsize_t chunk[DIMENSIONS];
+
+  for (nd = 0; nd < DIMENSIONS; nd++){
+    np = wgrid[nd]->np_int;
+    #ifdef PARALLEL
+     MPI_Allreduce (MPI_IN_PLACE, &np, 1, MPI_INT, MPI_MAX, AL_COMM_WORLD);
+    #endif
+    chunk[nd] = np;
+  }
+
+  for (;;){
+    *chunk_bytes = dsize;
+    for (nd = 0; nd < DIMENSIONS; nd++) *chunk_bytes *= chunk[nd];
+    if (*chunk_bytes <= H5_CHUNK_MAX_BYTES) break;
+    for (nd = 0; nd < DIMENSIONS - 1 && chunk[nd] == 1; nd++);
+    chunk[nd] = (chunk[nd] + 1)/2;
+  }
+
+  dataset_create = H5Pcreate(H5P_DATASET_CREATE);
+  H5Pset_chunk(dataset_create, DIMENSIONS, chunk);
+  H5Pset_fill_time(dataset_create, H5D_FILL_TIME_NEVER);
+
+  #if defined(PARALLEL) && !(H5_VERS_MAJOR > 1 || H5_VERS_MINOR > 10 || \
+                             (H5_VERS_MINOR == 10 && H5_VERS_RELEASE >= 2))
+   if (deflate){
+     static int first_call = 1;
+     if (first_call){
+       print1 ("! WriteHDF5: parallel compression requires HDF5 >= 1.10.2,\n");
+       print1 ("!            chunks will not be compressed\n");
+       first_call = 0;
+     }
+     deflate = 0;
+   }
+  #endif
+
+  if (deflate){
+    if (H5Zfilter_avail(H5Z_FILTER_DEFLATE) <= 0){
+      print1 ("! WriteHDF5: deflate filter not available\n");
+    }else{
+      H5Pset_shuffle(dataset_create);
+      H5Pset_deflate(dataset_create, H5_DEFLATE_LEVEL);
+    }
+  }
+  return dataset_create;
+}
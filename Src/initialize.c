@@ -32,6 +32,9 @@
 #include "pluto.h"
 
 static int GetDecompMode (Cmd_Line *cmd_line, int procs[]);
+#ifdef PARALLEL
+static void SetEnsembleMember (Cmd_Line *cmd_line, char *ini_file);
+#endif
 
 /* ********************************************************************* */
 void Initialize(int argc, char *argv[], Data *data, 
@@ -53,7 +56,7 @@ void Initialize(int argc, char *argv[], Data *data,
 {
   int  nprocs, decomp_mode;
   int  i, j, k, idim, nv;
-  int  nx, ny, nz, nghost, status;
+  int  nx, ny, nz, nghost, status, tag;
   int  gsize[DIMENSIONS], lsize[DIMENSIONS];
   int  beg[DIMENSIONS], end[DIMENSIONS];
   int  gbeg[DIMENSIONS], gend[DIMENSIONS];
@@ -79,21 +82,29 @@ void Initialize(int argc, char *argv[], Data *data,
 
   ParseCmdLineArgs (argc, argv, ini_file, cmd_line);
 
+/* -- threads used by Startup() and to first-touch the arrays -- */
+
+  g_initThreads = cmd_line->init_threads;
+
   #ifdef PARALLEL
 
+/* -- split processors among ensemble members -- */
+
+   if (cmd_line->ensemble > 0) SetEnsembleMember (cmd_line, ini_file);
+
 /* -- get number of processors -- */
 
-   MPI_Comm_size(MPI_COMM_WORLD, &nprocs);
+   MPI_Comm_size(AL_COMM_WORLD, &nprocs);
 
 /* -- read initialization file -- */
 
    if (prank == 0) Setup (input, cmd_line, ini_file);
-   MPI_Bcast (input,  sizeof (struct INPUT) , MPI_BYTE, 0, MPI_COMM_WORLD);
+   MPI_Bcast (input,  sizeof (struct INPUT) , MPI_BYTE, 0, AL_COMM_WORLD);
 
 /* -- get number of ghost zones and set periodic boundaries -- */
 
    nghost = GetNghost(input);
-   MPI_Allreduce (&nghost, &idim, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+   MPI_Allreduce (&nghost, &idim, 1, MPI_INT, MPI_MAX, AL_COMM_WORLD);
    nghost = idim;
    
    for (idim = 0; idim < DIMENSIONS; idim++) {
@@ -114,7 +125,19 @@ void Initialize(int argc, char *argv[], Data *data,
   return args: beg, end, lsize, lbeg, lend, gbeg, gend, is_gbeg, is_gend
 */
 
-   AL_Sz_init (MPI_COMM_WORLD, &SZ);
+   if (cmd_line->node_aware) AL_Set_node_aware (AL_TRUE);
+   if (cmd_line->async_output && AL_Set_io_thread (AL_TRUE) != AL_SUCCESS){
+     if (prank == 0){
+       printf ("! Initialize: MPI_THREAD_MULTIPLE not available, ");
+       printf ("output will be synchronous\n");
+     }
+     cmd_line->async_output = NO;
+   }
+   if (cmd_line->read_ahead > 0){
+     AL_Set_read_ahead ((long int)cmd_line->read_ahead*1048576);
+   }
+
+   AL_Sz_init (AL_COMM_WORLD, &SZ);
    AL_Set_type (MPI_DOUBLE, 1, SZ);
    AL_Set_dimensions (DIMENSIONS, SZ);
    AL_Set_global_dim (gsize, SZ);
@@ -123,6 +146,10 @@ void Initialize(int argc, char *argv[], Data *data,
    AL_Set_parallel_dim (pardim, SZ);
 
    AL_Decompose (SZ, procs, decomp_mode);
+
+/* -- processors may have been renumbered (node-aware mode) -- */
+
+   MPI_Comm_rank (AL_COMM_WORLD, &prank);
    AL_Get_local_dim (SZ, lsize);
    AL_Get_bounds (SZ, beg, end, ghosts, AL_C_INDEXES);
    AL_Get_lbounds (SZ, lbeg, lend, ghosts, AL_C_INDEXES);
@@ -131,7 +158,7 @@ void Initialize(int argc, char *argv[], Data *data,
 
 /* ---- float distributed array descriptor ---- */
 
-   AL_Sz_init (MPI_COMM_WORLD, &SZ_float);
+   AL_Sz_init (AL_COMM_WORLD, &SZ_float);
    AL_Set_type (MPI_FLOAT, 1, SZ_float);
    AL_Set_dimensions (DIMENSIONS, SZ_float);
    AL_Set_global_dim (gsize, SZ_float);
@@ -148,7 +175,7 @@ void Initialize(int argc, char *argv[], Data *data,
 
 /* ---- char distributed array descriptor ---- */
 
-   AL_Sz_init (MPI_COMM_WORLD, &SZ_char);
+   AL_Sz_init (AL_COMM_WORLD, &SZ_char);
    AL_Set_type (MPI_CHAR, 1, SZ_char);
    AL_Set_dimensions (DIMENSIONS, SZ_char);
    AL_Set_global_dim (gsize, SZ_char);
@@ -168,7 +195,7 @@ void Initialize(int argc, char *argv[], Data *data,
    MPI_Type_contiguous (3, MPI_FLOAT, &Float_Vect_type);
    MPI_Type_commit (&Float_Vect_type);
  
-   AL_Sz_init (MPI_COMM_WORLD, &SZ_Float_Vect);
+   AL_Sz_init (AL_COMM_WORLD, &SZ_Float_Vect);
    AL_Set_type (MPI_FLOAT, 3, SZ_Float_Vect);
    AL_Set_dimensions (DIMENSIONS, SZ_Float_Vect);
    AL_Set_global_dim (gsize, SZ_Float_Vect);
@@ -220,7 +247,7 @@ void Initialize(int argc, char *argv[], Data *data,
       periods[IDIR] = 0;
      #endif
 
-     AL_Sz_init (MPI_COMM_WORLD, &SZ_stagx);
+     AL_Sz_init (AL_COMM_WORLD, &SZ_stagx);
      AL_Set_type (MPI_DOUBLE, 1, SZ_stagx);
      AL_Set_dimensions (DIMENSIONS, SZ_stagx);
      AL_Set_global_dim (gsize, SZ_stagx);
@@ -249,7 +276,7 @@ void Initialize(int argc, char *argv[], Data *data,
      DIM_LOOP(idim) gsize[idim] = input->npoint[idim];
      gsize[JDIR] += 1;
 
-     AL_Sz_init (MPI_COMM_WORLD, &SZ_stagy);
+     AL_Sz_init (AL_COMM_WORLD, &SZ_stagy);
      AL_Set_type (MPI_DOUBLE, 1, SZ_stagy);
      AL_Set_dimensions (DIMENSIONS, SZ_stagy);
      AL_Set_global_dim (gsize, SZ_stagy);
@@ -274,7 +301,7 @@ void Initialize(int argc, char *argv[], Data *data,
      DIM_LOOP(idim) gsize[idim] = input->npoint[idim];
      gsize[KDIR] += 1;
 
-     AL_Sz_init (MPI_COMM_WORLD, &SZ_stagz);
+     AL_Sz_init (AL_COMM_WORLD, &SZ_stagz);
      AL_Set_type (MPI_DOUBLE, 1, SZ_stagz);
      AL_Set_dimensions (DIMENSIONS, SZ_stagz);
      AL_Set_global_dim (gsize, SZ_stagz);
@@ -317,6 +344,10 @@ void Initialize(int argc, char *argv[], Data *data,
                Serial Initialization
    ----------------------------------------------------- */
 
+   if (cmd_line->ensemble > 0){
+     printf ("! Initialize: -ensemble requires parallel mode\n");
+     QUIT_PLUTO(1);
+   }
    Setup (input, cmd_line, ini_file);
    nghost = GetNghost(input);
 
@@ -364,7 +395,6 @@ void Initialize(int argc, char *argv[], Data *data,
   g_time           = 0.0;
   g_maxMach        = 0.0;
   g_maxRiemannIter = 0;
-  g_usedMemory     = 0;
 
   IBEG = grid[IDIR].lbeg; IEND = grid[IDIR].lend;
   JBEG = grid[JDIR].lbeg; JEND = grid[JDIR].lend;
@@ -386,6 +416,14 @@ void Initialize(int argc, char *argv[], Data *data,
   NMAX_POINT = MAX(NX1_TOT, NX2_TOT);
   NMAX_POINT = MAX(NMAX_POINT, NX3_TOT);
 
+/* -- with run-time repartitioning a processor may later own a larger
+      portion of the domain along the jet direction: 1D buffers are 
+      sized for the whole direction -- */
+
+  if (cmd_line->jet != -1 && cmd_line->repart > 0){
+    NMAX_POINT = MAX(NMAX_POINT, grid[cmd_line->jet].np_tot_glob);
+  }
+
 /* --------------------------------------------------------------------
         FIND THE MINUM PHYSICAL CELL LENGTH IN EACH DIMENSIONS
    -------------------------------------------------------------------- */
@@ -408,7 +446,7 @@ void Initialize(int argc, char *argv[], Data *data,
   }}}
 
   #ifdef PARALLEL
-   MPI_Allreduce (dxmin, dxming, 3, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD);
+   MPI_Allreduce (dxmin, dxming, 3, MPI_DOUBLE, MPI_MIN, AL_COMM_WORLD);
    dxmin[IDIR] = dxming[IDIR];
    dxmin[JDIR] = dxming[JDIR];
    dxmin[KDIR] = dxming[KDIR];
@@ -439,6 +477,7 @@ void Initialize(int argc, char *argv[], Data *data,
    ------------------------------------------------------------ */
 
   print1 ("\n> Memory allocation\n");
+  tag = MemoryTag (MEM_STATE);
   data->Vc = ARRAY_4D(NVAR, NX3_TOT, NX2_TOT, NX1_TOT, double);
   data->Uc = ARRAY_4D(NX3_TOT, NX2_TOT, NX1_TOT, NVAR, double); 
 
@@ -463,6 +502,7 @@ void Initialize(int argc, char *argv[], Data *data,
   #endif
 
   data->flag = ARRAY_3D(NX3_TOT, NX2_TOT, NX1_TOT, unsigned char);
+  MemoryTag (tag);
 
 /* ------------------------------------------------------------
     Initialize tables needed for EOS 
@@ -508,6 +548,11 @@ void Initialize(int argc, char *argv[], Data *data,
    print1 ("\n");
   #endif   
   if (cmd_line->show_dec) ShowDomainDecomposition (nprocs, grid);
+
+  if (cmd_line->async_output){
+    print1 ("> Output files written by a separate thread\n");
+    AsyncOutputStart ();
+  }
 }
 
 #ifdef PARALLEL
@@ -560,7 +605,7 @@ int GetDecompMode (Cmd_Line *cmd_line, int procs[])
     
   /* -- check if decomposition is correct -- */
   
-    MPI_Comm_size(MPI_COMM_WORLD, &nprocs);
+    MPI_Comm_size(AL_COMM_WORLD, &nprocs);
     if (procs[IDIR]*procs[JDIR]*procs[KDIR] != nprocs){
       printf ("! The specified parallel decomposition (%d, %d, %d) is not\n",
                procs[IDIR],procs[JDIR],procs[KDIR]);
@@ -574,3 +619,54 @@ int GetDecompMode (Cmd_Line *cmd_line, int procs[])
   QUIT_PLUTO(1);
 }
 #endif
+
+#ifdef PARALLEL
+/* ********************************************************************* */
+static void SetEnsembleMember (Cmd_Line *cmd_line, char *ini_file)
+/*
+ * Split the processors into cmd_line->ensemble groups of consecutive
+ * ranks. Each group becomes an independent run: from now on
+ * AL_COMM_WORLD (and prank) refer to the group only, and the
+ * initialization file is read from the directory ens.mmmm/,
+ * where mmmm is the group number; its path must therefore be
+ * relative.
+ *
+ * \param [in]     cmd_line  pointer to the Cmd_Line structure
+ * \param [in,out] ini_file  the name of the initialization file
+ *********************************************************************** */
+{
+  int  nprocs, rank, member, n;
+  char fname[128];
+
+  MPI_Comm_size (MPI_COMM_WORLD, &nprocs);
+  MPI_Comm_rank (MPI_COMM_WORLD, &rank);
+
+  if (nprocs % cmd_line->ensemble != 0){
+    if (rank == 0) {
+      printf ("! SetEnsembleMember: %d processors cannot be split into %d groups\n",
+              nprocs, cmd_line->ensemble);
+    }
+    QUIT_PLUTO(1);
+  }
+
+  if (ini_file[0] == '/'){
+    if (rank == 0) {
+      printf ("! SetEnsembleMember: -ensemble requires a relative path for -i\n");
+    }
+    QUIT_PLUTO(1);
+  }
+
+  member = rank/(nprocs/cmd_line->ensemble);
+  AL_Split_world (member);
+  MPI_Comm_rank (AL_COMM_WORLD, &prank);
+
+  n = snprintf (fname, sizeof(fname), "ens.%04d/%s", member, ini_file);
+  if (n < 0 || n >= (int)sizeof(fname)){
+    if (rank == 0) {
+      printf ("! SetEnsembleMember: initialization file name too long\n");
+    }
+    QUIT_PLUTO(1);
+  }
+  strcpy (ini_file, fname);
+}
+#endif
@@ -65,94 +65,54 @@ void InputDataSet (char *grid_fname, int *get_var)
  * The following tasks are performed.
  *********************************************************************** */
 {
-  int    i, ip, nv, success;
-  size_t dsize, dcount;
-  char *sub_str, sline[256];
-  const char delimiters[] = " \t\r\f\n";
-  double xl, xr;
-  fpos_t file_pos;
-  FILE *fp;
+  int    i, nv;
+  char   *geom_name;
+  GridFile *gf;
 
   print1 ("> Input data:\n\n");
 
 /* --------------------------------------------------------------------- */
-/*! - Scan grid data file and try to determine the grid geometry 
-      (::id_geom). Search for tag "GEOMETRY:" and read the word that
-      follows.                                                           */
+/*! - Read the grid file (or its binary descriptor, see ReadGridFile())
+      and get the grid geometry (::id_geom).                             */
 /* --------------------------------------------------------------------- */
 
-  fp = fopen(grid_fname,"r");
-  if (fp == NULL){
-    print1 ("! InputDataSet: grid file %s not found\n",grid_fname);
-    QUIT_PLUTO(1);
-  }
-  success = 0;
-  while(!success){
-    fgets(sline,512,fp);
-    sub_str = strtok(sline, delimiters);
-    while (sub_str != NULL){
-      if (!strcmp(sub_str,"GEOMETRY:")) {
-        sub_str = strtok(NULL, delimiters);     
-        success = 1;
-        break;
-      }
-      sub_str = strtok(NULL, delimiters);     
-    }  
-  }
-  
-  if      (!strcmp(sub_str,"CARTESIAN"))   id_geom = CARTESIAN;
-  else if (!strcmp(sub_str,"CYLINDRICAL")) id_geom = CYLINDRICAL;
-  else if (!strcmp(sub_str,"POLAR"))       id_geom = POLAR;
-  else if (!strcmp(sub_str,"SPHERICAL"))   id_geom = SPHERICAL;
+  gf = ReadGridFile (grid_fname);
+  id_geom = gf->geometry;
+
+  if      (id_geom == CARTESIAN)   geom_name = "CARTESIAN";
+  else if (id_geom == CYLINDRICAL) geom_name = "CYLINDRICAL";
+  else if (id_geom == POLAR)       geom_name = "POLAR";
+  else if (id_geom == SPHERICAL)   geom_name = "SPHERICAL";
   else{
     print1 ("! InputDataSet: unknown geometry\n");
     QUIT_PLUTO(1);
   }
-    
-  print1 ("  Input grid file:       %s\n", grid_fname);
-  print1 ("  Input grid geometry:   %s\n", sub_str);
-
-/* --------------------------------------------------------------------- */
-/*! - Move file pointer until the first line that does not
-      begin with a "#".                                                  */
-/* --------------------------------------------------------------------- */
-
-  success = 0;
-  while(!success){
-    fgetpos(fp, &file_pos);
-    fgets(sline,512,fp);
-    if (sline[0] != '#') success = 1;
-  }
-
-  fsetpos(fp, &file_pos);
   
+  print1 ("  Input grid file:       %s%s\n", grid_fname,
+           gf->binary ? " (binary)":"");
+  print1 ("  Input grid geometry:   %s\n", geom_name);
+
 /* --------------------------------------------------------------------- */
-/*! - Start reading number of points and grid coordinates. For the
-      input x1 direction these are stored inside the module variables
+/*! - Compute the zone centers of the input grid. For the input x1
+      direction these are stored inside the module variables
       ::id_nx1 and ::id_x1.                                              */
 /* --------------------------------------------------------------------- */
    
-  fscanf (fp,"%d \n",&id_nx1);
-  id_x1 = ARRAY_1D(id_nx1, double);
-  for (i = 0; i < id_nx1; i++){
-    fscanf(fp,"%d  %lf %lf\n", &ip, &xl, &xr);
-    id_x1[i] = 0.5*(xl + xr);
-  }
+  if (id_x1 != NULL) FreeArray1D(id_x1);
+  if (id_x2 != NULL) FreeArray1D(id_x2);
+  if (id_x3 != NULL) FreeArray1D(id_x3);
 
-  fscanf (fp,"%d \n",&id_nx2);
-  id_x2 = ARRAY_1D(id_nx2, double);
-  for (i = 0; i < id_nx2; i++){
-    fscanf(fp,"%d  %lf %lf\n", &ip, &xl, &xr);
-    id_x2[i] = 0.5*(xl + xr);
-  }
+  id_nx1 = gf->np[IDIR];
+  id_x1  = ARRAY_1D(id_nx1, double);
+  for (i = 0; i < id_nx1; i++) id_x1[i] = 0.5*(gf->xl[IDIR][i] + gf->xr[IDIR][i]);
 
-  fscanf (fp,"%d \n",&id_nx3);
-  id_x3 = ARRAY_1D(id_nx3, double);
-  for (i = 0; i < id_nx3; i++){
-    fscanf(fp,"%d  %lf %lf\n", &ip, &xl, &xr);
-    id_x3[i] = 0.5*(xl + xr);
-  }
-  fclose(fp);
+  id_nx2 = gf->np[JDIR];
+  id_x2  = ARRAY_1D(id_nx2, double);
+  for (i = 0; i < id_nx2; i++) id_x2[i] = 0.5*(gf->xl[JDIR][i] + gf->xr[JDIR][i]);
+
+  id_nx3 = gf->np[KDIR];
+  id_x3  = ARRAY_1D(id_nx3, double);
+  for (i = 0; i < id_nx3; i++) id_x3[i] = 0.5*(gf->xl[KDIR][i] + gf->xr[KDIR][i]);
 
 /* -- reset grid with 1 point -- */
 
@@ -489,9 +449,7 @@ void InputDataFree (void)
 {
   int nv;
   for (nv = 0; nv < id_nvar; nv++){
-    free ((char *) Vin[nv][0][0]);    
-    free ((char *) Vin[nv][0]);
-    free ((char *) Vin[nv]);
+    FreeArray3D ((void *) Vin[nv]);
   }
 }
 
@@ -84,7 +84,7 @@ void SetJetDomain (const Data *d, int dir, int log_freq, Grid *grid)
   if (n > NEND)       n = NEND;
 
   #ifdef PARALLEL
-   MPI_Allreduce (&n, &n_glob, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+   MPI_Allreduce (&n, &n_glob, 1, MPI_INT, MPI_MAX, AL_COMM_WORLD);
    n = n_glob;
   #endif
 
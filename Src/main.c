@@ -84,10 +84,11 @@ int main (int argc, char *argv[])
 
   #ifdef PARALLEL
    AL_Init (&argc, &argv);
-   MPI_Comm_rank (MPI_COMM_WORLD, &prank);
+   MPI_Comm_rank (AL_COMM_WORLD, &prank);
   #endif
 
   Initialize (argc, argv, &data, &ini, grd, &cmd_line);
+  MemoryReport ("startup");
 
   double *dbl_pnt;
   int    *int_pnt;
@@ -190,6 +191,7 @@ int main (int argc, char *argv[])
        print1 (", Nrkc = %d",Dts.Nrkc);
       #endif
       print1 ("]\n");      
+      TimerReport ();
     }
 
   /* ------------------------------------------------------
@@ -207,7 +209,9 @@ int main (int argc, char *argv[])
      ------------------------------------------------------ */
 
     if (cmd_line.jet != -1) SetJetDomain (&data, cmd_line.jet, ini.log_freq, grd); 
+    TimerStart (TIMER_STEP);
     err = Integrate (&data, Solver, &Dts, grd);
+    TimerStop (TIMER_STEP);
     if (cmd_line.jet != -1) UnsetJetDomain (&data, cmd_line.jet, grd); 
 
   /* ------------------------------------------------------
@@ -241,13 +245,13 @@ int main (int argc, char *argv[])
        dtp = 0.5/Dts.inv_dtp;
        dtc = Dts.dt_cool;
        #ifdef PARALLEL
-        MPI_Allreduce (&dta, &cg, 1, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD);
+        MPI_Allreduce (&dta, &cg, 1, MPI_DOUBLE, MPI_MIN, AL_COMM_WORLD);
         dta = cg;
 
-        MPI_Allreduce (&dtp, &cg, 1, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD);
+        MPI_Allreduce (&dtp, &cg, 1, MPI_DOUBLE, MPI_MIN, AL_COMM_WORLD);
         dtp = cg;
 
-        MPI_Allreduce (&dtc, &cg, 1, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD);
+        MPI_Allreduce (&dtc, &cg, 1, MPI_DOUBLE, MPI_MIN, AL_COMM_WORLD);
         dtc = cg;
        #endif
        /*
@@ -278,14 +282,15 @@ int main (int argc, char *argv[])
   
     #ifdef PARALLEL
      MPI_Allreduce (&g_maxMach, &scrh, 1, 
-                    MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+                    MPI_DOUBLE, MPI_MAX, AL_COMM_WORLD);
      g_maxMach = scrh;
 
-     MPI_Allreduce (&g_maxRiemannIter, &nv, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+     MPI_Allreduce (&g_maxRiemannIter, &nv, 1, MPI_INT, MPI_MAX, AL_COMM_WORLD);
      g_maxRiemannIter = nv;
     #endif
 
     g_stepNumber++;
+    if (first_step) MemoryReport ("first step");
     
     first_step = 0;
   }
@@ -329,13 +334,13 @@ int main (int argc, char *argv[])
        dtp = 0.5/Dts.inv_dtp;
        dtc = Dts.dt_cool;
        #ifdef PARALLEL
-        MPI_Allreduce (&dta, &cg, 1, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD);
+        MPI_Allreduce (&dta, &cg, 1, MPI_DOUBLE, MPI_MIN, AL_COMM_WORLD);
         dta = cg;
 
-        MPI_Allreduce (&dtp, &cg, 1, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD);
+        MPI_Allreduce (&dtp, &cg, 1, MPI_DOUBLE, MPI_MIN, AL_COMM_WORLD);
         dtp = cg;
 
-        MPI_Allreduce (&dtc, &cg, 1, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD);
+        MPI_Allreduce (&dtc, &cg, 1, MPI_DOUBLE, MPI_MIN, AL_COMM_WORLD);
         dtc = cg;
        #endif
        print1 ("\t[dt/dta = %10.4e, dt/dtp = %10.4e, dt/dtc = %10.4e \n",
@@ -349,10 +354,10 @@ int main (int argc, char *argv[])
   
     #ifdef PARALLEL
      MPI_Allreduce (&g_maxMach, &scrh, 1, 
-                    MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+                    MPI_DOUBLE, MPI_MAX, AL_COMM_WORLD);
      g_maxMach = scrh;
 
-     MPI_Allreduce (&g_maxRiemannIter, &nv, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+     MPI_Allreduce (&g_maxRiemannIter, &nv, 1, MPI_INT, MPI_MAX, AL_COMM_WORLD);
      g_maxRiemannIter = nv;
     #endif
 
@@ -379,6 +384,7 @@ int main (int argc, char *argv[])
        print1 (", Nrkc = %d",Dts.Nrkc);
       #endif
       print1 ("]\n");      
+      TimerReport ();
     }
     
   /* ------------------------------------------------------
@@ -387,7 +393,9 @@ int main (int argc, char *argv[])
      ------------------------------------------------------ */
 
     if (cmd_line.jet != -1) SetJetDomain (&data, cmd_line.jet, ini.log_freq, grd); 
+    TimerStart (TIMER_STEP);
     err = Integrate (&data, Solver, &Dts, grd);
+    TimerStop (TIMER_STEP);
     if (cmd_line.jet != -1) UnsetJetDomain (&data, cmd_line.jet, grd); 
 
   /* ------------------------------------------------------
@@ -414,6 +422,7 @@ int main (int argc, char *argv[])
 
     g_dt = NextTimeStep(&Dts, &ini, grd);
     g_stepNumber++;
+    if (first_step) MemoryReport ("first step");
     first_step = 0;
   }
 #endif /* USE_ASYNC_IO */
@@ -429,15 +438,11 @@ int main (int argc, char *argv[])
      Async_EndWriteData (&ini);
     #endif
   }
+  AsyncOutputStop ();
 
-  #ifdef PARALLEL
-   MPI_Barrier (MPI_COMM_WORLD);
-   print1  ("\n> Total allocated memory  %6.2f Mb (proc #%d)\n",
-             (float)g_usedMemory/1.e6,prank);
-   MPI_Barrier (MPI_COMM_WORLD);
-  #else
-   print1  ("\n> Total allocated memory  %6.2f Mb\n",(float)g_usedMemory/1.e6);
-  #endif
+  print1 ("\n");
+  MemoryReport ("end");
+  TimerDump (ini.output_dir);
 
   time(&tend);
   g_dt = difftime(tend, tbeg);
@@ -449,7 +454,7 @@ int main (int argc, char *argv[])
 
   FreeArray4D ((void *) data.Vc);
   #ifdef PARALLEL
-   MPI_Barrier (MPI_COMM_WORLD);
+   MPI_Barrier (AL_COMM_WORLD);
    AL_Finalize ();
   #endif
 
@@ -505,10 +510,14 @@ int Integrate (Data *d, Riemann_Solver *Solver, Time_Step *Dts, Grid *grid)
      if (UpdateSolution (d, Solver, Dts, grid) != 0) return(1);
     #endif
     g_operatorStep = PARABOLIC_STEP;
+    TimerStart (TIMER_SOURCE);
     SplitSource (d, g_dt, Dts, grid);
+    TimerStop (TIMER_SOURCE);
   }else{
     g_operatorStep = PARABOLIC_STEP;
+    TimerStart (TIMER_SOURCE);
     SplitSource (d, g_dt, Dts, grid);
+    TimerStop (TIMER_SOURCE);
     g_operatorStep = HYPERBOLIC_STEP;
     #if DIMENSIONAL_SPLITTING == YES
      for (g_dir = DIMENSIONS - 1; g_dir >= 0; g_dir--){
@@ -572,16 +581,16 @@ double NextTimeStep (Time_Step *Dts, struct INPUT *ini, Grid *grid)
 
   #ifdef PARALLEL
    xloc = Dts->inv_dta;
-   MPI_Allreduce (&xloc, &xglob, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+   MPI_Allreduce (&xloc, &xglob, 1, MPI_DOUBLE, MPI_MAX, AL_COMM_WORLD);
    Dts->inv_dta = xglob;
    #if (PARABOLIC_FLUX != NO)
     xloc = Dts->inv_dtp;
-    MPI_Allreduce (&xloc, &xglob, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    MPI_Allreduce (&xloc, &xglob, 1, MPI_DOUBLE, MPI_MAX, AL_COMM_WORLD);
     Dts->inv_dtp = xglob;
    #endif
    #if COOLING != NO
     xloc = Dts->dt_cool;
-    MPI_Allreduce (&xloc, &xglob, 1, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD);
+    MPI_Allreduce (&xloc, &xglob, 1, MPI_DOUBLE, MPI_MIN, AL_COMM_WORLD);
     Dts->dt_cool = xglob;
    #endif
   #endif
@@ -669,7 +678,7 @@ void CheckForOutput (Data *d, Input *ini, Grid *grid)
 {
   static int first_call = 1;
   int  n, check_dt, check_dn, check_dclock;
-  int  restart_update, last_step;
+  int  restart_update, last_step, written = 0;
   double t, tnext;
   Output *output;
   static time_t clock_beg[MAX_OUTPUT_TYPES], clock_end;
@@ -692,7 +701,7 @@ void CheckForOutput (Data *d, Input *ini, Grid *grid)
        tstart = MPI_Wtime();
        for (n = 0; n < MAX_OUTPUT_TYPES; n++) tbeg[n] = tstart;
      }
-     MPI_Bcast(tbeg, MAX_OUTPUT_TYPES, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+     MPI_Bcast(tbeg, MAX_OUTPUT_TYPES, MPI_DOUBLE, 0, AL_COMM_WORLD);
     #else
      for (n = 0; n < MAX_OUTPUT_TYPES; n++) time(clock_beg + n);
     #endif
@@ -702,7 +711,7 @@ void CheckForOutput (Data *d, Input *ini, Grid *grid)
 
   #ifdef PARALLEL  
    if (prank == 0) tend = MPI_Wtime();
-   MPI_Bcast(&tend, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+   MPI_Bcast(&tend, 1, MPI_DOUBLE, 0, AL_COMM_WORLD);
   #else
    time(&clock_end);
   #endif
@@ -754,6 +763,7 @@ void CheckForOutput (Data *d, Input *ini, Grid *grid)
 
     if (check_dt || check_dn || check_dclock) { 
 
+      TimerStart (TIMER_OUTPUT);
       #ifdef USE_ASYNC_IO
        if (!strcmp(output->mode,"single_file_async")){
          Async_BegWriteData (d, output, grid);
@@ -763,6 +773,8 @@ void CheckForOutput (Data *d, Input *ini, Grid *grid)
       #else     
        WriteData(d, output, grid);
       #endif   
+      TimerStop (TIMER_OUTPUT);
+      written = 1;
 
     /* ----------------------------------------------------------
         save the file number of the dbl and dbl.h5 output format
@@ -782,6 +794,7 @@ void CheckForOutput (Data *d, Input *ini, Grid *grid)
    ------------------------------------------------------- */
 
   if (restart_update) RestartDump (ini);
+  if (written) MemoryReport ("output");
 
   first_call = 0;
 }
@@ -808,5 +821,9 @@ void CheckForAnalysis (Data *d, Input *ini, Grid *grid)
   check_dn = (g_stepNumber%ini->anl_dn) == 0;
   check_dn = check_dn && (ini->anl_dn > 0);
 
-  if (check_dt || check_dn) Analysis (d, grid);
+  if (check_dt || check_dn) {
+    TimerStart (TIMER_ANALYSIS);
+    Analysis (d, grid);
+    TimerStop (TIMER_ANALYSIS);
+  }
 }
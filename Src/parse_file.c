@@ -181,6 +181,33 @@ int ParamExist (const char *label)
   return (0);
 }
 
+/* ********************************************************************* */
+int ParamFileNWords (const char *label)
+/*!
+ * Return the number of words following label on the line beginning
+ * with label, up to the end of the line or to a comment.
+ *
+ * \param [in]  label  the first word of the line to be searched
+ * \return the number of words after label, -1 if label cannot be found.
+ *********************************************************************** */
+{
+  int         k, nwords, nw;
+  static char **words;
+
+  if (words == NULL) words = ARRAY_2D(128,128,char);
+
+  for (k = 0; k < nlines; k++) {
+    nwords = ParamFileGetWords(fline[k],words);
+    if (nwords > 0 && strcmp(words[0],label) == 0){
+      for (nw = 1; nw < nwords; nw++){
+        if (words[nw][0] == '#') break;
+      }
+      return nw - 1;
+    }
+  }
+  return -1;
+}
+
 /* ********************************************************************* */
 int ParamFileGetWords(char *line, char **words)
 /*!
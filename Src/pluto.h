@@ -77,6 +77,8 @@
 #define TAB_OUTPUT      6
 #define PPM_OUTPUT      7
 #define PNG_OUTPUT      8
+#define CMP_OUTPUT      9
+#define PVTK_OUTPUT    10
 
 #define VTK_VECTOR  5  /* -- any number but NOT 1  -- */
 
@@ -178,6 +180,9 @@
 #define ENG_FAIL  2
 #define RHO_FAIL  4
 
+#define ACTIVITY_SKIP   1  /* -- skip inactive tiles (see activity.c) -- */
+#define ACTIVITY_CHECK  2  /* -- update all, measure change in inactive tiles -- */
+
 #define IDIR     0     /*   This sequence (0,1,2) should */
 #define JDIR     1     /*   never be changed             */
 #define KDIR     2     /*                                */
@@ -331,6 +336,67 @@
 #define ROTATING_FRAME NO
 #endif
 
+/* -- memory arena used by the array allocation functions (arrays.c) -- */
+
+#ifndef ARRAY_ALIGNMENT
+#define ARRAY_ALIGNMENT  64  /**< Alignment in bytes of the array data. */
+#endif
+
+#ifndef ARRAY_PADDING
+#define ARRAY_PADDING  YES   /**< Stagger the array data over the cache sets. */
+#endif
+
+#ifndef ARRAY_HUGE_PAGES
+#define ARRAY_HUGE_PAGES  NO  /**< Request transparent huge pages. */
+#endif
+
+#ifndef ARRAY_CHUNK_SIZE
+#define ARRAY_CHUNK_SIZE  (8UL << 20)  /**< Arena chunk for small arrays. */
+#endif
+
+/* -- conservative variables nv >= RK_FLOAT_BEG saved at the beginning
+      of a Runge-Kutta step are stored in single precision (e.g. TRC for
+      the passive tracers only); see rk_update.c.
+      RK_FLOAT_BEG must be larger than ENG: the pressure of a Mach >> 1
+      flow is a small difference between total and kinetic energy -- */
+
+#ifndef RK_FLOAT_BEG
+#define RK_FLOAT_BEG  NVAR
+#endif
+
+/* -- subsystems the allocated memory is charged to (see MemoryTag()) -- */
+
+#define MEM_OTHER     0
+#define MEM_STATE     1  /**< Solution arrays (Vc, Uc, Vs, ...). */
+#define MEM_RK        2  /**< Runge-Kutta step storage. */
+#define MEM_SOLVER    3  /**< Work arrays of the solver. */
+#define MEM_TABLES    4  /**< Cooling and other tables. */
+#define MEM_CLOUDS    5  /**< Cloud cubes and fractal fields. */
+#define MEM_OUTPUT    6  /**< Output buffers. */
+#define MEM_PARALLEL  7  /**< Communication buffers. */
+#define MEM_NTAGS     8
+
+#ifndef MEMORY_WARN_FRACTION
+#define MEMORY_WARN_FRACTION  0.9  /**< Warn above this fraction of the
+                                        physical memory of a node. */
+#endif
+
+/* -- phases of the integrator measured with TimerStart() and
+      TimerStop() (see timer.c) -- */
+
+#define TIMER_STEP          0   /**< Integration step. */
+#define TIMER_BOUNDARY      1   /**< Boundary(). */
+#define TIMER_EXCHANGE      2   /**< Ghost zone exchange. */
+#define TIMER_INT_BOUNDARY  3   /**< Internal boundary. */
+#define TIMER_STATES        4   /**< States(). */
+#define TIMER_RIEMANN       5   /**< Riemann solver. */
+#define TIMER_RHS           6   /**< RightHandSide(). */
+#define TIMER_PRIM_CONS     7   /**< PrimToCons3D() and ConsToPrim3D(). */
+#define TIMER_SOURCE        8   /**< SplitSource() (e.g. cooling). */
+#define TIMER_OUTPUT        9   /**< Output. */
+#define TIMER_ANALYSIS     10   /**< Analysis(). */
+#define TIMER_NTIMERS      11
+
 #ifdef CH_SPACEDIM
 #define CHOMBO  1
 
@@ -451,6 +517,8 @@ typedef void Limiter(double *, double *, double *, int, int, Grid *);
 
 typedef double Reconstruct(double *, double, int);
 
+typedef double User_Var_Kernel(const Data *, Grid *, int, int, int);
+
 typedef double ****Data_Arr;
 
 #ifndef EOS
@@ -568,6 +636,14 @@ typedef double ****Data_Arr;
      Declare global variables
    ***************************************************** */
 
+/* -- the grid indices and the integration time are private to each
+      thread, so that output can be written by a separate thread
+      while they change (see async_output.c) -- */
+
+#ifndef THREAD_LOCAL
+ #define THREAD_LOCAL __thread
+#endif
+
 extern int SZ;
 extern int SZ_stagx;
 extern int SZ_stagy;
@@ -579,9 +655,9 @@ extern int SZ_rgb;
 extern int SZ_short;
 extern int prank;
 
-extern long int IBEG, IEND, JBEG, JEND, KBEG, KEND;
-extern long int NX1, NX2, NX3;
-extern long int NX1_TOT, NX2_TOT, NX3_TOT;
+extern THREAD_LOCAL long int IBEG, IEND, JBEG, JEND, KBEG, KEND;
+extern THREAD_LOCAL long int NX1, NX2, NX3;
+extern THREAD_LOCAL long int NX1_TOT, NX2_TOT, NX3_TOT;
 extern long int NMAX_POINT;
 
 extern int VXn, VXt, VXb;
@@ -594,7 +670,9 @@ extern int g_dir;
 extern int g_maxRiemannIter;
 extern int g_maxRootIter;
 extern long int g_usedMemory;
-extern long int g_stepNumber;
+extern THREAD_LOCAL long int g_stepNumber;
+extern int g_initThreads;
+extern int g_gridEpoch;
 extern int g_intStage;
 extern int g_operatorStep;
 
@@ -602,7 +680,7 @@ extern double g_maxCoolingRate, g_minCoolingTemp;
 
 extern double g_smallDensity, g_smallPressure;
 
-extern double g_time, g_dt;
+extern THREAD_LOCAL double g_time, g_dt;
 extern double g_maxMach;
 #if ROTATING_FRAME
 extern double g_OmegaZ;
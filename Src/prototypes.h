@@ -2,6 +2,17 @@
                     General function prototypes 
    --------------------------------------------------------------------- */
 
+void   ActivityCheck  (const Data *, Grid *);
+int    ActivityCell   (int, int, int);
+int    ActivityRange  (int, int, int, int *, int *);
+void   ActivityReport (void);
+void   ActivityUpdate (const Data *, int, Grid *);
+
+int    AsyncOutputPost  (const Data *, Output *, Grid *);
+void   AsyncOutputStart (void);
+void   AsyncOutputStop  (void);
+void   AsyncOutputWait  (void);
+
 void   AdvectFlux (const State_1D *, int, int, Grid *);
 void   Analysis (const Data *, Grid *);
 #if EOS == BAROTROPIC
@@ -33,6 +44,7 @@ void CreateImage (char *);
 void ComputeEntropy      (const Data *, Grid *);
 void EntropySwitch       (const Data *, Grid *);
 void EntropyOhmicHeating (const Data *, Data_Arr, double, Grid *);
+void EvalUserVar (const Data *, int, double ***, Grid *);
 
 #ifdef FINITE_DIFFERENCE  
  Riemann_Solver FD_Flux;
@@ -47,11 +59,14 @@ void FlagReset (const Data *d);
 void Flatten (const State_1D *, int, int, Grid *);
 void FreeGrid (Grid *);
 
+void   GatherPlane (double *, int, int *, int *, double *, int *);
 void   GetCGSUnits (double *u);
 Image  *GetImage (char *);
 double *GetInverse_dl (const Grid *);
 int    GetNghost (Input *);
 char   *GetOutputDir();
+double ***GetOutputVar (Output *, int, Grid *);
+double   GetOutputValue (Output *, int, int, int, int, Grid *);
 double ***GetUserVar (char *);
 
 int LocateIndex(double *, int, int, double);
@@ -80,6 +95,7 @@ void   ParseCmdLineArgs (int, char *argv[], char *, Cmd_Line *);
 int    ParamFileRead    (char *);
 char  *ParamFileGet     (const char *, int );
 int    ParamExist       (const char *);
+int    ParamFileNWords  (const char *);
 int    ParamFileHasBoth (const char *, const char *);
 
 void   PrimToChar (double **, double *, double *); 
@@ -100,9 +116,15 @@ int  Setup (Input *, Cmd_Line *, char *);
 void SetGrid (struct INPUT *INI, Grid *);
 void SetJetDomain   (const Data *, int, int, Grid *);
 void SetOutputDir(char *);
+void SetUserVar (Data *, Input *);
+void SetUserVarKernel (char *, User_Var_Kernel *);
 void SplitSource (const Data *, double, Time_Step *, Grid *);
 void Startup (Data *, Grid *);
 void States (const State_1D *, int, int, Grid *);
+void TimerDump (char *);
+void TimerReport (void);
+void TimerStart (int);
+void TimerStop (int);
 
 
 void UnsetJetDomain (const Data *, int, Grid *);
@@ -138,6 +160,9 @@ void FreeArrayMap (double ***);
 
 void FreeArrayCharMap(unsigned char ***);
 
+void MemoryReport (char *);
+int  MemoryTag (int);
+
 #define ARRAY_1D(nx,type)          (type    *)Array1D(nx,sizeof(type))
 #define ARRAY_2D(nx,ny,type)       (type   **)Array2D(nx,ny,sizeof(type))
 #define ARRAY_3D(nx,ny,nz,type)    (type  ***)Array3D(nx,ny,nz,sizeof(type))
@@ -192,6 +217,7 @@ int   CloseBinaryFile (FILE *, int);
 FILE *OpenBinaryFile  (char *, int, char *);
 void ReadBinaryArray (void *, size_t, int, FILE *, int, int);
 void ReadHDF5 (Output *output, Grid *grid);
+GridFile *ReadGridFile (char *);
 
 void Restart (Input *, int, int, Grid *);
 void RestartDump (Input *);
@@ -200,12 +226,16 @@ void RestartGet  (Input *, int, int, int);
 void SwapEndian (void *, const int); 
 
 void WriteData (const Data *, Output *, Grid *);
+void WriteGridFile (char *, Grid *);
+void WriteDataFiles (Output *, Grid *);
 void WriteBinaryArray (void *, size_t, int, FILE *, int);
 void WriteHDF5        (Output *output, Grid *grid);
 void WriteVTK_Header (FILE *, Grid *);
 void WriteVTK_Vector (FILE *, Data_Arr, double, char *, Grid *);
 void WriteVTK_Scalar (FILE *, double ***, double, char *, Grid *);
 void WriteTabArray (Output *, char *, Grid *);
+void WriteCompressed (Output *, char *, Grid *);
+void WritePVTK (Output *, char *, double *, Grid *);
 void WritePPM (double ***, char *, char *, Grid *);
 void WritePNG (double ***, char *, char *, Grid *);
 
@@ -6,6 +6,11 @@
   This file collects the necessary functions for restarting PLUTO 
   from a double precision binary or HDF5 file in the static grid
   version of the code.
+  Data files hold the global arrays and each processor reads its own
+  portion only, so that a run can be restarted with a different
+  number of processors or domain decomposition than the one which
+  wrote the files; the size of the files is checked against the
+  current grid.
 
   \author A. Mignone (mignone@ph.unito.it)
   \date   Aug 16, 2012
@@ -13,6 +18,8 @@
 /* ///////////////////////////////////////////////////////////////////// */
 #include "pluto.h"
 
+static void CheckRestartFile (char *, long long);
+
 /* *********************************************************************  */
 void Restart (Input *ini, int nrestart, int type, Grid *grid)
 /*!
@@ -28,6 +35,7 @@ void Restart (Input *ini, int nrestart, int type, Grid *grid)
 {
   int     i,j,k;
   int     nv, single_file, origin, nlines=0;
+  long long nbytes, ncell, var_bytes[64];
   int     swap_endian=0;
   char    fname[512], fout[512], str[512];
   double  dbl;
@@ -81,7 +89,7 @@ void Restart (Input *ini, int nrestart, int type, Grid *grid)
     fclose(fbin);
   }
   #ifdef PARALLEL
-   MPI_Bcast (&swap_endian, 1, MPI_INT, 0, MPI_COMM_WORLD);
+   MPI_Bcast (&swap_endian, 1, MPI_INT, 0, AL_COMM_WORLD);
   #endif
 
 /* ---------------------------------------------
@@ -103,11 +111,28 @@ void Restart (Input *ini, int nrestart, int type, Grid *grid)
            For .dbl output, read data from disk
    ----------------------------------------------------------------- */
 
+/* -- global size (in bytes) of each variable, used to check
+      that the file matches the current grid -- */
+
+  nbytes = 0;
+  for (nv = 0; nv < output->nvar; nv++) {
+    ncell = 1;
+    for (i = 0; i < DIMENSIONS; i++){
+      ncell *= grid[i].np_int_glob + (output->stag_var[nv] == i);
+    }
+    var_bytes[nv] = ncell*sizeof(double);
+    if (output->dump_var[nv]) nbytes += var_bytes[nv];
+  }
+
   if (single_file){ 
     int  sz;
     long long offset;
+    #ifdef PARALLEL
+     int sz_open = -1;
+    #endif
 
     sprintf (fname, "%s/data.%04d.dbl", output->dir, output->nfile);
+    CheckRestartFile (fname, nbytes);
     offset = 0;
     #ifndef PARALLEL
      fbin = OpenBinaryFile (fname, 0, "r");
@@ -115,6 +140,16 @@ void Restart (Input *ini, int nrestart, int type, Grid *grid)
     for (nv = 0; nv < output->nvar; nv++) {
       if (!output->dump_var[nv]) continue;
 
+    /* -- user variables computed on the fly are skipped -- */
+
+      if (output->V[nv] == NULL){
+        #ifndef PARALLEL
+         fseek (fbin, var_bytes[nv], SEEK_CUR);
+        #endif
+        offset += var_bytes[nv];
+        continue;
+      }
+
       if      (output->stag_var[nv] == -1) {  /* -- cell-centered data -- */
         sz = SZ;
         Vpt = (void *)output->V[nv][0][0];
@@ -128,18 +163,24 @@ void Restart (Input *ini, int nrestart, int type, Grid *grid)
          sz = SZ_stagz;
          Vpt = (void *)output->V[nv][-1][0];
       }
+
+    /* -- the file is reopened only when the array descriptor changes -- */
+
       #ifdef PARALLEL
-       fbin = OpenBinaryFile (fname, sz, "r");
+       if (sz != sz_open){
+         if (sz_open != -1) CloseBinaryFile(fbin, sz_open);
+         fbin = OpenBinaryFile (fname, sz, "r");
+         sz_open = sz;
+       }
        AL_Set_offset(sz, offset);
       #endif
       ReadBinaryArray (Vpt, sizeof(double), sz, fbin,
                        output->stag_var[nv], swap_endian);
-      #ifdef PARALLEL
-       offset = AL_Get_offset(sz);
-       CloseBinaryFile(fbin, sz);
-      #endif
+      offset += var_bytes[nv];
     }
-    #ifndef PARALLEL
+    #ifdef PARALLEL
+     if (sz_open != -1) CloseBinaryFile(fbin, sz_open);
+    #else
      CloseBinaryFile(fbin, sz);
     #endif
 
@@ -147,9 +188,10 @@ void Restart (Input *ini, int nrestart, int type, Grid *grid)
 
     int  sz;
     for (nv = 0; nv < output->nvar; nv++) {
-      if (!output->dump_var[nv]) continue;
+      if (!output->dump_var[nv] || output->V[nv] == NULL) continue;
       sprintf (fname, "%s/%s.%04d.%s", output->dir, output->var_name[nv], 
                                        output->nfile, output->ext);
+      CheckRestartFile (fname, var_bytes[nv]);
 
       if      (output->stag_var[nv] == -1) {  /* -- cell-centered data -- */
         sz = SZ;
@@ -172,6 +214,38 @@ void Restart (Input *ini, int nrestart, int type, Grid *grid)
   }
 }
 
+/* ********************************************************************* */
+static void CheckRestartFile (char *fname, long long nbytes)
+/*!
+ * Make sure that the restart file fname has the size (nbytes)
+ * expected for the current grid.
+ * This does not depend on the number of processors which wrote it.
+ *
+ *********************************************************************** */
+{
+  long long fsize;
+  FILE *fp;
+
+  if (prank != 0) return;
+
+  fp = fopen (fname, "rb");
+  if (fp == NULL){
+    print1 ("! Restart: file %s does not exist\n", fname);
+    QUIT_PLUTO(1);
+  }
+  fseek (fp, 0, SEEK_END);
+  fsize = (long long) ftell (fp);
+  fclose (fp);
+
+  if (fsize != nbytes){
+    print1 ("! Restart: %s has %lld bytes, %lld expected.\n",
+             fname, fsize, nbytes);
+    print1 ("!          Check that the grid in pluto.ini is the same\n");
+    print1 ("!          as the one of the restart file.\n");
+    QUIT_PLUTO(1);
+  }
+}
+
 static int counter = -1;
 
 /* ********************************************************************* */
@@ -237,7 +311,7 @@ void RestartGet (Input *ini, int nrestart, int out_type,
 /* printf ("counter = %d\n",counter); */
 
   #ifdef PARALLEL
-   MPI_Bcast (&runtime, sizeof (Runtime), MPI_BYTE, 0, MPI_COMM_WORLD);
+   MPI_Bcast (&runtime, sizeof (Runtime), MPI_BYTE, 0, AL_COMM_WORLD);
   #endif
 
   g_time = runtime.t;
@@ -143,7 +143,7 @@ void RKC (const Data *d, Time_Step *Dts, Grid *grid)
   Dts->inv_dtp  = ParabolicRHS(d, F_0, 1.0, grid);
   Dts->inv_dtp /= (double) DIMENSIONS;  
   #ifdef PARALLEL
-   MPI_Allreduce (&Dts->inv_dtp, &scrh, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+   MPI_Allreduce (&Dts->inv_dtp, &scrh, 1, MPI_DOUBLE, MPI_MAX, AL_COMM_WORLD);
    Dts->inv_dtp = scrh;
   #endif
   dt_par = Dts->cfl_par/(2.0*Dts->inv_dtp); /* -- explicit parabolic time step -- */   
@@ -164,6 +164,10 @@ void SetGrid (Input *INI, Grid *GXYZ)
       }
     }
     fclose(fg);
+
+    /* -- binary descriptor (grid.bin), read by ReadGridFile() -- */
+
+    WriteGridFile (fname, GXYZ);
   }
 #endif
 
@@ -16,6 +16,13 @@
   The function GetUserVar() returns the memory address to a 
   user-defined 3D array.
 
+  User-defined variables may also be given as kernels computing the
+  value in a single zone (see SetUserVarKernel()). No storage is
+  kept for these variables: writers obtain them with GetOutputVar()
+  or GetOutputValue(), so that each output evaluates only the
+  variables it writes, one at a time. With asynchronous output they
+  are evaluated directly into the staging buffers.
+
   \note Starting with PLUTO 4.1 velocity and magnetic field components 
         will be saved as scalars when writing VTK output. 
         If this is not what you want and prefer to save them as vector 
@@ -33,6 +40,9 @@
 #endif
 
 static Output *all_outputs;
+static int user_beg; /* index of the first user-defined variable */
+static User_Var_Kernel *user_kernel[64];
+static const Data *user_data;
 /* ********************************************************************* */
 void SetOutput (Data *d, Input *input)
 /*!
@@ -47,12 +57,10 @@ void SetOutput (Data *d, Input *input)
   int nv, i, k;
   Output *output;
 
-  if (input->user_var > 0)
-    d->Vuser = ARRAY_4D(input->user_var, NX3_TOT, NX2_TOT, NX1_TOT, double);
-  else
-    d->Vuser = NULL;
-
+  d->Vuser    = NULL;  /* allocated by SetUserVar() below */
+  user_data   = d;
   all_outputs = input->output;
+  for (nv = 0; nv < 64; nv++) user_kernel[nv] = NULL;
 
 /* ---------------------------------------------
           Loop on output types 
@@ -113,9 +121,10 @@ void SetOutput (Data *d, Input *input)
 
   /* -- repeat for user defined vars -- */
 
+    user_beg = nv;
     for (i = 0; i < input->user_var; i++){
       sprintf (output->var_name[i + nv], "%s", input->user_var_name[i]);
-      output->V[i + nv] = d->Vuser[i];
+      output->V[i + nv] = NULL;
       output->stag_var[i + nv] = -1; /* -- assume cell-centered -- */
     }
 
@@ -156,9 +165,25 @@ void SetOutput (Data *d, Input *input)
          #endif
         #endif
         break;
+      case PVTK_OUTPUT:  /* -- do not dump staggered fields (below) -- */
+        sprintf (output->ext,"pvtk");
+        #if VTK_VECTOR_DUMP == YES
+         D_EXPAND(output->dump_var[VX1] = VTK_VECTOR;  ,
+                  output->dump_var[VX2] = NO;          ,
+                  output->dump_var[VX3] = NO;)
+         #if PHYSICS == MHD || PHYSICS == RMHD
+          D_EXPAND(output->dump_var[BX1] = VTK_VECTOR;  ,
+                   output->dump_var[BX2] = NO;          ,
+                   output->dump_var[BX3] = NO;)
+         #endif
+        #endif
+        break;
       case TAB_OUTPUT:   /* -- do not dump staggered fields -- */
         sprintf (output->ext,"tab");
         break;
+      case CMP_OUTPUT:   /* -- do not dump staggered fields (below) -- */
+        sprintf (output->ext,"cmp");
+        break;
       case PPM_OUTPUT:   /* -- dump density only  -- */
         sprintf (output->ext,"ppm");
         for (nv = output->nvar; nv--; ) output->dump_var[nv] = NO;
@@ -188,6 +213,9 @@ void SetOutput (Data *d, Input *input)
    D_EXPAND( SetDumpVar ("bx1s", VTK_OUTPUT, NO);  ,
              SetDumpVar ("bx2s", VTK_OUTPUT, NO);  ,
              SetDumpVar ("bx3s", VTK_OUTPUT, NO);)
+   D_EXPAND( SetDumpVar ("bx1s", PVTK_OUTPUT, NO);  ,
+             SetDumpVar ("bx2s", PVTK_OUTPUT, NO);  ,
+             SetDumpVar ("bx3s", PVTK_OUTPUT, NO);)
    D_EXPAND( SetDumpVar ("bx1s", FLT_OUTPUT, NO);  ,
              SetDumpVar ("bx2s", FLT_OUTPUT, NO);  ,
              SetDumpVar ("bx3s", FLT_OUTPUT, NO);)
@@ -197,6 +225,9 @@ void SetOutput (Data *d, Input *input)
    D_EXPAND( SetDumpVar ("bx1s", TAB_OUTPUT, NO);  ,
              SetDumpVar ("bx2s", TAB_OUTPUT, NO);  ,
              SetDumpVar ("bx3s", TAB_OUTPUT, NO);)
+   D_EXPAND( SetDumpVar ("bx1s", CMP_OUTPUT, NO);  ,
+             SetDumpVar ("bx2s", CMP_OUTPUT, NO);  ,
+             SetDumpVar ("bx3s", CMP_OUTPUT, NO);)
   #endif
 
 /* -- defaults: dump density only in ppm and png formats -- */
@@ -205,6 +236,141 @@ void SetOutput (Data *d, Input *input)
   SetDumpVar ("rho", PNG_OUTPUT, YES);
   
   ChangeDumpVar();
+  SetUserVar (d, input);
+}
+
+/* ********************************************************************* */
+void SetUserVar (Data *d, Input *input)
+/*!
+ * (Re)allocate the arrays of the user-defined variables that are not
+ * computed on the fly and set the corresponding output pointers.
+ * Must be called again whenever the local grid size changes.
+ *
+ * \param [in,out] d      pointer to Data structure
+ * \param [in]     input  pointer to input structure
+ *********************************************************************** */
+{
+  int i, k, nv, nalloc = 0;
+
+  if (d->Vuser != NULL){
+    for (i = 0; i < input->user_var; i++){
+      if (d->Vuser[i] != NULL) FreeArray3D ((void *) d->Vuser[i]);
+    }
+    FreeArray1D ((void *) d->Vuser);
+    d->Vuser = NULL;
+  }
+
+  for (i = 0; i < input->user_var; i++){
+    if (user_kernel[user_beg + i] == NULL) nalloc++;
+  }
+  if (nalloc > 0){
+    d->Vuser = ARRAY_1D(input->user_var, double ***);
+    for (i = 0; i < input->user_var; i++){
+      if (user_kernel[user_beg + i] == NULL){
+        d->Vuser[i] = ARRAY_3D(NX3_TOT, NX2_TOT, NX1_TOT, double);
+      }else{
+        d->Vuser[i] = NULL;
+      }
+    }
+  }
+
+  for (k = 0; k < MAX_OUTPUT_TYPES; k++){
+    for (i = 0; i < input->user_var; i++){
+      input->output[k].V[user_beg + i] = (d->Vuser != NULL ? d->Vuser[i]:NULL);
+    }
+  }
+
+/* -- kernels are evaluated one variable at a time and
+      cannot be written as VTK vectors -- */
+
+  for (k = 0; k < MAX_OUTPUT_TYPES; k++){
+    for (i = user_beg; i < input->output[k].nvar; i++){
+      if (input->output[k].dump_var[i] != VTK_VECTOR) continue;
+      for (nv = i; nv < MIN(i + COMPONENTS, input->output[k].nvar); nv++){
+        if (user_kernel[nv] == NULL) continue;
+        print1 ("! SetUserVar: uservar '%s' cannot be part of a VTK vector\n",
+                input->output[k].var_name[nv]);
+        QUIT_PLUTO(1);
+      }
+    }
+  }
+}
+
+/* ********************************************************************* */
+void SetUserVarKernel (char *var_name, User_Var_Kernel *kernel)
+/*!
+ *  Compute the user-defined variable 'var_name' on the fly using
+ *  the function 'kernel', which returns its value in the zone
+ *  (k,j,i). Should be called from ChangeDumpVar().
+ *  The variable has no permanent storage and cannot be retrieved
+ *  with GetUserVar().
+ *
+ * \param [in] var_name  the name of the user-defined variable
+ * \param [in] kernel    pointer to the kernel function
+ *********************************************************************** */
+{
+  int nv;
+
+  for (nv = user_beg; nv < all_outputs->nvar; nv++){
+    if (strcmp(all_outputs->var_name[nv], var_name) == 0){
+      user_kernel[nv] = kernel;
+      return;
+    }
+  }
+  print1 ("! SetUserVarKernel: uservar '%s' not found\n", var_name);
+}
+
+/* ********************************************************************* */
+void EvalUserVar (const Data *d, int nv, double ***V, Grid *grid)
+/*!
+ *  Evaluate the kernel of the user-defined variable nv in the
+ *  interior zones and store the result in V.
+ *
+ *********************************************************************** */
+{
+  int i, j, k;
+  User_Var_Kernel *kernel = user_kernel[nv];
+
+  DOM_LOOP(k,j,i) V[k][j][i] = kernel(d, grid, k, j, i);
+}
+
+/* ********************************************************************* */
+double ***GetOutputVar (Output *output, int nv, Grid *grid)
+/*!
+ *  Return the 3D array of the output variable nv.
+ *  User-defined variables given as kernels are evaluated into a
+ *  scratch array shared by all of them, which remains valid only
+ *  until the next call.
+ *
+ *********************************************************************** */
+{
+  static double ***Vs;
+  static int epoch;
+
+  if (output->V[nv] != NULL) return output->V[nv];
+
+  if (Vs != NULL && epoch != g_gridEpoch){
+    FreeArray3D ((void *) Vs);
+    Vs = NULL;
+  }
+  if (Vs == NULL){
+    Vs    = ARRAY_3D(NX3_TOT, NX2_TOT, NX1_TOT, double);
+    epoch = g_gridEpoch;
+  }
+  EvalUserVar (user_data, nv, Vs, grid);
+  return Vs;
+}
+
+/* ********************************************************************* */
+double GetOutputValue (Output *output, int nv, int k, int j, int i,
+                       Grid *grid)
+/*!
+ *  Return the value of the output variable nv in the zone (k,j,i).
+ *
+ *********************************************************************** */
+{
+  if (output->V[nv] != NULL) return output->V[nv][k][j][i];
+  return user_kernel[nv](user_data, grid, k, j, i);
 }
 
 /* ********************************************************************* */
@@ -255,13 +421,17 @@ double ***GetUserVar (char *var_name)
  *
  *********************************************************************** */
 {
-  int indx = -1;
+  int indx;
   
-  while (strcmp(all_outputs->var_name[++indx], var_name)){
+  for (indx = 0; indx < all_outputs->nvar; indx++){
+    if (strcmp(all_outputs->var_name[indx], var_name)) continue;
     if (all_outputs->V[indx] == NULL){
-      print1 ("! Error: uservar '%s' is not allocated\n"); 
+      print1 ("! Error: uservar '%s' is not allocated\n", var_name); 
       QUIT_PLUTO(1);
     }
+    return (all_outputs->V[indx]);
   }
-  return (all_outputs->V[indx]);
+  print1 ("! Error: uservar '%s' not found\n", var_name); 
+  QUIT_PLUTO(1);
+  return (NULL);
 }
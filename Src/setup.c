@@ -34,7 +34,7 @@ int Setup (Input *input, Cmd_Line *cmd_line, char *ini_file)
  *
  *********************************************************************** */
 {
-  int    idim, ip, ipos, itype, nlines;
+  int    idim, ip, ipos, itype, nlines, n;
   char   *bound_opt[NOPT], str_var[512], *str;
   char  *glabel[]     = {"X1-grid", "X2-grid","X3-grid"};
   char  *bbeg_label[] = {"X1-beg", "X2-beg","X3-beg"};
@@ -206,6 +206,24 @@ printf ("%f  %d %s\n",input->patch_left_node[idim][ip],input->patch_npoint[idim]
     str = ParamFileGet("output_dir",1);
     sprintf (input->output_dir, "%s",str);
   }
+
+/* -- ensemble members write in the directory of their
+      initialization file; an absolute path would be shared -- */
+
+  if (cmd_line->ensemble > 0){
+    if (input->output_dir[0] == '/'){
+      printf ("! Setup: -ensemble requires a relative output_dir\n");
+      QUIT_PLUTO(1);
+    }
+    ipos = strrchr(ini_file, '/') - ini_file;
+    sprintf (str_var, "%s", input->output_dir);
+    n = snprintf (input->output_dir, sizeof(input->output_dir),
+                  "%.*s/%s", ipos, ini_file, str_var);
+    if (n < 0 || n >= (int)sizeof(input->output_dir)){
+      printf ("! Setup: output_dir too long\n");
+      QUIT_PLUTO(1);
+    }
+  }
   SetOutputDir(input->output_dir);
 
 /* -- check if we have write access and if the directory exists -- */
@@ -283,12 +301,18 @@ printf ("%f  %d %s\n",input->patch_left_node[idim][ip],input->patch_npoint[idim]
     output->type  = DBL_H5_OUTPUT;
     output->cgs   = 0;  /* cannot write .h5 using cgs units */
     GetOutputFrequency(output, "dbl.h5");
+    sprintf (output->mode,"single_file");
+    if (ParamFileHasBoth ("dbl.h5","chunked")) sprintf (output->mode,"chunked");
+    if (ParamFileHasBoth ("dbl.h5","deflate")) sprintf (output->mode,"deflate");
   }
   if (ParamExist("flt.h5")){
     output = input->output + (ipos++);
     output->type  = FLT_H5_OUTPUT;
     output->cgs   = 0;  /* cannot write .h5 using cgs units */
     GetOutputFrequency(output, "flt.h5");
+    sprintf (output->mode,"single_file");
+    if (ParamFileHasBoth ("flt.h5","chunked")) sprintf (output->mode,"chunked");
+    if (ParamFileHasBoth ("flt.h5","deflate")) sprintf (output->mode,"deflate");
   }
 
  /* -- vtk output -- */
@@ -313,6 +337,29 @@ printf ("%f  %d %s\n",input->patch_left_node[idim][ip],input->patch_npoint[idim]
     else                                output->cgs = 0;
   }
 
+ /* -- parallel (XML) vtk output -- */
+
+  if (ParamExist ("pvtk")){
+    #if GEOMETRY != CARTESIAN && GEOMETRY != CYLINDRICAL
+     printf ("! Setup: pvtk output requires Cartesian or cylindrical geometry\n");
+     QUIT_PLUTO(1);
+    #endif
+    output = input->output + (ipos++);
+    output->type  = PVTK_OUTPUT;
+    GetOutputFrequency(output, "pvtk");
+    sprintf (output->mode,"multiple_files");
+    output->nfiles = 0;   /* -- default: one file per processor -- */
+    if (ParamFileNWords("pvtk") >= 3 && strcmp(ParamFileGet("pvtk",3),"cgs")){
+      output->nfiles = atoi(ParamFileGet("pvtk",3));
+      if (output->nfiles <= 0){
+        printf ("! Setup: expecting a positive number of files in pvtk output\n");
+        QUIT_PLUTO(1);
+      }
+    }
+    if (ParamFileHasBoth ("pvtk","cgs")) output->cgs = 1;
+    else                                 output->cgs = 0;
+  }
+
  /* -- tab output -- */
 
   if (ParamExist ("tab")){
@@ -323,6 +370,20 @@ printf ("%f  %d %s\n",input->patch_left_node[idim][ip],input->patch_npoint[idim]
     else                                output->cgs = 0;
   }
 
+ /* -- compressed output -- */
+
+  if (ParamExist ("cmp")){
+    output = input->output + (ipos++);
+    output->type  = CMP_OUTPUT;
+    output->cgs   = 0;   /* cannot write cmp using cgs units */
+    GetOutputFrequency(output, "cmp");
+    output->cmp_tol = atof(ParamFileGet("cmp", 3));
+    if (output->cmp_tol <= 0.0){
+      printf ("! Setup: expecting a positive error bound in cmp output\n");
+      QUIT_PLUTO(1);
+    }
+  }
+
  /* -- ppm output -- */
 
   if (ParamExist ("ppm")){
@@ -339,14 +339,14 @@ void ShowDomainDecomposition(int nprocs, Grid *GXYZ)
   zb = Gz->xl[kb]; ze = Gz->xr[ke];
 
   D_EXPAND(
-    MPI_Gather (&xb, 1, MPI_DOUBLE, xb_proc, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
-    MPI_Gather (&xe, 1, MPI_DOUBLE, xe_proc, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);  ,
+    MPI_Gather (&xb, 1, MPI_DOUBLE, xb_proc, 1, MPI_DOUBLE, 0, AL_COMM_WORLD);
+    MPI_Gather (&xe, 1, MPI_DOUBLE, xe_proc, 1, MPI_DOUBLE, 0, AL_COMM_WORLD);  ,
     
-    MPI_Gather (&yb, 1, MPI_DOUBLE, yb_proc, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
-    MPI_Gather (&ye, 1, MPI_DOUBLE, ye_proc, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);  ,
+    MPI_Gather (&yb, 1, MPI_DOUBLE, yb_proc, 1, MPI_DOUBLE, 0, AL_COMM_WORLD);
+    MPI_Gather (&ye, 1, MPI_DOUBLE, ye_proc, 1, MPI_DOUBLE, 0, AL_COMM_WORLD);  ,
     
-    MPI_Gather (&zb, 1, MPI_DOUBLE, zb_proc, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
-    MPI_Gather (&ze, 1, MPI_DOUBLE, ze_proc, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    MPI_Gather (&zb, 1, MPI_DOUBLE, zb_proc, 1, MPI_DOUBLE, 0, AL_COMM_WORLD);
+    MPI_Gather (&ze, 1, MPI_DOUBLE, ze_proc, 1, MPI_DOUBLE, 0, AL_COMM_WORLD);
   )
 
 /* -- Global beg and end indices -- */
@@ -356,14 +356,14 @@ void ShowDomainDecomposition(int nprocs, Grid *GXYZ)
   kb  = Gz->beg; ke += Gz->beg - nghz;
 
   D_EXPAND(
-    MPI_Gather (&ib, 1, MPI_INT, ib_proc, 1, MPI_INT, 0, MPI_COMM_WORLD);
-    MPI_Gather (&ie, 1, MPI_INT, ie_proc, 1, MPI_INT, 0, MPI_COMM_WORLD);  ,
+    MPI_Gather (&ib, 1, MPI_INT, ib_proc, 1, MPI_INT, 0, AL_COMM_WORLD);
+    MPI_Gather (&ie, 1, MPI_INT, ie_proc, 1, MPI_INT, 0, AL_COMM_WORLD);  ,
     
-    MPI_Gather (&jb, 1, MPI_INT, jb_proc, 1, MPI_INT, 0, MPI_COMM_WORLD);
-    MPI_Gather (&je, 1, MPI_INT, je_proc, 1, MPI_INT, 0, MPI_COMM_WORLD);  ,
+    MPI_Gather (&jb, 1, MPI_INT, jb_proc, 1, MPI_INT, 0, AL_COMM_WORLD);
+    MPI_Gather (&je, 1, MPI_INT, je_proc, 1, MPI_INT, 0, AL_COMM_WORLD);  ,
     
-    MPI_Gather (&kb, 1, MPI_INT, kb_proc, 1, MPI_INT, 0, MPI_COMM_WORLD);
-    MPI_Gather (&ke, 1, MPI_INT, ke_proc, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Gather (&kb, 1, MPI_INT, kb_proc, 1, MPI_INT, 0, AL_COMM_WORLD);
+    MPI_Gather (&ke, 1, MPI_INT, ke_proc, 1, MPI_INT, 0, AL_COMM_WORLD);
   )
 
   print1 ("> Domain Decomposition (%d procs):\n\n", nprocs);
@@ -385,7 +385,7 @@ void ShowDomainDecomposition(int nprocs, Grid *GXYZ)
     )
   }
 
-  MPI_Barrier (MPI_COMM_WORLD);
+  MPI_Barrier (AL_COMM_WORLD);
 #endif
 
 /* ---- Free memory ---- */
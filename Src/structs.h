@@ -16,6 +16,13 @@ typedef struct CMD_LINE {
   int write;         
   int maxsteps;
   int jet;  /* -- follow jet evolution in a given direction -- */
+  int repart; /* -- repartition along the jet direction every n steps -- */
+  int activity; /* -- skip (1) or check (2) quiescent tiles -- */
+  int ensemble; /* -- number of independent runs sharing the job -- */
+  int node_aware; /* -- host-aware decomposition and ghost exchange -- */
+  int async_output; /* -- write output files from a separate thread -- */
+  int read_ahead; /* -- MB of MPI-IO read buffers when restarting -- */
+  int init_threads; /* -- number of threads used by Startup() -- */
   int parallel_dim[3];
   int nproc[3];  /* -- user supplied number of processors -- */
   int show_dec; /* -- show domain decomposition ? -- */
@@ -51,7 +58,8 @@ typedef struct DATA{
                        locations of the cell in the \f$x_3\f$,
                        \f$x_2\f$ and \f$x_1\f$ direction. */
   double ****Vuser; /**< Array storing user-defined supplementary variables 
-                         written to disk. */ 
+                         written to disk (NULL for the variables computed
+                         on the fly, see SetUserVarKernel()). */ 
   double ***Ax1;  /**< Vector potential component in the \f$x_1\f$ direction.*/
   double ***Ax2;  /**< Vector potential component in the \f$x_2\f$ direction.*/
   double ***Ax3;  /**< Vector potential component in the \f$x_3\f$ direction.*/
@@ -125,6 +133,19 @@ typedef struct GRID{
   int level;       /**< The current refinement level (chombo only). */
   char fill[40];   /* useless, just to make the structure size a power of 2 */
 } Grid;
+
+/* ********************************************************************* */
+/*! The GridFile structure contains the content of a grid file
+    (see ReadGridFile()): interior zones only, indices start from 0.
+   ********************************************************************* */
+typedef struct GRID_FILE{
+  int dimensions;  /**< Number of dimensions. */
+  int geometry;    /**< Coordinate geometry (CARTESIAN, ...). */
+  int np[3];       /**< Number of zones in each direction. */
+  double *xl[3];   /**< Left interfaces in each direction. */
+  double *xr[3];   /**< Right interfaces in each direction. */
+  int binary;      /**< 1 if read from the binary descriptor. */
+} GridFile;
    
 /* ********************************************************************* */
 /*! This structure contains one-dimensional vectors of conserved variables,   
@@ -242,7 +263,9 @@ typedef struct OUTPUT{
   double dt;           /**< time increment between outputs   - one per output */
   double dclock;       /**< time increment in clock hours     - one per output */
   double ***V[64];     /**< pointer to arrays being written   - same for all  */
-  char   fill[168];    /**< useless, just to make the structure size a power of 2 */
+  double cmp_tol;      /**< relative error bound (cmp output) - one per output */
+  int    nfiles;       /**< files per output, 0 = one per proc (pvtk output) */
+  char   fill[156];    /**< useless, just to make the structure size a power of 2 */
 } Output;
 
 typedef struct INPUT{
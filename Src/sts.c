@@ -98,7 +98,7 @@ void STS (const Data *d, Time_Step *Dts, Grid *grid)
     if (m == 0){
       Dts->inv_dtp = inv_dtp/(double)DIMENSIONS;  
       #ifdef PARALLEL
-       MPI_Allreduce (&Dts->inv_dtp, &tau, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+       MPI_Allreduce (&Dts->inv_dtp, &tau, 1, MPI_DOUBLE, MPI_MAX, AL_COMM_WORLD);
        Dts->inv_dtp = tau;
       #endif
       Dts->inv_dtp = MAX(Dts->inv_dtp, 1.e-18);
@@ -0,0 +1,353 @@
+/* ///////////////////////////////////////////////////////////////////// */
+/*!
+  \file
+  \brief Per-phase timers of the static-grid integrator.
+
+  The integrator phases (boundary conditions, ghost zone exchange,
+  States, Riemann, RightHandSide, conversions, split sources, output,
+  ...) are enclosed between TimerStart() and TimerStop() with one of
+  the TIMER_* identifiers.
+  Timers can be nested: each node of the tree is a phase together with
+  the chain of phases it has been started from (e.g. the exchange
+  during the boundary conditions of a step is a different node from the
+  exchange during the boundary conditions set by Initialize()).
+  Processors need not have the same nodes; phases not run by some
+  processors are excluded from the minimum.
+  Only the master thread may use the timers.
+
+  TimerReport() prints, for each node of the tree, the time per step
+  spent since the previous report (minimum, average and maximum over
+  the processors) and its fraction of the wall clock time.
+  It is called every log_freq steps.
+  TimerDump() writes the totals of the whole run to a JSON file:
+
+  \verbatim
+  {"nproc": 4, "steps": 100, "wall": 12.5,
+   "timers": [
+     {"path": "step/boundary", "calls": 900,
+      "min": 2.9, "avg": 3.0, "max": 3.4},
+     ...
+   ]}
+  \endverbatim
+
+  where "calls" is the maximum over the processors and times are in
+  seconds. A timer costs two reads of the monotonic clock.
+
+  \date   Oct 19, 2026
+*/
+/* ///////////////////////////////////////////////////////////////////// */
+#include "pluto.h"
+
+#define TIMER_MAX_DEPTH  8
+#define TIMER_MAX_NODES  64
+
+typedef struct TIMER_NODE{
+  long   key;                  /* Path, one base-(TIMER_NTIMERS+1) digit
+                                  per level (0 for the root)            */
+  int    child[TIMER_NTIMERS]; /* Children nodes, -1 if not created     */
+  long   calls;                /* Total number of calls                 */
+  long   calls_last;           /* Calls at the previous report          */
+  double time;                 /* Total time                            */
+  double last;                 /* Total time at the previous report     */
+} Timer_Node;
+
+static double TimerClock (void);
+static int    TimerReduce (int, long *, double *, double *, double *, long *);
+static void   TimerPrint (long, int, int, long *, double *, double *,
+                          double *, long *, double, long);
+static int    TimerFind (long, int, long *);
+static char  *TimerPath (long);
+
+static char *tm_name[TIMER_NTIMERS] = {"step", "boundary", "exchange",
+                                       "int_boundary", "states", "riemann",
+                                       "rhs", "prim_cons", "source",
+                                       "output", "analysis"};
+
+static Timer_Node tm_node[TIMER_MAX_NODES];
+static int    tm_nnodes = 0;
+
+static int    tm_stack[TIMER_MAX_DEPTH + 1];  /* Nodes currently running */
+static double tm_beg[TIMER_MAX_DEPTH + 1];    /* and their starting time */
+static int    tm_depth = 0;
+
+static double tm_wall0 = -1.0;  /* Clock at the first call */
+static double tm_wall_last;     /* Clock at the last report */
+static long   tm_step_last;     /* Step number at the last report */
+
+/* ********************************************************************* */
+void TimerStart (int id)
+/*!
+ * Start timer \c id, as a child of the innermost running one.
+ *
+ *********************************************************************** */
+{
+  int n, parent, i;
+
+  if (tm_nnodes == 0){  /* -- create the root -- */
+    for (i = 0; i < TIMER_NTIMERS; i++) tm_node[0].child[i] = -1;
+    tm_nnodes = 1;
+    tm_wall0  = tm_wall_last = TimerClock();
+  }
+
+  parent = tm_stack[tm_depth];
+  n      = tm_node[parent].child[id];
+  if (n < 0){
+    if (tm_depth == TIMER_MAX_DEPTH || tm_nnodes == TIMER_MAX_NODES){
+      print1 ("! TimerStart: too many timers\n");
+      QUIT_PLUTO(1);
+    }
+    n = tm_node[parent].child[id] = tm_nnodes++;
+    tm_node[n].key = tm_node[parent].key*(TIMER_NTIMERS + 1) + id + 1;
+    for (i = 0; i < TIMER_NTIMERS; i++) tm_node[n].child[i] = -1;
+  }
+  tm_depth++;
+  tm_stack[tm_depth] = n;
+  tm_beg[tm_depth]   = TimerClock();
+}
+
+/* ********************************************************************* */
+void TimerStop (int id)
+/*!
+ * Stop timer \c id, which must be the innermost running one.
+ *
+ *********************************************************************** */
+{
+  Timer_Node *node = tm_node + tm_stack[tm_depth];
+
+  if (tm_depth == 0 || node->key%(TIMER_NTIMERS + 1) != id + 1){
+    print1 ("! TimerStop: timer '%s' is not running\n", tm_name[id]);
+    QUIT_PLUTO(1);
+  }
+  node->time += TimerClock() - tm_beg[tm_depth];
+  node->calls++;
+  tm_depth--;
+}
+
+/* ********************************************************************* */
+void TimerReport (void)
+/*!
+ * Print the time per step spent in each phase since the previous
+ * call. Must be called by all processors.
+ *
+ *********************************************************************** */
+{
+  int  nk;
+  long nsteps, key[TIMER_MAX_NODES], calls[TIMER_MAX_NODES];
+  double tmin[TIMER_MAX_NODES], tavg[TIMER_MAX_NODES];
+  double tmax[TIMER_MAX_NODES], now, wall;
+
+  if (tm_nnodes == 0) return;
+  nsteps = g_stepNumber - tm_step_last;
+  if (nsteps <= 0) return;
+
+  now  = TimerClock();
+  wall = now - tm_wall_last;
+  nk   = TimerReduce (0, key, tmin, tavg, tmax, calls);
+
+  print1 ("> Timers, steps %ld-%ld (sec/step; min, avg, max over procs):\n",
+          tm_step_last, g_stepNumber - 1);
+  TimerPrint (0, 0, nk, key, tmin, tavg, tmax, calls, wall, nsteps);
+
+  tm_wall_last = now;
+  tm_step_last = g_stepNumber;
+}
+
+/* ********************************************************************* */
+void TimerDump (char *dir)
+/*!
+ * Write the totals of the whole run to dir/timers.json.
+ * Must be called by all processors.
+ *
+ *********************************************************************** */
+{
+  int  n, nk, nproc = 1;
+  long key[TIMER_MAX_NODES], calls[TIMER_MAX_NODES];
+  double tmin[TIMER_MAX_NODES], tavg[TIMER_MAX_NODES];
+  double tmax[TIMER_MAX_NODES];
+  char   fname[512];
+  FILE  *fp;
+
+  if (tm_nnodes == 0) return;
+  nk = TimerReduce (1, key, tmin, tavg, tmax, calls);
+
+  #ifdef PARALLEL
+   MPI_Comm_size (AL_COMM_WORLD, &nproc);
+  #endif
+  if (prank != 0) return;
+
+  sprintf (fname, "%s/timers.json", dir);
+  fp = fopen (fname, "w");
+  if (fp == NULL){
+    print1 ("! TimerDump: cannot open %s\n", fname);
+    return;
+  }
+  fprintf (fp, "{\"nproc\": %d, \"steps\": %ld, \"wall\": %.6e,\n",
+           nproc, g_stepNumber, TimerClock() - tm_wall0);
+  fprintf (fp, " \"timers\": [");
+  for (n = 0; n < nk; n++){
+    fprintf (fp, "%s\n   {\"path\": \"%s\", \"calls\": %ld,"
+                 " \"min\": %.6e, \"avg\": %.6e, \"max\": %.6e}",
+             n == 0 ? "" : ",", TimerPath(key[n]), calls[n],
+             tmin[n], tavg[n], tmax[n]);
+  }
+  fprintf (fp, "\n ]}\n");
+  fclose (fp);
+}
+
+/* ********************************************************************* */
+static int TimerReduce (int total, long *key, double *tmin, double *tavg,
+                        double *tmax, long *calls)
+/*
+ * Collect the nodes of all processors, sorted by key, with the
+ * minimum, average and maximum time over the processors and the
+ * maximum number of calls.
+ * Times and calls are totals (total == 1) or since the previous
+ * report (total == 0), in which case the reference is reset.
+ *
+ * Return the number of nodes.
+ *
+ *********************************************************************** */
+{
+  int  n, m, nk = 0;
+  double t[TIMER_MAX_NODES];
+
+/* -- union of the keys, in ascending order -- */
+
+  #ifdef PARALLEL
+  {
+    int nproc, *cnt, *displ;
+    long *all, lkey[TIMER_MAX_NODES];
+
+    MPI_Comm_size (AL_COMM_WORLD, &nproc);
+    cnt   = ARRAY_1D(nproc, int);
+    displ = ARRAY_1D(nproc, int);
+    all   = ARRAY_1D(nproc*TIMER_MAX_NODES, long);
+    m = tm_nnodes - 1;
+    for (n = 0; n < m; n++) lkey[n] = tm_node[n + 1].key;
+    MPI_Allgather (&m, 1, MPI_INT, cnt, 1, MPI_INT, AL_COMM_WORLD);
+    for (n = 0; n < nproc; n++) displ[n] = n*TIMER_MAX_NODES;
+    MPI_Allgatherv (lkey, m, MPI_LONG, all, cnt, displ, MPI_LONG,
+                    AL_COMM_WORLD);
+    for (m = 0; m < nproc; m++){
+    for (n = 0; n < cnt[m]; n++){
+      if (TimerFind (all[displ[m] + n], nk, key) < 0){
+        if (nk == TIMER_MAX_NODES) break;
+        key[nk++] = all[displ[m] + n];
+      }
+    }}
+    FreeArray1D ((void *)cnt);
+    FreeArray1D ((void *)displ);
+    FreeArray1D ((void *)all);
+  }
+  #else
+   for (n = 1; n < tm_nnodes; n++) key[nk++] = tm_node[n].key;
+  #endif
+  for (n = 1; n < nk; n++){  /* -- insertion sort -- */
+    long k = key[n];
+    for (m = n; m > 0 && key[m - 1] > k; m--) key[m] = key[m - 1];
+    key[m] = k;
+  }
+
+/* -- local values; nodes never run are left out of the minimum -- */
+
+  for (n = 0; n < nk; n++){
+    t[n] = 0.0;
+    calls[n] = 0;
+    for (m = 1; m < tm_nnodes && tm_node[m].key != key[n]; m++);
+    if (m < tm_nnodes) {
+      calls[n] = tm_node[m].calls - (total ? 0 : tm_node[m].calls_last);
+      t[n]     = tm_node[m].time  - (total ? 0.0 : tm_node[m].last);
+      if (!total) {
+        tm_node[m].calls_last = tm_node[m].calls;
+        tm_node[m].last       = tm_node[m].time;
+      }
+    }
+    tmin[n] = (calls[n] > 0 ? t[n] : 1.e30);
+  }
+
+  #ifdef PARALLEL
+  {
+    int nproc;
+    MPI_Comm_size (AL_COMM_WORLD, &nproc);
+    MPI_Allreduce (MPI_IN_PLACE, tmin, nk, MPI_DOUBLE, MPI_MIN, AL_COMM_WORLD);
+    MPI_Allreduce (t, tavg, nk, MPI_DOUBLE, MPI_SUM, AL_COMM_WORLD);
+    MPI_Allreduce (t, tmax, nk, MPI_DOUBLE, MPI_MAX, AL_COMM_WORLD);
+    MPI_Allreduce (MPI_IN_PLACE, calls, nk, MPI_LONG, MPI_MAX, AL_COMM_WORLD);
+    for (n = 0; n < nk; n++) tavg[n] /= (double) nproc;
+  }
+  #else
+   for (n = 0; n < nk; n++) tavg[n] = tmax[n] = t[n];
+  #endif
+  for (n = 0; n < nk; n++) if (tmin[n] > 1.e29) tmin[n] = 0.0;
+  return nk;
+}
+
+/* ********************************************************************* */
+static void TimerPrint (long parent, int level, int nk, long *key,
+                        double *tmin, double *tavg, double *tmax, long *calls,
+                        double wall, long nsteps)
+/*
+ * Print the children of the node with key parent and, recursively,
+ * their children.
+ *
+ *********************************************************************** */
+{
+  int  id, n;
+  long k;
+
+  for (id = 0; id < TIMER_NTIMERS; id++){
+    k = parent*(TIMER_NTIMERS + 1) + id + 1;
+    n = TimerFind (k, nk, key);
+    if (n < 0 || calls[n] == 0) continue;
+    print1 ("  %*s%-*s %9.3e %9.3e %9.3e %6.1f%%\n", 2*level, "",
+            16 - 2*level, tm_name[id], tmin[n]/nsteps, tavg[n]/nsteps,
+            tmax[n]/nsteps, 100.0*tavg[n]/wall);
+    TimerPrint (k, level + 1, nk, key, tmin, tavg, tmax, calls, wall, nsteps);
+  }
+}
+
+/* ********************************************************************* */
+static int TimerFind (long k, int nk, long *key)
+/*
+ * Return the index of k in key[0..nk-1], or -1.
+ *
+ *********************************************************************** */
+{
+  int n;
+
+  for (n = 0; n < nk; n++) if (key[n] == k) return n;
+  return -1;
+}
+
+/* ********************************************************************* */
+static char *TimerPath (long k)
+/*
+ * Return the names along the path of the node with key k, separated
+ * by '/'.
+ *
+ *********************************************************************** */
+{
+  static char path[TIMER_MAX_DEPTH*32];
+  char   tmp[TIMER_MAX_DEPTH*32];
+
+  path[0] = '\0';
+  for (; k > 0; k /= (TIMER_NTIMERS + 1)){
+    sprintf (tmp, "%s%s%s", tm_name[k%(TIMER_NTIMERS + 1) - 1],
+             path[0] ? "/" : "", path);
+    strcpy (path, tmp);
+  }
+  return path;
+}
+
+/* ********************************************************************* */
+static double TimerClock (void)
+/*
+ * Return the time in seconds from an arbitrary origin.
+ *
+ *********************************************************************** */
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (double) ts.tv_sec + 1.e-9*(double) ts.tv_nsec;
+}
@@ -0,0 +1,366 @@
+/* ///////////////////////////////////////////////////////////////////// */
+/*!
+  \file
+  \brief Write compressed (lossy) data files.
+
+  WriteCompressed() provides the \c cmp output format, a compact
+  alternative to \c flt for analysis and visualization dumps.
+  Each variable is compressed with an error-bounded scheme:
+
+  - values are quantized on a uniform lattice of spacing 2*tol
+    starting at the minimum of the variable, so that the reconstructed
+    value differs from the original one by at most tol;
+  - the integer lattice coordinates are replaced by their Lorenzo
+    differences (the inverse transform is a running sum along each
+    direction), which are small where the flow is smooth;
+  - the differences are stored, in blocks of CMP_BLOCK zones in every
+    direction (4x4 in 2D, 4x4x4 in 3D), with the minimum number of
+    bits required by the largest of them in the block.
+
+  A variable which cannot be quantized (e.g. it contains NaN's or the
+  error bound is too small compared to its range) is stored as plain
+  single-precision values.
+  The error bound is set, for each variable, as a fraction of its
+  global range, given by the third field of the \c cmp line in
+  pluto.ini:
+  \verbatim
+    cmp    -1.0   100   1.e-3
+  \endverbatim
+
+  File layout (native byte order, as for the other binary outputs):
+  \verbatim
+    "PLUTOCMP"                              8 bytes
+    version, nvar, CMP_BLOCK, nproc         4 x int
+    global number of zones (x1, x2, x3)     3 x int
+    tol[nvar], vmin[nvar]                   2*nvar x double
+    index[nproc]: beg[3], np[3] (int), offset, nbytes (long long)
+    compressed data of each processor, one segment per variable:
+      width[nblock]   (unsigned char, 255 = single precision values)
+      bit stream      (most significant bit first, byte padded)
+  \endverbatim
+  In parallel, each processor compresses its own domain and the file
+  offsets are obtained from a prefix sum of the compressed sizes.
+  Data can be read with the pload class of pyPLUTO (datatype='cmp').
+
+  \date   Oct 19, 2026
+*/
+/* ///////////////////////////////////////////////////////////////////// */
+#include "pluto.h"
+
+#define CMP_BLOCK    4
+#define CMP_VERSION  1
+#define CMP_RAW      255
+#define CMP_QMAX     134217728.0  /* 2^27: differences fit in 32 bits */
+
+typedef struct CMP_INDEX {
+  int beg[3];           /* global index of the first interior zone */
+  int np[3];            /* number of interior zones */
+  long long offset;     /* position of the compressed data in the file */
+  long long nbytes;     /* size of the compressed data */
+} CmpIndex;
+
+typedef struct BIT_STREAM {
+  unsigned char *p;
+  unsigned long long acc;
+  int nacc;
+} BitStream;
+
+static void  PutBits (BitStream *, unsigned long long, int);
+static char *CompressVar (double ***, double, double, int *, int *, char *);
+
+/* ********************************************************************* */
+void WriteCompressed (Output *output, char *filename, Grid *grid)
+/*!
+ * Compress the variables of output and write them to filename.
+ *
+ * \param [in] output    a pointer to the output structure corresponding
+ *                       to the cmp format
+ * \param [in] filename  the output file name
+ * \param [in] grid      pointer to an array of Grid structures
+ *********************************************************************** */
+{
+  int  i, j, k, nv, nvar, nproc, np[3], head_int[7], *Q;
+  long int   nblock, ncell;
+  long long  offset, nbytes, hsize;
+  double vmin[MAX_OUTPUT_VARS], vmax[MAX_OUTPUT_VARS];
+  double tol[MAX_OUTPUT_VARS], ***V;
+  char  *buf, *p;
+  CmpIndex index;
+  static int first_call = 1;
+  #ifndef PARALLEL
+   FILE *fout;
+  #endif
+
+  nproc = 1;
+  #ifdef PARALLEL
+   MPI_Comm_size (AL_COMM_WORLD, &nproc);
+  #endif
+
+/* ----------------------------------------------------------
+    error bound of each variable from its global range;
+    staggered variables are skipped
+   ---------------------------------------------------------- */
+
+  nvar = 0;
+  for (nv = 0; nv < output->nvar; nv++){
+    if (!output->dump_var[nv]) continue;
+    if (output->stag_var[nv] != -1){
+      if (first_call){
+        print1 ("! WriteCompressed: staggered variable %s not written\n",
+                 output->var_name[nv]);
+      }
+      continue;
+    }
+    V = GetOutputVar(output, nv, grid);
+    vmin[nvar] =  1.e38;
+    vmax[nvar] = -1.e38;
+    DOM_LOOP(k,j,i){
+      vmin[nvar] = MIN(vmin[nvar], V[k][j][i]);
+      vmax[nvar] = MAX(vmax[nvar], V[k][j][i]);
+    }
+    nvar++;
+  }
+  #ifdef PARALLEL
+   MPI_Allreduce (MPI_IN_PLACE, vmin, nvar, MPI_DOUBLE, MPI_MIN, AL_COMM_WORLD);
+   MPI_Allreduce (MPI_IN_PLACE, vmax, nvar, MPI_DOUBLE, MPI_MAX, AL_COMM_WORLD);
+  #endif
+  for (nv = 0; nv < nvar; nv++){
+    tol[nv] = output->cmp_tol*(vmax[nv] - vmin[nv]);
+    if (tol[nv] <= 0.0) tol[nv] = output->cmp_tol*fabs(vmax[nv]);
+    if (tol[nv] <= 0.0) tol[nv] = 1.0;  /* all zero */
+  }
+
+/* ----------------------------------------------------------
+    compress the local domain: the buffer is large enough
+    for the worst case (single precision values)
+   ---------------------------------------------------------- */
+
+  np[IDIR] = NX1; np[JDIR] = NX2; np[KDIR] = NX3;
+  ncell  = (long int)NX1*NX2*NX3;
+  nblock = (long int)((NX1 + CMP_BLOCK - 1)/CMP_BLOCK)
+                    *((NX2 + CMP_BLOCK - 1)/CMP_BLOCK)
+                    *((NX3 + CMP_BLOCK - 1)/CMP_BLOCK);
+  buf = (char *) malloc (nvar*(nblock + ncell*sizeof(float) + 1));
+  Q   = (int *)  malloc (ncell*sizeof(int));
+  if (buf == NULL || Q == NULL){
+    print ("! WriteCompressed: not enough memory\n");
+    QUIT_PLUTO(1);
+  }
+
+  first_call = 0;
+
+  p = buf; j = 0;
+  for (nv = 0; nv < output->nvar; nv++){
+    if (!output->dump_var[nv] || output->stag_var[nv] != -1) continue;
+    p = CompressVar (GetOutputVar(output, nv, grid), vmin[j], tol[j], np, Q, p);
+    j++;
+  }
+  nbytes = p - buf;
+  free (Q);
+
+/* ----------------------------------------------------------
+    header and index
+   ---------------------------------------------------------- */
+
+  head_int[0] = CMP_VERSION;
+  head_int[1] = nvar;
+  head_int[2] = CMP_BLOCK;
+  head_int[3] = nproc;
+  head_int[4] = grid[IDIR].np_int_glob;
+  head_int[5] = grid[JDIR].np_int_glob;
+  head_int[6] = grid[KDIR].np_int_glob;
+  hsize = 8 + sizeof(head_int) + 2*nvar*sizeof(double)
+            + (long long)nproc*sizeof(CmpIndex);
+
+  offset = 0;
+  #ifdef PARALLEL
+   MPI_Exscan (&nbytes, &offset, 1, MPI_LONG_LONG, MPI_SUM, AL_COMM_WORLD);
+   if (prank == 0) offset = 0;  /* undefined on the first rank */
+  #endif
+  offset += hsize;
+
+  for (nv = 0; nv < 3; nv++){
+    index.beg[nv] = grid[nv].beg - grid[nv].gbeg;
+    index.np[nv]  = np[nv];
+  }
+  index.offset = offset;
+  index.nbytes = nbytes;
+
+  #ifdef PARALLEL
+  {
+    MPI_File   fh;
+    MPI_Status status;
+    MPI_Offset pos;
+
+    MPI_File_open (AL_COMM_WORLD, filename, MPI_MODE_CREATE | MPI_MODE_WRONLY,
+                   MPI_INFO_NULL, &fh);
+    MPI_File_set_size (fh, 0);
+    if (prank == 0){
+      pos = 0;
+      MPI_File_write_at (fh, pos, "PLUTOCMP", 8, MPI_CHAR, &status);
+      pos += 8;
+      MPI_File_write_at (fh, pos, head_int, 7, MPI_INT, &status);
+      pos += sizeof(head_int);
+      MPI_File_write_at (fh, pos, tol, nvar, MPI_DOUBLE, &status);
+      pos += nvar*sizeof(double);
+      MPI_File_write_at (fh, pos, vmin, nvar, MPI_DOUBLE, &status);
+    }
+    pos = hsize - (long long)(nproc - prank)*sizeof(CmpIndex);
+    MPI_File_write_at_all (fh, pos, &index, sizeof(CmpIndex), MPI_BYTE,
+                           &status);
+
+  /* -- the data segment may exceed the range of an int -- */
+
+    pos = offset;
+    p   = buf;
+    for (;;){
+      i = (int) MIN(nbytes, 1 << 30);
+      MPI_File_write_at_all (fh, pos, p, i, MPI_BYTE, &status);
+      nbytes -= i; pos += i; p += i;
+      i = (nbytes > 0);
+      MPI_Allreduce (MPI_IN_PLACE, &i, 1, MPI_INT, MPI_MAX, AL_COMM_WORLD);
+      if (!i) break;
+    }
+    MPI_File_close (&fh);
+  }
+  #else
+   fout = fopen (filename, "wb");
+   if (fout == NULL){
+     print ("! WriteCompressed: cannot open %s\n", filename);
+     QUIT_PLUTO(1);
+   }
+   fwrite ("PLUTOCMP", 1, 8, fout);
+   fwrite (head_int, sizeof(int), 7, fout);
+   fwrite (tol,  sizeof(double), nvar, fout);
+   fwrite (vmin, sizeof(double), nvar, fout);
+   fwrite (&index, sizeof(CmpIndex), 1, fout);
+   fwrite (buf, 1, nbytes, fout);
+   fclose (fout);
+  #endif
+
+  free (buf);
+}
+
+/* ********************************************************************* */
+static char *CompressVar (double ***V, double vmin, double tol, int *np,
+                          int *Q, char *p)
+/*!
+ * Compress the interior values of V with absolute error bound tol
+ * and append the resulting segment at p.
+ *
+ * \param [in] V     the array to be compressed
+ * \param [in] vmin  the origin of the quantization lattice
+ * \param [in] tol   the maximum absolute error
+ * \param [in] np    number of interior zones in the three directions
+ * \param [in] Q     work array of np[0]*np[1]*np[2] elements
+ * \param [in] p     pointer to the output buffer
+ *
+ * \return a pointer to the end of the segment.
+ *********************************************************************** */
+{
+  int  i, j, k, i0, j0, k0, ni, nj, nk, width, raw;
+  long int nb, n, nblock, si, sj, sk;
+  long long d;
+  unsigned long long z[CMP_BLOCK*CMP_BLOCK*CMP_BLOCK], zmax;
+  unsigned int   fbits;
+  unsigned char *width_arr;
+  float  fv;
+  double x;
+  BitStream bs;
+
+  nblock = (long int)((np[IDIR] + CMP_BLOCK - 1)/CMP_BLOCK)
+                    *((np[JDIR] + CMP_BLOCK - 1)/CMP_BLOCK)
+                    *((np[KDIR] + CMP_BLOCK - 1)/CMP_BLOCK);
+  width_arr = (unsigned char *)p;
+  bs.p    = width_arr + nblock;
+  bs.acc  = 0;
+  bs.nacc = 0;
+
+/* -- strides of Q: zones outside the domain count as zero -- */
+
+  si = 1;
+  sj = np[IDIR];
+  sk = (long int)np[IDIR]*np[JDIR];
+
+/* -- quantize -- */
+
+  raw = 0;
+  n   = 0;
+  for (k = 0; k < np[KDIR]; k++){
+  for (j = 0; j < np[JDIR]; j++){
+  for (i = 0; i < np[IDIR]; i++){
+    x = (V[KBEG + k][JBEG + j][IBEG + i] - vmin)/(2.0*tol);
+    if (!(fabs(x) < CMP_QMAX)) raw = 1;  /* also for NaN */
+    else Q[n] = (int)floor(x + 0.5);
+    n++;
+  }}}
+
+  nb = 0;
+  for (k0 = 0; k0 < np[KDIR]; k0 += CMP_BLOCK){
+  for (j0 = 0; j0 < np[JDIR]; j0 += CMP_BLOCK){
+  for (i0 = 0; i0 < np[IDIR]; i0 += CMP_BLOCK){
+    nk = MIN(CMP_BLOCK, np[KDIR] - k0);
+    nj = MIN(CMP_BLOCK, np[JDIR] - j0);
+    ni = MIN(CMP_BLOCK, np[IDIR] - i0);
+
+    n = 0;
+    zmax = 0;
+    for (k = k0; k < k0 + nk; k++){
+    for (j = j0; j < j0 + nj; j++){
+    for (i = i0; i < i0 + ni; i++){
+      if (raw){
+        fv = (float)V[KBEG + k][JBEG + j][IBEG + i];
+        memcpy (&fbits, &fv, sizeof(float));
+        z[n++] = fbits;
+        continue;
+      }
+
+    /* -- Lorenzo difference, zig-zag encoded -- */
+
+      #define QQ(a,b,c)  Q[(a)*sk + (b)*sj + (c)*si]
+      d = QQ(k,j,i);
+      if (i > 0) d -= QQ(k,j,i-1);
+      if (j > 0) d -= QQ(k,j-1,i);
+      if (k > 0) d -= QQ(k-1,j,i);
+      if (i > 0 && j > 0) d += QQ(k,j-1,i-1);
+      if (i > 0 && k > 0) d += QQ(k-1,j,i-1);
+      if (j > 0 && k > 0) d += QQ(k-1,j-1,i);
+      if (i > 0 && j > 0 && k > 0) d -= QQ(k-1,j-1,i-1);
+      #undef QQ
+      z[n] = d >= 0 ? 2*(unsigned long long)d
+                    : 2*(unsigned long long)(-d) - 1;
+      zmax = MAX(zmax, z[n]);
+      n++;
+    }}}
+
+    if (raw) width = CMP_RAW;
+    else     for (width = 0; zmax >> width; width++);
+
+    width_arr[nb++] = (unsigned char)width;
+    for (i = 0; i < n; i++) PutBits (&bs, z[i], raw ? 32:width);
+  }}}
+
+  if (bs.nacc > 0) PutBits (&bs, 0, 8 - bs.nacc);  /* pad last byte */
+  return (char *)bs.p;
+}
+
+/* ********************************************************************* */
+static void PutBits (BitStream *bs, unsigned long long v, int width)
+/*!
+ * Append the width least significant bits of v to the bit stream.
+ *
+ *********************************************************************** */
+{
+  if (width == 0) return;
+  bs->acc   = (bs->acc << width) | v;
+  bs->nacc += width;
+  while (bs->nacc >= 8){
+    bs->nacc -= 8;
+    *(bs->p)++ = (unsigned char)(bs->acc >> bs->nacc);
+  }
+  bs->acc &= (1ULL << bs->nacc) - 1;
+}
+#undef CMP_BLOCK
+#undef CMP_VERSION
+#undef CMP_RAW
+#undef CMP_QMAX
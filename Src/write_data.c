@@ -11,9 +11,16 @@
   - HDF5 files are handled by hdf5_io.c.
   - image files are handled by write_img.c
   - tabulated ascii files are handled by write_tab.c
+  - compressed files are handled by write_cmp.c
+
+  User-defined variables given as kernels (see SetUserVarKernel())
+  are retrieved through GetOutputVar() and evaluated only by the
+  outputs writing them.
 
   This function also updates the corresponding .out file associated 
   with the output data format.
+  When output is asynchronous the files are written by WriteDataFiles()
+  from a separate thread (see async_output.c).
 
   \authors A. Mignone (mignone@ph.unito.it)\n
            G. Muscianisi (g.muscianisi@cineca.it)
@@ -35,12 +42,48 @@ void WriteData (const Data *d, Output *output, Grid *grid)
  *                    format
  * \param [in] grid   pointer to an array of Grid structures
  *********************************************************************** */
+{
+  static int last_computed_var = -1;
+
+/* -----------------------------------------------------------
+                Increment the file number 
+   ----------------------------------------------------------- */
+
+  output->nfile++;
+
+/* --------------------------------------------------------
+            Get user var if necessary 
+   -------------------------------------------------------- */
+
+  if (last_computed_var != g_stepNumber && d->Vuser != NULL) {
+    ComputeUserVar (d, grid);
+    last_computed_var = g_stepNumber;
+  }
+
+/* --------------------------------------------------------
+     Hand the output over to the I/O thread, if any
+   -------------------------------------------------------- */
+
+  if (AsyncOutputPost (d, output, grid)) return;
+
+  WriteDataFiles (output, grid);
+}
+
+/* ********************************************************************* */
+void WriteDataFiles (Output *output, Grid *grid)
+/*!
+ * Write the files of output number output->nfile and update the
+ * corresponding .out file.
+ *
+ * \param [in] output the output structure corresponding to a given
+ *                    format
+ * \param [in] grid   pointer to an array of Grid structures
+ *********************************************************************** */
 {
   int    i, j, k, nv;
   int    single_file;
   size_t dsize;
   char   filename[512], sline[512];
-  static int last_computed_var = -1;
   double units[MAX_OUTPUT_VARS]; 
   float ***Vpt3;
   void *Vpt;
@@ -49,30 +92,19 @@ void WriteData (const Data *d, Output *output, Grid *grid)
   long long offset;
 
 /* -----------------------------------------------------------
-            Increment the file number and initialize units
+                    Initialize units
    ----------------------------------------------------------- */
 
-  output->nfile++;
-
   print1 ("> Writing file #%d (%s) to disk...", output->nfile, output->ext);
 
   #ifdef PARALLEL
-   MPI_Barrier (MPI_COMM_WORLD);
+   MPI_Barrier (AL_COMM_WORLD);
    if (prank == 0) time(&tbeg);
   #endif
 
   for (nv = 0; nv < MAX_OUTPUT_VARS; nv++) units[nv] = 1.0;
   if (output->cgs) GetCGSUnits(units);
 
-/* --------------------------------------------------------
-            Get user var if necessary 
-   -------------------------------------------------------- */
-
-  if (last_computed_var != g_stepNumber && d->Vuser != NULL) {
-    ComputeUserVar (d, grid);
-    last_computed_var = g_stepNumber;
-  }
-
 /* --------------------------------------------------------
             Select the output type 
    -------------------------------------------------------- */
@@ -114,7 +146,7 @@ void WriteData (const Data *d, Output *output, Grid *grid)
 
         if      (output->stag_var[nv] == -1) {  /* -- cell-centered data -- */
           sz = SZ;
-          Vpt = (void *)output->V[nv][0][0];
+          Vpt = (void *)GetOutputVar(output, nv, grid)[0][0];
         } else if (output->stag_var[nv] == 0) { /* -- x-staggered data -- */
           sz  = SZ_stagx;
           Vpt = (void *)(output->V[nv][0][0]-1);
@@ -148,7 +180,7 @@ void WriteData (const Data *d, Output *output, Grid *grid)
 
         if      (output->stag_var[nv] == -1) {  /* -- cell-centered data -- */
           sz = SZ;
-          Vpt = (void *)output->V[nv][0][0];
+          Vpt = (void *)GetOutputVar(output, nv, grid)[0][0];
         } else if (output->stag_var[nv] == 0) { /* -- x-staggered data -- */
           sz  = SZ_stagx;
           Vpt = (void *)(output->V[nv][0][0]-1);
@@ -180,7 +212,7 @@ void WriteData (const Data *d, Output *output, Grid *grid)
       for (nv = 0; nv < output->nvar; nv++) {
         if (!output->dump_var[nv]) continue;
 /*        Vpt = (void *)(Convert_dbl2flt(output->V[nv],0))[0][0];  */
-        Vpt3 = Convert_dbl2flt(output->V[nv], units[nv],0);
+        Vpt3 = Convert_dbl2flt(GetOutputVar(output, nv, grid), units[nv],0);
         Vpt = (void *)Vpt3[0][0];
         WriteBinaryArray (Vpt, sizeof(float), SZ_float, fbin, 
                           output->stag_var[nv]);
@@ -198,7 +230,7 @@ BOV_Header(output, filename);
 
         fbin = OpenBinaryFile (filename, SZ_float, "w");
 /*        Vpt = (void *)(Convert_dbl2flt(output->V[nv],0))[0][0];   */
-        Vpt3 = Convert_dbl2flt(output->V[nv], units[nv],0);
+        Vpt3 = Convert_dbl2flt(GetOutputVar(output, nv, grid), units[nv],0);
         Vpt = (void *)Vpt3[0][0];
         WriteBinaryArray (Vpt, sizeof(float), SZ_float, fbin, 
                           output->stag_var[nv]);
@@ -253,7 +285,7 @@ BOV_Header(output, filename);
       
       for (nv = 0; nv < output->nvar; nv++) { /* -- write scalars -- */
         if (output->dump_var[nv] != YES) continue;
-        WriteVTK_Scalar (fbin, output->V[nv], units[nv],
+        WriteVTK_Scalar (fbin, GetOutputVar(output, nv, grid), units[nv],
                          output->var_name[nv], grid);
       }
       CloseBinaryFile(fbin, SZ_float);
@@ -292,12 +324,23 @@ BOV_Header(output, filename);
          fbin  = OpenBinaryFile(filename, SZ_float, "w");
          AL_Set_offset(SZ_float, offset);
         #endif
-        WriteVTK_Scalar(fbin, output->V[nv], units[nv],
+        WriteVTK_Scalar(fbin, GetOutputVar(output, nv, grid), units[nv],
                         output->var_name[nv], grid);
         CloseBinaryFile (fbin, SZ_float);
       }
     }
 
+  }else if (output->type == PVTK_OUTPUT) { 
+
+  /* ------------------------------------------------------
+       Parallel XML VTK output: one or more piece files
+       and an index file (see write_pvtk.c)
+     ------------------------------------------------------ */
+
+    single_file = NO;
+    sprintf (filename, "%s/data.%04d", output->dir, output->nfile);
+    WritePVTK (output, filename, units, grid);
+
   }else if (output->type == TAB_OUTPUT) { 
 
   /* ------------------------------------------------------
@@ -309,6 +352,17 @@ BOV_Header(output, filename);
                                          output->ext);
     WriteTabArray (output, filename, grid);
 
+  }else if (output->type == CMP_OUTPUT) { 
+
+  /* ------------------------------------------------------
+          Compressed (lossy, error-bounded) output
+     ------------------------------------------------------ */
+
+    single_file = YES;
+    sprintf (filename,"%s/data.%04d.%s", output->dir, output->nfile,
+                                         output->ext);
+    WriteCompressed (output, filename, grid);
+
   }else if (output->type == PPM_OUTPUT) { 
 
   /* ------------------------------------------------------
@@ -320,7 +374,8 @@ BOV_Header(output, filename);
       if (!output->dump_var[nv]) continue;
       sprintf (filename, "%s/%s.%04d.%s", output->dir, output->var_name[nv], 
                                           output->nfile, output->ext);
-      WritePPM (output->V[nv], output->var_name[nv], filename, grid);
+      WritePPM (GetOutputVar(output, nv, grid), output->var_name[nv],
+                filename, grid);
     }
 
   }else if (output->type == PNG_OUTPUT) { 
@@ -335,7 +390,8 @@ BOV_Header(output, filename);
        if (!output->dump_var[nv]) continue;
        sprintf (filename, "%s/%s.%04d.%s", output->dir, output->var_name[nv], 
                                            output->nfile, output->ext);
-       WritePNG (output->V[nv], output->var_name[nv], filename, grid);
+       WritePNG (GetOutputVar(output, nv, grid), output->var_name[nv],
+                 filename, grid);
      }
     #else
      print1 ("! PNG library not available\n");
@@ -371,7 +427,9 @@ BOV_Header(output, filename);
     else                  fprintf (fout, "big ");
 
     for (nv = 0; nv < output->nvar; nv++) { 
-      if (output->dump_var[nv]) fprintf (fout, "%s ", output->var_name[nv]);
+      if (!output->dump_var[nv]) continue;
+      if (output->type == CMP_OUTPUT && output->stag_var[nv] != -1) continue;
+      fprintf (fout, "%s ", output->var_name[nv]);
     }
 
     fprintf (fout,"\n");
@@ -379,7 +437,7 @@ BOV_Header(output, filename);
   }
 
   #ifdef PARALLEL
-   MPI_Barrier (MPI_COMM_WORLD);
+   MPI_Barrier (AL_COMM_WORLD);
    if (prank == 0){
      time(&tend);
      print1 (" [%5.2f sec]",difftime(tend,tbeg));
@@ -391,6 +449,7 @@ BOV_Header(output, filename);
 
 #ifdef USE_ASYNC_IO
 static float ****Vflt;
+static int vflt_epoch;
 static int perf_output[16] = {0};
 /* ********************************************************************* */
 void Async_BegWriteData (const Data *d, Output *output, Grid *grid)
@@ -405,9 +464,10 @@ void Async_BegWriteData (const Data *d, Output *output, Grid *grid)
  *
  *********************************************************************** */
 {
-  int  i, j, k, nv;
+  int  i, j, k, nv, tag;
   size_t dsize;
   char   filename[128];
+  double ***V;
   static int last_computed_var = -1;
 
 /* -----------------------------------------------------------
@@ -450,14 +510,22 @@ void Async_BegWriteData (const Data *d, Output *output, Grid *grid)
                                   output->dump_var, output->nvar);
   }
   if (dsize == sizeof(float)){
+    if (Vflt != NULL && vflt_epoch != g_gridEpoch){
+      FreeArray4D ((void *) Vflt);
+      Vflt = NULL;
+    }
     if (Vflt == NULL){
+      tag  = MemoryTag (MEM_OUTPUT);
       Vflt = ARRAY_4D(output->nvar, NX3_TOT, NX2_TOT, NX1_TOT, float);
+      MemoryTag (tag);
+      vflt_epoch = g_gridEpoch;
     }
   
     /* similar to CONVERT_TO_FLOAT, with swap_endian disabled */
     
     for (nv = 0; nv < output->nvar; nv++){
-      DOM_LOOP(k,j,i) Vflt[nv][k][j][i] = (float)output->V[nv][k][j][i]; 
+      V = GetOutputVar(output, nv, grid);
+      DOM_LOOP(k,j,i) Vflt[nv][k][j][i] = (float)V[k][j][i]; 
     }
     AL_Write_array_begin ((void *)Vflt[0][0][0], SZ_float, 
                           output->stag_var, output->dump_var, output->nvar);
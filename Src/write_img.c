@@ -147,46 +147,32 @@ void GetSlice (double ***Vdbl, Image *image, Grid *grid)
  * PURPOSE
  *
  *  get a 2D slice from the 3D array Vdbl.
- *  The array is actually written to disk and
- *  re-open for reading immediately after by
- *  proc #0. 
- *  Store its content as 2D rgb structure inside 
+ *  Each processor whose sub-domain intersects the 
+ *  slice plane copies its patch of the slice;
+ *  patches are then gathered by proc #0 (see
+ *  GatherPlane()), which assembles the slice and
+ *  stores its content as 2D rgb structure inside 
  *  image->rgb.
  *   
  *
  * 
  ************************************************************* */
 {
-  int i, j, k;
+  int i, n;
   int nx, ny, nz;
-  int col_offset, row_offset;
-  int offset, ir, ic;
-  char filename[256];
+  int ir, ic, dcol, drow, dnrm, ind[3];
+  int s, ln[2], goff[3], poff[2], np[2];
   float xflt, slice_min, slice_max;
+  double *patch;
+  static double *plane;
   static float **slice;
   static RGB **rgb;
-  FILE *fl;
-  size_t dsize = sizeof(float);
 
   #if DIMENSIONS == 1
    print1 ("! PPM output disabled in 1-D\n");
    return;    
   #endif    
 
-/* ------------------------------------------------ 
-    Write the whole array in single precision
-    Slice are post-processed later 
-   ------------------------------------------------ */
-  
-  fl = OpenBinaryFile ("tmp_file.out", SZ_float, "w");
-  WriteBinaryArray ((Convert_dbl2flt(Vdbl,1.0, 0))[0][0], dsize, SZ_float, fl, -1); 
-  CloseBinaryFile (fl, SZ_float);
-  #ifdef PARALLEL
-   MPI_Barrier (MPI_COMM_WORLD);
-  #endif
-
-  if (prank != 0) return; /* -- rank 0 will do the rest -- */
-
 /* ------------------------------------------------
           get global dimensions
    ------------------------------------------------ */
@@ -195,73 +181,79 @@ void GetSlice (double ***Vdbl, Image *image, Grid *grid)
   ny = grid[JDIR].gend + 1 - grid[JDIR].nghost;
   nz = grid[KDIR].gend + 1 - grid[KDIR].nghost;
 
-/* -----------------------------------------
-     Allocate memory: make slices big
-     enough to contain slices of different 
-     sizes.
-   ----------------------------------------- */
-
-  if (slice == NULL) {
-    ic = MAX(nx,ny); 
-    ir = MAX(ny,nz);
-    slice = ARRAY_2D(ir, ic, float);
-    rgb   = ARRAY_2D(ir, ic, RGB);
-  }
-
 /* --------------------------------------------
-       set offsets for slice reading
+    Set the column, row and normal directions
+    of the slice plane
    -------------------------------------------- */
 
-  fl = fopen ("tmp_file.out", "rb");
-  if (image->slice_plane == X12_PLANE){
-
-    k = GET_SLICE_INDEX (image->slice_plane, image->slice_coord, grid);
-    offset = k*nx*ny*dsize; 
-    fseek (fl, offset, SEEK_SET);
-    col_offset = 0;
-    row_offset = 0;
-    image->ncol = nx;
-    image->nrow = ny;
-
-  } else if (image->slice_plane == X13_PLANE){
-
-    j = GET_SLICE_INDEX (image->slice_plane, image->slice_coord, grid);
-    offset = j*nx*dsize;
-    fseek (fl, offset, SEEK_CUR);
-    col_offset = 0;
-    row_offset = nx*(ny - 1)*dsize; 
+  if (image->slice_plane == X13_PLANE){
+    dcol = IDIR; drow = KDIR; dnrm = JDIR;
     image->ncol = nx;
     image->nrow = nz;
-
   } else if (image->slice_plane == X23_PLANE){
-    
-    i = GET_SLICE_INDEX (image->slice_plane, image->slice_coord, grid);
-    offset = i*dsize;
-    fseek (fl, offset, SEEK_CUR);
-    col_offset = (nx - 1)*dsize; 
-    row_offset = 0;
+    dcol = JDIR; drow = KDIR; dnrm = IDIR;
     image->ncol = ny;
     image->nrow = nz;
+  } else {
+    dcol = IDIR; drow = JDIR; dnrm = KDIR;
+    image->ncol = nx;
+    image->nrow = ny;
+  }
+  s = GET_SLICE_INDEX (image->slice_plane, image->slice_coord, grid);
+
+/* ------------------------------------------------
+    Copy the local patch of the slice, if any.
+    goff[] is the global (interior) index of the
+    first local interior zone.
+   ------------------------------------------------ */
 
+  for (n = 0; n < 3; n++) goff[n] = grid[n].beg - grid[n].gbeg;
+
+  ln[0] = ln[1] = 0;
+  if (s >= goff[dnrm] && s < goff[dnrm] + grid[dnrm].np_int){
+    ln[0] = grid[dcol].np_int;
+    ln[1] = grid[drow].np_int;
   }
+  patch = ARRAY_1D(MAX(ln[0]*ln[1],1), double);
+
+  ind[dnrm] = s - goff[dnrm] + grid[dnrm].nghost;
+  for (ir = 0; ir < ln[1]; ir++){
+  for (ic = 0; ic < ln[0]; ic++){
+    ind[drow] = ir + grid[drow].nghost;
+    ind[dcol] = ic + grid[dcol].nghost;
+    patch[ir*ln[0] + ic] = Vdbl[ind[KDIR]][ind[JDIR]][ind[IDIR]];
+  }}
 
 /* -----------------------------------------
-            Read slice  
+     Allocate memory: make slices big
+     enough to contain slices of different 
+     sizes.
    ----------------------------------------- */
 
-  for (ir = 0; ir < image->nrow; ir++) {
-    for (ic = 0; ic < image->ncol; ic++) {     
-      fread (&xflt, dsize, 1, fl);
-      if (feof(fl)){
-         printf (" ! end of file reached\n");
-         QUIT_PLUTO(1);
-      }
-      slice[image->nrow - 1 - ir][ic] = xflt;  /* -- swap row order -- */
-      if (col_offset > 0) fseek(fl, col_offset, SEEK_CUR);
-    }
-    if (row_offset > 0) fseek(fl, row_offset, SEEK_CUR);
+  if (prank == 0 && slice == NULL) {
+    ic = MAX(nx,ny); 
+    ir = MAX(ny,nz);
+    plane = ARRAY_1D(ir*ic, double);
+    slice = ARRAY_2D(ir, ic, float);
+    rgb   = ARRAY_2D(ir, ic, RGB);
   }
-  fclose(fl);
+
+/* -----------------------------------------
+      Assemble slice from patches on proc #0
+   ----------------------------------------- */
+
+  poff[0] = goff[dcol];
+  poff[1] = goff[drow];
+  np[0]   = image->ncol;
+  np[1]   = image->nrow;
+  GatherPlane (patch, 1, ln, poff, plane, np);
+  FreeArray1D ((void *) patch);
+  if (prank != 0) return;   /* -- rank 0 will do the rest -- */
+
+  for (ir = 0; ir < image->nrow; ir++){   /* -- swap row order -- */
+  for (ic = 0; ic < image->ncol; ic++){
+    slice[image->nrow - 1 - ir][ic] = (float) plane[ir*image->ncol + ic];
+  }}
 
 /* -----------------------------------------------------------
          Get slice max and min 
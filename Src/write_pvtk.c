@@ -0,0 +1,524 @@
+/* ///////////////////////////////////////////////////////////////////// */
+/*!
+  \file
+  \brief Write data in the parallel XML VTK format.
+
+  WritePVTK() provides the \c pvtk output format, an alternative to the
+  legacy \c vtk format which scales to large processor counts:
+
+  - every processor writes its own subdomain as one piece of an XML
+    ImageData (.vti, uniform grids) or RectilinearGrid (.vtr) dataset;
+  - data are stored in single precision as raw appended data in the
+    native byte order of the machine (declared in the file), so that no
+    byte swapping is needed when writing or, on the same architecture,
+    reading;
+  - processor 0 writes the index file (.pvti or .pvtr) listing the
+    pieces, which is the file to be opened with ParaView or VisIt.
+    Pieces are then read in parallel by parallel readers.
+
+  By default each processor writes a separate file,
+  <tt>data.nnnn.pXXXX.vti</tt>.
+  For large runs the number of files can be reduced by giving it as the
+  third field of the \c pvtk line in pluto.ini:
+  \verbatim
+    pvtk    -1.0   100   64
+  \endverbatim
+  Processors are then divided into (at most) 64 groups of consecutive
+  ranks: the first processor of each group receives the pieces of the
+  others and writes all of them, one after the other, in the same file.
+
+  Scalars are written as cell data; quantities flagged as VTK_VECTOR
+  (velocity and magnetic field, see VTK_VECTOR_DUMP) are converted to
+  Cartesian components as in the legacy format.
+  Only Cartesian and cylindrical geometries are supported.
+
+  \b Reference
+
+  https://vtk.org/wp-content/uploads/2015/04/file-formats.pdf
+
+  \date   Oct 19, 2026
+*/
+/* ///////////////////////////////////////////////////////////////////// */
+#include "pluto.h"
+
+#define PVTK_CHUNK  (1 << 28)   /* max. number of floats per message */
+
+static int   PVTK_ArrayList (Output *, int *, int *);
+static void  PVTK_Extent (Grid *, int *);
+static void  PVTK_Layout (int *, int, int *, long long *);
+static float *PVTK_Fill (Output *, int, int, double, float *, Grid *);
+static char *PVTK_ArrayName (char *, int);
+static void  PVTK_WriteIndex (Output *, char *, int *, int *, int *, int, int,
+                              Grid *);
+static void  PVTK_WritePieces (Output *, char *, int *, int, int *, int *,
+                               int, double *, Grid *);
+
+static int  image_data;     /* 1: ImageData, 0: RectilinearGrid */
+static char piece_ext[8], index_ext[8];
+
+/* ********************************************************************* */
+void WritePVTK (Output *output, char *basename, double *units, Grid *grid)
+/*!
+ * Write the variables selected in output as a parallel XML VTK
+ * dataset: the pieces <basename>.pXXXX.vt[ir] and the index file
+ * <basename>.pvt[ir].
+ *
+ * \param [in] output    pointer to an Output structure
+ * \param [in] basename  path of the files without extension
+ *                       (e.g. "./data.0004")
+ * \param [in] units     conversion factors (cgs units)
+ * \param [in] grid      pointer to an array of Grid structures
+ *********************************************************************** */
+{
+  int  d, i, nproc, nfiles, group, narr;
+  int  ext[6], *all_ext, arr_nv[MAX_OUTPUT_VARS], arr_nc[MAX_OUTPUT_VARS];
+  double dx0;
+  static int first_call = 1;
+
+/* --------------------------------------------------------
+    The grid can be written as ImageData only if uniform
+   -------------------------------------------------------- */
+
+  if (first_call){
+    image_data = 1;
+    for (d = 0; d < DIMENSIONS; d++){
+      dx0 = grid[d].dx_glob[grid[d].gbeg];
+      for (i = grid[d].gbeg; i <= grid[d].gend; i++){
+        if (fabs(grid[d].dx_glob[i] - dx0) > 1.e-9*dx0) image_data = 0;
+      }
+    }
+    sprintf (piece_ext, image_data ? "vti":"vtr");
+    sprintf (index_ext, image_data ? "pvti":"pvtr");
+    first_call = 0;
+  }
+
+  narr = PVTK_ArrayList (output, arr_nv, arr_nc);
+  PVTK_Extent (grid, ext);
+
+/* --------------------------------------------------------
+    Assign processors to files and collect the extents
+   -------------------------------------------------------- */
+
+  #ifdef PARALLEL
+   MPI_Comm_size (AL_COMM_WORLD, &nproc);
+  #else
+   nproc = 1;
+  #endif
+  nfiles = output->nfiles;
+  if (nfiles <= 0 || nfiles > nproc) nfiles = nproc;
+  group = (int)(((long)prank*nfiles)/nproc);
+
+  all_ext = ARRAY_1D(6*nproc, int);
+  #ifdef PARALLEL
+   MPI_Gather (ext, 6, MPI_INT, all_ext, 6, MPI_INT, 0, AL_COMM_WORLD);
+  #else
+   for (i = 0; i < 6; i++) all_ext[i] = ext[i];
+  #endif
+
+  PVTK_WritePieces (output, basename, ext, group, arr_nv, arr_nc, narr,
+                    units, grid);
+  if (prank == 0) PVTK_WriteIndex (output, basename, all_ext, arr_nv,
+                                   arr_nc, narr, nfiles, grid);
+
+  FreeArray1D ((void *) all_ext);
+}
+
+/* ********************************************************************* */
+static int PVTK_ArrayList (Output *output, int *arr_nv, int *arr_nc)
+/*!
+ * Build the list of the cell data arrays being written: the index
+ * of the output variable (arr_nv) and the number of components
+ * (arr_nc, 1 or 3).
+ *
+ * \return the number of arrays
+ *********************************************************************** */
+{
+  int nv, narr = 0;
+
+  for (nv = 0; nv < output->nvar; nv++){
+    if (output->dump_var[nv] == VTK_VECTOR){
+      arr_nv[narr]   = nv;
+      arr_nc[narr++] = 3;
+    }else if (output->dump_var[nv] == YES){
+      arr_nv[narr]   = nv;
+      arr_nc[narr++] = 1;
+    }
+  }
+  return narr;
+}
+
+/* ********************************************************************* */
+static char *PVTK_ArrayName (char *var_name, int nc)
+/*!
+ * Return the name of a cell data array: the variable name for
+ * scalars, Velocity or Magnetic_Field for vectors.
+ *********************************************************************** */
+{
+  if (nc == 1) return var_name;
+  return strcmp(var_name, "bx1") == 0 ? "Magnetic_Field":"Velocity";
+}
+
+/* ********************************************************************* */
+static void PVTK_Extent (Grid *grid, int *ext)
+/*!
+ * Return the extent (first and last node index in each direction)
+ * of the local domain.
+ *********************************************************************** */
+{
+  int d, gbeg;
+
+  for (d = 0; d < 3; d++){
+    ext[2*d] = ext[2*d + 1] = 0;
+    if (d >= DIMENSIONS) continue;
+    #ifdef PARALLEL
+     gbeg = grid[d].beg - grid[d].gbeg;
+    #else
+     gbeg = 0;
+    #endif
+    ext[2*d]     = gbeg;
+    ext[2*d + 1] = gbeg + grid[d].np_int;
+  }
+}
+
+/* ********************************************************************* */
+static void PVTK_Layout (int *ext, int narr, int *arr_nc, long long *offset)
+/*!
+ * Compute the offset of each array of a piece with extent ext within
+ * the appended data of the piece: the coordinates (RectilinearGrid
+ * only) come first, then the cell data arrays.
+ * Every array is preceded by its size in bytes (8-byte integer).
+ * offset[] has 3 + narr + 1 elements; the last one is the total size.
+ *********************************************************************** */
+{
+  int  d, n;
+  long long ncells = 1, off = 0;
+
+  for (d = 0; d < 3; d++){
+    offset[d] = off;
+    if (!image_data) off += sizeof(long long)
+                          + (ext[2*d + 1] - ext[2*d] + 1)*sizeof(float);
+    ncells *= MAX(ext[2*d + 1] - ext[2*d], 1);
+  }
+  for (n = 0; n < narr; n++){
+    offset[3 + n] = off;
+    off += sizeof(long long) + ncells*arr_nc[n]*sizeof(float);
+  }
+  offset[3 + narr] = off;
+}
+
+/* ********************************************************************* */
+static float *PVTK_Fill (Output *output, int n, int nc, double unit,
+                         float *buf, Grid *grid)
+/*!
+ * Copy into buf the values of the local domain of output variable n
+ * (with nc = 3 components for vectors) in the order expected by VTK.
+ * For n < 0, copy the node coordinates along direction -n-1.
+ *
+ * \return a pointer to buf
+ *********************************************************************** */
+{
+  int  i, j, k, c, d, m = 0;
+  int  beg[3] = {IBEG, JBEG, KBEG}, np[3] = {NX1, NX2, NX3};
+  double v[3], x1, x2, x3, ***V;
+
+  if (n < 0){     /* -- node coordinates -- */
+    d = -n - 1;
+    if (d >= DIMENSIONS) {
+      buf[0] = 0.0;
+      return buf;
+    }
+    for (i = 0; i < np[d]; i++) buf[i] = (float)grid[d].xl[beg[d] + i];
+    buf[np[d]] = (float)grid[d].xr[beg[d] + np[d] - 1];
+    return buf;
+  }
+
+  if (nc == 1){
+    V = GetOutputVar(output, n, grid);
+    DOM_LOOP(k,j,i) buf[m++] = (float)(V[k][j][i]*unit);
+    return buf;
+  }
+
+  v[0] = v[1] = v[2] = 0.0;
+  x1 = x2 = x3 = 0.0;
+  DOM_LOOP(k,j,i){
+    D_EXPAND(v[0] = output->V[n][k][j][i];     x1 = grid[IDIR].x[i]; ,
+             v[1] = output->V[n + 1][k][j][i]; x2 = grid[JDIR].x[j]; ,
+             v[2] = output->V[n + 2][k][j][i]; x3 = grid[KDIR].x[k];)
+    VectorCartesianComponents(v, x1, x2, x3);
+    for (c = 0; c < 3; c++) buf[m++] = (float)(v[c]*unit);
+  }
+  return buf;
+}
+
+/* ********************************************************************* */
+static void PVTK_WritePieces (Output *output, char *basename, int *ext,
+                              int group, int *arr_nv, int *arr_nc, int narr,
+                              double *units, Grid *grid)
+/*!
+ * Write the pieces of the processors in the same group as this one
+ * into a single file.
+ * The first processor of the group writes the XML header for all the
+ * pieces, then its own data and those received from the other
+ * processors of the group, in rank order.
+ *********************************************************************** */
+{
+  int  d, n, p, np, gsize, grank, *gext, *pext, nc;
+  char fname[512];
+  long long *offset, base, nbytes, size, ncells;
+  float *buf;
+  FILE *fp = NULL;
+  #ifdef PARALLEL
+   MPI_Comm gcomm;
+   MPI_Status status;
+  #endif
+
+  #ifdef PARALLEL
+   MPI_Comm_split (AL_COMM_WORLD, group, prank, &gcomm);
+   MPI_Comm_size (gcomm, &gsize);
+   MPI_Comm_rank (gcomm, &grank);
+  #else
+   gsize = 1;
+   grank = 0;
+  #endif
+
+  gext   = ARRAY_1D(6*gsize, int);
+  offset = ARRAY_1D(4 + narr, long long);
+  #ifdef PARALLEL
+   MPI_Gather (ext, 6, MPI_INT, gext, 6, MPI_INT, 0, gcomm);
+  #else
+   for (d = 0; d < 6; d++) gext[d] = ext[d];
+  #endif
+
+/* -- buffer for one array of the largest piece handled here -- */
+
+  size = 0;
+  for (p = 0; p < (grank == 0 ? gsize : 1); p++){
+    pext   = (grank == 0 ? gext + 6*p : ext);
+    ncells = 1;
+    for (d = 0; d < 3; d++){
+      ncells *= MAX(pext[2*d + 1] - pext[2*d], 1);
+      size    = MAX(size, pext[2*d + 1] - pext[2*d] + 1);
+    }
+    size = MAX(size, 3*ncells);
+  }
+  buf = ARRAY_1D(size, float);
+
+/* --------------------------------------------------------
+    Group leader: write the XML header of all pieces
+   -------------------------------------------------------- */
+
+  if (grank == 0){
+    sprintf (fname, "%s.p%04d.%s", basename, group, piece_ext);
+    fp = fopen (fname, "wb");
+    if (fp == NULL){
+      printf ("! WritePVTK: cannot open file %s\n", fname);
+      QUIT_PLUTO(1);
+    }
+    fprintf (fp, "<?xml version=\"1.0\"?>\n");
+    fprintf (fp, "<VTKFile type=\"%s\" version=\"1.0\" byte_order=\"%s\""
+                 " header_type=\"UInt64\">\n",
+                 image_data ? "ImageData":"RectilinearGrid",
+                 IsLittleEndian() ? "LittleEndian":"BigEndian");
+    if (image_data){
+      fprintf (fp, "  <ImageData WholeExtent=\"");
+    }else{
+      fprintf (fp, "  <RectilinearGrid WholeExtent=\"");
+    }
+    for (d = 0; d < 3; d++){
+      fprintf (fp, "%d %d%s", 0, d < DIMENSIONS ? grid[d].np_int_glob:0,
+                              d < 2 ? " ":"\"");
+    }
+    if (image_data){
+      fprintf (fp, "\n    Origin=\"");
+      for (d = 0; d < 3; d++){
+        fprintf (fp, "%.9g%s", d < DIMENSIONS ? grid[d].xl_glob[grid[d].gbeg]:0.0,
+                               d < 2 ? " ":"\"");
+      }
+      fprintf (fp, " Spacing=\"");
+      for (d = 0; d < 3; d++){
+        fprintf (fp, "%.9g%s", d < DIMENSIONS ? grid[d].dx_glob[grid[d].gbeg]:1.0,
+                               d < 2 ? " ":"\"");
+      }
+    }
+    fprintf (fp, ">\n");
+    fprintf (fp, "    <FieldData>\n");
+    fprintf (fp, "      <DataArray type=\"Float64\" Name=\"TIME\""
+                 " NumberOfTuples=\"1\" format=\"ascii\"> %.16e </DataArray>\n",
+                 g_time);
+    fprintf (fp, "    </FieldData>\n");
+
+    base = 0;
+    for (p = 0; p < gsize; p++){
+      PVTK_Layout (gext + 6*p, narr, arr_nc, offset);
+      fprintf (fp, "    <Piece Extent=\"%d %d %d %d %d %d\">\n",
+               gext[6*p],     gext[6*p + 1], gext[6*p + 2],
+               gext[6*p + 3], gext[6*p + 4], gext[6*p + 5]);
+      if (!image_data){
+        fprintf (fp, "      <Coordinates>\n");
+        for (d = 0; d < 3; d++){
+          fprintf (fp, "        <DataArray type=\"Float32\" Name=\"x%d\""
+                       " format=\"appended\" offset=\"%lld\"/>\n",
+                       d + 1, base + offset[d]);
+        }
+        fprintf (fp, "      </Coordinates>\n");
+      }
+      fprintf (fp, "      <CellData>\n");
+      for (n = 0; n < narr; n++){
+        fprintf (fp, "        <DataArray type=\"Float32\" Name=\"%s\"",
+                 PVTK_ArrayName (output->var_name[arr_nv[n]], arr_nc[n]));
+        if (arr_nc[n] == 3) fprintf (fp, " NumberOfComponents=\"3\"");
+        fprintf (fp, " format=\"appended\" offset=\"%lld\"/>\n",
+                 base + offset[3 + n]);
+      }
+      fprintf (fp, "      </CellData>\n");
+      fprintf (fp, "    </Piece>\n");
+      base += offset[3 + narr];
+    }
+    fprintf (fp, "  </%s>\n", image_data ? "ImageData":"RectilinearGrid");
+    fprintf (fp, "  <AppendedData encoding=\"raw\">\n_");
+  }
+
+/* --------------------------------------------------------
+    Write (leader) or send (others) the appended data,
+    one array at a time
+   -------------------------------------------------------- */
+
+  for (p = 0; p < gsize; p++){
+    if (grank != 0 && grank != p) continue;
+    pext = (grank == 0 ? gext + 6*p : ext);  /* -- gext is set on leader only -- */
+    for (n = -3; n < narr; n++){
+      if (n < 0 && image_data) continue;
+
+      if (n < 0){       /* -- coordinates x1, x2, x3 -- */
+        d  = n + 3;
+        nc = 1;
+        np = pext[2*d + 1] - pext[2*d] + 1;
+      }else{
+        nc = arr_nc[n];
+        np = 1;
+        for (d = 0; d < 3; d++) np *= MAX(pext[2*d + 1] - pext[2*d], 1);
+      }
+      nbytes = (long long)np*nc*sizeof(float);
+
+      if (p == grank){   /* -- own data -- */
+        if (n < 0) PVTK_Fill (output, -d - 1, 1, 1.0, buf, grid);
+        else       PVTK_Fill (output, arr_nv[n], nc, units[arr_nv[n]], buf, grid);
+      }
+
+      #ifdef PARALLEL
+       if (p != 0){     /* -- send to / receive from the leader -- */
+         long long chunk;
+         for (size = 0; size < nbytes/sizeof(float); size += chunk){
+           chunk = MIN(PVTK_CHUNK, nbytes/sizeof(float) - size);
+           if (grank == 0) MPI_Recv (buf + size, (int)chunk, MPI_FLOAT, p, n + 3,
+                                     gcomm, &status);
+           else            MPI_Send (buf + size, (int)chunk, MPI_FLOAT, 0, n + 3,
+                                     gcomm);
+         }
+       }
+      #endif
+
+      if (grank == 0){
+        fwrite (&nbytes, sizeof(long long), 1, fp);
+        fwrite (buf, sizeof(float), np*nc, fp);
+      }
+    }
+  }
+
+  if (grank == 0){
+    fprintf (fp, "\n  </AppendedData>\n</VTKFile>\n");
+    fclose (fp);
+  }
+
+  FreeArray1D ((void *) buf);
+  FreeArray1D ((void *) offset);
+  FreeArray1D ((void *) gext);
+  #ifdef PARALLEL
+   MPI_Comm_free (&gcomm);
+  #endif
+}
+
+/* ********************************************************************* */
+static void PVTK_WriteIndex (Output *output, char *basename, int *all_ext,
+                             int *arr_nv, int *arr_nc, int narr, int nfiles,
+                             Grid *grid)
+/*!
+ * Write the index file <basename>.pvt[ir] listing the extent and the
+ * file of every piece.
+ * Called by processor 0 only.
+ *********************************************************************** */
+{
+  int  d, n, p, nproc;
+  char fname[512], *source;
+  FILE *fp;
+
+  #ifdef PARALLEL
+   MPI_Comm_size (AL_COMM_WORLD, &nproc);
+  #else
+   nproc = 1;
+  #endif
+  sprintf (fname, "%s.%s", basename, index_ext);
+  fp = fopen (fname, "w");
+  if (fp == NULL){
+    printf ("! WritePVTK: cannot open file %s\n", fname);
+    QUIT_PLUTO(1);
+  }
+
+/* -- the pieces are referred to relative to the index file -- */
+
+  source = strrchr (basename, '/');
+  source = (source == NULL ? basename : source + 1);
+
+  fprintf (fp, "<?xml version=\"1.0\"?>\n");
+  fprintf (fp, "<VTKFile type=\"%s\" version=\"1.0\" byte_order=\"%s\""
+               " header_type=\"UInt64\">\n",
+               image_data ? "PImageData":"PRectilinearGrid",
+               IsLittleEndian() ? "LittleEndian":"BigEndian");
+  fprintf (fp, "  <%s WholeExtent=\"",
+               image_data ? "PImageData":"PRectilinearGrid");
+  for (d = 0; d < 3; d++){
+    fprintf (fp, "%d %d%s", 0, d < DIMENSIONS ? grid[d].np_int_glob:0,
+                            d < 2 ? " ":"\"");
+  }
+  fprintf (fp, " GhostLevel=\"0\"");
+  if (image_data){
+    fprintf (fp, "\n    Origin=\"");
+    for (d = 0; d < 3; d++){
+      fprintf (fp, "%.9g%s", d < DIMENSIONS ? grid[d].xl_glob[grid[d].gbeg]:0.0,
+                             d < 2 ? " ":"\"");
+    }
+    fprintf (fp, " Spacing=\"");
+    for (d = 0; d < 3; d++){
+      fprintf (fp, "%.9g%s", d < DIMENSIONS ? grid[d].dx_glob[grid[d].gbeg]:1.0,
+                             d < 2 ? " ":"\"");
+    }
+  }
+  fprintf (fp, ">\n");
+
+  if (!image_data){
+    fprintf (fp, "    <PCoordinates>\n");
+    for (d = 0; d < 3; d++){
+      fprintf (fp, "      <PDataArray type=\"Float32\" Name=\"x%d\"/>\n", d + 1);
+    }
+    fprintf (fp, "    </PCoordinates>\n");
+  }
+
+  fprintf (fp, "    <PCellData>\n");
+  for (n = 0; n < narr; n++){
+    fprintf (fp, "      <PDataArray type=\"Float32\" Name=\"%s\"",
+             PVTK_ArrayName (output->var_name[arr_nv[n]], arr_nc[n]));
+    if (arr_nc[n] == 3) fprintf (fp, " NumberOfComponents=\"3\"");
+    fprintf (fp, "/>\n");
+  }
+  fprintf (fp, "    </PCellData>\n");
+
+  for (p = 0; p < nproc; p++){
+    fprintf (fp, "    <Piece Extent=\"%d %d %d %d %d %d\" Source=\"%s.p%04d.%s\"/>\n",
+             all_ext[6*p],     all_ext[6*p + 1], all_ext[6*p + 2],
+             all_ext[6*p + 3], all_ext[6*p + 4], all_ext[6*p + 5],
+             source, (int)(((long)p*nfiles)/nproc), piece_ext);
+  }
+  fprintf (fp, "  </%s>\n", image_data ? "PImageData":"PRectilinearGrid");
+  fprintf (fp, "</VTKFile>\n");
+  fclose (fp);
+}
@@ -62,7 +62,7 @@ void WriteTabArray (Output *output, char *filename, Grid *grid)
       fprintf (fout, "%f %f ", grid[IDIR].x[i], grid[JDIR].x[j]);
       for (nv = 0; nv < output->nvar; nv++) {
         if (output->dump_var[nv]) 
-          fprintf (fout, "%12.6e ", output->V[nv][k][j][i]);
+          fprintf (fout, "%12.6e ", GetOutputValue(output, nv, k, j, i, grid));
       }
       fprintf (fout, "\n");   /* newline */
     }
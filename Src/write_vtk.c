@@ -316,10 +316,16 @@ void WriteVTK_Vector (FILE *fvtk, Data_Arr V, double unit,
   int vel_field, mag_field;
   char header[512];
   static Float_Vect ***vect3D;
+  static int epoch;
   double v[3], x1, x2, x3;
 
+  if (vect3D != NULL && epoch != g_gridEpoch){
+    FreeArray3D ((void *) vect3D);
+    vect3D = NULL;
+  }
   if (vect3D == NULL){
     vect3D = ARRAY_3D(NX3_TOT, NX2_TOT, NX1_TOT, Float_Vect);
+    epoch  = g_gridEpoch;
   }
 
 /* --------------------------------------------------------
@@ -386,7 +392,7 @@ void WriteVTK_Scalar (FILE *fvtk, double ***V, double unit,
   sprintf (header,"%sLOOKUP_TABLE default\n",header);
 
   #ifdef PARALLEL
-   MPI_Barrier (MPI_COMM_WORLD);
+   MPI_Barrier (AL_COMM_WORLD);
    AL_Write_header (header, strlen(header), MPI_CHAR, SZ_float);
   #else
    fprintf (fvtk, "%s",header);
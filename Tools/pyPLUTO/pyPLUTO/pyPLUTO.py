@@ -331,6 +331,93 @@ class pload(object):
         vtkvardict = dict(zip(ks,vtkvar))
         return vtkvardict
             
+    def DataScanCMP(self, fp, myvars, endian):
+        """ Scans the compressed (lossy) data files written by PLUTO
+        (see write_cmp.c).
+
+        **Inputs**:
+
+          fp -- Data file pointer\n
+          myvars -- List of variable names stored in the file\n
+          endian -- Endianess of the data
+
+        **Output**:
+
+          Dictionary consisting of variable names as keys and its values.
+
+        """
+        if fp.read(8) != b'PLUTOCMP':
+            print "Not a PLUTO compressed file"
+            sys.exit()
+        hd = np.frombuffer(fp.read(28), dtype=endian+'i4')
+        nvar, bs, nproc = hd[1], hd[2], hd[3]
+        n1_tot, n2_tot, n3_tot = hd[4], hd[5], hd[6]
+        tol  = np.frombuffer(fp.read(8*nvar), dtype=endian+'f8')
+        vmin = np.frombuffer(fp.read(8*nvar), dtype=endian+'f8')
+        index = np.frombuffer(fp.read(40*nproc), dtype=np.dtype([
+                              ('beg', endian+'i4', 3), ('np', endian+'i4', 3),
+                              ('offset', endian+'i8'), ('nbytes', endian+'i8')]))
+
+        V = np.zeros((nvar, n3_tot, n2_tot, n1_tot))
+        for r in range(nproc):
+            b1, b2, b3 = index['beg'][r]
+            l1, l2, l3 = index['np'][r]
+            fp.seek(int(index['offset'][r]))
+            seg = np.frombuffer(fp.read(int(index['nbytes'][r])), dtype=np.uint8)
+
+          # Block corners and sizes, in the order they are written
+
+            k0, j0, i0 = np.meshgrid(np.arange(0, l3, bs), np.arange(0, l2, bs),
+                                     np.arange(0, l1, bs), indexing='ij')
+            k0 = k0.ravel(); j0 = j0.ravel(); i0 = i0.ravel()
+            nk = np.minimum(bs, l3 - k0)
+            nj = np.minimum(bs, l2 - j0)
+            ni = np.minimum(bs, l1 - i0)
+            nblk = len(k0)
+
+            pos = 0
+            for nv in range(nvar):
+                width = seg[pos:pos+nblk].astype(np.int64)
+                pos += nblk
+                raw = (width[0] == 255)
+                wbits = np.where(width == 255, 32, width)
+                nbits = wbits*nk*nj*ni
+                nbyte = (int(nbits.sum()) + 7)//8
+                bits = np.unpackbits(seg[pos:pos+nbyte]).astype(np.int64)
+                pos += nbyte
+                start = np.concatenate(([0], np.cumsum(nbits)[:-1]))
+
+              # Decode together all the blocks with same width and shape
+
+                Z = np.zeros((l3, l2, l1), dtype=np.int64)
+                key = ((wbits*(bs+1) + nk)*(bs+1) + nj)*(bs+1) + ni
+                for kv in np.unique(key):
+                    sel = np.where(key == kv)[0]
+                    w = wbits[sel[0]]
+                    sk, sj, si = nk[sel[0]], nj[sel[0]], ni[sel[0]]
+                    m = sk*sj*si
+                    ib = start[sel][:, None] + np.arange(m*w)[None, :]
+                    val = bits[ib].reshape(len(sel), m, w).dot(
+                          2**np.arange(w-1, -1, -1, dtype=np.int64))
+                    kk = k0[sel][:, None, None, None] + np.arange(sk)[None, :, None, None]
+                    jj = j0[sel][:, None, None, None] + np.arange(sj)[None, None, :, None]
+                    ii = i0[sel][:, None, None, None] + np.arange(si)[None, None, None, :]
+                    Z[kk, jj, ii] = val.reshape(len(sel), sk, sj, si)
+
+                if raw:
+                    x = Z.astype(np.uint32).view(np.float32)
+                else:
+                    Q = (Z >> 1) ^ -(Z & 1)
+                    Q = Q.cumsum(axis=2).cumsum(axis=1).cumsum(axis=0)
+                    x = vmin[nv] + 2.0*tol[nv]*Q
+                V[nv][b3:b3+l3, b2:b2+l2, b1:b1+l1] = x
+
+        cmpd = {}
+        for nv in range(nvar):
+            A = V[nv][np.ix_(self.krange, self.jrange, self.irange)]
+            cmpd[myvars[nv]] = np.reshape(A, self.nshp).transpose()
+        return cmpd
+
     def DataScanHDF5(self, fp, myvars, ilev):
         """ Scans the Chombo HDF5 data files for AMR in PLUTO. 
         
@@ -620,6 +707,8 @@ class pload(object):
         if self.datatype == 'vtk':
             vtkd = self.DataScanVTK(fp, n1, n2, n3, endian, dtype)
             ddict.update(vtkd)
+        elif self.datatype == 'cmp':
+            ddict.update(self.DataScanCMP(fp, myvars, endian))
         elif self.datatype == 'hdf5':
             h5d = self.DataScanHDF5(fp,myvars,self.level)
             ddict.update(h5d)      
@@ -695,6 +784,10 @@ class pload(object):
             dtype = "f"
             varfile = self.wdir+"vtk.out"
             dataext=".vtk"
+        elif self.datatype == "cmp":
+            dtype = "f"
+            varfile = self.wdir+"cmp.out"
+            dataext = ".cmp"
         elif self.datatype == 'hdf5':
             dtype = 'd'
             dataext = '.hdf5'
@@ -733,7 +826,7 @@ class pload(object):
                                    self.n3, endian, dtype, ddict)
         else:
             print "Wrong file type : CHECK pluto.ini for file type."
-            print "Only supported are .dbl, .flt, .vtk, .hdf5"
+            print "Only supported are .dbl, .flt, .vtk, .cmp, .hdf5"
             sys.exit()
 
         return ddict